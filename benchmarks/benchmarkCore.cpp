@@ -0,0 +1,1079 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkCore.cpp
+// =================
+// micro benchmarks of cs105core: Matrix4, Vector3, shapes, BmpLoader, MipChain,
+// the texture cache and the log queue
+//
+// Write the results as JSON, then compare 2 runs with compareBenchmarks.py:
+// benchmarkCore --benchmark_out=current.json --benchmark_out_format=json
+///////////////////////////////////////////////////////////////////////////////
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cwchar>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Matrices.h"
+#include "Vectors.h"
+#include "Cylinder.h"
+#include "Sphere.h"
+#include "Torus.h"
+#include "BmpLoader.h"
+#include "BinaryMesh.h"
+#include "KeyframeTrack.h"
+#include "Frustum.h"
+#include "MeshLod.h"
+#include "MipChain.h"
+#include "BlockCompressor.h"
+#include "TextureLoader.h"
+#include "LogQueue.h"
+#ifdef CS105_BENCHMARK_GL
+#include <GL/glu.h>
+#include "OffscreenGL.h"
+#include "TextureManager.h"
+#endif
+
+// test data
+static Matrix4 makeAffine()
+{
+    Matrix4 m;
+    m.scale(1.5f, 0.5f, 2.0f);
+    m.rotate(33.0f, 1, 2, 3);
+    m.translate(1, -2, 3);
+    return m;
+}
+
+static Matrix4 makeEuclidean()
+{
+    Matrix4 m;
+    m.rotate(33.0f, 1, 2, 3);
+    m.translate(1, -2, 3);
+    return m;
+}
+
+static Matrix4 makeProjective()
+{
+    Matrix4 m = makeAffine();
+    m[3] = 0.1f; m[7] = -0.2f; m[11] = 0.3f; m[15] = 1.5f;
+    return m;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Matrix4
+///////////////////////////////////////////////////////////////////////////////
+static void BM_Matrix4_Multiply(benchmark::State& state)
+{
+    Matrix4 a = makeAffine();
+    Matrix4 b = makeProjective();
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(a);
+        Matrix4 c = a * b;
+        benchmark::DoNotOptimize(c);
+    }
+}
+BENCHMARK(BM_Matrix4_Multiply);
+
+static void BM_Matrix4_MultiplyScalar(benchmark::State& state)
+{
+    Matrix4 a = makeAffine();
+    Matrix4 b = makeProjective();
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(a);
+        Matrix4 c = a.multiplyScalar(b);
+        benchmark::DoNotOptimize(c);
+    }
+}
+BENCHMARK(BM_Matrix4_MultiplyScalar);
+
+static void BM_Matrix4_MultiplyVector4(benchmark::State& state)
+{
+    Matrix4 m = makeProjective();
+    Vector4 v(1, 2, 3, 1);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(v);
+        Vector4 r = m * v;
+        benchmark::DoNotOptimize(r);
+    }
+}
+BENCHMARK(BM_Matrix4_MultiplyVector4);
+
+// invert functions modify the matrix, so restore the source every iteration
+#define BENCHMARK_INVERT(NAME, SOURCE, FUNC)                \
+static void NAME(benchmark::State& state)                   \
+{                                                           \
+    const Matrix4 src = SOURCE();                           \
+    for(auto _ : state)                                     \
+    {                                                       \
+        Matrix4 m = src;                                    \
+        benchmark::DoNotOptimize(m);                        \
+        m.FUNC();                                           \
+        benchmark::DoNotOptimize(m);                        \
+    }                                                       \
+}                                                           \
+BENCHMARK(NAME)
+
+BENCHMARK_INVERT(BM_Matrix4_Invert, makeProjective, invert);
+BENCHMARK_INVERT(BM_Matrix4_InvertEuclidean, makeEuclidean, invertEuclidean);
+BENCHMARK_INVERT(BM_Matrix4_InvertAffine, makeAffine, invertAffine);
+BENCHMARK_INVERT(BM_Matrix4_InvertAffineScalar, makeAffine, invertAffineScalar);
+BENCHMARK_INVERT(BM_Matrix4_InvertProjective, makeProjective, invertProjective);
+BENCHMARK_INVERT(BM_Matrix4_InvertGeneral, makeProjective, invertGeneral);
+BENCHMARK_INVERT(BM_Matrix4_InvertGeneralScalar, makeProjective, invertGeneralScalar);
+
+static void BM_Matrix4_Rotate(benchmark::State& state)
+{
+    Vector3 axis(1, 2, 3);
+    axis.normalize();
+    for(auto _ : state)
+    {
+        Matrix4 m = makeAffine();
+        m.rotate(33.0f, axis);
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_Matrix4_Rotate);
+
+static void BM_Matrix4_RotateXYZ(benchmark::State& state)
+{
+    for(auto _ : state)
+    {
+        Matrix4 m = makeAffine();
+        m.rotateX(10.0f);
+        m.rotateY(20.0f);
+        m.rotateZ(30.0f);
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_Matrix4_RotateXYZ);
+
+// model matrix of ModelGL: identity, rotZ, rotY, rotX, then translation
+static void BM_Matrix4_EulerTRSComposed(benchmark::State& state)
+{
+    float angle[3] = { 10.0f, 20.0f, 30.0f };
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(angle);
+        Matrix4 m;
+        m.rotateZ(angle[2]);
+        m.rotateY(angle[1]);
+        m.rotateX(angle[0]);
+        m.translate(1, 2, 3);
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_Matrix4_EulerTRSComposed);
+
+static void BM_Matrix4_EulerTRSFused(benchmark::State& state)
+{
+    float angle[3] = { 10.0f, 20.0f, 30.0f };
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(angle);
+        Matrix4 m = Matrix4::fromEulerTRS(angle[0], angle[1], angle[2], 1, 2, 3);
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_Matrix4_EulerTRSFused);
+
+// view matrix of ModelGL: identity, translation, rotX, rotY, then rotZ
+static void BM_Matrix4_TranslateEulerComposed(benchmark::State& state)
+{
+    float angle[3] = { 10.0f, 20.0f, 30.0f };
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(angle);
+        Matrix4 m;
+        m.translate(-1, -2, -3);
+        m.rotateX(angle[0]);
+        m.rotateY(angle[1]);
+        m.rotateZ(angle[2]);
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_Matrix4_TranslateEulerComposed);
+
+static void BM_Matrix4_TranslateEulerFused(benchmark::State& state)
+{
+    float angle[3] = { 10.0f, 20.0f, 30.0f };
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(angle);
+        Matrix4 m = Matrix4::fromTranslateEuler(-1, -2, -3, angle[0], angle[1], angle[2]);
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_Matrix4_TranslateEulerFused);
+
+static void BM_Matrix4_LookAt(benchmark::State& state)
+{
+    Vector3 target(3, 2, -5);
+    Vector3 up(0, 1, 0);
+    for(auto _ : state)
+    {
+        Matrix4 m;
+        m.translate(1, 2, 3);
+        benchmark::DoNotOptimize(target);
+        m.lookAt(target, up);
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_Matrix4_LookAt);
+
+static void BM_Matrix4_GetAngle(benchmark::State& state)
+{
+    Matrix4 m = makeEuclidean();
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(m);
+        Vector3 angle = m.getAngle();
+        benchmark::DoNotOptimize(angle);
+    }
+}
+BENCHMARK(BM_Matrix4_GetAngle);
+
+// batch transform of N points, SoA and interleaved (x,y,z,nx,ny,nz,s,t)
+static void BM_Matrix4_TransformSoA(benchmark::State& state)
+{
+    const int count = (int)state.range(0);
+    std::vector<float> x(count, 1.0f), y(count, 2.0f), z(count, 3.0f);
+    std::vector<float> outX(count), outY(count), outZ(count);
+    Matrix4 m = makeAffine();
+    for(auto _ : state)
+    {
+        m.transform(&x[0], &y[0], &z[0], &outX[0], &outY[0], &outZ[0], count);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Matrix4_TransformSoA)->Arg(1 << 10)->Arg(1 << 16);
+
+static void BM_Matrix4_TransformInterleaved(benchmark::State& state)
+{
+    const int count = (int)state.range(0);
+    const int stride = 8;
+    std::vector<float> src(count * stride, 1.0f), dst(count * stride);
+    Matrix4 m = makeAffine();
+    for(auto _ : state)
+    {
+        m.transform(&src[0], &dst[0], count, stride);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Matrix4_TransformInterleaved)->Arg(1 << 10)->Arg(1 << 16);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Vector3
+///////////////////////////////////////////////////////////////////////////////
+static void BM_Vector3_Normalize(benchmark::State& state)
+{
+    for(auto _ : state)
+    {
+        Vector3 v(1, 2, 3);
+        benchmark::DoNotOptimize(v);
+        v.normalize();
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(BM_Vector3_Normalize);
+
+static void BM_Vector3_Cross(benchmark::State& state)
+{
+    Vector3 a(1, 2, 3);
+    Vector3 b(-3, 1, 2);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(a);
+        Vector3 c = a.cross(b);
+        benchmark::DoNotOptimize(c);
+    }
+}
+BENCHMARK(BM_Vector3_Cross);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Quaternion, DualQuaternion and KeyframeTrack
+///////////////////////////////////////////////////////////////////////////////
+static void BM_Quaternion_Slerp(benchmark::State& state)
+{
+    Quaternion from = Quaternion::fromEuler(10, 20, 30);
+    Quaternion to = Quaternion::fromEuler(-40, 80, 120);
+    float t = 0.3f;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(t);
+        Quaternion q = Quaternion::slerp(from, to, t);
+        benchmark::DoNotOptimize(q);
+    }
+}
+BENCHMARK(BM_Quaternion_Slerp);
+
+static void BM_Quaternion_Nlerp(benchmark::State& state)
+{
+    Quaternion from = Quaternion::fromEuler(10, 20, 30);
+    Quaternion to = Quaternion::fromEuler(-40, 80, 120);
+    float t = 0.3f;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(t);
+        Quaternion q = Quaternion::nlerp(from, to, t);
+        benchmark::DoNotOptimize(q);
+    }
+}
+BENCHMARK(BM_Quaternion_Nlerp);
+
+static void BM_Quaternion_GetMatrix(benchmark::State& state)
+{
+    Quaternion q = Quaternion::fromEuler(10, 20, 30);
+    Vector3 position(1, 2, 3);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(q);
+        Matrix4 m = q.getMatrix(position);
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_Quaternion_GetMatrix);
+
+static void BM_Quaternion_FromMatrix(benchmark::State& state)
+{
+    Matrix4 m = Matrix4::fromEulerTRS(10, 20, 30, 1, 2, 3);
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(m);
+        Quaternion q = Quaternion::fromMatrix(m);
+        benchmark::DoNotOptimize(q);
+    }
+}
+BENCHMARK(BM_Quaternion_FromMatrix);
+
+static void BM_DualQuaternion_Blend(benchmark::State& state)
+{
+    DualQuaternion from(Quaternion::fromEuler(10, 20, 30), Vector3(1, 2, 3));
+    DualQuaternion to(Quaternion::fromEuler(-40, 80, 120), Vector3(-3, 0, 2));
+    float t = 0.3f;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(t);
+        DualQuaternion dq = DualQuaternion::blend(from, to, t);
+        benchmark::DoNotOptimize(dq);
+    }
+}
+BENCHMARK(BM_DualQuaternion_Blend);
+
+// sample the model matrix of a track, arg: # of keys
+static void BM_KeyframeTrack_GetMatrix(benchmark::State& state)
+{
+    KeyframeTrack track;
+    track.setLoop(true);
+    for(int i = 0; i < state.range(0); ++i)
+        track.addKey((float)i, i * 30.0f, i * 45.0f, i * 10.0f, (float)i, 0, 0);
+
+    float time = 0;
+    for(auto _ : state)
+    {
+        time += 0.013f;
+        Matrix4 m = track.getMatrix(time);
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_KeyframeTrack_GetMatrix)->Arg(4)->Arg(64);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Cylinder, args: sectorCount, stackCount
+///////////////////////////////////////////////////////////////////////////////
+// full build of all arrays, set() with the same params is a no-op now
+static void BM_Cylinder_Set(benchmark::State& state)
+{
+    unsigned int vertexCount = 0;
+    for(auto _ : state)
+    {
+        Cylinder cylinder(1.0f, 0.5f, 2.0f, (int)state.range(0), (int)state.range(1));
+        benchmark::DoNotOptimize(cylinder.getInterleavedVertices());
+        vertexCount = cylinder.getVertexCount();
+    }
+    state.counters["vertices"] = vertexCount;
+}
+BENCHMARK(BM_Cylinder_Set)->Args({36, 1})->Args({36, 8})->Args({128, 32})->Args({512, 128});
+
+// dragging a radius slider
+static void BM_Cylinder_SetBaseRadius(benchmark::State& state)
+{
+    Cylinder cylinder(1.0f, 0.5f, 2.0f, (int)state.range(0), (int)state.range(1));
+    float radius = 1.0f;
+    for(auto _ : state)
+    {
+        radius = (radius > 2.0f) ? 1.0f : radius + 0.01f;
+        cylinder.setBaseRadius(radius);
+        benchmark::DoNotOptimize(cylinder.getInterleavedVertices());
+    }
+}
+BENCHMARK(BM_Cylinder_SetBaseRadius)->Args({36, 1})->Args({128, 32})->Args({512, 128});
+
+// Sphere and Torus, args: sectorCount, stackCount (sideCount of Torus)
+static void BM_Sphere_Set(benchmark::State& state)
+{
+    unsigned int vertexCount = 0;
+    for(auto _ : state)
+    {
+        Sphere sphere(1.0f, (int)state.range(0), (int)state.range(1));
+        benchmark::DoNotOptimize(sphere.getInterleavedVertices());
+        vertexCount = sphere.getVertexCount();
+    }
+    state.counters["vertices"] = vertexCount;
+}
+BENCHMARK(BM_Sphere_Set)->Args({32, 16})->Args({128, 64});
+
+static void BM_Torus_Set(benchmark::State& state)
+{
+    unsigned int vertexCount = 0;
+    for(auto _ : state)
+    {
+        Torus torus(2.0f, 1.0f, (int)state.range(0), (int)state.range(1));
+        benchmark::DoNotOptimize(torus.getInterleavedVertices());
+        vertexCount = torus.getVertexCount();
+    }
+    state.counters["vertices"] = vertexCount;
+}
+BENCHMARK(BM_Torus_Set)->Args({64, 64})->Args({256, 128});
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Frustum: camera at the origin facing -Z, boxes scattered around it,
+// about 1/8 of them are visible
+///////////////////////////////////////////////////////////////////////////////
+static Frustum makeFrustum()
+{
+    // same as ModelGL::setFrustum(45, 1.5, 1, 10)
+    const float n = 1, f = 10;
+    float t = n * tanf(45.0f * 3.141593f / 360.0f);
+    float r = t * 1.5f;
+    Matrix4 projection(n / r, 0, 0, 0,
+                       0, n / t, 0, 0,
+                       0, 0, -(f + n) / (f - n), -1,
+                       0, 0, -2 * f * n / (f - n), 0);
+    return Frustum(projection * Matrix4::fromTranslateEuler(0, 0, 0, 0, 30, 0));
+}
+
+static std::vector<BoundingBox> makeBoxes(int count)
+{
+    std::vector<BoundingBox> boxes(count);
+    unsigned int seed = 1;
+    for(int i = 0; i < count; ++i)
+    {
+        float p[3];
+        for(int j = 0; j < 3; ++j)
+        {
+            seed = seed * 1664525u + 1013904223u;   // LCG, same boxes every run
+            p[j] = (seed >> 8) / 16777216.0f * 20.0f - 10.0f;
+        }
+        boxes[i] = BoundingBox(Vector3(p[0] - 0.5f, p[1] - 0.5f, p[2] - 0.5f),
+                               Vector3(p[0] + 0.5f, p[1] + 0.5f, p[2] + 0.5f));
+    }
+    return boxes;
+}
+
+static void BM_Frustum_TestSpheres(benchmark::State& state)
+{
+    Frustum frustum = makeFrustum();
+    std::vector<BoundingBox> boxes = makeBoxes((int)state.range(0));
+    std::vector<Vector3> centers;
+    std::vector<float> radii;
+    for(size_t i = 0; i < boxes.size(); ++i)
+    {
+        centers.push_back(boxes[i].getCenter());
+        radii.push_back(boxes[i].getRadius());
+    }
+    for(auto _ : state)
+    {
+        int visibleCount = 0;
+        for(size_t i = 0; i < centers.size(); ++i)
+            visibleCount += frustum.testSphere(centers[i], radii[i]) ? 1 : 0;
+        benchmark::DoNotOptimize(visibleCount);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Frustum_TestSpheres)->Arg(4096);
+
+static void BM_Frustum_TestSpheresBatch(benchmark::State& state)
+{
+    Frustum frustum = makeFrustum();
+    std::vector<BoundingBox> boxes = makeBoxes((int)state.range(0));
+    std::vector<Vector4> spheres;
+    for(size_t i = 0; i < boxes.size(); ++i)
+    {
+        Vector3 center = boxes[i].getCenter();
+        spheres.push_back(Vector4(center.x, center.y, center.z, boxes[i].getRadius()));
+    }
+    std::vector<unsigned char> visible(spheres.size());
+    for(auto _ : state)
+    {
+        int visibleCount = frustum.testSpheres(&spheres[0], (int)spheres.size(), &visible[0]);
+        benchmark::DoNotOptimize(visibleCount);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Frustum_TestSpheresBatch)->Arg(4096);
+
+static void BM_Frustum_TestBoxes(benchmark::State& state)
+{
+    Frustum frustum = makeFrustum();
+    std::vector<BoundingBox> boxes = makeBoxes((int)state.range(0));
+    std::vector<unsigned char> visible(boxes.size());
+    for(auto _ : state)
+    {
+        int visibleCount = frustum.testBoxes(&boxes[0], (int)boxes.size(), &visible[0]);
+        benchmark::DoNotOptimize(visibleCount);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Frustum_TestBoxes)->Arg(4096);
+
+static void BM_BoundingBox_Transform(benchmark::State& state)
+{
+    BoundingBox box(Vector3(-1, -2, -3), Vector3(1, 2, 3));
+    Matrix4 m = makeAffine();
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(m);
+        BoundingBox b = box.transform(m);
+        benchmark::DoNotOptimize(b);
+    }
+}
+BENCHMARK(BM_BoundingBox_Transform);
+
+// LOD selection of the instances as ModelGL::drawInstances(): project the
+// bounding sphere and choose the level with the last level for hysteresis
+static void BM_MeshLod_SelectLevel(benchmark::State& state)
+{
+    MeshLod lod(64, 64, 8, 8);
+    Matrix4 view = Matrix4::fromTranslateEuler(0, 0, 0, 0, 30, 0);
+    float pixelsPerUnit = MeshLod::getPixelsPerUnit(2.414214f, 400);    // fovY = 45
+    std::vector<BoundingBox> boxes = makeBoxes((int)state.range(0));
+    std::vector<unsigned char> levels(boxes.size(), 0);
+    for(auto _ : state)
+    {
+        for(size_t i = 0; i < boxes.size(); ++i)
+        {
+            float diameter = MeshLod::getScreenDiameter(view * boxes[i].getCenter(), boxes[i].getRadius(), pixelsPerUnit);
+            levels[i] = (unsigned char)lod.selectLevel(diameter, levels[i]);
+        }
+        benchmark::DoNotOptimize(levels.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MeshLod_SelectLevel)->Arg(4096);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// BmpLoader: decode a 24-bit BMP file from the source tree
+///////////////////////////////////////////////////////////////////////////////
+static void BM_BmpLoader_Decode(benchmark::State& state)
+{
+    const std::string fileName = std::string(CS105_DATA_DIR) + "/brics.bmp";
+    int64_t imageSize = 0;
+    for(auto _ : state)
+    {
+        BmpLoader bmp;
+        if(!bmp.load(fileName.c_str()))
+        {
+            state.SkipWithError(bmp.getErrorMessage().c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(bmp.getPixels());
+        imageSize = (int64_t)bmp.getPixelSize();
+    }
+    state.SetBytesProcessed(state.iterations() * imageSize);
+}
+BENCHMARK(BM_BmpLoader_Decode);
+
+///////////////////////////////////////////////////////////////////////////////
+// BmpLoader: decode a large generated BMP file (8K x 4K, 24-bit), swizzled to
+// RGB (arg 1) or kept in BGR for GL_BGR (arg 0, no copy)
+///////////////////////////////////////////////////////////////////////////////
+static void BM_BmpLoader_DecodeLarge(benchmark::State& state)
+{
+    const int width = 8192;
+    const int height = 4096;
+    const char* fileName = "benchmark_8k.bmp";
+    {
+        std::vector<unsigned char> pixels((size_t)width * height * 3);
+        for(size_t i = 0; i < pixels.size(); ++i)
+            pixels[i] = (unsigned char)(i * 7);
+        if(!BmpLoader::save(fileName, &pixels[0], width, height, 3))
+        {
+            state.SkipWithError("cannot write benchmark_8k.bmp");
+            return;
+        }
+    }
+
+    bool swapToRgb = state.range(0) != 0;
+    for(auto _ : state)
+    {
+        BmpLoader bmp;
+        bmp.load(fileName, swapToRgb);
+        benchmark::DoNotOptimize(bmp.getPixels());
+        if(!swapToRgb)
+        {
+            // touch every page like an upload would do
+            unsigned int sum = 0;
+            const unsigned char* p = bmp.getPixels();
+            for(size_t i = 0; i < bmp.getPixelSize(); i += 4096)
+                sum += p[i];
+            benchmark::DoNotOptimize(sum);
+        }
+    }
+    remove(fileName);
+    state.SetBytesProcessed(state.iterations() * (int64_t)width * height * 3);
+}
+BENCHMARK(BM_BmpLoader_DecodeLarge)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+///////////////////////////////////////////////////////////////////////////////
+// BmpLoader: swap red and blue of 8K row in cache, SIMD vs scalar
+///////////////////////////////////////////////////////////////////////////////
+static void BM_BmpLoader_SwapRedBlue(benchmark::State& state)
+{
+    int channels = (int)state.range(0);
+    std::vector<unsigned char> src((size_t)8192 * channels, 100), dst(src.size());
+    for(auto _ : state)
+    {
+        BmpLoader::swapRedBlue(&src[0], &dst[0], 8192, channels);
+        benchmark::DoNotOptimize(&dst[0]);
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)src.size());
+}
+BENCHMARK(BM_BmpLoader_SwapRedBlue)->Arg(3)->Arg(4);
+
+static void BM_BmpLoader_SwapRedBlueScalar(benchmark::State& state)
+{
+    int channels = (int)state.range(0);
+    std::vector<unsigned char> src((size_t)8192 * channels, 100), dst(src.size());
+    for(auto _ : state)
+    {
+        BmpLoader::swapRedBlueScalar(&src[0], &dst[0], 8192, channels);
+        benchmark::DoNotOptimize(&dst[0]);
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)src.size());
+}
+BENCHMARK(BM_BmpLoader_SwapRedBlueScalar)->Arg(3)->Arg(4);
+
+///////////////////////////////////////////////////////////////////////////////
+// BinaryMesh: map the baked teapot and decode all vertices and indices
+///////////////////////////////////////////////////////////////////////////////
+static void BM_BinaryMesh_LoadTeapot(benchmark::State& state)
+{
+    const std::string fileName = std::string(CS105_DATA_DIR) + "/teapot.mesh";
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    for(auto _ : state)
+    {
+        BinaryMesh mesh;
+        if(!mesh.open(fileName.c_str()))
+        {
+            state.SkipWithError("cannot open teapot.mesh");
+            return;
+        }
+
+        vertices.resize(mesh.getVertexCount() * 6);
+        for(unsigned int i = 0; i < mesh.getVertexCount(); ++i)
+        {
+            mesh.getPosition(i, &vertices[i * 6]);
+            mesh.getNormal(i, &vertices[i * 6 + 3]);
+        }
+        indices.resize(mesh.getIndexCount());
+        for(unsigned int i = 0; i < mesh.getIndexCount(); ++i)
+            indices[i] = mesh.getIndex(i);
+        benchmark::DoNotOptimize(&vertices[0]);
+        benchmark::DoNotOptimize(&indices[0]);
+    }
+}
+BENCHMARK(BM_BinaryMesh_LoadTeapot);
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MipChain: build all levels of RGB image on CPU (size, filter, gamma, threads)
+///////////////////////////////////////////////////////////////////////////////
+static std::vector<unsigned char> makeImage(int size)
+{
+    std::vector<unsigned char> pixels((size_t)size * size * 3);
+    for(size_t i = 0; i < pixels.size(); ++i)
+        pixels[i] = (unsigned char)((i * 7) ^ (i >> 11));
+    return pixels;
+}
+
+static void BM_MipChain_Build(benchmark::State& state)
+{
+    int size = (int)state.range(0);
+    std::vector<unsigned char> pixels = makeImage(size);
+    MipChain mipChain;
+    mipChain.setFilter((MipFilter)state.range(1));
+    mipChain.setGammaCorrect(state.range(2) != 0);
+    mipChain.setThreadCount((int)state.range(3));
+    for(auto _ : state)
+    {
+        mipChain.build(&pixels[0], size, size, 3);
+        benchmark::DoNotOptimize(mipChain.getPixels(0));
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)pixels.size());
+}
+BENCHMARK(BM_MipChain_Build)->ArgNames({"size", "filter", "gamma", "threads"})
+    ->Args({1024, MIP_FILTER_BOX, 0, 1})->Args({4096, MIP_FILTER_BOX, 0, 1})->Args({8192, MIP_FILTER_BOX, 0, 1})
+    ->Args({4096, MIP_FILTER_BOX, 0, 0})->Args({4096, MIP_FILTER_BOX, 1, 1})
+    ->Args({1024, MIP_FILTER_KAISER, 0, 1})->Args({4096, MIP_FILTER_KAISER, 0, 1})->Args({4096, MIP_FILTER_KAISER, 0, 0})
+    ->Unit(benchmark::kMillisecond);
+
+///////////////////////////////////////////////////////////////////////////////
+// MipChain: 2x2 box filter of 1024x1024 RGB/RGBA, SIMD vs scalar
+///////////////////////////////////////////////////////////////////////////////
+static void BM_MipChain_Halve(benchmark::State& state)
+{
+    int channels = (int)state.range(0);
+    std::vector<unsigned char> src((size_t)1024 * 1024 * channels, 100), dst(src.size() / 4);
+    for(auto _ : state)
+    {
+        MipChain::halve(&src[0], 1024, 1024, &dst[0], 512, 512, channels);
+        benchmark::DoNotOptimize(&dst[0]);
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)src.size());
+}
+BENCHMARK(BM_MipChain_Halve)->Arg(3)->Arg(4);
+
+static void BM_MipChain_HalveScalar(benchmark::State& state)
+{
+    int channels = (int)state.range(0);
+    std::vector<unsigned char> src((size_t)1024 * 1024 * channels, 100), dst(src.size() / 4);
+    for(auto _ : state)
+    {
+        MipChain::halveScalar(&src[0], 1024, 1024, &dst[0], 512, 512, channels);
+        benchmark::DoNotOptimize(&dst[0]);
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)src.size());
+}
+BENCHMARK(BM_MipChain_HalveScalar)->Arg(3)->Arg(4);
+
+///////////////////////////////////////////////////////////////////////////////
+// BlockCompressor: 1024x1024 RGB to BC1 (arg 0), RGBA to BC3 (arg 1)
+///////////////////////////////////////////////////////////////////////////////
+static void BM_BlockCompressor_Encode(benchmark::State& state)
+{
+    int channels = state.range(0) ? 4 : 3;
+    std::vector<unsigned char> pixels = makeImage(1024);
+    if(channels == 4)
+        pixels.resize((size_t)1024 * 1024 * 4, 200);
+    std::vector<unsigned char> blocks(BlockCompressor::getSize(1024, 1024, BlockCompressor::BC3_BLOCK_SIZE));
+    for(auto _ : state)
+    {
+        if(channels == 4)
+            BlockCompressor::encodeBc3(&pixels[0], 1024, 1024, 4, &blocks[0]);
+        else
+            BlockCompressor::encodeBc1(&pixels[0], 1024, 1024, 3, &blocks[0]);
+        benchmark::DoNotOptimize(&blocks[0]);
+    }
+    state.SetBytesProcessed(state.iterations() * (int64_t)1024 * 1024 * channels);
+}
+BENCHMARK(BM_BlockCompressor_Encode)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+///////////////////////////////////////////////////////////////////////////////
+// write 4K x 4K 24-bit BMP for the texture cache benchmarks
+///////////////////////////////////////////////////////////////////////////////
+const char* CACHE_BENCHMARK_BMP = "benchmark_4k.bmp";
+const char* CACHE_BENCHMARK_DIR = "benchmark_cache";
+
+static bool writeCacheBenchmarkBmp()
+{
+    std::vector<unsigned char> pixels = makeImage(4096);
+    return BmpLoader::save(CACHE_BENCHMARK_BMP, &pixels[0], 4096, 4096, 3);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// TextureLoader: get all levels of 4K x 4K texture on the calling thread,
+// decoded with mipmaps (arg 0), mapped from the cache (arg 1), or mapped from
+// the BC1 compressed cache (arg 2)
+///////////////////////////////////////////////////////////////////////////////
+static void BM_TextureLoader_Decode(benchmark::State& state)
+{
+    if(!writeCacheBenchmarkBmp())
+    {
+        state.SkipWithError("cannot write benchmark_4k.bmp");
+        return;
+    }
+
+    TextureLoader loader;
+    if(state.range(0) > 0)
+        loader.setCache(CACHE_BENCHMARK_DIR, state.range(0) == 2);
+    TextureImage image;
+    image.path = CACHE_BENCHMARK_BMP;
+    loader.decode(image);                   // write the cache
+
+    size_t bytes = 0;
+    for(auto _ : state)
+    {
+        loader.decode(image);
+        const unsigned char* p = image.file.isOpen() ? image.file.getPixels(0) : image.mipChain.getPixels(0);
+        bytes = image.file.isOpen() ? image.file.getByteSize() : image.mipChain.getByteSize();
+
+        // touch every page like an upload would do
+        unsigned int sum = 0;
+        for(size_t i = 0; i < bytes; i += 4096)
+            sum += p[i];
+        benchmark::DoNotOptimize(sum);
+    }
+    state.counters["texture_MB"] = bytes / (1024.0 * 1024.0);
+    if(state.range(0) > 0 && loader.getCacheHitCount() == 0)
+        state.SkipWithError("texture cache is not used");
+
+    image.file.close();
+    remove(CACHE_BENCHMARK_BMP);
+}
+BENCHMARK(BM_TextureLoader_Decode)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+///////////////////////////////////////////////////////////////////////////////
+// log: latency of logging a line from 1 or 4 threads
+// LogQueue_Push only queues the message, a consumer thread drains it to a file
+// every 10 ms like the log thread of Win::Log. The producers here log far more
+// often than the app, so most messages are dropped (the "dropped" counter).
+// LogQueue_PushPop is the cost of a message that is accepted, pushed and
+// popped on the same thread. Log_SyncWrite is the former
+// path: format the time, write and flush the file on the calling thread (with
+// a lock to be safe from 4 threads).
+///////////////////////////////////////////////////////////////////////////////
+const char* LOG_BENCHMARK_FILE = "benchmark_log.txt";
+const wchar_t* LOG_BENCHMARK_MESSAGE = L"Loaded texture: brics.bmp (1024 x 1024), 3 channels";
+
+static int64_t getLogTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// static, new of the 64-byte aligned members is not aligned in C++11
+static LogQueue logQueue(256);
+static uint64_t logDropCount;           // drop count before the run
+static std::thread logConsumer;
+static std::atomic<bool> logStopping;
+
+static void drainLogQueue()
+{
+    std::wofstream file(LOG_BENCHMARK_FILE);
+    std::wstring buffer;
+    while(true)
+    {
+        bool stopping = logStopping.load();
+        const LogRecord* record;
+        while((record = logQueue.peek()) != 0)
+        {
+            wchar_t time[16];
+            swprintf(time, 16, L"%d:%02d:%02d", (int)(record->time / 3600000000000LL % 24),
+                     (int)(record->time / 60000000000LL % 60), (int)(record->time / 1000000000 % 60));
+            buffer += time;
+            buffer += L"  ";
+            buffer.append(record->text, record->length);
+            buffer += L'\n';
+            logQueue.pop();
+        }
+        if(!buffer.empty())
+        {
+            file.write(buffer.data(), buffer.size());
+            file.flush();
+            buffer.clear();
+        }
+        if(stopping)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+static void BM_LogQueue_Push(benchmark::State& state)
+{
+    if(state.thread_index() == 0)
+    {
+        logDropCount = logQueue.getDropCount();     // the consumer emptied the queue
+        logStopping = false;
+        logConsumer = std::thread(drainLogQueue);
+    }
+
+    int64_t pushed = 0;
+    for(auto _ : state)
+    {
+        logQueue.push(LOG_BENCHMARK_MESSAGE, getLogTime());
+        ++pushed;
+    }
+
+    if(state.thread_index() == 0)
+    {
+        logStopping = true;
+        logConsumer.join();
+        state.counters["dropped"] = (double)(logQueue.getDropCount() - logDropCount);
+        remove(LOG_BENCHMARK_FILE);
+    }
+    state.SetItemsProcessed(pushed);
+}
+BENCHMARK(BM_LogQueue_Push)->Threads(1)->Threads(4)->UseRealTime();
+
+static void BM_LogQueue_PushPop(benchmark::State& state)
+{
+    LogQueue queue(256);
+    for(auto _ : state)
+    {
+        queue.push(LOG_BENCHMARK_MESSAGE, getLogTime());
+        benchmark::DoNotOptimize(queue.peek());
+        queue.pop();
+    }
+    if(queue.getDropCount() > 0)
+        state.SkipWithError("message is dropped");
+}
+BENCHMARK(BM_LogQueue_PushPop);
+
+static std::wofstream logFile;
+static std::mutex logMutex;
+
+static void BM_Log_SyncWrite(benchmark::State& state)
+{
+    if(state.thread_index() == 0)
+        logFile.open(LOG_BENCHMARK_FILE);
+
+    int64_t written = 0;
+    for(auto _ : state)
+    {
+        int64_t t = getLogTime();
+        std::wstringstream wss;
+        wss << std::setfill(L'0');
+        wss << (t / 3600000000000LL % 24) << L":" << std::setw(2)
+            << (t / 60000000000LL % 60) << L":" << std::setw(2)
+            << (t / 1000000000 % 60);
+
+        std::lock_guard<std::mutex> lock(logMutex);
+        logFile << wss.str() << L"  " << LOG_BENCHMARK_MESSAGE << L"\n" << std::flush;
+        ++written;
+    }
+
+    if(state.thread_index() == 0)
+    {
+        logFile.close();
+        remove(LOG_BENCHMARK_FILE);
+    }
+    state.SetItemsProcessed(written);
+}
+BENCHMARK(BM_Log_SyncWrite)->Threads(1)->Threads(4)->UseRealTime();
+
+#ifdef CS105_BENCHMARK_GL
+///////////////////////////////////////////////////////////////////////////////
+// create a texture with all mipmaps of RGB image in an offscreen context:
+// gluBuild2DMipmaps (arg 0) vs MipChain box + glTexImage2D per level (arg 1)
+///////////////////////////////////////////////////////////////////////////////
+static void BM_MipChain_UploadVsGlu(benchmark::State& state)
+{
+    static OffscreenGL offscreen;
+    if(!offscreen.getWidth() && !offscreen.create(16, 16))
+    {
+        state.SkipWithError(offscreen.getErrorMessage().c_str());
+        return;
+    }
+
+    int size = (int)state.range(0);
+    std::vector<unsigned char> pixels = makeImage(size);
+    MipChain mipChain;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for(auto _ : state)
+    {
+        GLuint id;
+        glGenTextures(1, &id);
+        glBindTexture(GL_TEXTURE_2D, id);
+        if(state.range(1) == 0)
+        {
+            gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGB, size, size, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+        }
+        else
+        {
+            mipChain.build(&pixels[0], size, size, 3);
+            for(int i = 0; i < mipChain.getLevelCount(); ++i)
+            {
+                const MipLevel& level = mipChain.getLevel(i);
+                glTexImage2D(GL_TEXTURE_2D, i, GL_RGB, level.width, level.height, 0, GL_RGB, GL_UNSIGNED_BYTE, mipChain.getPixels(i));
+            }
+        }
+        glFinish();
+        glDeleteTextures(1, &id);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    state.SetBytesProcessed(state.iterations() * (int64_t)pixels.size());
+}
+BENCHMARK(BM_MipChain_UploadVsGlu)->ArgNames({"size", "mipchain"})
+    ->Args({1024, 0})->Args({1024, 1})->Args({4096, 0})->Args({4096, 1})->Args({8192, 0})->Args({8192, 1})
+    ->Unit(benchmark::kMillisecond);
+
+///////////////////////////////////////////////////////////////////////////////
+// startup of TextureManager until 4K x 4K texture is uploaded with all levels:
+// without cache (arg 0), with the cache (arg 1), with the BC1 cache (arg 2)
+// texture_MB is the texture memory of all levels
+///////////////////////////////////////////////////////////////////////////////
+static void BM_TextureManager_Startup(benchmark::State& state)
+{
+    static OffscreenGL offscreen;
+    if(!offscreen.getWidth() && !offscreen.create(16, 16))
+    {
+        state.SkipWithError(offscreen.getErrorMessage().c_str());
+        return;
+    }
+    if(!writeCacheBenchmarkBmp())
+    {
+        state.SkipWithError("cannot write benchmark_4k.bmp");
+        return;
+    }
+
+    bool compress = state.range(0) == 2;
+    if(state.range(0) > 0)
+    {
+        // write the cache first
+        TextureManager textureManager;
+        textureManager.setCache(CACHE_BENCHMARK_DIR, compress);
+        textureManager.init(1);
+        textureManager.getTexture(CACHE_BENCHMARK_BMP);
+        textureManager.finish();
+        textureManager.clear();
+        if(compress && !textureManager.isCompressionSupported())
+        {
+            state.SkipWithError("S3TC is not supported");
+            return;
+        }
+    }
+
+    unsigned int bytes = 0;
+    for(auto _ : state)
+    {
+        TextureManager textureManager;
+        if(state.range(0) > 0)
+            textureManager.setCache(CACHE_BENCHMARK_DIR, compress);
+        textureManager.init(1);
+        textureManager.getTexture(CACHE_BENCHMARK_BMP);
+        textureManager.finish();
+        glFinish();
+        bytes = textureManager.getBytesResident();
+        textureManager.clear();
+    }
+    state.counters["texture_MB"] = bytes / (1024.0 * 1024.0);
+    remove(CACHE_BENCHMARK_BMP);
+}
+BENCHMARK(BM_TextureManager_Startup)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+#endif
+
+BENCHMARK_MAIN();
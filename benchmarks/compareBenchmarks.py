@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+###############################################################################
+# compareBenchmarks.py
+# ====================
+# regression gate for Google Benchmark JSON results
+# It compares the time of each benchmark in CURRENT with BASELINE, prints the
+# change in percent, and exits with 1 if any benchmark is slower than the
+# threshold. If the runs have repetitions, the median aggregate is used.
+#
+# USAGE: compareBenchmarks.py BASELINE.json CURRENT.json [--threshold PERCENT]
+#                             [--metric real_time|cpu_time] [--filter REGEX]
+###############################################################################
+
+import argparse
+import json
+import re
+import sys
+
+
+def loadTimes(fileName, metric):
+    """return {name: time in ns} from Google Benchmark JSON output"""
+    with open(fileName) as f:
+        data = json.load(f)
+
+    scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    times = {}
+    medians = {}
+    for b in data.get("benchmarks", []):
+        if b.get("error_occurred"):
+            continue
+        time = b[metric] * scale[b.get("time_unit", "ns")]
+        runType = b.get("run_type", "iteration")
+        if runType == "aggregate":
+            if b.get("aggregate_name") == "median":
+                medians[b["run_name"]] = time
+        else:
+            name = b.get("run_name", b["name"])
+            times.setdefault(name, []).append(time)
+
+    # prefer median of repetitions, otherwise the mean of the iteration runs
+    result = dict((name, sum(t) / len(t)) for name, t in times.items())
+    result.update(medians)
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="fail if any benchmark slows down")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="max allowed slowdown in percent (default: 10)")
+    parser.add_argument("--metric", default="real_time", choices=["real_time", "cpu_time"])
+    parser.add_argument("--filter", default="", help="compare only names matching REGEX")
+    args = parser.parse_args()
+
+    baseline = loadTimes(args.baseline, args.metric)
+    current = loadTimes(args.current, args.metric)
+    pattern = re.compile(args.filter)
+
+    regressions = []
+    width = max([len(n) for n in current] + [4])
+    print("%-*s %12s %12s %8s" % (width, "name", "baseline", "current", "change"))
+    for name in sorted(current):
+        if not pattern.search(name):
+            continue
+        if name not in baseline:
+            print("%-*s %12s %10.1fns %8s" % (width, name, "-", current[name], "new"))
+            continue
+        change = (current[name] - baseline[name]) / baseline[name] * 100.0
+        flag = ""
+        if change > args.threshold:
+            regressions.append(name)
+            flag = "  <-- SLOWER"
+        print("%-*s %10.1fns %10.1fns %+7.1f%%%s" %
+              (width, name, baseline[name], current[name], change, flag))
+
+    for name in sorted(set(baseline) - set(current)):
+        if pattern.search(name):
+            print("%-*s %10.1fns %12s %8s" % (width, name, baseline[name], "-", "removed"))
+
+    if regressions:
+        print("\n%d benchmark(s) slower than %.1f%%: %s" %
+              (len(regressions), args.threshold, ", ".join(regressions)))
+        return 1
+    print("\nno regression over %.1f%%" % args.threshold)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
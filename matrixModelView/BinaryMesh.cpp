@@ -0,0 +1,253 @@
+///////////////////////////////////////////////////////////////////////////////
+// BinaryMesh.cpp
+// ==============
+// compact binary mesh file, mapped into memory without any parsing
+// The vertex positions are quantized to 16-bit in the bounding box, and the
+// normals are 16-bit signed normalized. The indices of triangle list are
+// 16-bit if the mesh has up to 65536 vertices, otherwise 32-bit.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "BinaryMesh.h"
+
+// constants
+const char MESH_MAGIC[4] = { 'M', 'E', 'S', 'H' };
+const uint32_t MESH_VERSION = 1;
+const float POSITION_SCALE = 65535.0f;
+const float NORMAL_SCALE = 32767.0f;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor/dtor
+///////////////////////////////////////////////////////////////////////////////
+BinaryMesh::BinaryMesh() : data(0), size(0), header(0), fileHandle(0), mappingHandle(0)
+{
+}
+
+BinaryMesh::~BinaryMesh()
+{
+    close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// map the mesh file into memory, then check the header and the file size
+///////////////////////////////////////////////////////////////////////////////
+bool BinaryMesh::open(const char* fileName)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, 0);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        errorMessage = std::string("cannot open ") + fileName;
+        return false;
+    }
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    size = (size_t)fileSize.QuadPart;
+
+    HANDLE mapping = size ? CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0) : 0;
+    if(mapping)
+    {
+        mappingHandle = mapping;
+        data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    int fd = ::open(fileName, O_RDONLY);
+    if(fd < 0)
+    {
+        errorMessage = std::string("cannot open ") + fileName;
+        return false;
+    }
+
+    struct stat status;
+    if(fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        size = (size_t)status.st_size;
+        data = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED)
+            data = 0;
+    }
+    ::close(fd);    // the mapping stays valid after closing the file
+#endif
+
+    if(!data)
+    {
+        errorMessage = std::string("cannot map ") + fileName;
+        close();
+        return false;
+    }
+
+    // validate the header, so the getters do not need any check
+    const MeshHeader* h = (const MeshHeader*)data;
+    if(size < sizeof(MeshHeader) || memcmp(h->magic, MESH_MAGIC, 4) != 0 || h->version != MESH_VERSION)
+    {
+        errorMessage = std::string("invalid mesh file ") + fileName;
+        close();
+        return false;
+    }
+    if((h->indexSize != 2 && h->indexSize != 4) ||
+       (uint64_t)h->vertexOffset + (uint64_t)h->vertexCount * sizeof(MeshVertex) > size ||
+       (uint64_t)h->indexOffset + (uint64_t)h->indexCount * h->indexSize > size)
+    {
+        errorMessage = std::string("corrupted mesh file ") + fileName;
+        close();
+        return false;
+    }
+
+    // every index must refer to a vertex, the indices are copied to the draw
+    // buffers without any check
+    header = h;
+    for(unsigned int i = 0; i < h->indexCount; ++i)
+    {
+        if(getIndex(i) >= h->vertexCount)
+        {
+            errorMessage = std::string("corrupted mesh file ") + fileName + " (index out of range)";
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// unmap the file
+///////////////////////////////////////////////////////////////////////////////
+void BinaryMesh::close()
+{
+#ifdef _WIN32
+    if(data)
+        UnmapViewOfFile(data);
+    if(mappingHandle)
+        CloseHandle((HANDLE)mappingHandle);
+    if(fileHandle)
+        CloseHandle((HANDLE)fileHandle);
+    mappingHandle = fileHandle = 0;
+#else
+    if(data)
+        munmap((void*)data, size);
+#endif
+    data = 0;
+    size = 0;
+    header = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// decode position, normal and index
+///////////////////////////////////////////////////////////////////////////////
+void BinaryMesh::getPosition(unsigned int i, float position[3]) const
+{
+    const MeshVertex& v = getVertices()[i];
+    for(int j = 0; j < 3; ++j)
+    {
+        float range = header->boundsMax[j] - header->boundsMin[j];
+        position[j] = header->boundsMin[j] + v.position[j] * (range / POSITION_SCALE);
+    }
+}
+
+void BinaryMesh::getNormal(unsigned int i, float normal[3]) const
+{
+    const MeshVertex& v = getVertices()[i];
+    for(int j = 0; j < 3; ++j)
+        normal[j] = v.normal[j] / NORMAL_SCALE;
+}
+
+unsigned int BinaryMesh::getIndex(unsigned int i) const
+{
+    if(header->indexSize == 2)
+        return ((const uint16_t*)getIndices())[i];
+    else
+        return ((const uint32_t*)getIndices())[i];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// quantize the vertices and write them with the indices of triangle list
+///////////////////////////////////////////////////////////////////////////////
+bool BinaryMesh::save(const char* fileName, const float* positions, const float* normals,
+                      unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+    MeshHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESH_MAGIC, 4);
+    header.version = MESH_VERSION;
+    header.vertexCount = vertexCount;
+    header.indexCount = indexCount;
+    header.indexSize = (vertexCount <= 65536) ? 2 : 4;
+    header.primitive = 0;
+    header.vertexOffset = sizeof(MeshHeader);
+    header.indexOffset = header.vertexOffset + vertexCount * sizeof(MeshVertex);
+
+    // bounding box
+    for(int j = 0; j < 3; ++j)
+        header.boundsMin[j] = header.boundsMax[j] = vertexCount ? positions[j] : 0;
+    for(unsigned int i = 0; i < vertexCount; ++i)
+    {
+        for(int j = 0; j < 3; ++j)
+        {
+            float p = positions[i * 3 + j];
+            if(p < header.boundsMin[j]) header.boundsMin[j] = p;
+            if(p > header.boundsMax[j]) header.boundsMax[j] = p;
+        }
+    }
+
+    std::vector<MeshVertex> vertices(vertexCount);
+    for(unsigned int i = 0; i < vertexCount; ++i)
+    {
+        for(int j = 0; j < 3; ++j)
+        {
+            float range = header.boundsMax[j] - header.boundsMin[j];
+            float p = (range > 0) ? (positions[i * 3 + j] - header.boundsMin[j]) / range : 0;
+            vertices[i].position[j] = (uint16_t)floorf(p * POSITION_SCALE + 0.5f);
+
+            float n = normals[i * 3 + j];
+            n = (n > 1.0f) ? 1.0f : (n < -1.0f ? -1.0f : n);
+            vertices[i].normal[j] = (int16_t)floorf(n * NORMAL_SCALE + 0.5f);
+        }
+    }
+
+    FILE* file = fopen(fileName, "wb");
+    if(!file)
+        return false;
+
+    bool result = fwrite(&header, sizeof(header), 1, file) == 1;
+    if(vertexCount)
+        result = result && fwrite(&vertices[0], sizeof(MeshVertex), vertexCount, file) == vertexCount;
+    if(header.indexSize == 2)
+    {
+        std::vector<uint16_t> shortIndices(indices, indices + indexCount);
+        if(indexCount)
+            result = result && fwrite(&shortIndices[0], 2, indexCount, file) == indexCount;
+    }
+    else if(indexCount)
+    {
+        result = result && fwrite(indices, 4, indexCount, file) == indexCount;
+    }
+
+    fclose(file);
+    return result;
+}
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// BinaryMesh.h
+// ============
+// compact binary mesh file, mapped into memory without any parsing
+// The vertex positions are quantized to 16-bit in the bounding box, and the
+// normals are 16-bit signed normalized. The indices of triangle list are
+// 16-bit if the mesh has up to 65536 vertices, otherwise 32-bit.
+// The files are baked offline by tools/meshBake.
+//
+// file layout (little-endian):
+// MeshHeader (64 bytes)
+// MeshVertex * vertexCount (12 bytes each) at vertexOffset
+// uint16_t or uint32_t * indexCount at indexOffset
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BINARY_MESH_H
+#define BINARY_MESH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+struct MeshHeader
+{
+    char magic[4];                          // "MESH"
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize;                     // 2 or 4 bytes
+    uint32_t primitive;                     // 0: triangle list
+    uint32_t vertexOffset;                  // bytes from the beginning of file
+    uint32_t indexOffset;
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t reserved[2];
+};
+
+struct MeshVertex
+{
+    uint16_t position[3];                   // 0 ~ 65535 in the bounding box
+    int16_t normal[3];                      // -32767 ~ 32767
+};
+
+class BinaryMesh
+{
+public:
+    BinaryMesh();
+    ~BinaryMesh();
+
+    bool open(const char* fileName);        // map the file into memory, validate the header and indices
+    void close();
+    bool isOpen() const                     { return header != 0; }
+
+    unsigned int getVertexCount() const     { return header ? header->vertexCount : 0; }
+    unsigned int getIndexCount() const      { return header ? header->indexCount : 0; }
+    unsigned int getIndexSize() const       { return header ? header->indexSize : 0; }
+    const float* getBoundsMin() const       { return header->boundsMin; }
+    const float* getBoundsMax() const       { return header->boundsMax; }
+    const MeshVertex* getVertices() const   { return (const MeshVertex*)((const char*)data + header->vertexOffset); }
+    const void* getIndices() const          { return (const char*)data + header->indexOffset; }
+
+    // decode a single vertex or index
+    void getPosition(unsigned int i, float position[3]) const;
+    void getNormal(unsigned int i, float normal[3]) const;
+    unsigned int getIndex(unsigned int i) const;
+
+    const std::string& getErrorMessage() const  { return errorMessage; }
+
+    // write triangle list (xyz positions and normals) to a file
+    static bool save(const char* fileName, const float* positions, const float* normals,
+                     unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+
+private:
+    const void* data;                       // mapped file
+    size_t size;
+    const MeshHeader* header;               // 0 if not opened
+    void* fileHandle;                       // for Windows
+    void* mappingHandle;
+    std::string errorMessage;
+};
+
+#endif
@@ -0,0 +1,348 @@
+///////////////////////////////////////////////////////////////////////////////
+// BlockCompressor.cpp
+// ===================
+// CPU encoder of S3TC block compressed textures (BC1 and BC3)
+// See BlockCompressor.h for the endpoint selection.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include "BlockCompressor.h"
+
+// constants //////////////////////////////////////////////////////////////////
+const int COLOR_INSET_SHIFT = 4;            // inset the endpoints by 1/16 of range
+const int POWER_ITERATIONS = 4;             // to find the principal axis of colors
+const int ALPHA_INSET_SHIFT = 5;            // 1/32 of alpha range
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// convert RGB888 to RGB565, and back to RGB888 as the decoder does
+///////////////////////////////////////////////////////////////////////////////
+static unsigned short toRgb565(const int color[3])
+{
+    int r = (color[0] * 31 + 127) / 255;    // rounded
+    int g = (color[1] * 63 + 127) / 255;
+    int b = (color[2] * 31 + 127) / 255;
+    return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+static void fromRgb565(unsigned short rgb565, int color[3])
+{
+    int r = (rgb565 >> 11) & 31;
+    int g = (rgb565 >> 5) & 63;
+    int b = rgb565 & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// round and clamp to 0 ~ 255
+///////////////////////////////////////////////////////////////////////////////
+static int clampColor(float c)
+{
+    int i = (int)(c + 0.5f);
+    return (i < 0) ? 0 : ((i > 255) ? 255 : i);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// choose the nearest of 4 colors interpolated between 2 RGB565 endpoints for
+// each texel, return 2-bit indices (texel 0 at the lowest bits) and the sum
+// of squared errors
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int matchColors(const unsigned char rgba[64], unsigned short color0, unsigned short color1, int& error)
+{
+    // palette as decoded
+    int palette[4][3];
+    fromRgb565(color0, palette[0]);
+    fromRgb565(color1, palette[1]);
+    for(int j = 0; j < 3; ++j)
+    {
+        palette[2][j] = (2 * palette[0][j] + palette[1][j]) / 3;
+        palette[3][j] = (palette[0][j] + 2 * palette[1][j]) / 3;
+    }
+
+    unsigned int indices = 0;
+    error = 0;
+    for(int i = 15; i >= 0; --i)
+    {
+        const unsigned char* texel = rgba + i * 4;
+        int bestIndex = 0;
+        int bestError = 0x7fffffff;
+        for(int k = 0; k < 4; ++k)
+        {
+            int dr = texel[0] - palette[k][0];
+            int dg = texel[1] - palette[k][1];
+            int db = texel[2] - palette[k][2];
+            int e = dr * dr + dg * dg + db * db;
+            if(e < bestError)
+            {
+                bestError = e;
+                bestIndex = k;
+            }
+        }
+        indices = (indices << 2) | bestIndex;
+        error += bestError;
+    }
+    return indices;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return bytes of compressed image
+///////////////////////////////////////////////////////////////////////////////
+size_t BlockCompressor::getSize(int width, int height, int blockSize)
+{
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// compress RGB(A) to BC1 or BC3
+///////////////////////////////////////////////////////////////////////////////
+void BlockCompressor::encodeBc1(const unsigned char* pixels, int width, int height, int channelCount, unsigned char* dst)
+{
+    encode(pixels, width, height, channelCount, dst, false);
+}
+
+void BlockCompressor::encodeBc3(const unsigned char* pixels, int width, int height, int channelCount, unsigned char* dst)
+{
+    encode(pixels, width, height, channelCount, dst, true);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// gather each 4x4 block into 16 RGBA texels, then encode it
+// The texels out of the image repeat the last column and row.
+///////////////////////////////////////////////////////////////////////////////
+void BlockCompressor::encode(const unsigned char* pixels, int width, int height, int channelCount,
+                             unsigned char* dst, bool alpha)
+{
+    unsigned char block[64];
+    size_t rowSize = (size_t)width * channelCount;
+    for(int by = 0; by < height; by += 4)
+    {
+        for(int bx = 0; bx < width; bx += 4)
+        {
+            for(int y = 0; y < 4; ++y)
+            {
+                int py = (by + y < height) ? by + y : height - 1;
+                const unsigned char* row = pixels + rowSize * py;
+                for(int x = 0; x < 4; ++x)
+                {
+                    int px = (bx + x < width) ? bx + x : width - 1;
+                    const unsigned char* src = row + (size_t)px * channelCount;
+                    unsigned char* texel = block + (y * 4 + x) * 4;
+                    texel[0] = src[0];
+                    texel[1] = src[1];
+                    texel[2] = src[2];
+                    texel[3] = (channelCount == 4) ? src[3] : 255;
+                }
+            }
+
+            if(alpha)
+            {
+                encodeAlphaBlock(block, dst);
+                dst += 8;
+            }
+            encodeBc1Block(block, dst);
+            dst += 8;
+        }
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// encode 16 texels to a BC1 color block in 4-color mode
+// color0 > color1 as RGB565; if they are same, the palette is a single color
+///////////////////////////////////////////////////////////////////////////////
+void BlockCompressor::encodeBc1Block(const unsigned char rgba[64], unsigned char dst[8])
+{
+    // mean and covariance of the colors
+    float mean[3] = { 0, 0, 0 };
+    for(int i = 0; i < 16; ++i)
+    {
+        for(int j = 0; j < 3; ++j)
+            mean[j] += rgba[i * 4 + j];
+    }
+    for(int j = 0; j < 3; ++j)
+        mean[j] /= 16;
+
+    float cov[6] = { 0, 0, 0, 0, 0, 0 };    // rr, rg, rb, gg, gb, bb
+    for(int i = 0; i < 16; ++i)
+    {
+        float r = rgba[i * 4] - mean[0];
+        float g = rgba[i * 4 + 1] - mean[1];
+        float b = rgba[i * 4 + 2] - mean[2];
+        cov[0] += r * r;  cov[1] += r * g;  cov[2] += r * b;
+        cov[3] += g * g;  cov[4] += g * b;  cov[5] += b * b;
+    }
+
+    // principal axis by power iteration, starting from the diagonal
+    float axis[3] = { 1, 1, 1 };
+    for(int k = 0; k < POWER_ITERATIONS; ++k)
+    {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float m = fabsf(x) > fabsf(y) ? fabsf(x) : fabsf(y);
+        if(fabsf(z) > m)
+            m = fabsf(z);
+        if(m == 0)
+            break;                          // all texels are same
+        axis[0] = x / m;
+        axis[1] = y / m;
+        axis[2] = z / m;
+    }
+
+    // extent of the colors along the axis
+    float minDot = 0, maxDot = 0;
+    for(int i = 0; i < 16; ++i)
+    {
+        float d = (rgba[i * 4] - mean[0]) * axis[0] + (rgba[i * 4 + 1] - mean[1]) * axis[1] +
+                  (rgba[i * 4 + 2] - mean[2]) * axis[2];
+        if(i == 0 || d < minDot) minDot = d;
+        if(i == 0 || d > maxDot) maxDot = d;
+    }
+
+    // endpoints on the axis, inset to the colors close to the optimal ones
+    float inset = (maxDot - minDot) / (1 << COLOR_INSET_SHIFT);
+    minDot += inset;
+    maxDot -= inset;
+    int minColor[3], maxColor[3];
+    float axisLength2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    for(int j = 0; j < 3; ++j)
+    {
+        float t = axisLength2 > 0 ? axis[j] / axisLength2 : 0;
+        minColor[j] = clampColor(mean[j] + minDot * t);
+        maxColor[j] = clampColor(mean[j] + maxDot * t);
+    }
+
+    unsigned short color0 = toRgb565(maxColor);
+    unsigned short color1 = toRgb565(minColor);
+    int error;
+    unsigned int indices = matchColors(rgba, color0, color1, error);
+
+    // refine the endpoints once by least squares with the chosen indices,
+    // keep them only if the error is smaller
+    if(error > 0)
+    {
+        const float weights[4] = { 1.0f, 0.0f, 2.0f / 3, 1.0f / 3 };   // of color0 for each index
+        float aa = 0, ab = 0, bb = 0;
+        float ax[3] = { 0, 0, 0 };
+        float bx[3] = { 0, 0, 0 };
+        for(int i = 0; i < 16; ++i)
+        {
+            float a = weights[(indices >> (2 * i)) & 3];
+            float b = 1 - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for(int j = 0; j < 3; ++j)
+            {
+                ax[j] += a * rgba[i * 4 + j];
+                bx[j] += b * rgba[i * 4 + j];
+            }
+        }
+
+        float det = aa * bb - ab * ab;
+        if(fabsf(det) > 1e-6f)
+        {
+            for(int j = 0; j < 3; ++j)
+            {
+                maxColor[j] = clampColor((ax[j] * bb - bx[j] * ab) / det);
+                minColor[j] = clampColor((bx[j] * aa - ax[j] * ab) / det);
+            }
+            int refinedError;
+            unsigned short refined0 = toRgb565(maxColor);
+            unsigned short refined1 = toRgb565(minColor);
+            unsigned int refinedIndices = matchColors(rgba, refined0, refined1, refinedError);
+            if(refinedError < error)
+            {
+                color0 = refined0;
+                color1 = refined1;
+                indices = refinedIndices;
+            }
+        }
+    }
+
+    // 4-color mode needs color0 > color1, swap with the indices (0<->1, 2<->3)
+    if(color0 < color1)
+    {
+        unsigned short tmp = color0;
+        color0 = color1;
+        color1 = tmp;
+        indices ^= 0x55555555;
+    }
+
+    // little-endian
+    dst[0] = (unsigned char)(color0 & 0xff);
+    dst[1] = (unsigned char)(color0 >> 8);
+    dst[2] = (unsigned char)(color1 & 0xff);
+    dst[3] = (unsigned char)(color1 >> 8);
+    dst[4] = (unsigned char)(indices & 0xff);
+    dst[5] = (unsigned char)((indices >> 8) & 0xff);
+    dst[6] = (unsigned char)((indices >> 16) & 0xff);
+    dst[7] = (unsigned char)(indices >> 24);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// encode alpha of 16 texels to a BC3 alpha block in 8-alpha mode
+// alpha0 > alpha1, or all texels take alpha0 if they are same
+///////////////////////////////////////////////////////////////////////////////
+void BlockCompressor::encodeAlphaBlock(const unsigned char rgba[64], unsigned char dst[8])
+{
+    int minAlpha = 255;
+    int maxAlpha = 0;
+    for(int i = 0; i < 16; ++i)
+    {
+        int a = rgba[i * 4 + 3];
+        if(a < minAlpha) minAlpha = a;
+        if(a > maxAlpha) maxAlpha = a;
+    }
+    int inset = (maxAlpha - minAlpha) >> ALPHA_INSET_SHIFT;
+    minAlpha += inset;
+    maxAlpha -= inset;
+
+    unsigned long long indices = 0;
+    if(maxAlpha > minAlpha)
+    {
+        int palette[8];
+        palette[0] = maxAlpha;
+        palette[1] = minAlpha;
+        for(int k = 1; k < 7; ++k)
+            palette[k + 1] = ((7 - k) * maxAlpha + k * minAlpha) / 7;
+
+        for(int i = 15; i >= 0; --i)
+        {
+            int a = rgba[i * 4 + 3];
+            int bestIndex = 0;
+            int bestError = 256;
+            for(int k = 0; k < 8; ++k)
+            {
+                int error = (a > palette[k]) ? a - palette[k] : palette[k] - a;
+                if(error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = k;
+                }
+            }
+            indices = (indices << 3) | bestIndex;
+        }
+    }
+
+    dst[0] = (unsigned char)maxAlpha;
+    dst[1] = (unsigned char)minAlpha;
+    for(int i = 0; i < 6; ++i)
+        dst[2 + i] = (unsigned char)((indices >> (8 * i)) & 0xff);
+}
@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////
+// BlockCompressor.h
+// =================
+// CPU encoder of S3TC block compressed textures
+// BC1 (DXT1) stores each 4x4 texel block of RGB in 8 bytes: 2 endpoint colors
+// in RGB565, and a 2-bit index per texel to 4 colors interpolated between
+// them. BC3 (DXT5) adds 8 bytes of alpha for RGBA: 2 endpoint alphas and a
+// 3-bit index per texel to 8 interpolated alphas.
+//
+// The color endpoints are the extent of the block colors along their
+// principal axis, inset by 1/16 of the range, then each texel takes the
+// nearest of the palette. The endpoints are refined once by least squares
+// with the chosen indices. The alpha endpoints are the min and max alpha,
+// inset by 1/32 of the range.
+// It is fast enough to run once when a texture is cached, but not as good as
+// an exhaustive (cluster fit) encoder.
+// The blocks on the right and top edges of a size not multiple of 4 repeat
+// the last column/row.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BLOCK_COMPRESSOR_H
+#define BLOCK_COMPRESSOR_H
+
+#include <stddef.h>
+
+class BlockCompressor
+{
+public:
+    // bytes of a 4x4 block
+    static const int BC1_BLOCK_SIZE = 8;
+    static const int BC3_BLOCK_SIZE = 16;
+
+    // bytes of compressed image, ceil(w/4) * ceil(h/4) blocks
+    static size_t getSize(int width, int height, int blockSize);
+
+    // compress tightly packed RGB(A) pixels, the block rows follow the pixel
+    // rows (first block row is the first 4 rows of pixels)
+    // BC1 ignores alpha of 4-channel pixels, BC3 takes 1.0 as alpha of RGB
+    static void encodeBc1(const unsigned char* pixels, int width, int height, int channelCount, unsigned char* dst);
+    static void encodeBc3(const unsigned char* pixels, int width, int height, int channelCount, unsigned char* dst);
+
+    // a single block of 16 RGBA texels
+    static void encodeBc1Block(const unsigned char rgba[64], unsigned char dst[8]);
+    static void encodeAlphaBlock(const unsigned char rgba[64], unsigned char dst[8]);
+
+private:
+    static void encode(const unsigned char* pixels, int width, int height, int channelCount,
+                       unsigned char* dst, bool alpha);
+};
+
+#endif
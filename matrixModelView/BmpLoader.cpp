@@ -1,31 +1,365 @@
+///////////////////////////////////////////////////////////////////////////////
+// BmpLoader.cpp
+// =============
+// BMP decoder without any dependency on the platform headers
+// The file is mapped into memory, then the headers are validated before any
+// pixel is read. Uncompressed 24-bit (BGR) and 32-bit (BGRA) images are
+// supported, bottom-up or top-down, with the rows padded to 4 bytes.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
 #include "BmpLoader.h"
-#include<stdio.h>
-BmpLoader::BmpLoader(const char* filename) {
-	FILE* file = 0;
-	file = fopen(filename, "rb");
-	if (!file) {
-		std::cout << "File not found" << std::endl;
-	}
-	fread(&bfh, sizeof(BITMAPFILEHEADER), 1, file);
-	if (bfh.bfType != 0x4D42)
-		std::cout << "Not a valid bitmap" << std:: endl;
-	fread(&bih, sizeof(BITMAPINFOHEADER), 1, file);
-	if (bih.biSizeImage == 0)
-		bih.biSizeImage = bih.biHeight * bih.biWidth*3;
-	textureData = new unsigned char[bih.biSizeImage];
-	fseek(file, bfh.bfOffBits, SEEK_SET);
-	fread(textureData,1,bih.biSizeImage, file);
-	unsigned char temp;
-	for (int i = 0; i < bih.biSizeImage; i+= 3) {
-		temp = textureData[i];
-		textureData[i] = textureData[i + 2];
-		textureData[i + 2] = temp;
-	}
-	iWidth = bih.biWidth;
-	iHeight = bih.biHeight;
-	fclose(file);
-}
-
-BmpLoader::~BmpLoader() {
-	delete[] textureData;
-}
\ No newline at end of file
+
+#if defined(BMP_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(BMP_SIMD)
+#include <tmmintrin.h>
+#endif
+
+// constants
+const uint16_t BMP_TYPE = 0x4D42;           // "BM"
+const uint32_t BMP_RGB = 0;                 // BI_RGB, uncompressed
+const uint32_t BMP_BITFIELDS = 3;           // BI_BITFIELDS, uncompressed with masks
+const uint32_t BMP_INFO_SIZE = 40;          // BITMAPINFOHEADER
+const int32_t BMP_MAX_DIMENSION = 65536;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor/dtor
+///////////////////////////////////////////////////////////////////////////////
+BmpLoader::BmpLoader() : data(0), size(0), fileHandle(0), mappingHandle(0),
+                         pixels(0), width(0), height(0), channelCount(0), bgr(false)
+{
+}
+
+BmpLoader::BmpLoader(const char* fileName, bool swapToRgb) : data(0), size(0), fileHandle(0), mappingHandle(0),
+                                                            pixels(0), width(0), height(0), channelCount(0), bgr(false)
+{
+    load(fileName, swapToRgb);
+}
+
+BmpLoader::~BmpLoader()
+{
+    close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// map the file, validate the headers, then convert the rows if needed
+// The rows are copied only if they have to be flipped (top-down), unpadded
+// or swizzled to RGB, all in a single pass.
+///////////////////////////////////////////////////////////////////////////////
+bool BmpLoader::load(const char* fileName, bool swapToRgb)
+{
+    close();
+    errorMessage.clear();
+
+    if(!map(fileName))
+        return false;
+
+    // headers
+    BmpFileHeader fileHeader;
+    BmpInfoHeader infoHeader;
+    if(size < sizeof(BmpFileHeader) + sizeof(BmpInfoHeader))
+    {
+        errorMessage = std::string("invalid bitmap file ") + fileName;
+        close();
+        return false;
+    }
+    memcpy(&fileHeader, data, sizeof(BmpFileHeader));   // may be unaligned in the mapped file
+    memcpy(&infoHeader, (const char*)data + sizeof(BmpFileHeader), sizeof(BmpInfoHeader));
+    if(fileHeader.type != BMP_TYPE || infoHeader.size < BMP_INFO_SIZE || infoHeader.planes != 1)
+    {
+        errorMessage = std::string("invalid bitmap file ") + fileName;
+        close();
+        return false;
+    }
+
+    // format, BI_BITFIELDS only if the masks are same as BGRA
+    bool supported = infoHeader.bitCount == 24 && infoHeader.compression == BMP_RGB;
+    if(infoHeader.bitCount == 32)
+    {
+        supported = infoHeader.compression == BMP_RGB;
+        if(infoHeader.compression == BMP_BITFIELDS &&
+           size >= sizeof(BmpFileHeader) + BMP_INFO_SIZE + 3 * sizeof(uint32_t))
+        {
+            uint32_t masks[3];          // R, G, B, right after 40-byte header for all versions
+            memcpy(masks, (const char*)data + sizeof(BmpFileHeader) + BMP_INFO_SIZE, sizeof(masks));
+            supported = masks[0] == 0x00ff0000 && masks[1] == 0x0000ff00 && masks[2] == 0x000000ff;
+        }
+    }
+    if(!supported)
+    {
+        errorMessage = std::string("unsupported bitmap format (24/32-bit uncompressed only) ") + fileName;
+        close();
+        return false;
+    }
+
+    // dimensions and pixel bounds, the last row may be unpadded
+    bool topDown = infoHeader.height < 0;
+    int32_t rows = topDown ? -infoHeader.height : infoHeader.height;
+    if(infoHeader.width <= 0 || infoHeader.width > BMP_MAX_DIMENSION || rows <= 0 || rows > BMP_MAX_DIMENSION)
+    {
+        errorMessage = std::string("invalid bitmap dimensions ") + fileName;
+        close();
+        return false;
+    }
+    int channels = infoHeader.bitCount / 8;
+    uint64_t rowSize = (uint64_t)infoHeader.width * channels;
+    uint64_t stride = (rowSize + 3) & ~(uint64_t)3;
+    if((uint64_t)fileHeader.offBits + stride * (rows - 1) + rowSize > size)
+    {
+        errorMessage = std::string("truncated bitmap file ") + fileName;
+        close();
+        return false;
+    }
+
+    width = infoHeader.width;
+    height = rows;
+    channelCount = channels;
+    bgr = !swapToRgb;
+
+    // use the mapped pixels as is if possible
+    const unsigned char* src = (const unsigned char*)data + fileHeader.offBits;
+    if(!swapToRgb && !topDown && stride == rowSize)
+    {
+        pixels = src;
+        return true;
+    }
+
+    // otherwise, convert rows to bottom-up and tightly packed
+    buffer.resize(getPixelSize());
+    for(int i = 0; i < height; ++i)
+    {
+        const unsigned char* srcRow = src + stride * (topDown ? height - 1 - i : i);
+        unsigned char* dstRow = &buffer[0] + rowSize * i;
+        if(swapToRgb)
+            swapRedBlue(srcRow, dstRow, width, channelCount);
+        else
+            memcpy(dstRow, srcRow, (size_t)rowSize);
+    }
+    pixels = &buffer[0];
+
+    // the mapping is no longer needed
+    unmap();
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// release the pixels and unmap the file
+///////////////////////////////////////////////////////////////////////////////
+void BmpLoader::close()
+{
+    unmap();
+    std::vector<unsigned char>().swap(buffer);
+    pixels = 0;
+    width = height = channelCount = 0;
+    bgr = false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// map the whole file as read-only
+///////////////////////////////////////////////////////////////////////////////
+bool BmpLoader::map(const char* fileName)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, 0);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        errorMessage = std::string("cannot open ") + fileName;
+        return false;
+    }
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    size = (size_t)fileSize.QuadPart;
+
+    HANDLE mapping = size ? CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0) : 0;
+    if(mapping)
+    {
+        mappingHandle = mapping;
+        data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    int fd = ::open(fileName, O_RDONLY);
+    if(fd < 0)
+    {
+        errorMessage = std::string("cannot open ") + fileName;
+        return false;
+    }
+
+    struct stat status;
+    if(fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        size = (size_t)status.st_size;
+        data = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED)
+            data = 0;
+    }
+    ::close(fd);    // the mapping stays valid after closing the file
+#endif
+
+    if(!data)
+    {
+        errorMessage = std::string("cannot map ") + fileName;
+        unmap();
+        return false;
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// unmap the file, the pixels must not point into the mapping after it
+///////////////////////////////////////////////////////////////////////////////
+void BmpLoader::unmap()
+{
+#ifdef _WIN32
+    if(data)
+        UnmapViewOfFile(data);
+    if(mappingHandle)
+        CloseHandle((HANDLE)mappingHandle);
+    if(fileHandle)
+        CloseHandle((HANDLE)fileHandle);
+    mappingHandle = fileHandle = 0;
+#else
+    if(data)
+        munmap((void*)data, size);
+#endif
+    data = 0;
+    size = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// swap red and blue of BGR(A) pixels
+// 24-bit: 4 pixels (12 bytes) per 16-byte shuffle, the last 4 bytes are
+// copied as is and overwritten by the next store, so it stops 2 pixels early.
+// 32-bit: 4 pixels per SSSE3 shuffle, or 8 pixels per AVX2 shuffle.
+///////////////////////////////////////////////////////////////////////////////
+void BmpLoader::swapRedBlue(const unsigned char* src, unsigned char* dst, size_t pixelCount, int channelCount)
+{
+    size_t i = 0;
+#ifdef BMP_SIMD
+    if(channelCount == 3)
+    {
+        const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15);
+        for(; i + 6 <= pixelCount; i += 4)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i * 3));
+            _mm_storeu_si128((__m128i*)(dst + i * 3), _mm_shuffle_epi8(v, mask));
+        }
+    }
+    else
+    {
+#ifdef BMP_SIMD_AVX2
+        const __m256i mask8 = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                               2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        for(; i + 8 <= pixelCount; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(src + i * 4));
+            _mm256_storeu_si256((__m256i*)(dst + i * 4), _mm256_shuffle_epi8(v, mask8));
+        }
+#endif
+        const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+        for(; i + 4 <= pixelCount; i += 4)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i * 4));
+            _mm_storeu_si128((__m128i*)(dst + i * 4), _mm_shuffle_epi8(v, mask));
+        }
+    }
+#endif
+
+    // remaining pixels
+    swapRedBlueScalar(src + i * channelCount, dst + i * channelCount, pixelCount - i, channelCount);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// scalar version of swapRedBlue(), for comparison
+///////////////////////////////////////////////////////////////////////////////
+void BmpLoader::swapRedBlueScalar(const unsigned char* src, unsigned char* dst, size_t pixelCount, int channelCount)
+{
+    for(size_t i = 0; i < pixelCount; ++i)
+    {
+        unsigned char b = src[0];
+        unsigned char g = src[1];
+        unsigned char r = src[2];
+        dst[0] = r;
+        dst[1] = g;
+        dst[2] = b;
+        if(channelCount == 4)
+            dst[3] = src[3];
+        src += channelCount;
+        dst += channelCount;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// write RGB(A) pixels to an uncompressed bottom-up BMP file
+///////////////////////////////////////////////////////////////////////////////
+bool BmpLoader::save(const char* fileName, const unsigned char* pixels, int width, int height, int channelCount)
+{
+    if(!pixels || width <= 0 || height <= 0 || (channelCount != 3 && channelCount != 4))
+        return false;
+
+    size_t rowSize = (size_t)width * channelCount;
+    size_t stride = (rowSize + 3) & ~(size_t)3;
+    size_t headerSize = sizeof(BmpFileHeader) + sizeof(BmpInfoHeader);
+
+    BmpFileHeader fileHeader;
+    memset(&fileHeader, 0, sizeof(fileHeader));
+    fileHeader.type = BMP_TYPE;
+    fileHeader.size = (uint32_t)(headerSize + stride * height);
+    fileHeader.offBits = (uint32_t)headerSize;
+
+    BmpInfoHeader infoHeader;
+    memset(&infoHeader, 0, sizeof(infoHeader));
+    infoHeader.size = BMP_INFO_SIZE;
+    infoHeader.width = width;
+    infoHeader.height = height;
+    infoHeader.planes = 1;
+    infoHeader.bitCount = (uint16_t)(channelCount * 8);
+    infoHeader.compression = BMP_RGB;
+    infoHeader.sizeImage = (uint32_t)(stride * height);
+
+    FILE* file = fopen(fileName, "wb");
+    if(!file)
+        return false;
+
+    fwrite(&fileHeader, sizeof(fileHeader), 1, file);
+    fwrite(&infoHeader, sizeof(infoHeader), 1, file);
+    std::vector<unsigned char> row(stride, 0);
+    for(int i = 0; i < height; ++i)
+    {
+        swapRedBlue(pixels + rowSize * i, &row[0], width, channelCount);
+        fwrite(&row[0], 1, stride, file);
+    }
+
+    bool written = ferror(file) == 0;
+    fclose(file);
+    return written;
+}
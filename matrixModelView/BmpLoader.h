@@ -1,16 +1,105 @@
-#pragma once
-#include<windows.h>
-#include<iostream>
+///////////////////////////////////////////////////////////////////////////////
+// BmpLoader.h
+// ===========
+// BMP decoder without any dependency on the platform headers
+// The file is mapped into memory, then the headers are validated before any
+// pixel is read. Uncompressed 24-bit (BGR) and 32-bit (BGRA) images are
+// supported, bottom-up or top-down, with the rows padded to 4 bytes.
+//
+// The pixels are always returned bottom-up (first row is the bottom of the
+// image, same as glTexImage2D), and tightly packed, 3 or 4 bytes per pixel.
+// With swapToRgb, the blue and red are swapped for GL_RGB/GL_RGBA (SSSE3 or
+// AVX2 shuffles if available). Without it, the pixels stay in BGR/BGRA for
+// GL_BGR/GL_BGRA, and are not copied at all if the rows in the file need no
+// flip and no padding removal.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BMP_LOADER_H
+#define BMP_LOADER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// SSSE3 for 24/32-bit swizzle, AVX2 for 32-bit
+#if !defined(BMP_NO_SIMD) && (defined(__SSSE3__) || defined(__AVX2__))
+#define BMP_SIMD
+#if defined(__AVX2__)
+#define BMP_SIMD_AVX2
+#endif
+#endif
+
+// same layout as BITMAPFILEHEADER and BITMAPINFOHEADER of windows.h
+#pragma pack(push, 2)
+struct BmpFileHeader
+{
+    uint16_t type;                          // "BM"
+    uint32_t size;
+    uint16_t reserved1;
+    uint16_t reserved2;
+    uint32_t offBits;                       // bytes from the beginning of file to pixels
+};
+
+struct BmpInfoHeader
+{
+    uint32_t size;                          // 40 or larger (V4, V5 headers)
+    int32_t  width;
+    int32_t  height;                        // negative if top-down
+    uint16_t planes;
+    uint16_t bitCount;
+    uint32_t compression;
+    uint32_t sizeImage;
+    int32_t  xPelsPerMeter;
+    int32_t  yPelsPerMeter;
+    uint32_t clrUsed;
+    uint32_t clrImportant;
+};
+#pragma pack(pop)
+
 class BmpLoader
 {
 public:
-	unsigned char* textureData;
-	int iWidth, iHeight;
-	BmpLoader(const char*);
-	
-	~BmpLoader();
+    BmpLoader();
+    explicit BmpLoader(const char* fileName, bool swapToRgb=true);  // same as load()
+    ~BmpLoader();
+
+    bool load(const char* fileName, bool swapToRgb=true);   // false if cannot open or invalid
+    void close();                                           // release pixels and unmap the file
+    bool isLoaded() const                   { return pixels != 0; }
+
+    int getWidth() const                    { return width; }
+    int getHeight() const                   { return height; }
+    int getChannelCount() const             { return channelCount; }    // 3 or 4
+    bool isBgr() const                      { return bgr; }             // BGR(A) if not swapped
+    bool isCopied() const                   { return !buffer.empty(); } // false if pixels are in the mapped file
+    const unsigned char* getPixels() const  { return pixels; }          // bottom-up, tightly packed
+    size_t getPixelSize() const             { return (size_t)width * height * channelCount; }
+    const std::string& getErrorMessage() const  { return errorMessage; }
+
+    // swap 1st and 3rd bytes of 3 or 4-byte pixels, src and dst can be same
+    static void swapRedBlue(const unsigned char* src, unsigned char* dst, size_t pixelCount, int channelCount);
+    static void swapRedBlueScalar(const unsigned char* src, unsigned char* dst, size_t pixelCount, int channelCount);
+
+    // write 24-bit (3 channels) or 32-bit (4 channels) bottom-up BMP from RGB(A) pixels
+    static bool save(const char* fileName, const unsigned char* pixels, int width, int height, int channelCount);
+
 private:
-	BITMAPFILEHEADER bfh;
-	BITMAPINFOHEADER bih;
+    bool map(const char* fileName);
+    void unmap();
+
+    const void* data;                       // mapped file
+    size_t size;
+    void* fileHandle;                       // for Windows
+    void* mappingHandle;
+
+    const unsigned char* pixels;            // into buffer or the mapped file, 0 if not loaded
+    std::vector<unsigned char> buffer;      // if converted
+    int width;
+    int height;
+    int channelCount;
+    bool bgr;
+    std::string errorMessage;
 };
 
+#endif
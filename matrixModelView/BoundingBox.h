@@ -0,0 +1,47 @@
+///////////////////////////////////////////////////////////////////////////////
+// BoundingBox.h
+// =============
+// axis-aligned bounding box (AABB) of a mesh, and the bounding sphere of it
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef BOUNDING_BOX_H
+#define BOUNDING_BOX_H
+
+#include <cmath>
+#include "Matrices.h"
+
+struct BoundingBox
+{
+    Vector3 min;
+    Vector3 max;
+
+    // ctors
+    BoundingBox() : min(0, 0, 0), max(0, 0, 0) {};
+    BoundingBox(const Vector3& min, const Vector3& max) : min(min), max(max) {};
+
+    Vector3 getCenter() const               { return (min + max) * 0.5f; }
+    Vector3 getExtent() const               { return (max - min) * 0.5f; }    // half size
+    float   getRadius() const               { return getExtent().length(); }  // bounding sphere at the center
+
+    // enlarge to include the point
+    void expand(float x, float y, float z)
+    {
+        min.x = (x < min.x) ? x : min.x;    max.x = (x > max.x) ? x : max.x;
+        min.y = (y < min.y) ? y : min.y;    max.y = (y > max.y) ? y : max.y;
+        min.z = (z < min.z) ? z : min.z;    max.z = (z > max.z) ? z : max.z;
+    }
+
+    // AABB of the box transformed by the affine matrix, e.g. object to world
+    // center' = M * center, extent' = |M3x3| * extent
+    BoundingBox transform(const Matrix4& m) const
+    {
+        Vector3 c = m * getCenter();
+        Vector3 e = getExtent();
+        Vector3 e2(fabsf(m[0]) * e.x + fabsf(m[4]) * e.y + fabsf(m[8]) * e.z,
+                   fabsf(m[1]) * e.x + fabsf(m[5]) * e.y + fabsf(m[9]) * e.z,
+                   fabsf(m[2]) * e.x + fabsf(m[6]) * e.y + fabsf(m[10]) * e.z);
+        return BoundingBox(c - e2, c + e2);
+    }
+};
+
+#endif
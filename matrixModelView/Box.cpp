@@ -0,0 +1,317 @@
+///////////////////////////////////////////////////////////////////////////////
+// Box.cpp
+// =======
+// axis-aligned box for OpenGL with (width, height, depth), centered at origin
+// Each face has its own 4 vertices, so the normals are flat and each face has
+// the full texture.
+// - width : the size along x-axis
+// - height: the size along y-axis
+// - depth : the size along z-axis
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>    // include windows.h to avoid thousands of compile errors even though this class is not depending on Windows
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <iostream>
+#include "Box.h"
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+Box::Box(float width, float height, float depth) : width(0), height(0), depth(0),
+                                                    interleavedStride(32)
+{
+    set(width, height, depth);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// setters
+///////////////////////////////////////////////////////////////////////////////
+void Box::set(float width, float height, float depth)
+{
+    this->width = width;
+    this->height = height;
+    this->depth = depth;
+    buildVertices();
+}
+
+void Box::setWidth(float width)
+{
+    if(this->width != width)
+        set(width, height, depth);
+}
+
+void Box::setHeight(float height)
+{
+    if(this->height != height)
+        set(width, height, depth);
+}
+
+void Box::setDepth(float depth)
+{
+    if(this->depth != depth)
+        set(width, height, depth);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the bounding box without scanning vertices
+///////////////////////////////////////////////////////////////////////////////
+BoundingBox Box::getBounds() const
+{
+    Vector3 half(width * 0.5f, height * 0.5f, depth * 0.5f);
+    return BoundingBox(-half, half);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// print itself
+///////////////////////////////////////////////////////////////////////////////
+void Box::printSelf() const
+{
+    std::cout << "===== Box =====\n"
+              << "         Width: " << width << "\n"
+              << "        Height: " << height << "\n"
+              << "         Depth: " << depth << "\n"
+              << "Triangle Count: " << getTriangleCount() << "\n"
+              << "   Index Count: " << getIndexCount() << "\n"
+              << "  Vertex Count: " << getVertexCount() << "\n"
+              << "  Normal Count: " << getNormalCount() << "\n"
+              << "TexCoord Count: " << getTexCoordCount() << std::endl;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw a box in VertexArray mode
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void Box::draw() const
+{
+    // interleaved array
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, interleavedStride, &interleavedVertices[0]);
+    glNormalPointer(GL_FLOAT, interleavedStride, &interleavedVertices[3]);
+    glTexCoordPointer(2, GL_FLOAT, interleavedStride, &interleavedVertices[6]);
+
+    glDrawElements(GL_TRIANGLES, (unsigned int)indices.size(), GL_UNSIGNED_INT, indices.data());
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw lines only
+// the caller must set the line width before call this
+///////////////////////////////////////////////////////////////////////////////
+void Box::drawLines(const float lineColor[4]) const
+{
+    // set line colour
+    glColor4fv(lineColor);
+    glMaterialfv(GL_FRONT, GL_DIFFUSE,   lineColor);
+
+    // draw lines with VA
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, vertices.data());
+
+    glDrawElements(GL_LINES, (unsigned int)lineIndices.size(), GL_UNSIGNED_INT, lineIndices.data());
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw a box surfaces and lines on top of it
+// the caller must set the line width before call this
+///////////////////////////////////////////////////////////////////////////////
+void Box::drawWithLines(const float lineColor[4]) const
+{
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1.0, 1.0f); // move polygon backward
+    this->draw();
+    glDisable(GL_POLYGON_OFFSET_FILL);
+
+    // draw lines with VA
+    drawLines(lineColor);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// dealloc vectors
+///////////////////////////////////////////////////////////////////////////////
+void Box::clearArrays()
+{
+    std::vector<float>().swap(vertices);
+    std::vector<float>().swap(normals);
+    std::vector<float>().swap(texCoords);
+    std::vector<unsigned int>().swap(indices);
+    std::vector<unsigned int>().swap(lineIndices);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build 4 vertices per face, 2 triangles per face
+//    v6----- v5
+//   /|      /|
+//  v1------v0|
+//  | |     | |
+//  | v7----|-v4
+//  |/      |/
+//  v2------v3
+///////////////////////////////////////////////////////////////////////////////
+void Box::buildVertices()
+{
+    clearArrays();
+
+    float x = width * 0.5f;
+    float y = height * 0.5f;
+    float z = depth * 0.5f;
+    const float v[8][3] = {
+        { x,  y,  z}, {-x,  y,  z}, {-x, -y,  z}, { x, -y,  z},    // v0-v3: front
+        { x, -y, -z}, { x,  y, -z}, {-x,  y, -z}, {-x, -y, -z}     // v4-v7: back
+    };
+
+    // tex coords of 4 corners, starting from the 1st vertex of the face
+    const float front[] = { 0,0,  1,0,  1,1,  0,1 };
+    const float back[]  = { 1,0,  1,1,  0,1,  0,0 };
+    const float top[]   = { 0,1,  0,0,  1,0,  1,1 };
+    const float bottom[]= { 1,1,  0,1,  0,0,  1,0 };
+    const float right[] = { 1,0,  1,1,  0,1,  0,0 };
+    const float left[]  = { 0,0,  1,0,  1,1,  0,1 };
+
+    const float nFront[]  = { 0, 0, 1 };
+    const float nBack[]   = { 0, 0,-1 };
+    const float nTop[]    = { 0, 1, 0 };
+    const float nBottom[] = { 0,-1, 0 };
+    const float nRight[]  = { 1, 0, 0 };
+    const float nLeft[]   = {-1, 0, 0 };
+
+    addFace(v[2], v[3], v[0], v[1], nFront,  front);     // v2-v3-v0-v1
+    addFace(v[7], v[6], v[5], v[4], nBack,   back);      // v7-v6-v5-v4
+    addFace(v[6], v[1], v[0], v[5], nTop,    top);       // v6-v1-v0-v5
+    addFace(v[7], v[4], v[3], v[2], nBottom, bottom);    // v7-v4-v3-v2
+    addFace(v[4], v[5], v[0], v[3], nRight,  right);     // v4-v5-v0-v3
+    addFace(v[7], v[2], v[1], v[6], nLeft,   left);      // v7-v2-v1-v6
+
+    // generate interleaved vertex array as well
+    buildInterleavedVertices();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// generate interleaved vertices: V/N/T
+// stride must be 32 bytes
+///////////////////////////////////////////////////////////////////////////////
+void Box::buildInterleavedVertices()
+{
+    std::vector<float>().swap(interleavedVertices);
+    interleavedVertices.reserve(vertices.size() / 3 * 8);
+
+    std::size_t i, j;
+    std::size_t count = vertices.size();
+    for(i = 0, j = 0; i < count; i += 3, j += 2)
+    {
+        interleavedVertices.insert(interleavedVertices.end(), &vertices[i], &vertices[i] + 3);
+        interleavedVertices.insert(interleavedVertices.end(), &normals[i], &normals[i] + 3);
+        interleavedVertices.insert(interleavedVertices.end(), &texCoords[j], &texCoords[j] + 2);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single vertex to array
+///////////////////////////////////////////////////////////////////////////////
+void Box::addVertex(float x, float y, float z)
+{
+    vertices.push_back(x);
+    vertices.push_back(y);
+    vertices.push_back(z);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single normal to array
+///////////////////////////////////////////////////////////////////////////////
+void Box::addNormal(float nx, float ny, float nz)
+{
+    normals.push_back(nx);
+    normals.push_back(ny);
+    normals.push_back(nz);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single texture coord to array
+///////////////////////////////////////////////////////////////////////////////
+void Box::addTexCoord(float s, float t)
+{
+    texCoords.push_back(s);
+    texCoords.push_back(t);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add 3 indices to array
+///////////////////////////////////////////////////////////////////////////////
+void Box::addIndices(unsigned int i1, unsigned int i2, unsigned int i3)
+{
+    indices.push_back(i1);
+    indices.push_back(i2);
+    indices.push_back(i3);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add a quad v1-v2-v3-v4 (counter-clockwise) with 2 triangles and 4 lines
+///////////////////////////////////////////////////////////////////////////////
+void Box::addFace(const float* v1, const float* v2, const float* v3, const float* v4,
+                  const float* normal, const float* texCoord)
+{
+    unsigned int k = (unsigned int)vertices.size() / 3;
+    const float* v[4] = { v1, v2, v3, v4 };
+    for(int i = 0; i < 4; ++i)
+    {
+        addVertex(v[i][0], v[i][1], v[i][2]);
+        addNormal(normal[0], normal[1], normal[2]);
+        addTexCoord(texCoord[i * 2], texCoord[i * 2 + 1]);
+    }
+
+    addIndices(k, k + 1, k + 2);
+    addIndices(k, k + 2, k + 3);
+    for(unsigned int i = 0; i < 4; ++i)
+    {
+        lineIndices.push_back(k + i);
+        lineIndices.push_back(k + (i + 1) % 4);
+    }
+}
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////
+// Box.h
+// =====
+// axis-aligned box for OpenGL with (width, height, depth), centered at origin
+// Each face has its own 4 vertices, so the normals are flat and each face has
+// the full texture.
+// - width : the size along x-axis
+// - height: the size along y-axis
+// - depth : the size along z-axis
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GEOMETRY_BOX_H
+#define GEOMETRY_BOX_H
+
+#include <vector>
+#include "BoundingBox.h"
+
+class Box
+{
+public:
+    // ctor/dtor
+    Box(float width=1.0f, float height=1.0f, float depth=1.0f);
+    ~Box() {}
+
+    // getters/setters
+    float getWidth() const                  { return width; }
+    float getHeight() const                 { return height; }
+    float getDepth() const                  { return depth; }
+    void set(float width, float height, float depth);
+    void setWidth(float width);
+    void setHeight(float height);
+    void setDepth(float depth);
+    BoundingBox getBounds() const;
+
+    // for vertex data
+    unsigned int getVertexCount() const     { return (unsigned int)vertices.size() / 3; }
+    unsigned int getNormalCount() const     { return (unsigned int)normals.size() / 3; }
+    unsigned int getTexCoordCount() const   { return (unsigned int)texCoords.size() / 2; }
+    unsigned int getIndexCount() const      { return (unsigned int)indices.size(); }
+    unsigned int getLineIndexCount() const  { return (unsigned int)lineIndices.size(); }
+    unsigned int getTriangleCount() const   { return getIndexCount() / 3; }
+    unsigned int getVertexSize() const      { return (unsigned int)vertices.size() * sizeof(float); }
+    unsigned int getNormalSize() const      { return (unsigned int)normals.size() * sizeof(float); }
+    unsigned int getTexCoordSize() const    { return (unsigned int)texCoords.size() * sizeof(float); }
+    unsigned int getIndexSize() const       { return (unsigned int)indices.size() * sizeof(unsigned int); }
+    unsigned int getLineIndexSize() const   { return (unsigned int)lineIndices.size() * sizeof(unsigned int); }
+    const float* getVertices() const        { return vertices.data(); }
+    const float* getNormals() const         { return normals.data(); }
+    const float* getTexCoords() const       { return texCoords.data(); }
+    const unsigned int* getIndices() const  { return indices.data(); }
+    const unsigned int* getLineIndices() const  { return lineIndices.data(); }
+
+    // for interleaved vertices: V/N/T
+    unsigned int getInterleavedVertexCount() const  { return getVertexCount(); }    // # of vertices
+    unsigned int getInterleavedVertexSize() const   { return (unsigned int)interleavedVertices.size() * sizeof(float); }    // # of bytes
+    int getInterleavedStride() const                { return interleavedStride; }   // should be 32 bytes
+    const float* getInterleavedVertices() const     { return &interleavedVertices[0]; }
+
+    // draw in VertexArray mode
+    void draw() const;                                  // draw surface
+    void drawLines(const float lineColor[4]) const;     // draw lines only
+    void drawWithLines(const float lineColor[4]) const; // draw surface and lines
+
+    // debug
+    void printSelf() const;
+
+private:
+    // member functions
+    void buildVertices();
+    void buildInterleavedVertices();
+    void clearArrays();
+    void addVertex(float x, float y, float z);
+    void addNormal(float x, float y, float z);
+    void addTexCoord(float s, float t);
+    void addIndices(unsigned int i1, unsigned int i2, unsigned int i3);
+    void addFace(const float* v1, const float* v2, const float* v3, const float* v4,
+                 const float* normal, const float* texCoord);   // CCW quad
+
+    // member vars
+    float width;
+    float height;
+    float depth;
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<float> texCoords;
+    std::vector<unsigned int> indices;
+    std::vector<unsigned int> lineIndices;
+
+    // interleaved
+    std::vector<float> interleavedVertices;
+    int interleavedStride;                  // # of bytes to hop to the next vertex (should be 32 bytes)
+};
+
+#endif
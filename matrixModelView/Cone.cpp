@@ -0,0 +1,416 @@
+///////////////////////////////////////////////////////////////////////////////
+// Cone.cpp
+// ========
+// Cone for OpenGL with (base radius, height, sectors, stacks)
+// The min number of sectors (slices) is 3 and the min number of stacks are 1.
+// It is same as Cylinder with top radius 0, but without the top cap and the
+// degenerate triangles at the apex.
+// - base radius: the radius of the cone at z = -height/2
+// - height     : the height of the cone along z-axis, the apex is at height/2
+// - sectors    : the number of slices of the base
+// - stacks     : the number of subdivisions along z-axis
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>    // include windows.h to avoid thousands of compile errors even though this class is not depending on Windows
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <iostream>
+#include <cmath>
+#include "Cone.h"
+
+
+
+// constants //////////////////////////////////////////////////////////////////
+const int MIN_SECTOR_COUNT = 3;
+const int MIN_STACK_COUNT  = 1;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+Cone::Cone(float baseRadius, float height, int sectors, int stacks)
+    : baseRadius(0), height(0), sectorCount(0), stackCount(0), baseIndex(0), interleavedStride(32)
+{
+    set(baseRadius, height, sectors, stacks);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// setters
+///////////////////////////////////////////////////////////////////////////////
+void Cone::set(float baseRadius, float height, int sectors, int stacks)
+{
+    if(sectors < MIN_SECTOR_COUNT)
+        sectors = MIN_SECTOR_COUNT;
+    if(stacks < MIN_STACK_COUNT)
+        stacks = MIN_STACK_COUNT;
+
+    this->baseRadius = baseRadius;
+    this->height = height;
+    if(this->sectorCount != sectors)
+    {
+        this->sectorCount = sectors;
+        buildUnitCircleVertices();
+    }
+    this->stackCount = stacks;
+
+    buildVertices();
+}
+
+void Cone::setBaseRadius(float radius)
+{
+    if(this->baseRadius != radius)
+        set(radius, height, sectorCount, stackCount);
+}
+
+void Cone::setHeight(float height)
+{
+    if(this->height != height)
+        set(baseRadius, height, sectorCount, stackCount);
+}
+
+void Cone::setSectorCount(int sectors)
+{
+    if(sectors != this->sectorCount)
+        set(baseRadius, height, sectors, stackCount);
+}
+
+void Cone::setStackCount(int stacks)
+{
+    if(stacks != this->stackCount)
+        set(baseRadius, height, sectorCount, stacks);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the bounding box without scanning vertices
+///////////////////////////////////////////////////////////////////////////////
+BoundingBox Cone::getBounds() const
+{
+    float halfHeight = height * 0.5f;
+    return BoundingBox(Vector3(-baseRadius, -baseRadius, -halfHeight), Vector3(baseRadius, baseRadius, halfHeight));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// print itself
+///////////////////////////////////////////////////////////////////////////////
+void Cone::printSelf() const
+{
+    std::cout << "===== Cone =====\n"
+              << "   Base Radius: " << baseRadius << "\n"
+              << "        Height: " << height << "\n"
+              << "  Sector Count: " << sectorCount << "\n"
+              << "   Stack Count: " << stackCount << "\n"
+              << "Triangle Count: " << getTriangleCount() << "\n"
+              << "   Index Count: " << getIndexCount() << "\n"
+              << "  Vertex Count: " << getVertexCount() << "\n"
+              << "  Normal Count: " << getNormalCount() << "\n"
+              << "TexCoord Count: " << getTexCoordCount() << std::endl;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw a cone in VertexArray mode
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void Cone::draw() const
+{
+    // interleaved array
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, interleavedStride, &interleavedVertices[0]);
+    glNormalPointer(GL_FLOAT, interleavedStride, &interleavedVertices[3]);
+    glTexCoordPointer(2, GL_FLOAT, interleavedStride, &interleavedVertices[6]);
+
+    glDrawElements(GL_TRIANGLES, (unsigned int)indices.size(), GL_UNSIGNED_INT, indices.data());
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw side or base of cone only
+///////////////////////////////////////////////////////////////////////////////
+void Cone::drawSide() const
+{
+    // interleaved array
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, interleavedStride, &interleavedVertices[0]);
+    glNormalPointer(GL_FLOAT, interleavedStride, &interleavedVertices[3]);
+    glTexCoordPointer(2, GL_FLOAT, interleavedStride, &interleavedVertices[6]);
+
+    glDrawElements(GL_TRIANGLES, baseIndex, GL_UNSIGNED_INT, indices.data());
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+void Cone::drawBase() const
+{
+    // interleaved array
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, interleavedStride, &interleavedVertices[0]);
+    glNormalPointer(GL_FLOAT, interleavedStride, &interleavedVertices[3]);
+    glTexCoordPointer(2, GL_FLOAT, interleavedStride, &interleavedVertices[6]);
+
+    glDrawElements(GL_TRIANGLES, getBaseIndexCount(), GL_UNSIGNED_INT, &indices[baseIndex]);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw lines only
+// the caller must set the line width before call this
+///////////////////////////////////////////////////////////////////////////////
+void Cone::drawLines(const float lineColor[4]) const
+{
+    // set line colour
+    glColor4fv(lineColor);
+    glMaterialfv(GL_FRONT, GL_DIFFUSE,   lineColor);
+
+    // draw lines with VA
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, vertices.data());
+
+    glDrawElements(GL_LINES, (unsigned int)lineIndices.size(), GL_UNSIGNED_INT, lineIndices.data());
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw a cone surfaces and lines on top of it
+// the caller must set the line width before call this
+///////////////////////////////////////////////////////////////////////////////
+void Cone::drawWithLines(const float lineColor[4]) const
+{
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1.0, 1.0f); // move polygon backward
+    this->draw();
+    glDisable(GL_POLYGON_OFFSET_FILL);
+
+    // draw lines with VA
+    drawLines(lineColor);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// dealloc vectors
+///////////////////////////////////////////////////////////////////////////////
+void Cone::clearArrays()
+{
+    std::vector<float>().swap(vertices);
+    std::vector<float>().swap(normals);
+    std::vector<float>().swap(texCoords);
+    std::vector<unsigned int>().swap(indices);
+    std::vector<unsigned int>().swap(lineIndices);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build vertices of cone with smooth shading
+// The side has the same vertices as Cylinder with top radius 0: each vertex
+// at the apex has the normal of its sector.
+///////////////////////////////////////////////////////////////////////////////
+void Cone::buildVertices()
+{
+    clearArrays();
+
+    // normal of the side at 0 degree, tanA = baseRadius / height
+    float zAngle = atan2f(baseRadius, height);
+    float nxy = cosf(zAngle);
+    float nz = sinf(zAngle);
+
+    // put vertices of side by scaling unit circle
+    for(int i = 0; i <= stackCount; ++i)
+    {
+        float z = -(height * 0.5f) + (float)i / stackCount * height;
+        float radius = baseRadius + (float)i / stackCount * (0 - baseRadius);   // lerp to apex
+        float t = 1.0f - (float)i / stackCount;     // top-to-bottom
+
+        for(int j = 0, k = 0; j <= sectorCount; ++j, k += 2)
+        {
+            float x = unitCircleVertices[k];
+            float y = unitCircleVertices[k + 1];
+            addVertex(x * radius, y * radius, z);
+            addNormal(x * nxy, y * nxy, nz);
+            addTexCoord((float)j / sectorCount, t);
+        }
+    }
+
+    // remember where the base vertices start
+    unsigned int baseVertexIndex = (unsigned int)vertices.size() / 3;
+
+    // put vertices of base
+    float z = -height * 0.5f;
+    addVertex(0, 0, z);
+    addNormal(0, 0, -1);
+    addTexCoord(0.5f, 0.5f);
+    for(int i = 0, k = 0; i < sectorCount; ++i, k += 2)
+    {
+        float x = unitCircleVertices[k];
+        float y = unitCircleVertices[k + 1];
+        addVertex(x * baseRadius, y * baseRadius, z);
+        addNormal(0, 0, -1);
+        addTexCoord(-x * 0.5f + 0.5f, -y * 0.5f + 0.5f);    // flip horizontal
+    }
+
+    // put indices for side
+    for(int i = 0; i < stackCount; ++i)
+    {
+        unsigned int k1 = i * (sectorCount + 1);    // beginning of current stack
+        unsigned int k2 = k1 + sectorCount + 1;     // beginning of next stack
+
+        for(int j = 0; j < sectorCount; ++j, ++k1, ++k2)
+        {
+            // 2 triangles per sector, only 1 at the apex
+            addIndices(k1, k1 + 1, k2);
+            if(i != (stackCount - 1))
+                addIndices(k2, k1 + 1, k2 + 1);
+
+            // vertical lines for all stacks
+            lineIndices.push_back(k1);
+            lineIndices.push_back(k2);
+            // horizontal lines, no line at the apex
+            lineIndices.push_back(k1);
+            lineIndices.push_back(k1 + 1);
+        }
+    }
+
+    // remember where the base indices start
+    baseIndex = (unsigned int)indices.size();
+
+    // put indices for base
+    for(int i = 0, k = baseVertexIndex + 1; i < sectorCount; ++i, ++k)
+    {
+        if(i < (sectorCount - 1))
+            addIndices(baseVertexIndex, k + 1, k);
+        else    // last triangle
+            addIndices(baseVertexIndex, baseVertexIndex + 1, k);
+    }
+
+    // generate interleaved vertex array as well
+    buildInterleavedVertices();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// generate interleaved vertices: V/N/T
+// stride must be 32 bytes
+///////////////////////////////////////////////////////////////////////////////
+void Cone::buildInterleavedVertices()
+{
+    std::vector<float>().swap(interleavedVertices);
+    interleavedVertices.reserve(vertices.size() / 3 * 8);
+
+    std::size_t i, j;
+    std::size_t count = vertices.size();
+    for(i = 0, j = 0; i < count; i += 3, j += 2)
+    {
+        interleavedVertices.insert(interleavedVertices.end(), &vertices[i], &vertices[i] + 3);
+        interleavedVertices.insert(interleavedVertices.end(), &normals[i], &normals[i] + 3);
+        interleavedVertices.insert(interleavedVertices.end(), &texCoords[j], &texCoords[j] + 2);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// generate cos and sin of the sector angles, a unit circle on XY plane
+// all stacks and the base reuse them
+///////////////////////////////////////////////////////////////////////////////
+void Cone::buildUnitCircleVertices()
+{
+    const float PI = acosf(-1);
+    float sectorStep = 2 * PI / sectorCount;
+
+    std::vector<float>().swap(unitCircleVertices);
+    unitCircleVertices.reserve((size_t)(sectorCount + 1) * 2);
+    for(int i = 0; i <= sectorCount; ++i)
+    {
+        float sectorAngle = i * sectorStep;
+        unitCircleVertices.push_back(cosf(sectorAngle));
+        unitCircleVertices.push_back(sinf(sectorAngle));
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single vertex to array
+///////////////////////////////////////////////////////////////////////////////
+void Cone::addVertex(float x, float y, float z)
+{
+    vertices.push_back(x);
+    vertices.push_back(y);
+    vertices.push_back(z);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single normal to array
+///////////////////////////////////////////////////////////////////////////////
+void Cone::addNormal(float nx, float ny, float nz)
+{
+    normals.push_back(nx);
+    normals.push_back(ny);
+    normals.push_back(nz);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single texture coord to array
+///////////////////////////////////////////////////////////////////////////////
+void Cone::addTexCoord(float s, float t)
+{
+    texCoords.push_back(s);
+    texCoords.push_back(t);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add 3 indices to array
+///////////////////////////////////////////////////////////////////////////////
+void Cone::addIndices(unsigned int i1, unsigned int i2, unsigned int i3)
+{
+    indices.push_back(i1);
+    indices.push_back(i2);
+    indices.push_back(i3);
+}
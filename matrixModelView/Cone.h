@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+// Cone.h
+// ======
+// Cone for OpenGL with (base radius, height, sectors, stacks)
+// The min number of sectors (slices) is 3 and the min number of stacks are 1.
+// It is same as Cylinder with top radius 0, but without the top cap and the
+// degenerate triangles at the apex.
+// - base radius: the radius of the cone at z = -height/2
+// - height     : the height of the cone along z-axis, the apex is at height/2
+// - sectors    : the number of slices of the base
+// - stacks     : the number of subdivisions along z-axis
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GEOMETRY_CONE_H
+#define GEOMETRY_CONE_H
+
+#include <vector>
+#include "BoundingBox.h"
+
+class Cone
+{
+public:
+    // ctor/dtor
+    Cone(float baseRadius=1.0f, float height=1.0f, int sectorCount=36, int stackCount=1);
+    ~Cone() {}
+
+    // getters/setters
+    float getBaseRadius() const             { return baseRadius; }
+    float getHeight() const                 { return height; }
+    int getSectorCount() const              { return sectorCount; }
+    int getStackCount() const               { return stackCount; }
+    void set(float baseRadius, float height, int sectorCount, int stackCount);
+    void setBaseRadius(float radius);
+    void setHeight(float height);
+    void setSectorCount(int sectorCount);
+    void setStackCount(int stackCount);
+    BoundingBox getBounds() const;
+
+    // for vertex data
+    unsigned int getVertexCount() const     { return (unsigned int)vertices.size() / 3; }
+    unsigned int getNormalCount() const     { return (unsigned int)normals.size() / 3; }
+    unsigned int getTexCoordCount() const   { return (unsigned int)texCoords.size() / 2; }
+    unsigned int getIndexCount() const      { return (unsigned int)indices.size(); }
+    unsigned int getLineIndexCount() const  { return (unsigned int)lineIndices.size(); }
+    unsigned int getTriangleCount() const   { return getIndexCount() / 3; }
+    unsigned int getVertexSize() const      { return (unsigned int)vertices.size() * sizeof(float); }
+    unsigned int getNormalSize() const      { return (unsigned int)normals.size() * sizeof(float); }
+    unsigned int getTexCoordSize() const    { return (unsigned int)texCoords.size() * sizeof(float); }
+    unsigned int getIndexSize() const       { return (unsigned int)indices.size() * sizeof(unsigned int); }
+    unsigned int getLineIndexSize() const   { return (unsigned int)lineIndices.size() * sizeof(unsigned int); }
+    const float* getVertices() const        { return vertices.data(); }
+    const float* getNormals() const         { return normals.data(); }
+    const float* getTexCoords() const       { return texCoords.data(); }
+    const unsigned int* getIndices() const  { return indices.data(); }
+    const unsigned int* getLineIndices() const  { return lineIndices.data(); }
+
+    // for interleaved vertices: V/N/T
+    unsigned int getInterleavedVertexCount() const  { return getVertexCount(); }    // # of vertices
+    unsigned int getInterleavedVertexSize() const   { return (unsigned int)interleavedVertices.size() * sizeof(float); }    // # of bytes
+    int getInterleavedStride() const                { return interleavedStride; }   // should be 32 bytes
+    const float* getInterleavedVertices() const     { return &interleavedVertices[0]; }
+
+    // for indices of base/side parts
+    unsigned int getBaseIndexCount() const  { return (unsigned int)indices.size() - baseIndex; }
+    unsigned int getSideIndexCount() const  { return baseIndex; }
+    unsigned int getBaseStartIndex() const  { return baseIndex; }
+    unsigned int getSideStartIndex() const  { return 0; }   // side starts from the begining
+
+    // draw in VertexArray mode
+    void draw() const;                                  // draw all
+    void drawBase() const;                              // draw base cap only
+    void drawSide() const;                              // draw side only
+    void drawLines(const float lineColor[4]) const;     // draw lines only
+    void drawWithLines(const float lineColor[4]) const; // draw surface and lines
+
+    // debug
+    void printSelf() const;
+
+private:
+    // member functions
+    void buildVertices();
+    void buildInterleavedVertices();
+    void buildUnitCircleVertices();
+    void clearArrays();
+    void addVertex(float x, float y, float z);
+    void addNormal(float x, float y, float z);
+    void addTexCoord(float s, float t);
+    void addIndices(unsigned int i1, unsigned int i2, unsigned int i3);
+
+    // member vars
+    float baseRadius;
+    float height;
+    int sectorCount;                        // # of slices
+    int stackCount;                         // # of stacks
+    unsigned int baseIndex;                 // starting index of base
+    std::vector<float> unitCircleVertices;  // cos, sin of each sector angle, shared by all stacks
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<float> texCoords;
+    std::vector<unsigned int> indices;
+    std::vector<unsigned int> lineIndices;
+
+    // interleaved
+    std::vector<float> interleavedVertices;
+    int interleavedStride;                  // # of bytes to hop to the next vertex (should be 32 bytes)
+};
+
+#endif
@@ -3,11 +3,14 @@
 
 using namespace Win;
 
+const float ROTATION_SPEED = 30.0f;     // degrees per second for auto-rotation
+
 ///////////////////////////////////////////////////////////////////////////////
 // default contructor
 ///////////////////////////////////////////////////////////////////////////////
-ControllerGL::ControllerGL(ModelGL* model, ViewGL* view, ViewFormGL* viewForm) : model(model), view(view), loopFlag(false), viewForm(viewForm)
+ControllerGL::ControllerGL(ModelGL* model, ViewGL* view, ViewFormGL* viewForm) : model(model), view(view), viewForm(viewForm)
 {
+    model->setFrameScheduler(&scheduler);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -16,7 +19,7 @@ ControllerGL::ControllerGL(ModelGL* model, ViewGL* view, ViewFormGL* viewForm) :
 int ControllerGL::close()
 {
     // wait for rendering thread is terminated
-    loopFlag = false;
+    scheduler.stop();
     glThread.join();
 
     ::DestroyWindow(handle);
@@ -42,7 +45,6 @@ int ControllerGL::create()
 
     // create a thread for OpenGL rendering
     glThread = std::thread(&ControllerGL::runThread, this);
-    loopFlag = true;
     Win::log(L"Created a rendering thread for OpenGL.");
 
     return 0;
@@ -53,6 +55,7 @@ int ControllerGL::create()
 ///////////////////////////////////////////////////////////////////////////////
 int ControllerGL::paint()
 {
+    scheduler.requestRedraw();
     return 0;
 }
 
@@ -73,6 +76,9 @@ void ControllerGL::runThread()
     // set the current RC in this thread
     ::wglMakeCurrent(view->getDC(), view->getRC());
 
+    // keep the decoded textures with mipmaps, so the next run maps them as is
+    model->setTextureCache("cache", false);
+
     // initialize OpenGL states
     model->init();
     Win::log(L"Initialized OpenGL states.");
@@ -90,42 +96,32 @@ void ControllerGL::runThread()
     Win::log(L"Initialized OpenGL window size.");
 
     // rendering loop
+    // vsync is on except uncapped mode, it is updated when the mode is changed
     Win::log(L"Entering OpenGL rendering thread...");
-    while (loopFlag)
+    int swapInterval = -1;
+    while (scheduler.waitForFrame())
     {
-        //std::this_thread::yield();      // yield to other processes or threads
-        std::this_thread::sleep_for(std::chrono::milliseconds(30)); // yield to other processes or threads
-        
+        int interval = (scheduler.getMode() == FRAME_UNCAPPED) ? 0 : 1;
+        if (interval != swapInterval)
+        {
+            if (!view->setSwapInterval(interval))
+                Win::log(L"[WARNING] WGL_EXT_swap_control is not supported.");
+            swapInterval = interval;
+        }
+
+        // changing the model requests the next frame, so it keeps drawing while rotating
+        if (model->isAnimating())
+            animate(scheduler.getFrameSeconds());
+
         model->draw();
         view->swapBuffers();
-        if (model->boxRotationOXIsCheck() || model->boxRotationOYIsCheck() || model->boxRotationOZIsCheck()) {
-            int x = model->getModelX();
-            int y = model->getModelY();
-            int z = model->getModelZ();
-            int rx = model->getModelAngleX();
-            int ry = model->getModelAngleY();
-            int rz = model->getModelAngleZ();
-            if (model->boxRotationOXIsCheck()) {
-                rx++;
-                if (rx > 180)
-                    rx = -179;
-            }
-            if (model->boxRotationOYIsCheck()) {
-                ry++;
-                if (ry > 180)
-                    ry = -179;
-            }
-            if (model->boxRotationOZIsCheck()) {
-                rz++;
-                if (rz > 180)
-                    rz = -179;
-            }
-            model->setModelMatrix(x, y, z, rx, ry, rz);
-            viewForm->setModelMatrix(x, y, z, rx, ry, rz);
-            view->swapBuffers();
-        }
+        scheduler.frameDone();
     }
 
+    FrameStats stats = scheduler.getStats();
+    Win::log(L"Frame time: %u frames, avg %.2f ms (%.1f FPS), min %.2f ms, max %.2f ms",
+             stats.frameCount, stats.avgMs, stats.fps, stats.minMs, stats.maxMs);
+
     // close OpenGL Rendering Context (RC)
     model->quit();
     view->closeContext(handle);
@@ -133,6 +129,33 @@ void ControllerGL::runThread()
     Win::log(L"Exit OpenGL rendering thread.");
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// rotate the model on the checked axes
+// the angle is proportional to the elapsed time, so the speed does not depend
+// on the frame rate
+///////////////////////////////////////////////////////////////////////////////
+void ControllerGL::animate(float seconds)
+{
+    float angle = ROTATION_SPEED * seconds;
+    float dx = model->boxRotationOXIsCheck() ? angle : 0;
+    float dy = model->boxRotationOYIsCheck() ? angle : 0;
+    float dz = model->boxRotationOZIsCheck() ? angle : 0;
+
+    // read-modify-write under the state lock, the UI thread may edit the model
+    float position[3], rotation[3];
+    model->rotateModel(dx, dy, dz, position, rotation);
+    viewForm->setModelMatrix(position[0], position[1], position[2], rotation[0], rotation[1], rotation[2]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// change frame scheduling mode
+///////////////////////////////////////////////////////////////////////////////
+void ControllerGL::setFrameMode(FrameMode mode, float fps)
+{
+    scheduler.setTargetFps(fps);
+    scheduler.setMode(mode);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // handle Left mouse down
 ///////////////////////////////////////////////////////////////////////////////
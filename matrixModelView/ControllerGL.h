@@ -8,6 +8,7 @@
 #include "ViewGL.h"
 #include "ModelGL.h"
 #include "ViewFormGL.h"
+#include "FrameScheduler.h"
 
 namespace Win
 {
@@ -30,13 +31,17 @@ namespace Win
         int size(int w, int h, WPARAM wParam);      // for WM_SIZE: width, height, type(SIZE_MAXIMIZED...)
         int timer(WPARAM id, LPARAM lParam);        // for VM_TIMER
 
+        void setFrameMode(FrameMode mode, float fps = 60.0f); // redraw on change, fixed FPS or uncapped
+        FrameStats getFrameStats() const { return scheduler.getStats(); }
+
     private:
         void runThread();                           // thread for OpenGL rendering
+        void animate(float seconds);                // auto-rotate the model by elapsed time
         ViewFormGL* viewForm;
         ModelGL* model;                             // pointer to model component
         ViewGL* view;                               // pointer to view component
         std::thread glThread;                       // opengl rendering thread object
-        volatile bool loopFlag;                     // rendering loop flag
+        FrameScheduler scheduler;                   // decide when to draw next frame
     };
 }
 
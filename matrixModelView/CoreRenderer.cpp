@@ -0,0 +1,511 @@
+///////////////////////////////////////////////////////////////////////////////
+// CoreRenderer.cpp
+// ================
+// shader-based replacement of the fixed pipeline for the core-profile path
+// See CoreRenderer.h for the requirements.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "CoreRenderer.h"
+#include "MeshCache.h"
+#include "glExtension.h"
+
+
+
+// constants //////////////////////////////////////////////////////////////////
+const int LIGHT_BINDING = 0;                // uniform buffer binding points
+const int MATERIAL_BINDING = 1;
+const int LIGHT_SIZE = 64;                  // bytes of Light block, 4 x vec4
+const int MATERIAL_SIZE = 64;               // bytes of Material block, 3 x vec4 + float, padded
+
+// the shaders below are compiled with this line first, then the defines
+const char* coreVersion = "#version 140\n";
+
+// vertex colors of helper lines ==========================
+const char* coreColorVs = R"(
+uniform mat4 matrixModelViewProjection;
+in vec3 vertexPosition;
+in vec4 vertexColor;
+out vec4 color;
+void main()
+{
+    color = vertexColor;
+    gl_Position = matrixModelViewProjection * vec4(vertexPosition, 1.0);
+}
+)";
+const char* coreColorFs = R"(
+in vec4 color;
+out vec4 fragColor;
+void main()
+{
+    fragColor = color;
+}
+)";
+
+// blinn specular shading with texture and fog ============
+// INSTANCED takes the model matrix and the color from per-instance attributes,
+// otherwise the color is a uniform; a varying color costs an interpolation per
+// fragment even if it is constant over the draw.
+// The matrices have uniform scale only, so the upper 3x3 transforms normals.
+// The matrix products are done on CPU, the vertex shader runs per vertex.
+const char* coreMeshVs = R"(
+uniform mat4 matrixModelView;
+uniform mat4 matrixModelViewProjection;
+in vec3 vertexPosition;
+in vec3 vertexNormal;
+in vec2 vertexTexCoord;
+#ifdef INSTANCED
+in vec4 vertexColor;
+in mat4 instanceMatrix;
+out vec4 color;
+#endif
+out vec3 esVertex, esNormal;
+out vec2 texCoord0;
+void main()
+{
+#ifdef INSTANCED
+    vec4 vertex = instanceMatrix * vec4(vertexPosition, 1.0);
+    vec3 normal = mat3(instanceMatrix) * vertexNormal;
+#else
+    vec4 vertex = vec4(vertexPosition, 1.0);
+    vec3 normal = vertexNormal;
+#endif
+    esVertex = vec3(matrixModelView * vertex);
+    esNormal = mat3(matrixModelView) * normal;
+    texCoord0 = vertexTexCoord;
+#ifdef INSTANCED
+    color = vertexColor;
+#endif
+    gl_Position = matrixModelViewProjection * vertex;
+}
+)";
+const char* coreMeshFs = R"(
+layout(std140) uniform Light
+{
+    vec4 lightPosition;             // in eye space, w = 0 for directional light
+    vec4 lightAmbient;
+    vec4 lightDiffuse;
+    vec4 lightSpecular;
+};
+layout(std140) uniform Material
+{
+    vec4 materialAmbient;           // scaled by the vertex color
+    vec4 materialDiffuse;
+    vec4 materialSpecular;
+    float materialShininess;
+};
+uniform bool textureUsed;
+uniform sampler2D map0;
+uniform float fogDensity;           // 0 if no fog
+uniform vec4 fogColor;
+#ifdef INSTANCED
+in vec4 color;
+#else
+uniform vec4 color;
+#endif
+in vec3 esVertex, esNormal;
+in vec2 texCoord0;
+out vec4 fragColor;
+void main()
+{
+    vec3 normal = normalize(esNormal);
+    vec3 view = normalize(-esVertex);
+    vec3 light;
+    if(lightPosition.w == 0.0)
+    {
+        light = normalize(lightPosition.xyz);
+    }
+    else
+    {
+        light = normalize(lightPosition.xyz - esVertex);
+    }
+    vec3 halfVec = normalize(light + view);
+    vec4 result = color * materialAmbient * lightAmbient;
+    float dotNL = max(dot(normal, light), 0.0);
+    result += color * materialDiffuse * lightDiffuse * dotNL;
+    float dotNH = max(dot(normal, halfVec), 0.0);
+    result += materialSpecular * lightSpecular * pow(dotNH, materialShininess);
+    result.a = color.a * materialDiffuse.a;
+    if(textureUsed)
+        result *= texture(map0, texCoord0);     // GL_MODULATE
+    if(fogDensity > 0.0)
+    {
+        float f = fogDensity * length(esVertex); // GL_EXP2
+        result.rgb = mix(fogColor.rgb, result.rgb, clamp(exp(-f * f), 0.0, 1.0));
+    }
+    fragColor = result;
+}
+)";
+
+
+
+// helpers ////////////////////////////////////////////////////////////////////
+// compile and link a program with the version and defines, print the logs if failed
+static GLuint createProgram(const char* defines, const char* vsSource, const char* fsSource,
+                            const char* attribNames[], const int attribLocations[], int attribCount)
+{
+    GLuint vsId = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fsId = glCreateShader(GL_FRAGMENT_SHADER);
+    GLuint progId = glCreateProgram();
+
+    const char* vsSources[] = { coreVersion, defines, vsSource };
+    const char* fsSources[] = { coreVersion, defines, fsSource };
+    glShaderSource(vsId, 3, vsSources, 0);
+    glShaderSource(fsId, 3, fsSources, 0);
+    glCompileShader(vsId);
+    glCompileShader(fsId);
+    glAttachShader(progId, vsId);
+    glAttachShader(progId, fsId);
+    for(int i = 0; i < attribCount; ++i)
+        glBindAttribLocation(progId, attribLocations[i], attribNames[i]);
+    glLinkProgram(progId);
+
+    // the program keeps the shaders until it is deleted
+    glDeleteShader(vsId);
+    glDeleteShader(fsId);
+
+    GLint linkStatus;
+    glGetProgramiv(progId, GL_LINK_STATUS, &linkStatus);
+    if(linkStatus != GL_TRUE)
+    {
+        int charCount = 0;
+        glGetProgramiv(progId, GL_INFO_LOG_LENGTH, &charCount);
+        std::vector<char> buffer(charCount + 1);
+        glGetProgramInfoLog(progId, charCount, &charCount, &buffer[0]);
+        std::cout << "=== GLSL LOG (core) ===\n" << &buffer[0] << std::endl;
+        glDeleteProgram(progId);
+        return 0;
+    }
+    return progId;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+CoreRenderer::CoreRenderer() : ready(false), instancingReady(false), colorProgId(0), colorMvpLoc(-1),
+                               lightUboId(0), materialUboId(0), materialStride(MATERIAL_SIZE),
+                               fogDensity(0), textureId(0)
+{
+    meshProgram.id = instanceProgram.id = 0;
+    fogColor[0] = fogColor[1] = fogColor[2] = fogColor[3] = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// check GLSL 1.40 (OpenGL 3.1), VBO, VAO and UBO
+// NOTE: must be called after OpenGL RC is set
+///////////////////////////////////////////////////////////////////////////////
+bool CoreRenderer::isSupported()
+{
+    glExtension& extension = glExtension::getInstance();
+    if(!extension.isSupported("GL_ARB_shader_objects") ||
+       !extension.isSupported("GL_ARB_vertex_buffer_object") ||
+       !extension.isSupported("GL_ARB_vertex_array_object") ||
+       !extension.isSupported("GL_ARB_uniform_buffer_object"))
+        return false;
+
+    // "major.minor vendor-specific", e.g. "4.50"
+    const char* version = (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION);
+    int major = 0, minor = 0;
+    if(!version || sscanf(version, "%d.%d", &major, &minor) != 2)
+        return false;
+    return major > 1 || (major == 1 && minor >= 40);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// create programs and uniform buffers
+// NOTE: must be called after OpenGL RC is set
+///////////////////////////////////////////////////////////////////////////////
+bool CoreRenderer::init()
+{
+    if(ready)
+        return true;
+    if(!createPrograms())
+    {
+        quit();
+        return false;
+    }
+
+    // materials are packed at the offset alignment, and a range is bound per mesh
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    materialStride = MATERIAL_SIZE;
+    if(alignment > 0)
+        materialStride = (MATERIAL_SIZE + alignment - 1) / alignment * alignment;
+
+    glGenBuffersARB(1, &lightUboId);
+    glBindBufferARB(GL_UNIFORM_BUFFER, lightUboId);
+    glBufferDataARB(GL_UNIFORM_BUFFER, LIGHT_SIZE, 0, GL_STATIC_DRAW_ARB);
+    glGenBuffersARB(1, &materialUboId);
+    glBindBufferARB(GL_UNIFORM_BUFFER, materialUboId);
+    glBufferDataARB(GL_UNIFORM_BUFFER, materialStride * MATERIAL_COUNT, 0, GL_STATIC_DRAW_ARB);
+    glBindBufferARB(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BINDING, lightUboId);
+
+    instancingReady = isInstancingSupported();
+    ready = true;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// check instanced draw and per-instance attributes
+// glDrawElementsInstanced() is core since 3.1 and glVertexAttribDivisor()
+// since 3.3. The extension strings are checked only below 3.3, a core-profile
+// context does not have to list them.
+///////////////////////////////////////////////////////////////////////////////
+bool CoreRenderer::isInstancingSupported()
+{
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    if(!version || sscanf(version, "%d.%d", &major, &minor) != 2)
+        return false;
+
+    if(major < 3 || (major == 3 && minor < 3))
+    {
+        glExtension& extension = glExtension::getInstance();
+        if(!extension.isSupported("GL_ARB_draw_instanced") ||
+           !extension.isSupported("GL_ARB_instanced_arrays"))
+            return false;
+    }
+
+#ifdef _WIN32
+    // loaded by glExtension, from the ARB or the core entry points
+    return glDrawElementsInstancedARB != 0 && glVertexAttribDivisorARB != 0;
+#else
+    return true;
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// delete programs and buffers
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void CoreRenderer::quit()
+{
+    if(lightUboId)
+        glDeleteBuffersARB(1, &lightUboId);
+    if(materialUboId)
+        glDeleteBuffersARB(1, &materialUboId);
+    lightUboId = materialUboId = 0;
+
+    if(colorProgId)
+        glDeleteProgram(colorProgId);
+    if(meshProgram.id)
+        glDeleteProgram(meshProgram.id);
+    if(instanceProgram.id)
+        glDeleteProgram(instanceProgram.id);
+    colorProgId = meshProgram.id = instanceProgram.id = 0;
+    ready = instancingReady = false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// copy the light into the Light block
+///////////////////////////////////////////////////////////////////////////////
+void CoreRenderer::setLight(const float position[4], const float ambient[4], const float diffuse[4], const float specular[4])
+{
+    float data[16];
+    for(int i = 0; i < 4; ++i)
+    {
+        data[i] = position[i];
+        data[i + 4] = ambient[i];
+        data[i + 8] = diffuse[i];
+        data[i + 12] = specular[i];
+    }
+    glBindBufferARB(GL_UNIFORM_BUFFER, lightUboId);
+    glBufferSubDataARB(GL_UNIFORM_BUFFER, 0, sizeof(data), data);
+    glBindBufferARB(GL_UNIFORM_BUFFER, 0);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// copy a material into its slot of the Material buffer
+///////////////////////////////////////////////////////////////////////////////
+void CoreRenderer::setMaterial(int material, const float ambient[4], const float diffuse[4], const float specular[4], float shininess)
+{
+    if(material < 0 || material >= MATERIAL_COUNT)
+        return;
+
+    float data[MATERIAL_SIZE / sizeof(float)] = { 0 };
+    for(int i = 0; i < 4; ++i)
+    {
+        data[i] = ambient[i];
+        data[i + 4] = diffuse[i];
+        data[i + 8] = specular[i];
+    }
+    data[12] = shininess;
+    glBindBufferARB(GL_UNIFORM_BUFFER, materialUboId);
+    glBufferSubDataARB(GL_UNIFORM_BUFFER, materialStride * material, sizeof(data), data);
+    glBindBufferARB(GL_UNIFORM_BUFFER, 0);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// fog of the following meshes
+///////////////////////////////////////////////////////////////////////////////
+void CoreRenderer::setFog(float density, const float color[4])
+{
+    fogDensity = density;
+    for(int i = 0; i < 4; ++i)
+        fogColor[i] = color[i];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// use the color program for the following HelperCache draws
+///////////////////////////////////////////////////////////////////////////////
+void CoreRenderer::beginLines(const Matrix4& matrixModelView)
+{
+    Matrix4 matrix = matrixProjection * matrixModelView;
+    glUseProgram(colorProgId);
+    glUniformMatrix4fv(colorMvpLoc, 1, GL_FALSE, matrix.get());
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// stop using the color program
+///////////////////////////////////////////////////////////////////////////////
+void CoreRenderer::endLines()
+{
+    glUseProgram(0);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// use the mesh program with the material, fog and texture for the following
+// MeshCache::draw() calls
+///////////////////////////////////////////////////////////////////////////////
+void CoreRenderer::beginMesh(const Matrix4& matrixModelView, int material, const float color[4])
+{
+    useMeshProgram(meshProgram, material);
+    setMeshTransform(matrixModelView, color);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// use the instanced program, the per-instance matrix is multiplied to the view
+// matrix in the vertex shader
+///////////////////////////////////////////////////////////////////////////////
+void CoreRenderer::beginInstances(const Matrix4& matrixView, int material)
+{
+    useMeshProgram(instanceProgram, material);
+    Matrix4 matrix = matrixProjection * matrixView;
+    glUniformMatrix4fv(instanceProgram.modelViewLoc, 1, GL_FALSE, matrixView.get());
+    glUniformMatrix4fv(instanceProgram.mvpLoc, 1, GL_FALSE, matrix.get());
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// change the modelview matrix and the color after beginMesh()
+///////////////////////////////////////////////////////////////////////////////
+void CoreRenderer::setMeshTransform(const Matrix4& matrixModelView, const float color[4])
+{
+    Matrix4 matrix = matrixProjection * matrixModelView;
+    glUniformMatrix4fv(meshProgram.modelViewLoc, 1, GL_FALSE, matrixModelView.get());
+    glUniformMatrix4fv(meshProgram.mvpLoc, 1, GL_FALSE, matrix.get());
+    glUniform4fv(meshProgram.colorLoc, 1, color);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// stop using the mesh program
+///////////////////////////////////////////////////////////////////////////////
+void CoreRenderer::endMesh()
+{
+    if(textureId)
+        glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set the material range, fog and texture of a mesh program
+///////////////////////////////////////////////////////////////////////////////
+void CoreRenderer::useMeshProgram(const MeshProgram& program, int material)
+{
+    glUseProgram(program.id);
+    glBindBufferRange(GL_UNIFORM_BUFFER, MATERIAL_BINDING, materialUboId,
+                      materialStride * material, MATERIAL_SIZE);
+
+    glUniform1f(program.fogDensityLoc, fogDensity);
+    if(fogDensity > 0)
+        glUniform4fv(program.fogColorLoc, 1, fogColor);
+
+    glUniform1i(program.textureUsedLoc, textureId ? 1 : 0);
+    if(textureId)
+        glBindTexture(GL_TEXTURE_2D, textureId);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// create the line and mesh programs, and look up the uniforms
+///////////////////////////////////////////////////////////////////////////////
+bool CoreRenderer::createPrograms()
+{
+    const char* colorAttribs[] = { "vertexPosition", "vertexColor" };
+    const int colorLocations[] = { MESH_ATTRIB_POSITION, MESH_ATTRIB_COLOR };
+    colorProgId = createProgram("", coreColorVs, coreColorFs, colorAttribs, colorLocations, 2);
+    if(!colorProgId)
+        return false;
+    colorMvpLoc = glGetUniformLocation(colorProgId, "matrixModelViewProjection");
+
+    return createMeshProgram(meshProgram, "") &&
+           createMeshProgram(instanceProgram, "#define INSTANCED\n");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// create a variant of the mesh program, and look up the uniforms and blocks
+///////////////////////////////////////////////////////////////////////////////
+bool CoreRenderer::createMeshProgram(MeshProgram& program, const char* defines)
+{
+    const char* attribs[] = { "vertexPosition", "vertexNormal", "vertexTexCoord", "vertexColor", "instanceMatrix" };
+    const int locations[] = { MESH_ATTRIB_POSITION, MESH_ATTRIB_NORMAL, MESH_ATTRIB_TEXCOORD,
+                              MESH_ATTRIB_COLOR, MESH_ATTRIB_INSTANCE_MATRIX };     // mat4 takes 4 ~ 7
+    program.id = createProgram(defines, coreMeshVs, coreMeshFs, attribs, locations, 5);
+    if(!program.id)
+        return false;
+
+    program.modelViewLoc = glGetUniformLocation(program.id, "matrixModelView");
+    program.mvpLoc = glGetUniformLocation(program.id, "matrixModelViewProjection");
+    program.textureUsedLoc = glGetUniformLocation(program.id, "textureUsed");
+    program.fogDensityLoc = glGetUniformLocation(program.id, "fogDensity");
+    program.fogColorLoc = glGetUniformLocation(program.id, "fogColor");
+    program.colorLoc = glGetUniformLocation(program.id, "color");    // -1 if INSTANCED
+
+    GLuint lightIndex = glGetUniformBlockIndex(program.id, "Light");
+    GLuint materialIndex = glGetUniformBlockIndex(program.id, "Material");
+    if(lightIndex == GL_INVALID_INDEX || materialIndex == GL_INVALID_INDEX)
+        return false;
+    glUniformBlockBinding(program.id, lightIndex, LIGHT_BINDING);
+    glUniformBlockBinding(program.id, materialIndex, MATERIAL_BINDING);
+
+    // texture unit 0
+    glUseProgram(program.id);
+    glUniform1i(glGetUniformLocation(program.id, "map0"), 0);
+    glUseProgram(0);
+    return true;
+}
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+// CoreRenderer.h
+// ==============
+// shader-based replacement of the fixed pipeline for the core-profile path
+// It uses GLSL 1.40 without any built-in state (gl_ModelViewMatrix,
+// gl_LightSource...): the matrices are explicit uniforms from Matrix4::get(),
+// the light and the materials are in uniform buffers, and all geometry is in
+// VAOs/VBOs. The meshes come from MeshCache and the grid, axis and frustum
+// from HelperCache, both with generic attributes (see MeshAttribute).
+// It needs GLSL 1.40, GL_ARB_vertex_array_object and
+// GL_ARB_uniform_buffer_object, see isSupported(). Instanced draws need
+// OpenGL 3.3 (or GL_ARB_draw_instanced and GL_ARB_instanced_arrays), see
+// isInstancingReady(); it does not depend on the legacy GLSL programs.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CORE_RENDERER_H
+#define CORE_RENDERER_H
+
+#ifdef _WIN32
+#include <windows.h>    // include windows.h to avoid thousands of compile errors even though this class is not depending on Windows
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include "Matrices.h"
+
+class CoreRenderer
+{
+public:
+    // material slots in the uniform buffer
+    enum Material
+    {
+        MATERIAL_SURFACE = 0,   // objects and instances, ambient and diffuse are scaled by the color
+        MATERIAL_CAMERA,        // camera body
+        MATERIAL_COUNT
+    };
+
+    CoreRenderer();
+    ~CoreRenderer() {}
+
+    static bool isSupported();                      // check GLSL version and extensions, OpenGL RC must be set
+    bool init();                                    // create programs and buffers, OpenGL RC must be set
+    void quit();                                    // delete all GL objects
+    bool isReady() const                    { return ready; }
+    bool isInstancingReady() const          { return instancingReady; }     // beginInstances() can be used
+
+    // light in eye space and materials, copied into the uniform buffers
+    void setLight(const float position[4], const float ambient[4], const float diffuse[4], const float specular[4]);
+    void setMaterial(int material, const float ambient[4], const float diffuse[4], const float specular[4], float shininess);
+
+    // states of the following draws
+    void setProjection(const Matrix4& matrix)   { matrixProjection = matrix; }
+    void setFog(float density, const float color[4]);   // GL_EXP2 fog, 0 density disables it
+    void disableFog()                           { fogDensity = 0; }
+    void setTexture(GLuint id)                  { textureId = id; }     // modulated, 0 disables it
+
+    // unlit program with vertex colors for HelperCache draws
+    void beginLines(const Matrix4& matrixModelView);
+    void endLines();
+
+    // lit program for MeshCache meshes with generic attributes
+    // color scales the ambient and diffuse of the material
+    void beginMesh(const Matrix4& matrixModelView, int material, const float color[4]);
+    void setMeshTransform(const Matrix4& matrixModelView, const float color[4]);    // after beginMesh()
+    // same program with the per-instance matrix and color arrays (MESH_ATTRIB_INSTANCE_MATRIX
+    // and MESH_ATTRIB_COLOR), the caller enables them
+    void beginInstances(const Matrix4& matrixView, int material);
+    void endMesh();                                 // after beginMesh() or beginInstances()
+
+private:
+    // uniform locations of a mesh program variant
+    struct MeshProgram
+    {
+        GLuint id;
+        GLint modelViewLoc;
+        GLint mvpLoc;                       // projection * modelview, done on CPU
+        GLint textureUsedLoc;
+        GLint fogDensityLoc;
+        GLint fogColorLoc;
+        GLint colorLoc;
+    };
+
+    static bool isInstancingSupported();    // OpenGL RC must be set
+    bool createPrograms();
+    bool createMeshProgram(MeshProgram& program, const char* defines);
+    void useMeshProgram(const MeshProgram& program, int material);
+
+    bool ready;
+    bool instancingReady;
+    GLuint colorProgId;                     // helper lines with vertex colors
+    GLint colorMvpLoc;
+    MeshProgram meshProgram;                // blinn shading with light and material blocks
+    MeshProgram instanceProgram;            // same with per-instance matrix and color
+    GLuint lightUboId;
+    GLuint materialUboId;                   // all materials, a range is bound per mesh
+    GLint materialStride;                   // bytes, aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+
+    Matrix4 matrixProjection;
+    float fogDensity;
+    float fogColor[4];
+    GLuint textureId;
+};
+
+#endif
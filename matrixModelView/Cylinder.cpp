@@ -38,7 +38,9 @@ const int MIN_STACK_COUNT  = 1;
 // ctor
 ///////////////////////////////////////////////////////////////////////////////
 Cylinder::Cylinder(float baseRadius, float topRadius, float height, int sectors,
-                   int stacks, bool smooth) : interleavedStride(32)
+                   int stacks, bool smooth) : baseRadius(0), topRadius(0), height(0),
+                                              sectorCount(0), stackCount(0), baseIndex(0),
+                                              topIndex(0), smooth(false), interleavedStride(32)
 {
     set(baseRadius, topRadius, height, sectors, stacks, smooth);
 }
@@ -51,42 +53,53 @@ Cylinder::Cylinder(float baseRadius, float topRadius, float height, int sectors,
 void Cylinder::set(float baseRadius, float topRadius, float height, int sectors,
                    int stacks, bool smooth)
 {
+    if(sectors < MIN_SECTOR_COUNT)
+        sectors = MIN_SECTOR_COUNT;
+    if(stacks < MIN_STACK_COUNT)
+        stacks = MIN_STACK_COUNT;
+
+    int dirty = 0;
+    if(vertices.empty() || this->sectorCount != sectors ||
+       this->stackCount != stacks || this->smooth != smooth)
+        dirty |= DIRTY_TOPOLOGY;
+    if(this->baseRadius != baseRadius || this->topRadius != topRadius || this->height != height)
+        dirty |= DIRTY_SHAPE;
+
     this->baseRadius = baseRadius;
     this->topRadius = topRadius;
     this->height = height;
     this->sectorCount = sectors;
-    if(sectors < MIN_SECTOR_COUNT)
-        this->sectorCount = MIN_SECTOR_COUNT;
     this->stackCount = stacks;
-    if(stacks < MIN_STACK_COUNT)
-        this->stackCount = MIN_STACK_COUNT;
     this->smooth = smooth;
 
-    // generate unit circle vertices first
-    buildUnitCircleVertices();
-
-    if(smooth)
-        buildVerticesSmooth();
-    else
-        buildVerticesFlat();
+    rebuild(dirty);
 }
 
 void Cylinder::setBaseRadius(float radius)
 {
     if(this->baseRadius != radius)
-        set(radius, topRadius, height, sectorCount, stackCount, smooth);
+    {
+        this->baseRadius = radius;
+        rebuild(DIRTY_SHAPE);
+    }
 }
 
 void Cylinder::setTopRadius(float radius)
 {
     if(this->topRadius != radius)
-        set(baseRadius, radius, height, sectorCount, stackCount, smooth);
+    {
+        this->topRadius = radius;
+        rebuild(DIRTY_SHAPE);
+    }
 }
 
 void Cylinder::setHeight(float height)
 {
     if(this->height != height)
-        set(baseRadius, topRadius, height, sectorCount, stackCount, smooth);
+    {
+        this->height = height;
+        rebuild(DIRTY_SHAPE);
+    }
 }
 
 void Cylinder::setSectorCount(int sectors)
@@ -103,14 +116,51 @@ void Cylinder::setStackCount(int stacks)
 
 void Cylinder::setSmooth(bool smooth)
 {
-    if(this->smooth == smooth)
-        return;
+    if(this->smooth != smooth)
+        set(baseRadius, topRadius, height, sectorCount, stackCount, smooth);
+}
 
-    this->smooth = smooth;
-    if(smooth)
-        buildVerticesSmooth();
-    else
-        buildVerticesFlat();
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the bounding box without scanning vertices
+///////////////////////////////////////////////////////////////////////////////
+BoundingBox Cylinder::getBounds() const
+{
+    float radius = baseRadius > topRadius ? baseRadius : topRadius;
+    float halfHeight = height * 0.5f;
+    return BoundingBox(Vector3(-radius, -radius, -halfHeight), Vector3(radius, radius, halfHeight));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// rebuild the arrays for the dirty flags
+// DIRTY_TOPOLOGY: sector/stack count or shading is changed, rebuild all arrays
+// DIRTY_SHAPE   : radius or height is changed, the topology stays the same,
+//                 so only positions and normals are updated in place
+///////////////////////////////////////////////////////////////////////////////
+void Cylinder::rebuild(int dirty)
+{
+    if(dirty & DIRTY_TOPOLOGY)
+    {
+        // generate unit circle vertices first
+        if(unitCircleVertices.size() != (std::size_t)(sectorCount + 1) * 3)
+            buildUnitCircleVertices();
+
+        if(smooth)
+            buildVerticesSmooth();
+        else
+            buildVerticesFlat();
+    }
+    else if(dirty & DIRTY_SHAPE)
+    {
+        if(smooth)
+            updateVerticesSmooth();
+        else
+            updateVerticesFlat();
+        updateInterleavedVertices();
+    }
 }
 
 
@@ -561,6 +611,110 @@ void Cylinder::buildVerticesFlat()
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// update positions and normals of smooth shading in place
+// the vertex order is same as buildVerticesSmooth()
+///////////////////////////////////////////////////////////////////////////////
+void Cylinder::updateVerticesSmooth()
+{
+    float* v = &vertices[0];
+    float* n = &normals[0];
+    float z, radius;
+
+    std::vector<float> sideNormals = getSideNormals();
+
+    // side
+    for(int i = 0; i <= stackCount; ++i)
+    {
+        z = -(height * 0.5f) + (float)i / stackCount * height;
+        radius = baseRadius + (float)i / stackCount * (topRadius - baseRadius);
+
+        for(int j = 0, k = 0; j <= sectorCount; ++j, k += 3, v += 3, n += 3)
+        {
+            v[0] = unitCircleVertices[k] * radius;
+            v[1] = unitCircleVertices[k+1] * radius;
+            v[2] = z;
+            n[0] = sideNormals[k];
+            n[1] = sideNormals[k+1];
+            n[2] = sideNormals[k+2];
+        }
+    }
+
+    // base and top, the normals are always (0,0,-1) and (0,0,1)
+    updateCapVertices(v, -height * 0.5f, baseRadius);
+    updateCapVertices(v + (sectorCount + 1) * 3, height * 0.5f, topRadius);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// update positions and face normals of flat shading in place
+// the vertex order is same as buildVerticesFlat(): 4 vertices per quad
+///////////////////////////////////////////////////////////////////////////////
+void Cylinder::updateVerticesFlat()
+{
+    float* v = &vertices[0];
+    float* n = &normals[0];
+    float x1, y1, x2, y2, z1, z2, r1, r2;
+    std::vector<float> faceNormal;
+
+    // v2-v4 <== stack at i+1
+    // | \ |
+    // v1-v3 <== stack at i
+    for(int i = 0; i < stackCount; ++i)
+    {
+        z1 = -(height * 0.5f) + (float)i / stackCount * height;
+        z2 = -(height * 0.5f) + (float)(i + 1) / stackCount * height;
+        r1 = baseRadius + (float)i / stackCount * (topRadius - baseRadius);
+        r2 = baseRadius + (float)(i + 1) / stackCount * (topRadius - baseRadius);
+
+        for(int j = 0, k = 0; j < sectorCount; ++j, k += 3, v += 12, n += 12)
+        {
+            x1 = unitCircleVertices[k];
+            y1 = unitCircleVertices[k+1];
+            x2 = unitCircleVertices[k+3];
+            y2 = unitCircleVertices[k+4];
+
+            v[0] = x1 * r1;  v[1]  = y1 * r1;  v[2]  = z1;     // v1
+            v[3] = x1 * r2;  v[4]  = y1 * r2;  v[5]  = z2;     // v2
+            v[6] = x2 * r1;  v[7]  = y2 * r1;  v[8]  = z1;     // v3
+            v[9] = x2 * r2;  v[10] = y2 * r2;  v[11] = z2;     // v4
+
+            // face normal of v1-v3-v2, same for all 4 vertices
+            faceNormal = computeFaceNormal(v[0],v[1],v[2], v[6],v[7],v[8], v[3],v[4],v[5]);
+            for(int m = 0; m < 12; m += 3)
+            {
+                n[m]   = faceNormal[0];
+                n[m+1] = faceNormal[1];
+                n[m+2] = faceNormal[2];
+            }
+        }
+    }
+
+    updateCapVertices(v, -height * 0.5f, baseRadius);
+    updateCapVertices(v + (sectorCount + 1) * 3, height * 0.5f, topRadius);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// update positions of a base or top cap: the center, then sectorCount vertices
+///////////////////////////////////////////////////////////////////////////////
+void Cylinder::updateCapVertices(float* v, float z, float radius)
+{
+    v[0] = v[1] = 0;
+    v[2] = z;
+    v += 3;
+    for(int i = 0, k = 0; i < sectorCount; ++i, k += 3, v += 3)
+    {
+        v[0] = unitCircleVertices[k] * radius;
+        v[1] = unitCircleVertices[k+1] * radius;
+        v[2] = z;
+    }
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // generate interleaved vertices: V/N/T
 // stride must be 32 bytes
@@ -591,6 +745,27 @@ void Cylinder::buildInterleavedVertices()
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// copy positions and normals to the interleaved array in place
+// tex coords are not changed by radius or height
+///////////////////////////////////////////////////////////////////////////////
+void Cylinder::updateInterleavedVertices()
+{
+    std::size_t count = vertices.size();
+    float* dst = &interleavedVertices[0];
+    for(std::size_t i = 0; i < count; i += 3, dst += 8)
+    {
+        dst[0] = vertices[i];
+        dst[1] = vertices[i+1];
+        dst[2] = vertices[i+2];
+        dst[3] = normals[i];
+        dst[4] = normals[i+1];
+        dst[5] = normals[i+2];
+    }
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // generate 3D vertices of a unit circle on XY plance
 ///////////////////////////////////////////////////////////////////////////////
@@ -14,6 +14,7 @@
 #define GEOMETRY_CYLINDER_H
 
 #include <vector>
+#include "BoundingBox.h"
 
 class Cylinder
 {
@@ -37,6 +38,7 @@ public:
     void setSectorCount(int sectorCount);
     void setStackCount(int stackCount);
     void setSmooth(bool smooth);
+    BoundingBox getBounds() const;          // AABB, the caps are bounded by the larger radius
 
     // for vertex data
     unsigned int getVertexCount() const     { return (unsigned int)vertices.size() / 3; }
@@ -84,11 +86,23 @@ public:
 protected:
 
 private:
+    // dirty flags for rebuild()
+    enum DirtyFlag
+    {
+        DIRTY_SHAPE     = 1,                // radius or height: update positions and normals
+        DIRTY_TOPOLOGY  = 2                 // sector/stack count or shading: rebuild all
+    };
+
     // member functions
+    void rebuild(int dirty);
     void clearArrays();
     void buildVerticesSmooth();
     void buildVerticesFlat();
     void buildInterleavedVertices();
+    void updateVerticesSmooth();
+    void updateVerticesFlat();
+    void updateCapVertices(float* v, float z, float radius);
+    void updateInterleavedVertices();
     void buildUnitCircleVertices();
     void addVertex(float x, float y, float z);
     void addNormal(float x, float y, float z);
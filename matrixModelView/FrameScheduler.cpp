@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////
+// FrameScheduler.cpp
+// ==================
+// decide when the rendering thread draws the next frame
+// See FrameScheduler.h for the 3 modes.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameScheduler.h"
+
+const float DEFAULT_FPS = 60.0f;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+// It starts dirty, so the first frame is drawn immediately.
+///////////////////////////////////////////////////////////////////////////////
+FrameScheduler::FrameScheduler() : mode(FRAME_ON_DIRTY), frameSeconds(0),
+                                   dirty(true), stopped(false), resumed(false)
+{
+    setTargetFps(DEFAULT_FPS);
+    deadline = lastFrame = Clock::now();
+    resetStats();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// change scheduling mode
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::setMode(FrameMode mode)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->mode = mode;
+    deadline = Clock::now();
+    dirty = true;
+    cond.notify_one();
+}
+
+FrameMode FrameScheduler::getMode() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return mode;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set target frame rate for FRAME_FIXED and FRAME_ON_DIRTY
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::setTargetFps(float fps)
+{
+    if(fps < 1.0f)
+        fps = 1.0f;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    targetFps = fps;
+    period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.0f / fps));
+}
+
+float FrameScheduler::getTargetFps() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return targetFps;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// mark the scene is changed and wake up the rendering thread
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::requestRedraw()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    dirty = true;
+    cond.notify_one();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// wake up the rendering thread, then waitForFrame() returns false
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::stop()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    stopped = true;
+    cond.notify_one();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// block the rendering thread until the next frame is due
+// return false if stop() is called
+///////////////////////////////////////////////////////////////////////////////
+bool FrameScheduler::waitForFrame()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if(mode == FRAME_ON_DIRTY)
+    {
+        // sleep until something is changed
+        resumed = !dirty;
+        while(!dirty && !stopped)
+            cond.wait(lock);
+
+        // do not exceed the target FPS while changes keep coming
+        Clock::time_point next = lastFrame + period;
+        while(!stopped && Clock::now() < next)
+            cond.wait_until(lock, next);
+    }
+    else if(mode == FRAME_FIXED)
+    {
+        // next deadline is added from the previous deadline, not from now
+        // if it is behind more than a frame, skip the missed frames
+        Clock::time_point now = Clock::now();
+        deadline += period;
+        if(deadline < now - period)
+            deadline = now;
+
+        while(!stopped && Clock::now() < deadline)
+        {
+            if(cond.wait_until(lock, deadline) == std::cv_status::timeout)
+                break;
+        }
+    }
+
+    dirty = false;
+    return !stopped;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// update frame time stats, call it after swap buffers
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::frameDone()
+{
+    Clock::time_point now = Clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    frameSeconds = std::chrono::duration<float>(now - lastFrame).count();
+    lastFrame = now;
+
+    // the first frame after idle is not counted, it includes the idle time
+    if(resumed)
+    {
+        frameSeconds = 1.0f / targetFps;
+        resumed = false;
+        return;
+    }
+
+    float ms = frameSeconds * 1000.0f;
+    ++stats.frameCount;
+    sumMs += ms;
+    stats.lastMs = ms;
+    stats.avgMs = (float)(sumMs / stats.frameCount);
+    if(stats.frameCount == 1 || ms < stats.minMs)
+        stats.minMs = ms;
+    if(ms > stats.maxMs)
+        stats.maxMs = ms;
+    stats.fps = stats.avgMs > 0 ? 1000.0f / stats.avgMs : 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return a copy of frame time stats
+///////////////////////////////////////////////////////////////////////////////
+FrameStats FrameScheduler::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// clear frame time stats
+///////////////////////////////////////////////////////////////////////////////
+void FrameScheduler::resetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.frameCount = 0;
+    stats.lastMs = stats.avgMs = stats.minMs = stats.maxMs = stats.fps = 0;
+    sumMs = 0;
+}
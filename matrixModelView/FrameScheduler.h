@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// FrameScheduler.h
+// ================
+// decide when the rendering thread draws the next frame
+// There are 3 modes:
+// FRAME_ON_DIRTY : sleep on a condition variable until the scene is changed,
+//                  then draw it, not faster than the target FPS
+// FRAME_FIXED    : draw at the target FPS, the deadlines are accumulated from
+//                  the start time, so late frames do not add up drift
+// FRAME_UNCAPPED : draw as fast as possible
+// It also keeps the frame time statistics of the rendering loop.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+enum FrameMode
+{
+    FRAME_ON_DIRTY = 0,
+    FRAME_FIXED,
+    FRAME_UNCAPPED
+};
+
+// frame time statistics in milliseconds
+struct FrameStats
+{
+    unsigned int frameCount;        // # of frames since reset
+    float lastMs;                   // the latest frame time
+    float avgMs;
+    float minMs;
+    float maxMs;
+    float fps;                      // 1000 / avgMs
+};
+
+class FrameScheduler
+{
+public:
+    FrameScheduler();
+    ~FrameScheduler() {}
+
+    // called from any thread
+    void setMode(FrameMode mode);
+    FrameMode getMode() const;
+    void setTargetFps(float fps);
+    float getTargetFps() const;
+
+    void requestRedraw();                   // mark dirty and wake up the rendering thread
+    void stop();                            // wake up the rendering thread to exit
+
+    // called from the rendering thread
+    bool waitForFrame();                    // block until the next frame is due, false if stopped
+    void frameDone();                       // record the frame time after swap buffers
+    float getFrameSeconds() const           { return frameSeconds; }  // elapsed time between last 2 frames
+
+    FrameStats getStats() const;            // copy of stats, thread-safe
+    void resetStats();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    FrameMode mode;
+    float targetFps;
+    Clock::duration period;                 // 1 / targetFps
+    Clock::time_point deadline;             // due time of next frame for FRAME_FIXED
+    Clock::time_point lastFrame;            // time of the previous frameDone()
+    float frameSeconds;
+    bool dirty;
+    bool stopped;
+    bool resumed;                           // woken up from idle in FRAME_ON_DIRTY
+    FrameStats stats;
+    double sumMs;
+
+    mutable std::mutex mutex;
+    std::condition_variable cond;
+};
+
+#endif
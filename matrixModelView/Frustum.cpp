@@ -0,0 +1,235 @@
+///////////////////////////////////////////////////////////////////////////////
+// Frustum.cpp
+// ===========
+// view frustum culling
+// See Frustum.h for how the planes are extracted and stored.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include "Frustum.h"
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor, every plane passes until set() is called
+///////////////////////////////////////////////////////////////////////////////
+Frustum::Frustum()
+{
+    for(int i = 0; i < PLANE_COUNT; ++i)
+    {
+        a[i] = b[i] = c[i] = 0;
+        d[i] = 1;
+    }
+}
+
+Frustum::Frustum(const Matrix4& matrix)
+{
+    set(matrix);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// extract the planes from clip = M * v, where M = projection * modelview
+// A point is inside if -w <= x,y,z <= w, so each plane is row3 +/- row0..2.
+///////////////////////////////////////////////////////////////////////////////
+void Frustum::set(const Matrix4& matrix)
+{
+    // row i of column-major m is m[i], m[i+4], m[i+8], m[i+12]
+    const float* m = matrix.get();
+    for(int i = 0; i < PLANE_COUNT; ++i)
+    {
+        int row = i / 2;
+        float sign = (i % 2 == 0) ? 1.0f : -1.0f;   // left, bottom, near: +, others: -
+        a[i] = m[3]  + sign * m[row];
+        b[i] = m[7]  + sign * m[row + 4];
+        c[i] = m[11] + sign * m[row + 8];
+        d[i] = m[15] + sign * m[row + 12];
+
+        // normalize, so the distance can be compared with a sphere radius
+        float length = sqrtf(a[i] * a[i] + b[i] * b[i] + c[i] * c[i]);
+        if(length > 0)
+        {
+            float invLength = 1.0f / length;
+            a[i] *= invLength;
+            b[i] *= invLength;
+            c[i] *= invLength;
+            d[i] *= invLength;
+        }
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the plane equation
+///////////////////////////////////////////////////////////////////////////////
+Vector4 Frustum::getPlane(int index) const
+{
+    return Vector4(a[index], b[index], c[index], d[index]);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// point and sphere tests, a plane at a time
+///////////////////////////////////////////////////////////////////////////////
+bool Frustum::testPoint(const Vector3& point) const
+{
+    return testSphere(point, 0);
+}
+
+bool Frustum::testSphere(const Vector3& center, float radius) const
+{
+    for(int i = 0; i < PLANE_COUNT; ++i)
+    {
+        if(a[i] * center.x + b[i] * center.y + c[i] * center.z + d[i] < -radius)
+            return false;
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AABB test with the center and half extent
+// The box is outside of a plane if n.center + d + |n|.extent < 0.
+// A single box exits at the first separating plane, which is faster than
+// testing all planes with SIMD, see testBoxes() for 4 boxes at once.
+///////////////////////////////////////////////////////////////////////////////
+bool Frustum::testBox(const BoundingBox& box) const
+{
+    float cx = (box.min.x + box.max.x) * 0.5f;
+    float cy = (box.min.y + box.max.y) * 0.5f;
+    float cz = (box.min.z + box.max.z) * 0.5f;
+    float ex = (box.max.x - box.min.x) * 0.5f;
+    float ey = (box.max.y - box.min.y) * 0.5f;
+    float ez = (box.max.z - box.min.z) * 0.5f;
+
+    for(int i = 0; i < PLANE_COUNT; ++i)
+    {
+        float dist = a[i] * cx + b[i] * cy + c[i] * cz + d[i];
+        float reach = fabsf(a[i]) * ex + fabsf(b[i]) * ey + fabsf(c[i]) * ez;
+        if(dist + reach < 0)
+            return false;
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// test many boxes
+// With SSE, 4 boxes are tested against a plane at once, and the planes stop
+// when all 4 boxes are already outside.
+///////////////////////////////////////////////////////////////////////////////
+int Frustum::testBoxes(const BoundingBox* boxes, int count, unsigned char* visible) const
+{
+    int visibleCount = 0;
+    int i = 0;
+
+#ifdef MATRICES_SIMD
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+    for(; i + 4 <= count; i += 4)
+    {
+        const BoundingBox* box = boxes + i;
+        __m128 minX = _mm_set_ps(box[3].min.x, box[2].min.x, box[1].min.x, box[0].min.x);
+        __m128 minY = _mm_set_ps(box[3].min.y, box[2].min.y, box[1].min.y, box[0].min.y);
+        __m128 minZ = _mm_set_ps(box[3].min.z, box[2].min.z, box[1].min.z, box[0].min.z);
+        __m128 maxX = _mm_set_ps(box[3].max.x, box[2].max.x, box[1].max.x, box[0].max.x);
+        __m128 maxY = _mm_set_ps(box[3].max.y, box[2].max.y, box[1].max.y, box[0].max.y);
+        __m128 maxZ = _mm_set_ps(box[3].max.z, box[2].max.z, box[1].max.z, box[0].max.z);
+        __m128 cx = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+        __m128 cy = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+        __m128 cz = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+        __m128 ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+        __m128 ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+        __m128 ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+        __m128 outside = zero;
+        for(int j = 0; j < PLANE_COUNT; ++j)
+        {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[j]), cx),
+                                                _mm_mul_ps(_mm_set1_ps(b[j]), cy)),
+                                     _mm_add_ps(_mm_mul_ps(_mm_set1_ps(c[j]), cz),
+                                                _mm_set1_ps(d[j])));
+            __m128 reach = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(fabsf(a[j])), ex),
+                                                 _mm_mul_ps(_mm_set1_ps(fabsf(b[j])), ey)),
+                                      _mm_mul_ps(_mm_set1_ps(fabsf(c[j])), ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, reach), zero));
+            if(_mm_movemask_ps(outside) == 0xf)
+                break;
+        }
+
+        int mask = _mm_movemask_ps(outside);
+        for(int k = 0; k < 4; ++k)
+        {
+            visible[i + k] = (mask >> k) & 1 ? 0 : 1;
+            visibleCount += visible[i + k];
+        }
+    }
+#endif
+
+    for(; i < count; ++i)
+    {
+        visible[i] = testBox(boxes[i]) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// test many spheres
+// With SSE, 4 spheres are transposed to x, y, z and radius vectors, then
+// tested against a plane at once in the same order of operations as
+// testSphere(), so both give the same result.
+///////////////////////////////////////////////////////////////////////////////
+int Frustum::testSpheres(const Vector4* spheres, int count, unsigned char* visible) const
+{
+    int visibleCount = 0;
+    int i = 0;
+
+#ifdef MATRICES_SIMD
+    const __m128 zero = _mm_setzero_ps();
+    for(; i + 4 <= count; i += 4)
+    {
+        const Vector4* sphere = spheres + i;
+        __m128 x = _mm_loadu_ps(&sphere[0].x);
+        __m128 y = _mm_loadu_ps(&sphere[1].x);
+        __m128 z = _mm_loadu_ps(&sphere[2].x);
+        __m128 r = _mm_loadu_ps(&sphere[3].x);
+        _MM_TRANSPOSE4_PS(x, y, z, r);
+        __m128 minusR = _mm_sub_ps(zero, r);
+
+        __m128 outside = zero;
+        for(int j = 0; j < PLANE_COUNT; ++j)
+        {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[j]), x),
+                                                           _mm_mul_ps(_mm_set1_ps(b[j]), y)),
+                                                _mm_mul_ps(_mm_set1_ps(c[j]), z)),
+                                     _mm_set1_ps(d[j]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, minusR));
+            if(_mm_movemask_ps(outside) == 0xf)
+                break;
+        }
+
+        int mask = _mm_movemask_ps(outside);
+        for(int k = 0; k < 4; ++k)
+        {
+            visible[i + k] = (mask >> k) & 1 ? 0 : 1;
+            visibleCount += visible[i + k];
+        }
+    }
+#endif
+
+    for(; i < count; ++i)
+    {
+        const Vector4& sphere = spheres[i];
+        visible[i] = testSphere(Vector3(sphere.x, sphere.y, sphere.z), sphere.w) ? 1 : 0;
+        visibleCount += visible[i];
+    }
+    return visibleCount;
+}
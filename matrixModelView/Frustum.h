@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// Frustum.h
+// =========
+// view frustum culling
+// The 6 clipping planes are extracted from a projection matrix multiplied by a
+// modelview matrix (Gribb & Hartmann), so the test runs in the space before
+// the modelview transform: pass projection * view to test world-space bounds,
+// or projection * view * model to test object-space bounds of a mesh.
+// The planes are stored as structure of arrays, and testBoxes() and
+// testSpheres() test 4 AABBs or spheres against a plane at once with SSE (same
+// backend switch as Matrices.h).
+// The tests are conservative: a box near a corner of the frustum may pass
+// even if it is outside, but a visible box never fails.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "Matrices.h"
+#include "BoundingBox.h"
+
+class Frustum
+{
+public:
+    enum Plane
+    {
+        PLANE_LEFT = 0,
+        PLANE_RIGHT,
+        PLANE_BOTTOM,
+        PLANE_TOP,
+        PLANE_NEAR,
+        PLANE_FAR,
+        PLANE_COUNT
+    };
+
+    Frustum();
+    Frustum(const Matrix4& matrix);                 // projection * modelview
+
+    void set(const Matrix4& matrix);
+    Vector4 getPlane(int index) const;              // (a,b,c,d), inside if ax+by+cz+d >= 0, |(a,b,c)| = 1
+
+    // return false if it is completely outside
+    bool testPoint(const Vector3& point) const;
+    bool testSphere(const Vector3& center, float radius) const;
+    bool testBox(const BoundingBox& box) const;
+
+    // test many boxes, visible[i] = 1 if boxes[i] is inside or intersecting
+    // return # of visible boxes
+    int testBoxes(const BoundingBox* boxes, int count, unsigned char* visible) const;
+
+    // test many spheres of (center x, y, z, radius), same as testBoxes()
+    int testSpheres(const Vector4* spheres, int count, unsigned char* visible) const;
+
+private:
+    float a[PLANE_COUNT];
+    float b[PLANE_COUNT];
+    float c[PLANE_COUNT];
+    float d[PLANE_COUNT];
+};
+
+#endif
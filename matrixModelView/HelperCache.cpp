@@ -0,0 +1,411 @@
+///////////////////////////////////////////////////////////////////////////////
+// HelperCache.cpp
+// ===============
+// GPU cache for the helper lines of the scene (grid, axis and frustum)
+// A helper is built once per parameters into a V/C vertex buffer (28 bytes
+// stride) with the primitive ranges, same order as the glBegin()/glEnd()
+// calls it replaces.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include "HelperCache.h"
+#include "MeshCache.h"
+#include "glExtension.h"
+
+
+
+// constants //////////////////////////////////////////////////////////////////
+const int HELPER_STRIDE = 28;               // bytes per vertex, position(3) + color(4)
+const float DEG2RAD = 3.141593f / 180;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+HelperCache::HelperCache() : useCount(0), vboSupported(false), vaoSupported(false),
+                             genericAttributes(false), buildCount(0)
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// check VBO and VAO extensions
+// NOTE: must be called after OpenGL RC is set
+///////////////////////////////////////////////////////////////////////////////
+void HelperCache::init()
+{
+    glExtension& extension = glExtension::getInstance();
+    vboSupported = extension.isSupported("GL_ARB_vertex_buffer_object");
+    vaoSupported = vboSupported && extension.isSupported("GL_ARB_vertex_array_object");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// switch between the fixed client arrays and the generic attributes
+// the cached helpers are released, and rebuilt with/without VAO on next draw
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void HelperCache::setGenericAttributes(bool enabled)
+{
+    enabled = enabled && vaoSupported;
+    if(genericAttributes == enabled)
+        return;
+
+    clear();
+    genericAttributes = enabled;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// delete all cached helpers
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void HelperCache::clear()
+{
+    for(size_t i = 0; i < helpers.size(); ++i)
+        release(helpers[i]);
+    helpers.clear();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw the cached helpers, build them first if the params are not cached
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void HelperCache::drawGrid(float size, float step)
+{
+    const float params[4] = { size, step, 0, 0 };
+    draw(prepare(HELPER_GRID, params));
+}
+
+void HelperCache::drawAxis(float size)
+{
+    const float params[4] = { size, 0, 0, 0 };
+    draw(prepare(HELPER_AXIS, params));
+}
+
+void HelperCache::drawFrustum(float fovY, float aspectRatio, float nearPlane, float farPlane)
+{
+    const float params[4] = { fovY, aspectRatio, nearPlane, farPlane };
+    draw(prepare(HELPER_FRUSTUM, params));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// find the helper built with the same params, or build and upload a new one
+// if the cache is full, the least recently used helper is released and reused
+///////////////////////////////////////////////////////////////////////////////
+HelperCache::Helper& HelperCache::prepare(int shape, const float params[4])
+{
+    ++useCount;
+    for(size_t i = 0; i < helpers.size(); ++i)
+    {
+        const Helper& helper = helpers[i];
+        const float* p = helper.params;
+        if(helper.shape == shape &&
+           p[0] == params[0] && p[1] == params[1] && p[2] == params[2] && p[3] == params[3])
+        {
+            helpers[i].lastUsed = useCount;
+            return helpers[i];
+        }
+    }
+
+    size_t index = helpers.size();
+    if(helpers.size() < MAX_HELPER_COUNT)
+    {
+        helpers.push_back(Helper());
+    }
+    else
+    {
+        index = 0;
+        for(size_t i = 1; i < helpers.size(); ++i)
+        {
+            if(useCount - helpers[i].lastUsed > useCount - helpers[index].lastUsed)
+                index = i;
+        }
+        release(helpers[index]);
+        helpers[index] = Helper();
+    }
+    Helper& helper = helpers[index];
+    helper.lastUsed = useCount;
+    helper.shape = shape;
+    for(int i = 0; i < 4; ++i)
+    {
+        helper.params[i] = params[i];
+        helper.lastColor[i] = 1;
+    }
+    helper.vboId = helper.vaoId = 0;
+
+    if(shape == HELPER_GRID)
+        buildGrid(helper);
+    else if(shape == HELPER_AXIS)
+        buildAxis(helper);
+    else
+        buildFrustum(helper);
+    upload(helper);
+    ++buildCount;
+    return helper;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// append a vertex, and a range of the last count vertices
+///////////////////////////////////////////////////////////////////////////////
+void HelperCache::addVertex(Helper& helper, float x, float y, float z, const float color[4])
+{
+    helper.vertices.push_back(x);
+    helper.vertices.push_back(y);
+    helper.vertices.push_back(z);
+    helper.vertices.insert(helper.vertices.end(), color, color + 4);
+    for(int i = 0; i < 4; ++i)
+        helper.lastColor[i] = color[i];
+}
+
+void HelperCache::addRange(Helper& helper, GLenum mode, int count, float size)
+{
+    Range range;
+    range.mode = mode;
+    range.first = (int)helper.vertices.size() / 7 - count;
+    range.count = count;
+    range.size = size;
+    helper.ranges.push_back(range);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// grid on the xz plane, and the x and z axes
+///////////////////////////////////////////////////////////////////////////////
+void HelperCache::buildGrid(Helper& helper)
+{
+    const float size = helper.params[0];
+    const float step = helper.params[1];
+    const float gridColor[4] = { 0.3f, 0.3f, 0.3f, 1 };
+    const float xColor[4] = { 0.6f, 0.2f, 0.2f, 1 };
+    const float zColor[4] = { 0.2f, 0.2f, 0.6f, 1 };
+
+    for(float i = step; i <= size; i += step)
+    {
+        addVertex(helper, -size, 0,  i, gridColor);     // lines parallel to X-axis
+        addVertex(helper,  size, 0,  i, gridColor);
+        addVertex(helper, -size, 0, -i, gridColor);
+        addVertex(helper,  size, 0, -i, gridColor);
+
+        addVertex(helper,  i, 0, -size, gridColor);     // lines parallel to Z-axis
+        addVertex(helper,  i, 0,  size, gridColor);
+        addVertex(helper, -i, 0, -size, gridColor);
+        addVertex(helper, -i, 0,  size, gridColor);
+    }
+    addVertex(helper, -size, 0, 0, xColor);             // x-axis
+    addVertex(helper,  size, 0, 0, xColor);
+    addVertex(helper, 0, 0, -size, zColor);             // z-axis
+    addVertex(helper, 0, 0,  size, zColor);
+    addRange(helper, GL_LINES, (int)helper.vertices.size() / 7);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// local axis of an object, 3 lines and the arrows(big square dots)
+///////////////////////////////////////////////////////////////////////////////
+void HelperCache::buildAxis(Helper& helper)
+{
+    const float size = helper.params[0];
+    const float red[4] = { 1, 0, 0, 1 };
+    const float green[4] = { 0, 1, 0, 1 };
+    const float blue[4] = { 0, 0, 1, 1 };
+
+    addVertex(helper, 0, 0, 0, red);
+    addVertex(helper, size, 0, 0, red);
+    addVertex(helper, 0, 0, 0, green);
+    addVertex(helper, 0, size, 0, green);
+    addVertex(helper, 0, 0, 0, blue);
+    addVertex(helper, 0, 0, size, blue);
+    addRange(helper, GL_LINES, 6, 3);
+
+    addVertex(helper, size, 0, 0, red);
+    addVertex(helper, 0, size, 0, green);
+    addVertex(helper, 0, 0, size, blue);
+    addRange(helper, GL_POINTS, 3, 8);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// frustum of the camera: edges, loops around far and near planes, then the
+// near and far planes
+// the planes are triangles instead of quads, for the core-profile path
+///////////////////////////////////////////////////////////////////////////////
+void HelperCache::buildFrustum(Helper& helper)
+{
+    const float fovY = helper.params[0];
+    const float aspectRatio = helper.params[1];
+    const float nearPlane = helper.params[2];
+    const float farPlane = helper.params[3];
+
+    float tangent = tanf(fovY / 2 * DEG2RAD);
+    float nearHeight = nearPlane * tangent;
+    float nearWidth = nearHeight * aspectRatio;
+    float farHeight = farPlane * tangent;
+    float farWidth = farHeight * aspectRatio;
+
+    // 8 vertices of the frustum: near (top right, top left, bottom left,
+    // bottom right), then far in the same order
+    const float v[8][3] = {
+        {  nearWidth,  nearHeight, -nearPlane }, { -nearWidth,  nearHeight, -nearPlane },
+        { -nearWidth, -nearHeight, -nearPlane }, {  nearWidth, -nearHeight, -nearPlane },
+        {  farWidth,   farHeight,  -farPlane },  { -farWidth,   farHeight,  -farPlane },
+        { -farWidth,  -farHeight,  -farPlane },  {  farWidth,  -farHeight,  -farPlane } };
+
+    const float colorLine1[4] = { 0.7f, 0.7f, 0.7f, 0.7f };
+    const float colorLine2[4] = { 0.2f, 0.2f, 0.2f, 0.7f };
+    const float colorPlane[4] = { 0.5f, 0.5f, 0.5f, 0.5f };
+
+    // edges from the origin to the far corners
+    for(int i = 4; i < 8; ++i)
+    {
+        addVertex(helper, 0, 0, 0, colorLine2);
+        addVertex(helper, v[i][0], v[i][1], v[i][2], colorLine1);
+    }
+    addRange(helper, GL_LINES, 8);
+
+    // loops around far and near planes
+    for(int plane = 4; plane >= 0; plane -= 4)
+    {
+        for(int i = 0; i < 4; ++i)
+            addVertex(helper, v[plane + i][0], v[plane + i][1], v[plane + i][2], colorLine1);
+        addRange(helper, GL_LINE_LOOP, 4);
+    }
+
+    // near and far planes
+    const int quadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+    for(int plane = 0; plane < 8; plane += 4)
+    {
+        for(int i = 0; i < 6; ++i)
+        {
+            const float* p = v[plane + quadIndices[i]];
+            addVertex(helper, p[0], p[1], p[2], colorPlane);
+        }
+    }
+    addRange(helper, GL_TRIANGLES, 12);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// copy vertices to VBO, and record the attribute pointers in a VAO if generic
+///////////////////////////////////////////////////////////////////////////////
+void HelperCache::upload(Helper& helper)
+{
+    if(!vboSupported || helper.vertices.empty())
+        return;
+
+    glGenBuffersARB(1, &helper.vboId);
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, helper.vboId);
+    glBufferDataARB(GL_ARRAY_BUFFER_ARB, helper.vertices.size() * sizeof(float), helper.vertices.data(), GL_STATIC_DRAW_ARB);
+
+    if(genericAttributes)
+    {
+        const char* vertexBase = 0;
+        glGenVertexArrays(1, &helper.vaoId);
+        glBindVertexArray(helper.vaoId);
+        glEnableVertexAttribArrayARB(MESH_ATTRIB_POSITION);
+        glEnableVertexAttribArrayARB(MESH_ATTRIB_COLOR);
+        glVertexAttribPointerARB(MESH_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, HELPER_STRIDE, vertexBase);
+        glVertexAttribPointerARB(MESH_ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, HELPER_STRIDE, vertexBase + sizeof(float) * 3);
+        glBindVertexArray(0);
+    }
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+    // data lives in VBO now
+    std::vector<float>().swap(helper.vertices);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw all ranges of a helper
+///////////////////////////////////////////////////////////////////////////////
+void HelperCache::draw(const Helper& helper)
+{
+    if(helper.vaoId)
+    {
+        glBindVertexArray(helper.vaoId);
+    }
+    else
+    {
+        // vertex pointers are offsets if VBO is bound
+        const char* vertexBase = 0;
+        if(helper.vboId)
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, helper.vboId);
+        else
+            vertexBase = (const char*)helper.vertices.data();
+
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(3, GL_FLOAT, HELPER_STRIDE, vertexBase);
+        glColorPointer(4, GL_FLOAT, HELPER_STRIDE, vertexBase + sizeof(float) * 3);
+    }
+
+    for(size_t i = 0; i < helper.ranges.size(); ++i)
+    {
+        const Range& range = helper.ranges[i];
+        if(range.size != 1)
+        {
+            if(range.mode == GL_POINTS)
+                glPointSize(range.size);
+            else
+                glLineWidth(range.size);
+        }
+
+        glDrawArrays(range.mode, range.first, range.count);
+
+        if(range.size != 1)
+        {
+            if(range.mode == GL_POINTS)
+                glPointSize(1);
+            else
+                glLineWidth(1);
+        }
+    }
+
+    if(helper.vaoId)
+    {
+        glBindVertexArray(0);
+    }
+    else
+    {
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisableClientState(GL_COLOR_ARRAY);
+        if(helper.vboId)
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+        // the current color is undefined after the color array, but
+        // glBegin()/glEnd() left it at the last vertex, and the objects drawn
+        // after rely on it with GL_COLOR_MATERIAL
+        glColor4fv(helper.lastColor);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// delete VAO and VBO
+///////////////////////////////////////////////////////////////////////////////
+void HelperCache::release(Helper& helper)
+{
+    if(helper.vaoId)
+        glDeleteVertexArrays(1, &helper.vaoId);
+    if(helper.vboId)
+        glDeleteBuffersARB(1, &helper.vboId);
+    helper.vboId = helper.vaoId = 0;
+    std::vector<float>().swap(helper.vertices);
+    helper.ranges.clear();
+}
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+// HelperCache.h
+// =============
+// GPU cache for the helper lines of the scene (grid, axis and frustum)
+// Each helper is built once into a vertex buffer of position(3) + color(4)
+// and a list of primitive ranges (lines, line loops, points, triangles), then
+// reused for all frames and viewports. A helper is keyed by its parameters
+// (size, step, FOV...), so it is rebuilt only when they are changed. The cache
+// keeps up to MAX_HELPER_COUNT helpers, and the least recently drawn one is
+// released when a new one is built.
+// The caller sets the transform and the states (lighting, depth, blending);
+// the line width and the point size are set per range.
+// Same as MeshCache, it is drawn with the fixed client arrays, or with a VAO
+// of generic attributes for the core-profile path, and from system memory if
+// GL_ARB_vertex_buffer_object is not available.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef HELPER_CACHE_H
+#define HELPER_CACHE_H
+
+#ifdef _WIN32
+#include <windows.h>    // include windows.h to avoid thousands of compile errors even though this class is not depending on Windows
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <vector>
+
+// helper ids of cached helpers
+enum HelperShape
+{
+    HELPER_GRID = 0,
+    HELPER_AXIS,
+    HELPER_FRUSTUM
+};
+
+class HelperCache
+{
+public:
+    static const unsigned int MAX_HELPER_COUNT = 16;
+
+
+    HelperCache();
+    ~HelperCache() {}
+
+    void init();                                    // check VBO support, OpenGL RC must be set
+    void clear();                                   // delete all helpers and GL buffers
+
+    // use generic attributes (MESH_ATTRIB_POSITION, MESH_ATTRIB_COLOR) in VAOs
+    // instead of the fixed client arrays, the cached helpers are rebuilt
+    void setGenericAttributes(bool enabled);
+    bool hasGenericAttributes() const       { return genericAttributes; }
+
+    // draw the cached helper with the current transform, one draw call per range
+    void drawGrid(float size, float step);          // on xz plane, with x and z axes
+    void drawAxis(float size);                      // xyz lines with arrows(big square dots)
+    void drawFrustum(float fovY, float aspectRatio, float nearPlane, float farPlane);
+
+    // stats
+    unsigned int getHelperCount() const     { return (unsigned int)helpers.size(); }
+    unsigned int getBuildCount() const      { return buildCount; }
+
+private:
+    // a draw call in the vertex buffer
+    struct Range
+    {
+        GLenum mode;                        // GL_LINES, GL_LINE_LOOP, GL_POINTS or GL_TRIANGLES
+        int first;
+        int count;
+        float size;                         // line width or point size
+    };
+
+    struct Helper
+    {
+        int shape;
+        float params[4];                    // parameters it was built with
+        GLuint vboId;                       // 0 if vertices are in system memory
+        GLuint vaoId;                       // 0 if no generic attributes
+        std::vector<float> vertices;        // interleaved V/C, empty after uploaded to VBO
+        std::vector<Range> ranges;
+        float lastColor[4];                 // color of the last vertex
+        unsigned int lastUsed;              // useCount when it was last drawn, for LRU
+    };
+
+    Helper& prepare(int shape, const float params[4]);  // find or build
+    static void addVertex(Helper& helper, float x, float y, float z, const float color[4]);
+    static void addRange(Helper& helper, GLenum mode, int count, float size=1); // last count vertices
+    void buildGrid(Helper& helper);
+    void buildAxis(Helper& helper);
+    void buildFrustum(Helper& helper);
+    void upload(Helper& helper);
+    void draw(const Helper& helper);
+    void release(Helper& helper);
+
+    std::vector<Helper> helpers;            // a few per scene, searched linearly
+    unsigned int useCount;                  // incremented by prepare()
+    bool vboSupported;
+    bool vaoSupported;
+    bool genericAttributes;
+    unsigned int buildCount;
+};
+
+#endif
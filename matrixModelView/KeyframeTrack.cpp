@@ -0,0 +1,174 @@
+///////////////////////////////////////////////////////////////////////////////
+// KeyframeTrack.cpp
+// =================
+// rigid transform animation sampled at any time
+// See KeyframeTrack.h for the interpolation.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include "KeyframeTrack.h"
+
+// compare the time of keys for binary search
+static bool isEarlier(float time, const Keyframe& key)
+{
+    return time < key.time;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+KeyframeTrack::KeyframeTrack() : loop(false)
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add a key, after the keys at the same time
+///////////////////////////////////////////////////////////////////////////////
+void KeyframeTrack::addKey(float time, const Quaternion& rotation, const Vector3& position)
+{
+    Keyframe key;
+    key.time = time;
+    key.rotation = rotation;
+    key.rotation.normalize();
+    key.position = position;
+
+    std::vector<Keyframe>::iterator it = std::upper_bound(keys.begin(), keys.end(), time, isEarlier);
+    keys.insert(it, key);
+}
+
+void KeyframeTrack::addKey(float time, float ax, float ay, float az, float x, float y, float z)
+{
+    addKey(time, Quaternion::fromEuler(ax, ay, az), Vector3(x, y, z));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the time between the first and last keys
+///////////////////////////////////////////////////////////////////////////////
+float KeyframeTrack::getDuration() const
+{
+    if (keys.empty())
+        return 0;
+    return keys.back().time - keys.front().time;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// sample the rotation, slerp between 2 keys
+///////////////////////////////////////////////////////////////////////////////
+Quaternion KeyframeTrack::getRotation(float time) const
+{
+    if (keys.empty())
+        return Quaternion();
+
+    float t;
+    int index = findSegment(time, t);
+    if (t <= 0)
+        return keys[index].rotation;
+    return Quaternion::slerp(keys[index].rotation, keys[index + 1].rotation, t);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// sample the position, lerp between 2 keys
+///////////////////////////////////////////////////////////////////////////////
+Vector3 KeyframeTrack::getPosition(float time) const
+{
+    if (keys.empty())
+        return Vector3(0, 0, 0);
+
+    float t;
+    int index = findSegment(time, t);
+    if (t <= 0)
+        return keys[index].position;
+    const Vector3& p0 = keys[index].position;
+    const Vector3& p1 = keys[index + 1].position;
+    return p0 + (p1 - p0) * t;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// sample the transform matrix, T * R
+// the segment is searched once for both rotation and position
+///////////////////////////////////////////////////////////////////////////////
+Matrix4 KeyframeTrack::getMatrix(float time) const
+{
+    if (keys.empty())
+        return Matrix4();
+
+    float t;
+    int index = findSegment(time, t);
+    if (t <= 0)
+        return keys[index].rotation.getMatrix(keys[index].position);
+
+    const Keyframe& k0 = keys[index];
+    const Keyframe& k1 = keys[index + 1];
+    Quaternion rotation = Quaternion::slerp(k0.rotation, k1.rotation, t);
+    return rotation.getMatrix(k0.position + (k1.position - k0.position) * t);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// sample the transform as dual quaternion, e.g. for blending with other tracks
+///////////////////////////////////////////////////////////////////////////////
+DualQuaternion KeyframeTrack::getDualQuaternion(float time) const
+{
+    if (keys.empty())
+        return DualQuaternion();
+
+    float t;
+    int index = findSegment(time, t);
+    if (t <= 0)
+        return DualQuaternion(keys[index].rotation, keys[index].position);
+
+    const Keyframe& k0 = keys[index];
+    const Keyframe& k1 = keys[index + 1];
+    return DualQuaternion(Quaternion::slerp(k0.rotation, k1.rotation, t),
+                          k0.position + (k1.position - k0.position) * t);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// find the segment [index, index+1] containing the time
+// t is the blend factor in the segment, 0 if the time is on a key or out of
+// the range (non-loop), so the caller uses keys[index] only.
+///////////////////////////////////////////////////////////////////////////////
+int KeyframeTrack::findSegment(float time, float& t) const
+{
+    t = 0;
+    int lastIndex = (int)keys.size() - 1;
+    float startTime = keys.front().time;
+    float duration = keys.back().time - startTime;
+
+    if (loop && duration > 0)
+    {
+        // floor() instead of fmod(), which is slow for a large time
+        float elapsed = time - startTime;
+        time = startTime + elapsed - duration * floorf(elapsed / duration);
+    }
+
+    if (time <= startTime)
+        return 0;
+    if (time >= keys.back().time)
+        return lastIndex;
+
+    // first key after the time, there is always one before it
+    int next = (int)(std::upper_bound(keys.begin(), keys.end(), time, isEarlier) - keys.begin());
+    const Keyframe& k0 = keys[next - 1];
+    const Keyframe& k1 = keys[next];
+    float span = k1.time - k0.time;
+    if (span > 0)
+        t = (time - k0.time) / span;
+    return next - 1;
+}
@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////
+// KeyframeTrack.h
+// ===============
+// rigid transform animation sampled at any time
+// Each key has a rotation (quaternion) and a position. A sample between 2 keys
+// is slerp of the rotations and lerp of the positions, so the motion depends
+// on the elapsed time only, not on the frame rate, and the rotation never
+// gimbal-locks. getMatrix() builds T * R directly from the quaternion without
+// Euler angles.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef KEYFRAME_TRACK_H
+#define KEYFRAME_TRACK_H
+
+#include <vector>
+#include "Matrices.h"
+
+struct Keyframe
+{
+    float time;                 // seconds
+    Quaternion rotation;        // unit quaternion
+    Vector3 position;
+};
+
+class KeyframeTrack
+{
+public:
+    KeyframeTrack();
+
+    // keys are kept sorted by time
+    void addKey(float time, const Quaternion& rotation, const Vector3& position);
+    void addKey(float time, float ax, float ay, float az,   // Euler angles in degree, same order as ModelGL
+                float x, float y, float z);
+    void clear()                                    { keys.clear(); }
+
+    // loop: the time wraps around the duration, otherwise clamped to the end keys
+    void setLoop(bool loop)                         { this->loop = loop; }
+    bool getLoop() const                            { return loop; }
+
+    int getKeyCount() const                         { return (int)keys.size(); }
+    const Keyframe& getKey(int index) const         { return keys[index]; }
+    float getDuration() const;                      // time between the first and last keys
+
+    // sample at the given time in seconds, identity if no key
+    Quaternion getRotation(float time) const;
+    Vector3 getPosition(float time) const;
+    Matrix4 getMatrix(float time) const;            // T * R
+    DualQuaternion getDualQuaternion(float time) const;
+
+private:
+    int findSegment(float time, float& t) const;    // first key of the segment and the blend factor 0~1
+
+    std::vector<Keyframe> keys;
+    bool loop;
+};
+
+#endif
@@ -1,9 +1,10 @@
+#include <chrono>
 #include <cstdarg>
+#include <cstdlib>
 #include <cwchar>
 #include <sstream>
 #include <iomanip>
 #include "Log.h"                       // for log dialog resource
-#include "wcharUtil.h"
 using namespace Win;
 
 #define IDD_LOG                         201
@@ -22,26 +23,49 @@ using namespace Win;
 #endif
 
 const char* LOG_FILE = "log.txt";
+const size_t LOG_QUEUE_SIZE = 256;              // messages queued between drains
+const int LOG_DRAIN_INTERVAL = 10;              // ms
+const UINT LOG_DIALOG_TIMEOUT = 500;            // ms to wait for the list box, only the log thread waits
+const int LOG_TIME_LENGTH = 16;                 // "hh:mm:ss"
 
 BOOL CALLBACK logDialogProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// return current time as FILETIME in a 64-bit integer, cheap enough for every
+// message (no conversion to local time here)
+///////////////////////////////////////////////////////////////////////////////
+static int64_t getTimeStamp()
+{
+    FILETIME fileTime;
+    ::GetSystemTimeAsFileTime(&fileTime);
+    return ((int64_t)fileTime.dwHighDateTime << 32) | fileTime.dwLowDateTime;
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // constructor
 ///////////////////////////////////////////////////////////////////////////////
-Log::Log() : logMode(LOG_MODE_FILE), dialogHandle(0), listHandle(0)
+Log::Log() : queue(LOG_QUEUE_SIZE), stopping(false), logMode(LOG_MODE_FILE), reportedDropCount(0),
+             dialogHandle(0), listHandle(0)
 {
     // open log file
     logFile.open(LOG_FILE, std::ios::out);
-    if (logFile.fail())
-        return;
-
-    // first put starting date and time
-    logFile << L"===== Log started at "
-        << getDate() << L", "
-        << getTime() << L". =====\n\n"
-        << std::flush;
+    if (!logFile.fail())
+    {
+        // first put starting date and time
+        wchar_t time[LOG_TIME_LENGTH];
+        formatTime(getTimeStamp(), time, LOG_TIME_LENGTH);
+        logFile << L"===== Log started at "
+            << getDate() << L", "
+            << time << L". =====\n\n"
+            << std::flush;
+    }
+
+    // start log thread
+    thread = std::thread(&Log::run, this);
 }
 
 
@@ -51,6 +75,16 @@ Log::Log() : logMode(LOG_MODE_FILE), dialogHandle(0), listHandle(0)
 ///////////////////////////////////////////////////////////////////////////////
 Log::~Log()
 {
+    // detach the dialog first, its list box belongs to this (blocked) thread,
+    // so the last drain writes the remaining messages to the file only
+    listHandle = 0;
+    logMode = LOG_MODE_FILE;
+
+    // write the remaining messages, then stop log thread
+    stopping = true;
+    if (thread.joinable())
+        thread.join();
+
     // close opened file
     logFile << L"\n\n===== END OF LOG =====\n";
     logFile.close();
@@ -78,33 +112,113 @@ Log& Log::getInstance()
 
 ///////////////////////////////////////////////////////////////////////////////
 // add message to log
+// It only copies the message to the queue, the log thread writes it later.
+// If the queue is full, the message is dropped and counted.
 ///////////////////////////////////////////////////////////////////////////////
-void Log::put(const std::wstring& message)
+void Log::put(const wchar_t* message)
 {
-    if (logMode != LOG_MODE_FILE)
+    queue.push(message, getTimeStamp());
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// log thread, drain the queue periodically until stopped
+///////////////////////////////////////////////////////////////////////////////
+void Log::run()
+{
+    while (!stopping)
     {
-        std::wstring str;
-        str = getTime() + L": " + message;
-        //long index = ::SendMessage(listHandle, LB_ADDSTRING, 0, (LPARAM)str.c_str());
-        //::SendMessage(listHandle, LB_SETTOPINDEX, index, 0);  // set focus to current line
-
-        // SendMessage() in worker thread may cause deadlock, use SendMessageTimeOut() instead
-        long index;
-        LRESULT result = ::SendMessageTimeout(listHandle, LB_ADDSTRING, 0, (LPARAM)str.c_str(), SMTO_NORMAL | SMTO_ABORTIFHUNG, 500, (PDWORD_PTR)&index);
-        if (result) // non-zero means succeeded
-            ::SendMessageTimeout(listHandle, LB_SETTOPINDEX, index, 0, SMTO_NORMAL, 500, 0);  // set focus to current line
+        // sleep only if the queue was not full, to batch more messages
+        if (drain() < (int)queue.getCapacity())
+            std::this_thread::sleep_for(std::chrono::milliseconds(LOG_DRAIN_INTERVAL));
     }
+    drain();    // messages logged before stopping
+}
+
 
-    if (logMode != LOG_MODE_DIALOG)
+
+///////////////////////////////////////////////////////////////////////////////
+// write all queued messages to the file with a single write and flush, and to
+// the list box with a single redraw
+// It returns the number of messages written.
+///////////////////////////////////////////////////////////////////////////////
+int Log::drain()
+{
+    int mode = logMode;
+    HWND list = listHandle;
+    bool toFile = (mode != LOG_MODE_DIALOG);
+    bool toDialog = (mode != LOG_MODE_FILE) && list;
+
+    int count = 0;
+    bool timedOut = false;                  // list box did not respond, stop sending
+    LRESULT index = LB_ERR;
+    wchar_t time[LOG_TIME_LENGTH];
+    wchar_t line[LOG_TIME_LENGTH + LOG_RECORD_LENGTH];
+    auto write = [&](const wchar_t* text, int length)
     {
-        // put time first and append message
-        logFile << getTime() << L"  "
-            << message
-            << L"\n"
-            << std::flush;
+        if (toFile)
+        {
+            fileBuffer += time;
+            fileBuffer += L"  ";
+            fileBuffer.append(text, length);
+            fileBuffer += L'\n';
+        }
+        if (toDialog)
+        {
+            // stop redrawing the list box until all lines are added
+            if (count == 0)
+                ::SendMessageTimeout(list, WM_SETREDRAW, FALSE, 0, SMTO_NORMAL | SMTO_ABORTIFHUNG, LOG_DIALOG_TIMEOUT, 0);
+            _snwprintf(line, LOG_TIME_LENGTH + LOG_RECORD_LENGTH, L"%s: %s", time, text);
+            line[LOG_TIME_LENGTH + LOG_RECORD_LENGTH - 1] = L'\0';
+            // skip the rest of this drain if the dialog thread does not respond
+            if (!timedOut &&
+                !::SendMessageTimeout(list, LB_ADDSTRING, 0, (LPARAM)line, SMTO_NORMAL | SMTO_ABORTIFHUNG, LOG_DIALOG_TIMEOUT, (PDWORD_PTR)&index))
+                timedOut = true;
+        }
+        ++count;
+    };
+
+    // report the messages dropped since the last drain
+    uint64_t dropCount = queue.getDropCount();
+    if (dropCount != reportedDropCount)
+    {
+        wchar_t message[128];
+        _snwprintf(message, 128, L"[WARNING] %llu log messages are dropped, the log queue is full.",
+                   (unsigned long long)(dropCount - reportedDropCount));
+        message[127] = L'\0';
+        reportedDropCount = dropCount;
+        formatTime(getTimeStamp(), time, LOG_TIME_LENGTH);
+        write(message, (int)wcslen(message));
     }
-}
 
+    // no more than the capacity at once, the producers may keep pushing
+    const LogRecord* record;
+    while (count < (int)queue.getCapacity() && (record = queue.peek()) != 0)
+    {
+        formatTime(record->time, time, LOG_TIME_LENGTH);
+        write(record->text, record->length);
+        queue.pop();
+    }
+
+    if (count == 0)
+        return 0;
+
+    if (toFile && !fileBuffer.empty())
+    {
+        logFile.write(fileBuffer.data(), fileBuffer.size());
+        logFile.flush();
+        fileBuffer.clear();                         // keep the capacity
+    }
+    if (toDialog)
+    {
+        ::SendMessageTimeout(list, WM_SETREDRAW, TRUE, 0, SMTO_NORMAL | SMTO_ABORTIFHUNG, LOG_DIALOG_TIMEOUT, 0);
+        if (index != LB_ERR && !timedOut)
+            ::SendMessageTimeout(list, LB_SETTOPINDEX, index, 0, SMTO_NORMAL, LOG_DIALOG_TIMEOUT, 0);  // set focus to current line
+        ::InvalidateRect(list, 0, TRUE);
+    }
+    return count;
+}
 
 
 
@@ -129,21 +243,19 @@ const std::wstring Log::getDate()
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// get system time as a string
+// convert the timestamp (FILETIME) to local time as "h:mm:ss"
 ///////////////////////////////////////////////////////////////////////////////
-const std::wstring Log::getTime()
+void Log::formatTime(int64_t time, wchar_t* buffer, int size)
 {
-    std::wstringstream wss;
+    FILETIME utcTime, localTime;
+    utcTime.dwLowDateTime = (DWORD)(time & 0xffffffff);
+    utcTime.dwHighDateTime = (DWORD)(time >> 32);
+    ::FileTimeToLocalFileTime(&utcTime, &localTime);
 
     SYSTEMTIME sysTime;
-    ::GetLocalTime(&sysTime);
-
-    wss << std::setfill(L'0');
-    wss << sysTime.wHour << L":" << std::setw(2)
-        << sysTime.wMinute << L":" << std::setw(2)
-        << sysTime.wSecond;
-
-    return wss.str();
+    ::FileTimeToSystemTime(&localTime, &sysTime);
+    _snwprintf(buffer, size, L"%d:%02d:%02d", sysTime.wHour, sysTime.wMinute, sysTime.wSecond);
+    buffer[size - 1] = L'\0';
 }
 
 
@@ -156,15 +268,9 @@ void Log::setMode(int mode)
     if (mode > LOG_MODE_BOTH) return;                // invalid mode number
 
     if (logMode == LOG_MODE_FILE && mode == LOG_MODE_DIALOG)
-    {
-        logFile << getTime() << L"  "
-            << L"Redirect log to dialog box.\n"
-            << std::flush;
-    }
-
-    logMode = mode;
+        put(L"Redirect log to dialog box.");
 
-    if (logMode != LOG_MODE_FILE)                    // to dialog
+    if (mode != LOG_MODE_FILE)                       // to dialog
     {
         if (!dialogHandle)
         {
@@ -176,11 +282,12 @@ void Log::setMode(int mode)
             ::ShowWindow(dialogHandle, SW_SHOW);
             ::UpdateWindow(dialogHandle);
 
-            // store handle to listbox
-            listHandle = ::GetDlgItem(dialogHandle, IDC_LIST_LOG);
+            // get handle to listbox, the log thread uses it after the mode is set
+            HWND list = ::GetDlgItem(dialogHandle, IDC_LIST_LOG);
 
             // set horizontal extent to display the horizontal scroll bar in the listbox
-            ::SendMessage(listHandle, LB_SETHORIZONTALEXTENT, 1000, 0);
+            ::SendMessage(list, LB_SETHORIZONTALEXTENT, 1000, 0);
+            listHandle = list;
 
             // positioning the dialog at the bottom of screen
             RECT rect1, rect2;
@@ -202,12 +309,15 @@ void Log::setMode(int mode)
         if (dialogHandle)
             ::ShowWindow(dialogHandle, SW_MINIMIZE);
     }
+
+    logMode = mode;
 }
 
 
 
 ///////////////////////////////////////////////////////////////////////////////
 // C-style printf fuction
+// The message is formatted and converted on the stack, no allocation.
 ///////////////////////////////////////////////////////////////////////////////
 void Win::log(const wchar_t* format, ...)
 {
@@ -218,6 +328,7 @@ void Win::log(const wchar_t* format, ...)
     va_start(valist, format);
     _vsnwprintf(buffer, LOG_MAX_STRING, format, valist);
     va_end(valist);
+    buffer[LOG_MAX_STRING - 1] = L'\0';             // not terminated if truncated
 
     Log::getInstance().put(buffer);
 }
@@ -233,8 +344,16 @@ void Win::log(const char* format, ...)
     va_start(valist, format);
     _vsnprintf(buffer, LOG_MAX_STRING, format, valist);
     va_end(valist);
+    buffer[LOG_MAX_STRING - 1] = '\0';
+
+    // convert to wide char here, toWchar() shares static buffers among threads
+    wchar_t wideBuffer[LOG_MAX_STRING];
+    size_t length = mbstowcs(wideBuffer, buffer, LOG_MAX_STRING - 1);
+    if (length == (size_t)-1)
+        length = 0;
+    wideBuffer[length] = L'\0';
 
-    Log::getInstance().put(toWchar(buffer));
+    Log::getInstance().put(wideBuffer);
 }
 
 
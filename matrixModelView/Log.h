@@ -2,9 +2,12 @@
 #ifndef WIN_LOG_H
 #define WIN_LOG_H
 
+#include <atomic>
 #include <string>
 #include <fstream>
+#include <thread>
 #include <windows.h>
+#include "LogQueue.h"
 
 namespace Win
 {
@@ -13,6 +16,8 @@ namespace Win
 
     // Clients are actually use this functions to send log messages.
     // USAGE: Win::log("I am the number %d.", 1);
+    // They are safe to call from any thread, and never block: the message is
+    // formatted on the stack and queued, then written by the log thread.
     void log(const std::wstring& str);
     void log(const wchar_t* format, ...);
     void log(const char* format, ...);
@@ -21,6 +26,11 @@ namespace Win
 
 
     // singleton class ////////////////////////////////////////////////////////
+    // The messages are queued in a lock-free ring buffer (LogQueue). A
+    // background thread drains it every LOG_DRAIN_INTERVAL ms: it writes all
+    // queued lines to the file at once, and adds them to the list box of the
+    // dialog with a single redraw. If the queue is full, the messages are
+    // dropped, and the count is logged by the next drain.
     class Log
     {
     public:
@@ -29,19 +39,28 @@ namespace Win
         static Log& getInstance();              // return reference to this class object
 
         void setMode(int mode);                 // set log target: file or dialog
-        void put(const std::wstring& str);      // print log message
+        void put(const wchar_t* str);           // queue log message, never blocks
+        void put(const std::wstring& str)       { put(str.c_str()); }
+        uint64_t getDropCount() const           { return queue.getDropCount(); }
 
     private:
         Log();                                  // hide it here to prevent instantiating this class
         Log(const Log& rhs);                    // must no body for copy ctor, so this class cannot have copy ctor
 
-        const std::wstring getTime();           // return system time as string
+        void run();                             // log thread
+        int drain();                            // write the queued messages, return # of messages
+        void formatTime(int64_t time, wchar_t* buffer, int size);   // FILETIME to "hh:mm:ss" local time
         const std::wstring getDate();           // return system date as string
 
-        int logMode;                            // file, dialog or both
-        std::wofstream logFile;                 // log file handle
+        LogQueue queue;
+        std::thread thread;
+        std::atomic<bool> stopping;
+        std::atomic<int> logMode;               // file, dialog or both
+        std::wofstream logFile;                 // log file handle, written by the log thread only
+        std::wstring fileBuffer;                // lines of a drain
+        uint64_t reportedDropCount;
         HWND dialogHandle;                      // handle to dialog window
-        HWND listHandle;                        // handle to listbox
+        std::atomic<HWND> listHandle;           // handle to listbox
     };
     ///////////////////////////////////////////////////////////////////////////
 }
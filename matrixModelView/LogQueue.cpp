@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////
+// LogQueue.cpp
+// ============
+// bounded multi-producer single-consumer queue of log messages
+// Each slot has a sequence number: a producer may write the slot at position
+// p only if its sequence is p, then sets it to p + 1 for the consumer. The
+// consumer sets it to p + capacity when it is done, for the producer of the
+// next round.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LogQueue.h"
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor/dtor, all slots are allocated once
+///////////////////////////////////////////////////////////////////////////////
+LogQueue::LogQueue(size_t capacity) : slots(0), mask(0), enqueuePosition(0), dequeuePosition(0), dropCount(0)
+{
+    size_t size = 2;
+    while(size < capacity)
+        size <<= 1;
+    mask = size - 1;
+
+    slots = new Slot[size];
+    for(size_t i = 0; i < size; ++i)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+LogQueue::~LogQueue()
+{
+    delete [] slots;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// claim the next slot, copy the text and publish it
+///////////////////////////////////////////////////////////////////////////////
+bool LogQueue::push(const wchar_t* text, int64_t time)
+{
+    Slot* slot;
+    size_t position = enqueuePosition.load(std::memory_order_relaxed);
+    while(true)
+    {
+        slot = &slots[position & mask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+        if(diff == 0)
+        {
+            // free slot, take it unless another producer did
+            if(enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if(diff < 0)
+        {
+            // the consumer has not released the slot of the previous round
+            dropCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    LogRecord& record = slot->record;
+    record.time = time;
+    int length = 0;
+    while(length < LOG_RECORD_LENGTH - 1 && text[length])
+    {
+        record.text[length] = text[length];
+        ++length;
+    }
+    record.text[length] = L'\0';
+    record.length = length;
+
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the oldest published record, or 0 if there is none
+///////////////////////////////////////////////////////////////////////////////
+const LogRecord* LogQueue::peek() const
+{
+    const Slot& slot = slots[dequeuePosition & mask];
+    if(slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+        return 0;
+    return &slot.record;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// release the record returned by peek() to the producers
+///////////////////////////////////////////////////////////////////////////////
+void LogQueue::pop()
+{
+    Slot& slot = slots[dequeuePosition & mask];
+    slot.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+    ++dequeuePosition;
+}
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// LogQueue.h
+// ==========
+// bounded multi-producer single-consumer queue of log messages
+// Any thread pushes a message without lock or allocation: it claims the next
+// slot with a single compare-and-swap, copies the text into the slot, then
+// publishes it by the sequence number of the slot. If the queue is full, the
+// message is dropped and counted instead of blocking the producer.
+// A single consumer thread peeks the oldest record in place, writes it out,
+// then pops it to give the slot back to the producers.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef LOG_QUEUE_H
+#define LOG_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+const int LOG_RECORD_LENGTH = 1024;         // max chars per message incl. null, longer is truncated
+
+struct LogRecord
+{
+    int64_t time;                           // timestamp from the producer
+    int length;                             // # of chars without null
+    wchar_t text[LOG_RECORD_LENGTH];
+};
+
+class LogQueue
+{
+public:
+    explicit LogQueue(size_t capacity=256); // rounded up to power of 2
+    ~LogQueue();
+
+    // producers: copy the message to a free slot, false if full (dropped)
+    bool push(const wchar_t* text, int64_t time);
+
+    // consumer: the oldest record or 0 if empty, valid until pop()
+    const LogRecord* peek() const;
+    void pop();
+
+    size_t getCapacity() const              { return mask + 1; }
+    uint64_t getDropCount() const           { return dropCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;       // == position if free, position + 1 if published
+        LogRecord record;
+    };
+
+    LogQueue(const LogQueue& rhs);          // no copy
+
+    Slot* slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePosition;   // separate cache lines for producers and consumer
+    alignas(64) size_t dequeuePosition;
+    alignas(64) std::atomic<uint64_t> dropCount;
+};
+
+#endif
@@ -1,10 +1,13 @@
 #include <cmath>
 #include <algorithm>
+#include <thread>
+#include <vector>
 #include "Matrices.h"
 
 const float DEG2RAD = 3.141593f / 180.0f;
 const float RAD2DEG = 180.0f / 3.141593f;
 const float EPSILON = 0.00001f;
+const int BATCH_MIN_PER_THREAD = 16384;     // less than it is not worth a thread
 
 
 
@@ -305,6 +308,69 @@ Matrix4& Matrix4::invertEuclidean()
 //  [ 0 | 1 ]     [  0   +     1     ]
 ///////////////////////////////////////////////////////////////////////////////
 Matrix4& Matrix4::invertAffine()
+{
+#ifdef MATRICES_SIMD
+    // columns of R, the 4th component is 0 for affine matrix
+    __m128 a = _mm_loadu_ps(&m[0]);
+    __m128 b = _mm_loadu_ps(&m[4]);
+    __m128 c = _mm_loadu_ps(&m[8]);
+
+    // rows of adj(R) are the cross products of columns: bxc, cxa, axb
+    __m128 a1 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)); // (y,z,x)
+    __m128 b1 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 c1 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 r0 = _mm_sub_ps(_mm_mul_ps(b, c1), _mm_mul_ps(b1, c));
+    __m128 r1 = _mm_sub_ps(_mm_mul_ps(c, a1), _mm_mul_ps(c1, a));
+    __m128 r2 = _mm_sub_ps(_mm_mul_ps(a, b1), _mm_mul_ps(a1, b));
+    r0 = _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(3, 0, 2, 1));
+    r1 = _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(3, 0, 2, 1));
+    r2 = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 0, 2, 1));
+
+    // det(R) = a . (b x c)
+    __m128 d = _mm_mul_ps(a, r0);
+    d = _mm_add_ss(_mm_add_ss(d, _mm_shuffle_ps(d, d, 1)), _mm_shuffle_ps(d, d, 2));
+    float determinant = _mm_cvtss_f32(d);
+    if (fabs(determinant) <= EPSILON)
+    {
+        // same as Matrix3::invert(), R^-1 becomes identity
+        r0 = _mm_setr_ps(1, 0, 0, 0);
+        r1 = _mm_setr_ps(0, 1, 0, 0);
+        r2 = _mm_setr_ps(0, 0, 1, 0);
+    }
+    else
+    {
+        __m128 invDeterminant = _mm_set1_ps(1.0f / determinant);
+        r0 = _mm_mul_ps(r0, invDeterminant);
+        r1 = _mm_mul_ps(r1, invDeterminant);
+        r2 = _mm_mul_ps(r2, invDeterminant);
+    }
+
+    // transpose rows of R^-1 to columns, the 4th row becomes (0,0,0,1)
+    __m128 r3 = _mm_setr_ps(0, 0, 0, 1);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    // -R^-1 * T
+    __m128 t = _mm_mul_ps(r0, _mm_set1_ps(m[12]));
+    t = simdMulAdd(r1, _mm_set1_ps(m[13]), t);
+    t = simdMulAdd(r2, _mm_set1_ps(m[14]), t);
+    t = _mm_sub_ps(r3, t);                      // w = 1 - 0
+
+    _mm_storeu_ps(&m[0], r0);
+    _mm_storeu_ps(&m[4], r1);
+    _mm_storeu_ps(&m[8], r2);
+    _mm_storeu_ps(&m[12], t);
+    return *this;
+#else
+    return invertAffineScalar();
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// scalar path of invertAffine()
+///////////////////////////////////////////////////////////////////////////////
+Matrix4& Matrix4::invertAffineScalar()
 {
     // R^-1
     Matrix3 r(m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10]);
@@ -404,6 +470,104 @@ Matrix4& Matrix4::invertProjective()
 // M^-1 = adj(M) / det(M)
 ///////////////////////////////////////////////////////////////////////////////
 Matrix4& Matrix4::invertGeneral()
+{
+#ifdef MATRICES_SIMD
+    // Cramer's Rule with SSE (Intel AP-928, "Streaming SIMD Extensions -
+    // Inverse of 4x4 Matrix"). It transposes M while loading, and the cofactors
+    // are computed 4 at once, so adj(M) is stored in the same column-major order.
+    __m128 minor0, minor1, minor2, minor3;
+    __m128 row0, row1, row2, row3;
+    __m128 det, tmp1;
+
+    tmp1 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(m)), (const __m64*)(m + 4));
+    row1 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(m + 8)), (const __m64*)(m + 12));
+    row0 = _mm_shuffle_ps(tmp1, row1, 0x88);
+    row1 = _mm_shuffle_ps(row1, tmp1, 0xDD);
+    tmp1 = _mm_loadh_pi(_mm_loadl_pi(tmp1, (const __m64*)(m + 2)), (const __m64*)(m + 6));
+    row3 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(m + 10)), (const __m64*)(m + 14));
+    row2 = _mm_shuffle_ps(tmp1, row3, 0x88);
+    row3 = _mm_shuffle_ps(row3, tmp1, 0xDD);
+
+    tmp1 = _mm_mul_ps(row2, row3);
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+    minor0 = _mm_mul_ps(row1, tmp1);
+    minor1 = _mm_mul_ps(row0, tmp1);
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+    minor0 = _mm_sub_ps(_mm_mul_ps(row1, tmp1), minor0);
+    minor1 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor1);
+    minor1 = _mm_shuffle_ps(minor1, minor1, 0x4E);
+
+    tmp1 = _mm_mul_ps(row1, row2);
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+    minor0 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor0);
+    minor3 = _mm_mul_ps(row0, tmp1);
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+    minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row3, tmp1));
+    minor3 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor3);
+    minor3 = _mm_shuffle_ps(minor3, minor3, 0x4E);
+
+    tmp1 = _mm_mul_ps(_mm_shuffle_ps(row1, row1, 0x4E), row3);
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+    row2 = _mm_shuffle_ps(row2, row2, 0x4E);
+    minor0 = _mm_add_ps(_mm_mul_ps(row2, tmp1), minor0);
+    minor2 = _mm_mul_ps(row0, tmp1);
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+    minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row2, tmp1));
+    minor2 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor2);
+    minor2 = _mm_shuffle_ps(minor2, minor2, 0x4E);
+
+    tmp1 = _mm_mul_ps(row0, row1);
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+    minor2 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor2);
+    minor3 = _mm_sub_ps(_mm_mul_ps(row2, tmp1), minor3);
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+    minor2 = _mm_sub_ps(_mm_mul_ps(row3, tmp1), minor2);
+    minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row2, tmp1));
+
+    tmp1 = _mm_mul_ps(row0, row3);
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+    minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row2, tmp1));
+    minor2 = _mm_add_ps(_mm_mul_ps(row1, tmp1), minor2);
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+    minor1 = _mm_add_ps(_mm_mul_ps(row2, tmp1), minor1);
+    minor2 = _mm_sub_ps(minor2, _mm_mul_ps(row1, tmp1));
+
+    tmp1 = _mm_mul_ps(row0, row2);
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+    minor1 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor1);
+    minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row1, tmp1));
+    tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+    minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row3, tmp1));
+    minor3 = _mm_add_ps(_mm_mul_ps(row1, tmp1), minor3);
+
+    // get determinant
+    det = _mm_mul_ps(row0, minor0);
+    det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
+    det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
+    float determinant = _mm_cvtss_f32(det);
+    if (fabs(determinant) <= EPSILON)
+    {
+        return identity();
+    }
+
+    // adj(M) / det(M)
+    det = _mm_set1_ps(1.0f / determinant);
+    _mm_storeu_ps(&m[0], _mm_mul_ps(det, minor0));
+    _mm_storeu_ps(&m[4], _mm_mul_ps(det, minor1));
+    _mm_storeu_ps(&m[8], _mm_mul_ps(det, minor2));
+    _mm_storeu_ps(&m[12], _mm_mul_ps(det, minor3));
+    return *this;
+#else
+    return invertGeneralScalar();
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// scalar path of invertGeneral()
+///////////////////////////////////////////////////////////////////////////////
+Matrix4& Matrix4::invertGeneralScalar()
 {
     // get cofactors of minor matrices
     float cofactor0 = getCofactor(m[5], m[6], m[7], m[9], m[10], m[11], m[13], m[14], m[15]);
@@ -639,6 +803,67 @@ Matrix4& Matrix4::rotateZ(float angle)
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// build Euler rotation and translation at once (angles in degree)
+// same as identity().rotateZ(az).rotateY(ay).rotateX(ax).translate(tx,ty,tz),
+// M = T * Rx * Ry * Rz, but sin/cos of each angle is computed once and the
+// final matrix is written directly without 3 matrix multiplications
+///////////////////////////////////////////////////////////////////////////////
+Matrix4 Matrix4::fromEulerTRS(float ax, float ay, float az, float tx, float ty, float tz)
+{
+    float cx = cosf(ax * DEG2RAD), sx = sinf(ax * DEG2RAD);
+    float cy = cosf(ay * DEG2RAD), sy = sinf(ay * DEG2RAD);
+    float cz = cosf(az * DEG2RAD), sz = sinf(az * DEG2RAD);
+    float sxsy = sx * sy;
+    float cxsy = cx * sy;
+
+    return Matrix4(cy * cz,                 // 1st column
+                   cx * sz + sxsy * cz,
+                   sx * sz - cxsy * cz,
+                   0,
+                   -cy * sz,                // 2nd column
+                   cx * cz - sxsy * sz,
+                   sx * cz + cxsy * sz,
+                   0,
+                   sy,                      // 3rd column
+                   -sx * cy,
+                   cx * cy,
+                   0,
+                   tx, ty, tz, 1);          // 4th column
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build translation and Euler rotation at once (angles in degree)
+// same as identity().translate(tx,ty,tz).rotateX(ax).rotateY(ay).rotateZ(az),
+// M = Rz * Ry * Rx * T, e.g. view matrix from the camera position and angles
+///////////////////////////////////////////////////////////////////////////////
+Matrix4 Matrix4::fromTranslateEuler(float tx, float ty, float tz, float ax, float ay, float az)
+{
+    float cx = cosf(ax * DEG2RAD), sx = sinf(ax * DEG2RAD);
+    float cy = cosf(ay * DEG2RAD), sy = sinf(ay * DEG2RAD);
+    float cz = cosf(az * DEG2RAD), sz = sinf(az * DEG2RAD);
+    float sysx = sy * sx;
+    float sycx = sy * cx;
+
+    // rotation part, row by row
+    float r00 = cz * cy,  r01 = cz * sysx - sz * cx,  r02 = cz * sycx + sz * sx;
+    float r10 = sz * cy,  r11 = sz * sysx + cz * cx,  r12 = sz * sycx - cz * sx;
+    float r20 = -sy,      r21 = cy * sx,              r22 = cy * cx;
+
+    // translation is rotated as well
+    return Matrix4(r00, r10, r20, 0,
+                   r01, r11, r21, 0,
+                   r02, r12, r22, 0,
+                   r00 * tx + r01 * ty + r02 * tz,
+                   r10 * tx + r11 * ty + r12 * tz,
+                   r20 * tx + r21 * ty + r22 * tz,
+                   1);
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // rotate matrix to face along the target direction
 // NOTE: This function will clear the previous rotation and scale info and
@@ -796,3 +1021,428 @@ Vector3 Matrix4::getAngle() const
 
     return Vector3(pitch, yaw, roll);
 }
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// transform SoA points, p' = M * (x,y,z,1)
+// SIMD transforms 4 points at once, the remaining points are done in scalar
+///////////////////////////////////////////////////////////////////////////////
+static void transformSoA(const float* m, const float* x, const float* y, const float* z,
+                         float* outX, float* outY, float* outZ, int count)
+{
+    int i = 0;
+#ifdef MATRICES_SIMD
+    __m128 m0 = _mm_set1_ps(m[0]), m4 = _mm_set1_ps(m[4]), m8 = _mm_set1_ps(m[8]), m12 = _mm_set1_ps(m[12]);
+    __m128 m1 = _mm_set1_ps(m[1]), m5 = _mm_set1_ps(m[5]), m9 = _mm_set1_ps(m[9]), m13 = _mm_set1_ps(m[13]);
+    __m128 m2 = _mm_set1_ps(m[2]), m6 = _mm_set1_ps(m[6]), m10 = _mm_set1_ps(m[10]), m14 = _mm_set1_ps(m[14]);
+    for (; i <= count - 4; i += 4)
+    {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vz = _mm_loadu_ps(z + i);
+        _mm_storeu_ps(outX + i, simdMulAdd(m0, vx, simdMulAdd(m4, vy, simdMulAdd(m8, vz, m12))));
+        _mm_storeu_ps(outY + i, simdMulAdd(m1, vx, simdMulAdd(m5, vy, simdMulAdd(m9, vz, m13))));
+        _mm_storeu_ps(outZ + i, simdMulAdd(m2, vx, simdMulAdd(m6, vy, simdMulAdd(m10, vz, m14))));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        float px = x[i];
+        float py = y[i];
+        float pz = z[i];
+        outX[i] = m[0] * px + m[4] * py + m[8] * pz + m[12];
+        outY[i] = m[1] * px + m[5] * py + m[9] * pz + m[13];
+        outZ[i] = m[2] * px + m[6] * py + m[10] * pz + m[14];
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// transform xyz of interleaved vertices, stride is # of bytes between vertices
+///////////////////////////////////////////////////////////////////////////////
+static void transformInterleaved(const float* m, const char* src, char* dst, int count, int stride)
+{
+#ifdef MATRICES_SIMD
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+#endif
+    for (int i = 0; i < count; ++i)
+    {
+        const float* p = (const float*)(src + (size_t)i * stride);
+        float* q = (float*)(dst + (size_t)i * stride);
+#ifdef MATRICES_SIMD
+        __m128 v = simdMulAdd(c0, _mm_set1_ps(p[0]),
+                   simdMulAdd(c1, _mm_set1_ps(p[1]),
+                   simdMulAdd(c2, _mm_set1_ps(p[2]), c3)));
+        _mm_storel_pi((__m64*)q, v);                // x, y
+        _mm_store_ss(q + 2, _mm_movehl_ps(v, v));   // z
+#else
+        float px = p[0];
+        float py = p[1];
+        float pz = p[2];
+        q[0] = m[0] * px + m[4] * py + m[8] * pz + m[12];
+        q[1] = m[1] * px + m[5] * py + m[9] * pz + m[13];
+        q[2] = m[2] * px + m[6] * py + m[10] * pz + m[14];
+#endif
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return # of points per thread for batch transform, multiple of 4
+// it returns count if it is not worth to split
+///////////////////////////////////////////////////////////////////////////////
+static int getBatchChunk(int count, int threadCount)
+{
+    if (threadCount <= 1 || count < BATCH_MIN_PER_THREAD * 2)
+        return count;
+
+    int chunk = (count + threadCount - 1) / threadCount;
+    if (chunk < BATCH_MIN_PER_THREAD)
+        chunk = BATCH_MIN_PER_THREAD;
+    return (chunk + 3) & ~3;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// batch transform of SoA points
+// The input is split into chunks, and the last chunk is done in the caller's
+// thread while the others are running on worker threads.
+///////////////////////////////////////////////////////////////////////////////
+void Matrix4::transform(const float* x, const float* y, const float* z,
+                        float* outX, float* outY, float* outZ,
+                        int count, int threadCount) const
+{
+    int chunk = getBatchChunk(count, threadCount);
+    std::vector<std::thread> threads;
+    int first = 0;
+    for (; first + chunk < count; first += chunk)
+    {
+        threads.push_back(std::thread(transformSoA, m, x + first, y + first, z + first,
+                                      outX + first, outY + first, outZ + first, chunk));
+    }
+    transformSoA(m, x + first, y + first, z + first, outX + first, outY + first, outZ + first, count - first);
+
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// batch transform of interleaved vertices
+// stride is # of bytes to the next vertex, e.g. Cylinder::getInterleavedStride()
+///////////////////////////////////////////////////////////////////////////////
+void Matrix4::transform(const float* src, float* dst, int count, int stride, int threadCount) const
+{
+    const char* srcBytes = (const char*)src;
+    char* dstBytes = (char*)dst;
+    size_t step;
+
+    int chunk = getBatchChunk(count, threadCount);
+    std::vector<std::thread> threads;
+    int first = 0;
+    for (; first + chunk < count; first += chunk)
+    {
+        step = (size_t)first * stride;
+        threads.push_back(std::thread(transformInterleaved, m, srcBytes + step, dstBytes + step, chunk, stride));
+    }
+    step = (size_t)first * stride;
+    transformInterleaved(m, srcBytes + step, dstBytes + step, count - first, stride);
+
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+}
+
+//=============================================================================
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build quaternion rotating angle(degree) around the axis
+///////////////////////////////////////////////////////////////////////////////
+Quaternion Quaternion::fromAxisAngle(const Vector3& axis, float angle)
+{
+    Vector3 v = axis;
+    v.normalize();
+    float halfAngle = 0.5f * angle * DEG2RAD;
+    float sine = sinf(halfAngle);
+    return Quaternion(cosf(halfAngle), v.x * sine, v.y * sine, v.z * sine);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build quaternion from Euler angles(degree), q = qx * qy * qz
+// same rotation as identity().rotateZ(az).rotateY(ay).rotateX(ax)
+///////////////////////////////////////////////////////////////////////////////
+Quaternion Quaternion::fromEuler(float ax, float ay, float az)
+{
+    float cx = cosf(0.5f * ax * DEG2RAD), sx = sinf(0.5f * ax * DEG2RAD);
+    float cy = cosf(0.5f * ay * DEG2RAD), sy = sinf(0.5f * ay * DEG2RAD);
+    float cz = cosf(0.5f * az * DEG2RAD), sz = sinf(0.5f * az * DEG2RAD);
+    float cxcy = cx * cy, sxsy = sx * sy;
+    float sxcy = sx * cy, cxsy = cx * sy;
+
+    return Quaternion(cxcy * cz - sxsy * sz,
+                      sxcy * cz + cxsy * sz,
+                      cxsy * cz - sxcy * sz,
+                      cxcy * sz + sxsy * cz);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build quaternion from rotation matrix
+// It takes the largest of s, x, y, z first to avoid dividing by a small value.
+///////////////////////////////////////////////////////////////////////////////
+Quaternion Quaternion::fromMatrix(const Matrix3& m)
+{
+    // m[col * 3 + row]
+    float r00 = m[0], r10 = m[1], r20 = m[2];
+    float r01 = m[3], r11 = m[4], r21 = m[5];
+    float r02 = m[6], r12 = m[7], r22 = m[8];
+    float trace = r00 + r11 + r22;
+    float t;
+
+    if (trace > 0)
+    {
+        t = 0.5f / sqrtf(trace + 1.0f);
+        return Quaternion(0.25f / t, (r21 - r12) * t, (r02 - r20) * t, (r10 - r01) * t);
+    }
+    else if (r00 > r11 && r00 > r22)
+    {
+        t = 0.5f / sqrtf(1.0f + r00 - r11 - r22);
+        return Quaternion((r21 - r12) * t, 0.25f / t, (r01 + r10) * t, (r02 + r20) * t);
+    }
+    else if (r11 > r22)
+    {
+        t = 0.5f / sqrtf(1.0f + r11 - r00 - r22);
+        return Quaternion((r02 - r20) * t, (r01 + r10) * t, 0.25f / t, (r12 + r21) * t);
+    }
+    else
+    {
+        t = 0.5f / sqrtf(1.0f + r22 - r00 - r11);
+        return Quaternion((r10 - r01) * t, (r02 + r20) * t, (r12 + r21) * t, 0.25f / t);
+    }
+}
+
+Quaternion Quaternion::fromMatrix(const Matrix4& m)
+{
+    return fromMatrix(m.getRotationMatrix());
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// normalize to unit quaternion, identity if the length is 0
+///////////////////////////////////////////////////////////////////////////////
+Quaternion& Quaternion::normalize()
+{
+    float lengthSq = s * s + x * x + y * y + z * z;
+    if (lengthSq < EPSILON)
+    {
+        set(1, 0, 0, 0);
+        return *this;
+    }
+
+    float invLength = 1.0f / sqrtf(lengthSq);
+    s *= invLength;  x *= invLength;  y *= invLength;  z *= invLength;
+    return *this;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// inverse quaternion, q^-1 = q* / |q|^2
+// same as conjugate() for unit quaternion
+///////////////////////////////////////////////////////////////////////////////
+Quaternion& Quaternion::invert()
+{
+    float lengthSq = s * s + x * x + y * y + z * z;
+    if (lengthSq < EPSILON)
+        return *this;
+
+    float invLengthSq = 1.0f / lengthSq;
+    s *= invLengthSq;  x *= -invLengthSq;  y *= -invLengthSq;  z *= -invLengthSq;
+    return *this;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// rotate vector with unit quaternion without building a matrix
+// v' = v + 2s(u x v) + 2u x (u x v), u = (x, y, z)
+///////////////////////////////////////////////////////////////////////////////
+Vector3 Quaternion::rotate(const Vector3& v) const
+{
+    Vector3 u(x, y, z);
+    Vector3 t = u.cross(v) * 2.0f;
+    return v + t * s + u.cross(t);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return rotation matrix of unit quaternion
+///////////////////////////////////////////////////////////////////////////////
+Matrix3 Quaternion::getMatrix3() const
+{
+    float x2 = x + x, y2 = y + y, z2 = z + z;
+    float xx = x * x2, xy = x * y2, xz = x * z2;
+    float yy = y * y2, yz = y * z2, zz = z * z2;
+    float sx = s * x2, sy = s * y2, sz = s * z2;
+
+    return Matrix3(1 - (yy + zz), xy + sz,       xz - sy,         // 1st column
+                   xy - sz,       1 - (xx + zz), yz + sx,         // 2nd column
+                   xz + sy,       yz - sx,       1 - (xx + yy));  // 3rd column
+}
+
+Matrix4 Quaternion::getMatrix() const
+{
+    return getMatrix(Vector3(0, 0, 0));
+}
+
+Matrix4 Quaternion::getMatrix(const Vector3& translation) const
+{
+    float x2 = x + x, y2 = y + y, z2 = z + z;
+    float xx = x * x2, xy = x * y2, xz = x * z2;
+    float yy = y * y2, yz = y * z2, zz = z * z2;
+    float sx = s * x2, sy = s * y2, sz = s * z2;
+
+    return Matrix4(1 - (yy + zz), xy + sz,       xz - sy,       0,    // 1st column
+                   xy - sz,       1 - (xx + zz), yz + sx,       0,    // 2nd column
+                   xz + sy,       yz - sx,       1 - (xx + yy), 0,    // 3rd column
+                   translation.x, translation.y, translation.z, 1);   // 4th column
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// normalized linear interpolation on the shortest path
+///////////////////////////////////////////////////////////////////////////////
+Quaternion Quaternion::nlerp(const Quaternion& from, const Quaternion& to, float t)
+{
+    // q and -q are the same rotation, flip to take the shorter arc
+    float sign = (from.dot(to) < 0) ? -1.0f : 1.0f;
+    Quaternion q = from * (1 - t) + to * (sign * t);
+    return q.normalize();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// spherical linear interpolation on the shortest path, constant angular speed
+// It falls back to nlerp() if 2 quaternions are almost same, because sin()
+// of the small angle loses the precision, and nlerp is as accurate there.
+///////////////////////////////////////////////////////////////////////////////
+Quaternion Quaternion::slerp(const Quaternion& from, const Quaternion& to, float t)
+{
+    const float NLERP_THRESHOLD = 0.9995f;  // cos(angle) between from and to
+
+    float cosine = from.dot(to);
+    float sign = 1.0f;
+    if (cosine < 0)
+    {
+        cosine = -cosine;
+        sign = -1.0f;
+    }
+
+    if (cosine > NLERP_THRESHOLD)
+        return nlerp(from, to, t);
+
+    float angle = acosf(cosine);
+    float invSine = 1.0f / sqrtf(1.0f - cosine * cosine);
+    float a = sinf((1 - t) * angle) * invSine;
+    float b = sinf(t * angle) * invSine * sign;
+    return from * a + to * b;
+}
+
+//=============================================================================
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build dual quaternion of rotation followed by translation
+///////////////////////////////////////////////////////////////////////////////
+DualQuaternion::DualQuaternion(const Quaternion& rotation, const Vector3& translation) : real(rotation)
+{
+    dual = Quaternion(0, translation.x, translation.y, translation.z) * rotation * 0.5f;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// normalize the real part to unit length and scale the dual part with it
+///////////////////////////////////////////////////////////////////////////////
+DualQuaternion& DualQuaternion::normalize()
+{
+    float length = real.length();
+    if (length < EPSILON)
+    {
+        *this = DualQuaternion();
+        return *this;
+    }
+
+    float invLength = 1.0f / length;
+    real = real * invLength;
+    dual = dual * invLength;
+
+    // remove the dual component parallel to real, so dot(real, dual) = 0
+    dual = dual - real * real.dot(dual);
+    return *this;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return translation, t = 2 * dual * real^*
+///////////////////////////////////////////////////////////////////////////////
+Vector3 DualQuaternion::getTranslation() const
+{
+    Quaternion conj = real;
+    conj.conjugate();
+    Quaternion t = dual * conj;
+    return Vector3(2 * t.x, 2 * t.y, 2 * t.z);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// transform point with unit dual quaternion
+///////////////////////////////////////////////////////////////////////////////
+Vector3 DualQuaternion::transform(const Vector3& point) const
+{
+    return real.rotate(point) + getTranslation();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return 4x4 rigid transform matrix of unit dual quaternion
+///////////////////////////////////////////////////////////////////////////////
+Matrix4 DualQuaternion::getMatrix() const
+{
+    return real.getMatrix(getTranslation());
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// dual quaternion linear blending on the shortest path
+///////////////////////////////////////////////////////////////////////////////
+DualQuaternion DualQuaternion::blend(const DualQuaternion& from, const DualQuaternion& to, float t)
+{
+    float b = (from.real.dot(to.real) < 0) ? -t : t;
+
+    DualQuaternion dq;
+    dq.real = from.real * (1 - t) + to.real * b;
+    dq.dual = from.dual * (1 - t) + to.dual * b;
+    return dq.normalize();
+}
@@ -6,6 +6,25 @@
 #include <iomanip>
 #include "Vectors.h"
 
+///////////////////////////////////////////////////////////////////////////
+// SIMD backend for Matrix4 multiply, transform and inverse
+// It is selected at compile time; SSE is used if the target supports SSE2
+// (x64, or x86 with /arch:SSE2 or -msse2), and FMA is used on top of it with
+// AVX2. Define MATRICES_NO_SIMD to build the scalar code only.
+// Both paths keep the same column-major m[16], compatible with glLoadMatrixf().
+// The scalar path is always available as multiplyScalar(), invertAffineScalar()
+// and invertGeneralScalar() for comparison.
+///////////////////////////////////////////////////////////////////////////
+#if !defined(MATRICES_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MATRICES_SIMD
+#if defined(__AVX2__)
+#define MATRICES_SIMD_FMA
+#include <immintrin.h>
+#else
+#include <xmmintrin.h>
+#endif
+#endif
+
 ///////////////////////////////////////////////////////////////////////////
 // 2x2 matrix
 ///////////////////////////////////////////////////////////////////////////
@@ -159,6 +178,8 @@ public:
     Matrix4& invertAffine();                         // inverse of affine transform matrix
     Matrix4& invertProjective();                     // inverse of projective matrix using partitioning
     Matrix4& invertGeneral();                        // inverse of generic matrix
+    Matrix4& invertAffineScalar();                   // scalar path of invertAffine()
+    Matrix4& invertGeneralScalar();                  // scalar path of invertGeneral()
 
     // transform matrix
     Matrix4& translate(float x, float y, float z);   // translation by (x,y,z)
@@ -174,8 +195,25 @@ public:
     Matrix4& lookAt(float tx, float ty, float tz, float ux, float uy, float uz);
     Matrix4& lookAt(const Vector3& target);
     Matrix4& lookAt(const Vector3& target, const Vector3& up);
+
+    // fused builders, sin/cos of each angle computed once (angles in degree)
+    static Matrix4 fromEulerTRS(float ax, float ay, float az,        // identity().rotateZ(az).rotateY(ay)
+                                float tx, float ty, float tz);       //   .rotateX(ax).translate(tx,ty,tz)
+    static Matrix4 fromTranslateEuler(float tx, float ty, float tz,  // identity().translate(tx,ty,tz)
+                                      float ax, float ay, float az); //   .rotateX(ax).rotateY(ay).rotateZ(az)
     //@@Matrix4&    skew(float angle, const Vector3& axis); //
 
+    // batch transform of points: p' = M * (x,y,z,1), same as operator*(Vector3)
+    // SoA takes separate x/y/z arrays. Interleaved takes xyz at the beginning of
+    // each vertex and the stride in bytes (32 for Cylinder interleaved V/N/T);
+    // only xyz of dst are written, so dst can be same as src.
+    // Large inputs are split into threadCount threads.
+    void        transform(const float* x, const float* y, const float* z,
+                          float* outX, float* outY, float* outZ,
+                          int count, int threadCount = 1) const;
+    void        transform(const float* src, float* dst, int count, int stride,
+                          int threadCount = 1) const;
+
     // operators
     Matrix4     operator+(const Matrix4& rhs) const;    // add rhs
     Matrix4     operator-(const Matrix4& rhs) const;    // subtract rhs
@@ -190,6 +228,10 @@ public:
     float       operator[](int index) const;            // subscript operator v[0], v[1]
     float& operator[](int index);                  // subscript operator v[0], v[1]
 
+    // scalar path of multiplication, regardless of SIMD backend
+    Vector4     multiplyScalar(const Vector4& rhs) const;
+    Matrix4     multiplyScalar(const Matrix4& rhs) const;
+
     // friends functions
     friend Matrix4 operator-(const Matrix4& m);                     // unary operator (-)
     friend Matrix4 operator*(float scalar, const Matrix4& m);       // pre-multiplication
@@ -211,6 +253,90 @@ private:
 
 
 
+///////////////////////////////////////////////////////////////////////////
+// quaternion, s + xi + yj + zk
+// rotation without gimbal lock; unit quaternion is assumed for rotation,
+// matrix conversion and interpolation
+///////////////////////////////////////////////////////////////////////////
+struct Quaternion
+{
+    float s;    // scalar part
+    float x;    // vector part
+    float y;
+    float z;
+
+    // ctors
+    Quaternion() : s(1), x(0), y(0), z(0) {};  // init with identity
+    Quaternion(float s, float x, float y, float z) : s(s), x(x), y(y), z(z) {};
+
+    // build rotation (angles in degree)
+    static Quaternion fromAxisAngle(const Vector3& axis, float angle);
+    static Quaternion fromEuler(float ax, float ay, float az);  // same rotation as Matrix4::fromEulerTRS()
+    static Quaternion fromMatrix(const Matrix3& m);             // rotation matrix without scale
+    static Quaternion fromMatrix(const Matrix4& m);             // upper-left 3x3 of m
+
+    // utils functions
+    void        set(float s, float x, float y, float z);
+    float       length() const;
+    Quaternion& normalize();
+    Quaternion& conjugate();
+    Quaternion& invert();                               // conjugate / squared length
+    float       dot(const Quaternion& rhs) const;
+    Vector3     rotate(const Vector3& v) const;         // v' = q * v * q^-1, unit quaternion
+    Matrix3     getMatrix3() const;                     // 3x3 rotation matrix
+    Matrix4     getMatrix() const;                      // 4x4 rotation matrix
+    Matrix4     getMatrix(const Vector3& translation) const;    // T * R at once
+
+    // interpolation on the shortest path, t = 0 ~ 1
+    // nlerp is cheaper (no trig), but the angular speed is not constant
+    static Quaternion nlerp(const Quaternion& from, const Quaternion& to, float t);
+    static Quaternion slerp(const Quaternion& from, const Quaternion& to, float t);
+
+    // operators
+    Quaternion  operator-() const;                      // unary operator (negate)
+    Quaternion  operator+(const Quaternion& rhs) const; // add rhs
+    Quaternion  operator-(const Quaternion& rhs) const; // subtract rhs
+    Quaternion  operator*(float scale) const;           // scale
+    Quaternion  operator*(const Quaternion& rhs) const; // Hamilton product, rotate rhs first
+    Quaternion& operator*=(const Quaternion& rhs);      // multiply and update this object
+    bool        operator==(const Quaternion& rhs) const;   // exact compare, no epsilon
+    bool        operator!=(const Quaternion& rhs) const;   // exact compare, no epsilon
+
+    friend std::ostream& operator<<(std::ostream& os, const Quaternion& q);
+};
+
+
+
+///////////////////////////////////////////////////////////////////////////
+// dual quaternion, real + dual * e (e^2 = 0)
+// rigid transform (rotation + translation) in 8 floats; it is blended
+// without the shearing artifact of blending matrices
+///////////////////////////////////////////////////////////////////////////
+struct DualQuaternion
+{
+    Quaternion real;    // rotation
+    Quaternion dual;    // 0.5 * translation * rotation
+
+    // ctors
+    DualQuaternion() : real(1, 0, 0, 0), dual(0, 0, 0, 0) {};  // init with identity
+    DualQuaternion(const Quaternion& rotation, const Vector3& translation);
+
+    // utils functions
+    DualQuaternion& normalize();
+    Quaternion  getRotation() const                     { return real; }
+    Vector3     getTranslation() const;
+    Vector3     transform(const Vector3& point) const;  // rotate, then translate
+    Matrix4     getMatrix() const;
+
+    // linear blend, then normalize (DLB), t = 0 ~ 1
+    static DualQuaternion blend(const DualQuaternion& from, const DualQuaternion& to, float t);
+
+    // operators
+    DualQuaternion operator*(const DualQuaternion& rhs) const; // apply rhs first
+};
+
+
+
 ///////////////////////////////////////////////////////////////////////////
 // inline functions for Matrix2
 ///////////////////////////////////////////////////////////////////////////
@@ -634,6 +760,20 @@ inline std::ostream& operator<<(std::ostream& os, const Matrix3& m)
 ///////////////////////////////////////////////////////////////////////////
 // inline functions for Matrix4
 ///////////////////////////////////////////////////////////////////////////
+#ifdef MATRICES_SIMD
+// a * b + c, fused with AVX2/FMA
+inline __m128 simdMulAdd(__m128 a, __m128 b, __m128 c)
+{
+#ifdef MATRICES_SIMD_FMA
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+#endif
+
+
+
 inline Matrix4::Matrix4()
 {
     // initially identity matrix
@@ -794,6 +934,24 @@ inline Matrix4& Matrix4::operator-=(const Matrix4& rhs)
 
 
 inline Vector4 Matrix4::operator*(const Vector4& rhs) const
+{
+#ifdef MATRICES_SIMD
+    // v' = col0*x + col1*y + col2*z + col3*w
+    __m128 v = _mm_mul_ps(_mm_loadu_ps(&m[0]), _mm_set1_ps(rhs.x));
+    v = simdMulAdd(_mm_loadu_ps(&m[4]), _mm_set1_ps(rhs.y), v);
+    v = simdMulAdd(_mm_loadu_ps(&m[8]), _mm_set1_ps(rhs.z), v);
+    v = simdMulAdd(_mm_loadu_ps(&m[12]), _mm_set1_ps(rhs.w), v);
+    float r[4];
+    _mm_storeu_ps(r, v);
+    return Vector4(r[0], r[1], r[2], r[3]);
+#else
+    return multiplyScalar(rhs);
+#endif
+}
+
+
+
+inline Vector4 Matrix4::multiplyScalar(const Vector4& rhs) const
 {
     return Vector4(m[0] * rhs.x + m[4] * rhs.y + m[8] * rhs.z + m[12] * rhs.w,
         m[1] * rhs.x + m[5] * rhs.y + m[9] * rhs.z + m[13] * rhs.w,
@@ -813,6 +971,33 @@ inline Vector3 Matrix4::operator*(const Vector3& rhs) const
 
 
 inline Matrix4 Matrix4::operator*(const Matrix4& n) const
+{
+#ifdef MATRICES_SIMD
+    // each column of M3 is a linear combination of the columns of M1
+    __m128 c0 = _mm_loadu_ps(&m[0]);
+    __m128 c1 = _mm_loadu_ps(&m[4]);
+    __m128 c2 = _mm_loadu_ps(&m[8]);
+    __m128 c3 = _mm_loadu_ps(&m[12]);
+
+    float r[16];
+    for (int i = 0; i < 16; i += 4)
+    {
+        __m128 col = _mm_loadu_ps(&n.m[i]);
+        __m128 v = _mm_mul_ps(c0, _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0)));
+        v = simdMulAdd(c1, _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1)), v);
+        v = simdMulAdd(c2, _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2)), v);
+        v = simdMulAdd(c3, _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3)), v);
+        _mm_storeu_ps(&r[i], v);
+    }
+    return Matrix4(r);
+#else
+    return multiplyScalar(n);
+#endif
+}
+
+
+
+inline Matrix4 Matrix4::multiplyScalar(const Matrix4& n) const
 {
     return Matrix4(m[0] * n[0] + m[4] * n[1] + m[8] * n[2] + m[12] * n[3], m[1] * n[0] + m[5] * n[1] + m[9] * n[2] + m[13] * n[3], m[2] * n[0] + m[6] * n[1] + m[10] * n[2] + m[14] * n[3], m[3] * n[0] + m[7] * n[1] + m[11] * n[2] + m[15] * n[3],
         m[0] * n[4] + m[4] * n[5] + m[8] * n[6] + m[12] * n[7], m[1] * n[4] + m[5] * n[5] + m[9] * n[6] + m[13] * n[7], m[2] * n[4] + m[6] * n[5] + m[10] * n[6] + m[14] * n[7], m[3] * n[4] + m[7] * n[5] + m[11] * n[6] + m[15] * n[7],
@@ -903,4 +1088,119 @@ inline std::ostream& operator<<(std::ostream& os, const Matrix4& m)
     return os;
 }
 // END OF MATRIX4 INLINE //////////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////////////////////
+// inline functions for Quaternion
+///////////////////////////////////////////////////////////////////////////
+inline void Quaternion::set(float s, float x, float y, float z)
+{
+    this->s = s;  this->x = x;  this->y = y;  this->z = z;
+}
+
+
+
+inline float Quaternion::length() const
+{
+    return sqrtf(s * s + x * x + y * y + z * z);
+}
+
+
+
+inline Quaternion& Quaternion::conjugate()
+{
+    x = -x;  y = -y;  z = -z;
+    return *this;
+}
+
+
+
+inline float Quaternion::dot(const Quaternion& rhs) const
+{
+    return s * rhs.s + x * rhs.x + y * rhs.y + z * rhs.z;
+}
+
+
+
+inline Quaternion Quaternion::operator-() const
+{
+    return Quaternion(-s, -x, -y, -z);
+}
+
+
+
+inline Quaternion Quaternion::operator+(const Quaternion& rhs) const
+{
+    return Quaternion(s + rhs.s, x + rhs.x, y + rhs.y, z + rhs.z);
+}
+
+
+
+inline Quaternion Quaternion::operator-(const Quaternion& rhs) const
+{
+    return Quaternion(s - rhs.s, x - rhs.x, y - rhs.y, z - rhs.z);
+}
+
+
+
+inline Quaternion Quaternion::operator*(float a) const
+{
+    return Quaternion(a * s, a * x, a * y, a * z);
+}
+
+
+
+inline Quaternion Quaternion::operator*(const Quaternion& rhs) const
+{
+    return Quaternion(s * rhs.s - x * rhs.x - y * rhs.y - z * rhs.z,
+                      s * rhs.x + x * rhs.s + y * rhs.z - z * rhs.y,
+                      s * rhs.y - x * rhs.z + y * rhs.s + z * rhs.x,
+                      s * rhs.z + x * rhs.y - y * rhs.x + z * rhs.s);
+}
+
+
+
+inline Quaternion& Quaternion::operator*=(const Quaternion& rhs)
+{
+    *this = *this * rhs;
+    return *this;
+}
+
+
+
+inline bool Quaternion::operator==(const Quaternion& rhs) const
+{
+    return (s == rhs.s) && (x == rhs.x) && (y == rhs.y) && (z == rhs.z);
+}
+
+
+
+inline bool Quaternion::operator!=(const Quaternion& rhs) const
+{
+    return (s != rhs.s) || (x != rhs.x) || (y != rhs.y) || (z != rhs.z);
+}
+
+
+
+inline std::ostream& operator<<(std::ostream& os, const Quaternion& q)
+{
+    os << "(" << q.s << ", " << q.x << ", " << q.y << ", " << q.z << ")";
+    return os;
+}
+// END OF QUATERNION INLINE ///////////////////////////////////////////////////
+
+
+
+///////////////////////////////////////////////////////////////////////////
+// inline functions for DualQuaternion
+///////////////////////////////////////////////////////////////////////////
+inline DualQuaternion DualQuaternion::operator*(const DualQuaternion& rhs) const
+{
+    DualQuaternion dq;
+    dq.real = real * rhs.real;
+    dq.dual = real * rhs.dual + dual * rhs.real;
+    return dq;
+}
+// END OF DUALQUATERNION INLINE ///////////////////////////////////////////////
 #endif
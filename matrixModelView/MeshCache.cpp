@@ -0,0 +1,538 @@
+///////////////////////////////////////////////////////////////////////////////
+// MeshCache.cpp
+// =============
+// GPU mesh cache for the built-in shapes (cube, sphere, cylinder, cone, torus,
+// teapot, camera)
+// Each shape is built once into an interleaved V/N/T vertex buffer (32 bytes
+// stride) and an index buffer, then reused for all frames and viewports.
+// Each tessellation of a shape is cached separately, and a cached mesh is
+// rebuilt only when its size is changed.
+// The mesh is drawn with the fixed client arrays (glVertexPointer...), or with
+// a VAO of generic attributes for the core-profile path.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "MeshCache.h"
+#include "glExtension.h"
+#include "Box.h"
+#include "Sphere.h"
+#include "Cylinder.h"
+#include "Cone.h"
+#include "Torus.h"
+#include "BinaryMesh.h"
+#ifdef _WINDOWS
+#include "Log.h"                            // GUI app, no console
+#endif
+
+
+
+// constants //////////////////////////////////////////////////////////////////
+const int MESH_STRIDE = 32;                 // bytes per interleaved vertex (V/N/T)
+const char* CAMERA_MESH_FILE = "camera.mesh";
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// report an error to the log of GUI app, or to the console
+///////////////////////////////////////////////////////////////////////////////
+static void logError(const std::string& message)
+{
+#ifdef _WINDOWS
+    Win::log("[ERROR] %s", message.c_str());
+#else
+    std::cout << "[ERROR] " << message << std::endl;
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// find a data file (mesh) relative to the current directory, then the
+// directory of the executable, then CS105_DATA_DIR given by the build
+// It returns the name as it is if the file is not found anywhere.
+///////////////////////////////////////////////////////////////////////////////
+static bool fileExists(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if(!file)
+        return false;
+    fclose(file);
+    return true;
+}
+
+static std::string getExecutableDir()
+{
+    char path[4096] = "";
+#ifdef _WIN32
+    DWORD length = ::GetModuleFileNameA(0, path, sizeof(path));
+    if(length == 0 || length >= sizeof(path))
+        return "";
+#else
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if(length <= 0)
+        return "";
+    path[length] = '\0';
+#endif
+    std::string dir = path;
+    std::string::size_type slash = dir.find_last_of("/\\");
+    return (slash == std::string::npos) ? "" : dir.substr(0, slash + 1);
+}
+
+static std::string findDataFile(const char* fileName)
+{
+    if(fileExists(fileName))
+        return fileName;
+
+    std::string path = getExecutableDir() + fileName;
+    if(fileExists(path))
+        return path;
+
+#ifdef CS105_DATA_DIR
+    path = std::string(CS105_DATA_DIR) + "/" + fileName;
+    if(fileExists(path))
+        return path;
+#endif
+    return fileName;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// helpers to generate interleaved vertices and indices of each shape
+///////////////////////////////////////////////////////////////////////////////
+static void addVertex(std::vector<float>& vertices, float x, float y, float z,
+                      float nx, float ny, float nz, float s, float t)
+{
+    vertices.push_back(x);
+    vertices.push_back(y);
+    vertices.push_back(z);
+    vertices.push_back(nx);
+    vertices.push_back(ny);
+    vertices.push_back(nz);
+    vertices.push_back(s);
+    vertices.push_back(t);
+}
+
+// copy interleaved vertices of a shape (Box, Sphere, Cylinder, Cone, Torus),
+// shift z and use first indexCount indices
+template<class Shape>
+static void copyShape(const Shape& shape, float shiftZ, unsigned int indexCount,
+                      std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+    const float* src = shape.getInterleavedVertices();
+    unsigned int count = shape.getInterleavedVertexCount() * 8;
+    vertices.assign(src, src + count);
+    if(shiftZ != 0)
+    {
+        for(unsigned int i = 2; i < count; i += 8)
+            vertices[i] += shiftZ;
+    }
+
+    const unsigned int* srcIndices = shape.getIndices();
+    indices.assign(srcIndices, srcIndices + indexCount);
+}
+
+
+
+// copy a baked mesh file, the positions are scaled and shifted along Y-axis
+// The tex coords are cylindrical mapping around Y-axis.
+static bool copyBinaryMesh(const char* fileName, float scale, float shiftY,
+                           std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+    BinaryMesh mesh;
+    if(!mesh.open(findDataFile(fileName).c_str()))
+    {
+        logError(mesh.getErrorMessage());
+        return false;
+    }
+
+    const float PI = acosf(-1);
+    const float* boundsMin = mesh.getBoundsMin();
+    const float* boundsMax = mesh.getBoundsMax();
+    float height = boundsMax[1] - boundsMin[1];
+    float p[3], n[3];
+
+    unsigned int count = mesh.getVertexCount();
+    vertices.reserve(count * 8);
+    for(unsigned int i = 0; i < count; ++i)
+    {
+        mesh.getPosition(i, p);
+        mesh.getNormal(i, n);
+        addVertex(vertices, p[0] * scale, (p[1] + shiftY) * scale, p[2] * scale,
+                  n[0], n[1], n[2],
+                  atan2f(p[2], p[0]) / (2 * PI) + 0.5f,
+                  height > 0 ? (p[1] - boundsMin[1]) / height : 0);
+    }
+
+    count = mesh.getIndexCount();
+    indices.resize(count);
+    for(unsigned int i = 0; i < count; ++i)
+        indices[i] = mesh.getIndex(i);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// load the teapot baked from teapot.h as a single triangle list
+// The transform is same as glutSolidTeapot(size): scale by 0.5 * size and put
+// the center of the body at the origin.
+///////////////////////////////////////////////////////////////////////////////
+bool MeshCache::buildTeapot(float size, std::vector<float>& vertices, std::vector<unsigned int>& indices,
+                            const char* fileName)
+{
+    return copyBinaryMesh(fileName, 0.5f * size, -1.5f, vertices, indices);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+MeshCache::MeshCache() : boundMesh(0), vboSupported(false), vaoSupported(false),
+                         genericAttributes(false), buildCount(0), hitCount(0)
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// check VBO and VAO extensions
+// NOTE: must be called after OpenGL RC is set
+///////////////////////////////////////////////////////////////////////////////
+void MeshCache::init()
+{
+    glExtension& extension = glExtension::getInstance();
+    vboSupported = extension.isSupported("GL_ARB_vertex_buffer_object");
+    vaoSupported = vboSupported && extension.isSupported("GL_ARB_vertex_array_object");
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// switch between the fixed client arrays and the generic attributes
+// the cached meshes are released, and rebuilt with/without VAO on next draw
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void MeshCache::setGenericAttributes(bool enabled)
+{
+    enabled = enabled && vaoSupported;
+    if(genericAttributes == enabled)
+        return;
+
+    clear();
+    genericAttributes = enabled;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// delete all cached meshes
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void MeshCache::clear()
+{
+    std::map<MeshKey, Mesh>::iterator iter;
+    for(iter = meshes.begin(); iter != meshes.end(); ++iter)
+        release(iter->second);
+    meshes.clear();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw a cached mesh in VertexArray mode
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void MeshCache::draw(int shape, float size, int sectorCount, int stackCount, int instanceCount)
+{
+    if(!bind(shape, size, sectorCount, stackCount))
+        return;
+
+    drawBound(instanceCount);
+    unbind();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// bind the VAO of a cached mesh, or set the vertex pointers of the VBO or
+// system memory if no VAO
+///////////////////////////////////////////////////////////////////////////////
+bool MeshCache::bind(int shape, float size, int sectorCount, int stackCount)
+{
+    unsigned int prevBuildCount = buildCount;
+    const Mesh& mesh = prepare(shape, size, sectorCount, stackCount);
+    if(buildCount == prevBuildCount)
+        ++hitCount;
+
+    if(mesh.indexCount == 0)
+        return false;
+
+    boundMesh = &mesh;
+    if(mesh.vaoId)
+    {
+        glBindVertexArray(mesh.vaoId);
+        return true;
+    }
+
+    // vertex pointers are offsets if VBO is bound
+    const char* vertexBase = 0;
+    if(mesh.vboId)
+    {
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, mesh.vboId);
+        glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, mesh.iboId);
+    }
+    else
+    {
+        vertexBase = (const char*)mesh.vertices.data();
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, MESH_STRIDE, vertexBase);
+    glNormalPointer(GL_FLOAT, MESH_STRIDE, vertexBase + sizeof(float) * 3);
+    glTexCoordPointer(2, GL_FLOAT, MESH_STRIDE, vertexBase + sizeof(float) * 6);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw the mesh bound by bind()
+///////////////////////////////////////////////////////////////////////////////
+void MeshCache::drawBound(int instanceCount)
+{
+    if(!boundMesh)
+        return;
+
+    // indices are an offset if IBO is bound
+    const char* indexBase = 0;
+    if(!boundMesh->iboId)
+        indexBase = (const char*)boundMesh->indices.data();
+
+    if(instanceCount > 0)
+        glDrawElementsInstancedARB(GL_TRIANGLES, boundMesh->indexCount, GL_UNSIGNED_INT, indexBase, instanceCount);
+    else
+        glDrawElements(GL_TRIANGLES, boundMesh->indexCount, GL_UNSIGNED_INT, indexBase);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// restore the states changed by bind()
+///////////////////////////////////////////////////////////////////////////////
+void MeshCache::unbind()
+{
+    if(!boundMesh)
+        return;
+
+    if(boundMesh->vaoId)
+    {
+        glBindVertexArray(0);
+    }
+    else
+    {
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+        if(boundMesh->vboId)
+        {
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+            glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+        }
+    }
+    boundMesh = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the bounding box of a cached mesh
+///////////////////////////////////////////////////////////////////////////////
+const BoundingBox& MeshCache::getBounds(int shape, float size, int sectorCount, int stackCount)
+{
+    return prepare(shape, size, sectorCount, stackCount).bounds;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// find the cached mesh, build it if not cached or the size is changed
+///////////////////////////////////////////////////////////////////////////////
+MeshCache::Mesh& MeshCache::prepare(int shape, float size, int sectorCount, int stackCount)
+{
+    MeshKey key = { shape, sectorCount, stackCount };
+    std::map<MeshKey, Mesh>::iterator iter = meshes.find(key);
+    if(iter == meshes.end())
+    {
+        Mesh mesh;
+        mesh.size = size;
+        mesh.sectorCount = sectorCount;
+        mesh.stackCount = stackCount;
+        mesh.vboId = mesh.iboId = mesh.vaoId = 0;
+        build(mesh, shape);
+        iter = meshes.insert(std::make_pair(key, mesh)).first;
+        upload(iter->second);
+    }
+    else if(iter->second.size != size)
+    {
+        // evict and rebuild with new size
+        Mesh& mesh = iter->second;
+        release(mesh);
+        mesh.size = size;
+        build(mesh, shape);
+        upload(mesh);
+    }
+
+    return iter->second;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// generate vertices and indices of the shape with current params of mesh
+///////////////////////////////////////////////////////////////////////////////
+void MeshCache::build(Mesh& mesh, int shape)
+{
+    std::vector<float>().swap(mesh.vertices);
+    std::vector<unsigned int>().swap(mesh.indices);
+
+    float size = mesh.size;
+    switch(shape)
+    {
+    case MESH_CUBE:
+    {
+        Box box(size * 2, size * 2, size * 2);
+        copyShape(box, 0, box.getIndexCount(), mesh.vertices, mesh.indices);
+        break;
+    }
+
+    case MESH_SPHERE:
+    {
+        // poles on z-axis, same as gluSphere
+        Sphere sphere(size, mesh.sectorCount, mesh.stackCount);
+        copyShape(sphere, 0, sphere.getIndexCount(), mesh.vertices, mesh.indices);
+        break;
+    }
+
+    case MESH_TEAPOT:
+        buildTeapot(size, mesh.vertices, mesh.indices);
+        break;
+
+    case MESH_CAMERA:
+        copyBinaryMesh(CAMERA_MESH_FILE, size, 0, mesh.vertices, mesh.indices);
+        break;
+
+    case MESH_CYLINDER:
+    {
+        Cylinder cylinder(size, size, size * 2, mesh.sectorCount, mesh.stackCount);
+        copyShape(cylinder, 0, cylinder.getIndexCount(), mesh.vertices, mesh.indices);
+        break;
+    }
+
+    case MESH_CONE:
+    {
+        // side only, base at z=0 (same as gluCylinder)
+        float radius = size / 4 > 1.0f ? size / 4 : 1.0f;
+        Cone cone(radius, size, mesh.sectorCount, mesh.stackCount);
+        copyShape(cone, size * 0.5f, cone.getSideIndexCount(), mesh.vertices, mesh.indices);
+        break;
+    }
+
+    case MESH_TORUS:
+    {
+        // tube radius is the size, on XY plane
+        Torus torus(size * 2, size, mesh.sectorCount, mesh.stackCount);
+        copyShape(torus, 0, torus.getIndexCount(), mesh.vertices, mesh.indices);
+        break;
+    }
+    }
+
+    // bounds before the vertices are moved to VBO
+    mesh.bounds = BoundingBox();
+    if(!mesh.vertices.empty())
+    {
+        const float* v = mesh.vertices.data();
+        mesh.bounds = BoundingBox(Vector3(v[0], v[1], v[2]), Vector3(v[0], v[1], v[2]));
+        for(size_t i = 8; i < mesh.vertices.size(); i += 8)
+            mesh.bounds.expand(mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2]);
+    }
+
+    mesh.indexCount = (unsigned int)mesh.indices.size();
+    ++buildCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// copy vertex and index data to VBOs, then free system memory
+// with generic attributes, a VAO records the VBOs and the attribute pointers
+///////////////////////////////////////////////////////////////////////////////
+void MeshCache::upload(Mesh& mesh)
+{
+    if(!vboSupported || mesh.indexCount == 0)
+        return;
+
+    glGenBuffersARB(1, &mesh.vboId);
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, mesh.vboId);
+    glBufferDataARB(GL_ARRAY_BUFFER_ARB, mesh.vertices.size() * sizeof(float), mesh.vertices.data(), GL_STATIC_DRAW_ARB);
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+    glGenBuffersARB(1, &mesh.iboId);
+    glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, mesh.iboId);
+    glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, mesh.indices.size() * sizeof(unsigned int), mesh.indices.data(), GL_STATIC_DRAW_ARB);
+    glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+
+    if(genericAttributes)
+    {
+        const char* vertexBase = 0;
+        glGenVertexArrays(1, &mesh.vaoId);
+        glBindVertexArray(mesh.vaoId);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, mesh.vboId);
+        glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, mesh.iboId);
+        glEnableVertexAttribArrayARB(MESH_ATTRIB_POSITION);
+        glEnableVertexAttribArrayARB(MESH_ATTRIB_NORMAL);
+        glEnableVertexAttribArrayARB(MESH_ATTRIB_TEXCOORD);
+        glVertexAttribPointerARB(MESH_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, MESH_STRIDE, vertexBase);
+        glVertexAttribPointerARB(MESH_ATTRIB_NORMAL, 3, GL_FLOAT, GL_FALSE, MESH_STRIDE, vertexBase + sizeof(float) * 3);
+        glVertexAttribPointerARB(MESH_ATTRIB_TEXCOORD, 2, GL_FLOAT, GL_FALSE, MESH_STRIDE, vertexBase + sizeof(float) * 6);
+        glBindVertexArray(0);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+        glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+    }
+
+    // data lives in VBOs now
+    std::vector<float>().swap(mesh.vertices);
+    std::vector<unsigned int>().swap(mesh.indices);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// delete VAO, VBOs and system memory of a mesh
+///////////////////////////////////////////////////////////////////////////////
+void MeshCache::release(Mesh& mesh)
+{
+    if(mesh.vaoId)
+        glDeleteVertexArrays(1, &mesh.vaoId);
+    if(mesh.vboId)
+        glDeleteBuffersARB(1, &mesh.vboId);
+    if(mesh.iboId)
+        glDeleteBuffersARB(1, &mesh.iboId);
+    mesh.vboId = mesh.iboId = mesh.vaoId = 0;
+    mesh.indexCount = 0;
+    std::vector<float>().swap(mesh.vertices);
+    std::vector<unsigned int>().swap(mesh.indices);
+}
@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////
+// MeshCache.h
+// ===========
+// GPU mesh cache for the built-in shapes (cube, sphere, cylinder, cone, torus,
+// teapot, camera)
+// Each shape is built once into an interleaved V/N/T vertex buffer (32 bytes
+// stride) and an index buffer, then reused for all frames and viewports.
+// Each tessellation of a shape is cached separately, so the LOD levels of a
+// shape (see MeshLod.h) stay in GPU memory. A cached mesh is rebuilt only when
+// its size is changed.
+// If GL_ARB_vertex_buffer_object is not available, the mesh is drawn from
+// system memory with vertex arrays instead.
+// With generic attributes (the core-profile path), each mesh also keeps a
+// vertex array object with the V/N/T pointers at the MeshAttribute locations.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#ifdef _WIN32
+#include <windows.h>    // include windows.h to avoid thousands of compile errors even though this class is not depending on Windows
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <map>
+#include <vector>
+#include "BoundingBox.h"
+
+// shape ids of cached meshes
+enum MeshShape
+{
+    MESH_CUBE = 0,
+    MESH_SPHERE,
+    MESH_CYLINDER,
+    MESH_CONE,
+    MESH_TORUS,
+    MESH_TEAPOT,
+    MESH_CAMERA
+};
+
+// generic vertex attribute locations shared by the shader programs
+// a mat4 attribute takes 4 locations, MESH_ATTRIB_INSTANCE_MATRIX to +3
+enum MeshAttribute
+{
+    MESH_ATTRIB_POSITION = 0,
+    MESH_ATTRIB_COLOR = 1,
+    MESH_ATTRIB_NORMAL = 2,
+    MESH_ATTRIB_TEXCOORD = 3,
+    MESH_ATTRIB_INSTANCE_MATRIX = 4
+};
+
+class MeshCache
+{
+public:
+    MeshCache();
+    ~MeshCache() {}
+
+    void init();                                    // check VBO support, OpenGL RC must be set
+    void clear();                                   // delete all meshes and GL buffers
+
+    // use generic attributes in VAOs instead of the fixed client arrays,
+    // needs VBO and GL_ARB_vertex_array_object, the cached meshes are rebuilt
+    void setGenericAttributes(bool enabled);
+    bool hasGenericAttributes() const       { return genericAttributes; }
+
+    // draw the cached mesh, (re)build it if not cached or the size is changed
+    // instanceCount > 0 draws with glDrawElementsInstancedARB()
+    void draw(int shape, float size, int sectorCount, int stackCount, int instanceCount=0);
+
+    // same as draw() in 3 steps, for the caller to set the per-instance
+    // attributes (GL_ARB_instanced_arrays) after the mesh is bound; they are
+    // recorded in the VAO of the mesh, so disable them before unbind()
+    // bind() returns false if the mesh is empty, then skip drawBound()
+    bool bind(int shape, float size, int sectorCount, int stackCount);
+    void drawBound(int instanceCount=0);
+    void unbind();
+
+    // bounding box of the mesh in object space, for frustum culling before draw()
+    // the mesh is (re)built same as draw() if needed, OpenGL RC must be set
+    const BoundingBox& getBounds(int shape, float size, int sectorCount, int stackCount);
+
+    // load the baked teapot as a single triangle list, V/N/T interleaved
+    // The mesh files are searched in the current directory, the directory of
+    // the executable, then CS105_DATA_DIR.
+    static bool buildTeapot(float size, std::vector<float>& vertices, std::vector<unsigned int>& indices,
+                            const char* fileName="teapot.mesh");
+
+    // stats
+    unsigned int getMeshCount() const       { return (unsigned int)meshes.size(); }
+    unsigned int getBuildCount() const      { return buildCount; }
+    unsigned int getHitCount() const        { return hitCount; }
+
+private:
+    struct Mesh
+    {
+        float size;
+        int sectorCount;
+        int stackCount;
+        GLuint vboId;                       // 0 if vertices are in system memory
+        GLuint iboId;
+        GLuint vaoId;                       // 0 if no generic attributes
+        unsigned int indexCount;
+        std::vector<float> vertices;        // interleaved V/N/T, empty after uploaded to VBO
+        std::vector<unsigned int> indices;
+        BoundingBox bounds;                 // computed from the vertices when built
+    };
+
+    struct MeshKey
+    {
+        int shape;
+        int sectorCount;
+        int stackCount;
+        bool operator<(const MeshKey& rhs) const
+        {
+            if(shape != rhs.shape) return shape < rhs.shape;
+            if(sectorCount != rhs.sectorCount) return sectorCount < rhs.sectorCount;
+            return stackCount < rhs.stackCount;
+        }
+    };
+
+    Mesh& prepare(int shape, float size, int sectorCount, int stackCount);    // find or (re)build
+    void build(Mesh& mesh, int shape);
+    void upload(Mesh& mesh);
+    void release(Mesh& mesh);
+
+    std::map<MeshKey, Mesh> meshes;         // one mesh per shape and tessellation
+    const Mesh* boundMesh;                  // between bind() and unbind()
+    bool vboSupported;
+    bool vaoSupported;
+    bool genericAttributes;
+    unsigned int buildCount;
+    unsigned int hitCount;
+};
+
+#endif
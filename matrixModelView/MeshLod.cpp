@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////
+// MeshLod.cpp
+// ===========
+// level of detail (LOD) of a tessellated shape (sphere, cylinder, cone, torus)
+// See MeshLod.h for how a level is chosen.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "MeshLod.h"
+
+
+
+// constants //////////////////////////////////////////////////////////////////
+const float LOD_EDGE_PIXELS = 6.0f;     // target length of a sector edge on screen
+const float LOD_HYSTERESIS = 0.25f;     // shrink 25% more before a coarser level
+const float LOD_PI = 3.141593f;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctors, the default has a single level without tessellation
+///////////////////////////////////////////////////////////////////////////////
+MeshLod::MeshLod()
+{
+    set(0, 0, 0, 0);
+}
+
+MeshLod::MeshLod(int sectorCount, int stackCount, int minSectorCount, int minStackCount)
+{
+    set(sectorCount, stackCount, minSectorCount, minStackCount);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build the level table by halving the counts until the min counts
+///////////////////////////////////////////////////////////////////////////////
+void MeshLod::set(int sectorCount, int stackCount, int minSectorCount, int minStackCount)
+{
+    sectorCounts[0] = sectorCount;
+    stackCounts[0] = stackCount;
+    levelCount = 1;
+
+    while(levelCount < MAX_LEVELS)
+    {
+        int sectors = std::max(minSectorCount, sectorCounts[levelCount - 1] / 2);
+        int stacks = std::max(minStackCount, stackCounts[levelCount - 1] / 2);
+        if(sectors >= sectorCounts[levelCount - 1] && stacks >= stackCounts[levelCount - 1])
+            break;  // no more reduction
+
+        sectorCounts[levelCount] = std::min(sectors, sectorCounts[levelCount - 1]);
+        stackCounts[levelCount] = std::min(stacks, stackCounts[levelCount - 1]);
+        ++levelCount;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// choose the level for the projected diameter
+// A finer level is taken at once, a coarser level only if it still has enough
+// sectors for a LOD_HYSTERESIS larger object.
+///////////////////////////////////////////////////////////////////////////////
+int MeshLod::selectLevel(float screenDiameter, int prevLevel) const
+{
+    if(levelCount == 1)
+        return 0;
+
+    // sectors on the circumference for LOD_EDGE_PIXELS long edges
+    float sectorCount = screenDiameter * LOD_PI / LOD_EDGE_PIXELS;
+    int level = findLevel(sectorCount);
+
+    prevLevel = clampLevel(prevLevel);
+    if(level > prevLevel)
+        level = std::max(prevLevel, findLevel(sectorCount * (1 + LOD_HYSTERESIS)));
+    return level;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// projected diameter of a bounding sphere, the camera looks at -Z in eye space
+// return FLT_MAX if the camera is inside of the sphere
+///////////////////////////////////////////////////////////////////////////////
+float MeshLod::getScreenDiameter(const Vector3& eyeCenter, float radius, float pixelsPerUnit)
+{
+    float distance = -eyeCenter.z;
+    if(distance <= radius)
+        return FLT_MAX;
+    return 2 * radius * pixelsPerUnit / distance;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// a unit at distance 1 covers projectionYY of NDC [-1, 1], which is the half
+// of the viewport height
+///////////////////////////////////////////////////////////////////////////////
+float MeshLod::getPixelsPerUnit(float projectionYY, int viewportHeight)
+{
+    return projectionYY * viewportHeight * 0.5f;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// private helpers
+///////////////////////////////////////////////////////////////////////////////
+int MeshLod::clampLevel(int level) const
+{
+    return std::min(std::max(level, 0), levelCount - 1);
+}
+
+int MeshLod::findLevel(float sectorCount) const
+{
+    int level = 0;
+    while(level + 1 < levelCount && sectorCounts[level + 1] >= sectorCount)
+        ++level;
+    return level;
+}
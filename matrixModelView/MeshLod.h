@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// MeshLod.h
+// =========
+// level of detail (LOD) of a tessellated shape (sphere, cylinder, cone, torus)
+// Level 0 is the full sector/stack counts, and each next level halves them
+// until the minimum counts. The level is chosen from the projected diameter of
+// the object in pixels, so a sector edge on the silhouette is about
+// LOD_EDGE_PIXELS long.
+// selectLevel() switches to a finer level at once, but to a coarser level
+// only after the object shrinks LOD_HYSTERESIS more, so an object at the
+// threshold distance does not pop between 2 levels every frame.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MESH_LOD_H
+#define MESH_LOD_H
+
+#include "Vectors.h"
+
+class MeshLod
+{
+public:
+    static const int MAX_LEVELS = 6;
+
+    MeshLod();
+    MeshLod(int sectorCount, int stackCount, int minSectorCount, int minStackCount);
+
+    // full detail counts and the min counts of the coarsest level
+    void set(int sectorCount, int stackCount, int minSectorCount, int minStackCount);
+
+    int getLevelCount() const               { return levelCount; }
+    int getSectorCount(int level) const     { return sectorCounts[clampLevel(level)]; }
+    int getStackCount(int level) const      { return stackCounts[clampLevel(level)]; }
+
+    // choose the level for the diameter in pixels, prevLevel is the level of
+    // the previous frame for hysteresis (0 if none)
+    int selectLevel(float screenDiameter, int prevLevel=0) const;
+
+    // projected diameter in pixels of a bounding sphere in eye space
+    // pixelsPerUnit is the size of a unit at distance 1, see getPixelsPerUnit()
+    static float getScreenDiameter(const Vector3& eyeCenter, float radius, float pixelsPerUnit);
+
+    // pixels per unit at distance 1 of perspective projection,
+    // projectionYY is (1,1) element of the matrix (cot(fovY/2))
+    static float getPixelsPerUnit(float projectionYY, int viewportHeight);
+
+private:
+    int clampLevel(int level) const;
+    int findLevel(float sectorCount) const;  // coarsest level that has sectorCount
+
+    int sectorCounts[MAX_LEVELS];
+    int stackCounts[MAX_LEVELS];
+    int levelCount;
+};
+
+#endif
@@ -0,0 +1,461 @@
+///////////////////////////////////////////////////////////////////////////////
+// MipChain.cpp
+// ============
+// mipmap levels of an 8-bit RGB or RGBA image, built on the CPU
+// All levels are stored in a single buffer, from the base level down to 1x1.
+// See MipChain.h for the filters.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include "MipChain.h"
+
+#ifdef MIP_SIMD
+#include <tmmintrin.h>
+#endif
+
+// constants
+const int PARALLEL_MIN_TEXELS = 256 * 256;  // smaller level is not worth threads
+const int PARALLEL_MIN_ROWS = 16;           // rows per thread at least
+const float KAISER_RADIUS = 2.0f;           // in destination texels
+const float KAISER_ALPHA = 4.0f;
+const int SRGB_TABLE_SIZE = 4096;           // linear to sRGB, 12-bit
+const float PI = 3.14159265f;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// sRGB <-> linear tables, built once
+///////////////////////////////////////////////////////////////////////////////
+struct GammaTable
+{
+    float toLinear[256];
+    unsigned char toSrgb[SRGB_TABLE_SIZE];
+
+    GammaTable()
+    {
+        for(int i = 0; i < 256; ++i)
+        {
+            float c = i / 255.0f;
+            toLinear[i] = (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for(int i = 0; i < SRGB_TABLE_SIZE; ++i)
+        {
+            float l = i / (float)(SRGB_TABLE_SIZE - 1);
+            float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * powf(l, 1 / 2.4f) - 0.055f;
+            toSrgb[i] = (unsigned char)(c * 255 + 0.5f);
+        }
+    }
+
+    unsigned char encode(float linear) const
+    {
+        int i = (int)(linear * (SRGB_TABLE_SIZE - 1) + 0.5f);
+        return toSrgb[std::min(std::max(i, 0), SRGB_TABLE_SIZE - 1)];
+    }
+};
+
+static const GammaTable& getGammaTable()
+{
+    static const GammaTable table;          // thread-safe init since C++11
+    return table;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// modified Bessel function of the first kind, order 0, for Kaiser window
+///////////////////////////////////////////////////////////////////////////////
+static float besselI0(float x)
+{
+    float sum = 1;
+    float term = 1;
+    for(int k = 1; k < 32; ++k)
+    {
+        term *= (x * 0.5f) / k;
+        sum += term * term;
+    }
+    return sum;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+MipChain::MipChain() : channelCount(0), filter(MIP_FILTER_BOX), gammaCorrect(false), threadCount(1)
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// allocate all levels at once, then build each level from the previous one
+///////////////////////////////////////////////////////////////////////////////
+bool MipChain::build(const unsigned char* pixels, int width, int height, int channelCount)
+{
+    clear();
+    if(!pixels || width <= 0 || height <= 0 || channelCount < 1 || channelCount > 4)
+        return false;
+
+    // level sizes
+    size_t size = 0;
+    MipLevel level;
+    level.width = width;
+    level.height = height;
+    while(true)
+    {
+        level.offset = size;
+        levels.push_back(level);
+        size += (size_t)level.width * level.height * channelCount;
+        if(level.width == 1 && level.height == 1)
+            break;
+        level.width = (level.width > 1) ? level.width / 2 : 1;
+        level.height = (level.height > 1) ? level.height / 2 : 1;
+    }
+
+    this->channelCount = channelCount;
+    buffer.resize(size);
+    memcpy(&buffer[0], pixels, (size_t)width * height * channelCount);
+    for(int i = 1; i < (int)levels.size(); ++i)
+        buildLevel(i);
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// release all levels
+///////////////////////////////////////////////////////////////////////////////
+void MipChain::clear()
+{
+    std::vector<MipLevel>().swap(levels);
+    std::vector<unsigned char>().swap(buffer);
+    channelCount = 0;
+}
+
+void MipChain::swap(MipChain& other)
+{
+    levels.swap(other.levels);
+    buffer.swap(other.buffer);
+    std::swap(channelCount, other.channelCount);
+    std::swap(filter, other.filter);
+    std::swap(gammaCorrect, other.gammaCorrect);
+    std::swap(threadCount, other.threadCount);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build a level from the previous one, the rows of a large level are split
+// among threads, and the last chunk is done by the calling thread
+///////////////////////////////////////////////////////////////////////////////
+void MipChain::buildLevel(int level)
+{
+    const MipLevel& src = levels[level - 1];
+    const MipLevel& dst = levels[level];
+    if(filter == MIP_FILTER_KAISER)
+    {
+        computeTaps(src.width, dst.width, tapsX);
+        computeTaps(src.height, dst.height, tapsY);
+    }
+
+    int count = threadCount;
+    if(count <= 0)
+        count = std::max(1, (int)std::thread::hardware_concurrency());
+    if(dst.width * dst.height < PARALLEL_MIN_TEXELS)
+        count = 1;
+    count = std::max(1, std::min(count, dst.height / PARALLEL_MIN_ROWS));
+
+    int chunk = (dst.height + count - 1) / count;
+    std::vector<std::thread> threads;
+    for(int y = chunk; y < dst.height; y += chunk)
+        threads.push_back(std::thread(&MipChain::filterRows, this, level, y, std::min(y + chunk, dst.height)));
+    filterRows(level, 0, std::min(chunk, dst.height));
+    for(size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// filter rows [yBegin, yEnd) of the level
+///////////////////////////////////////////////////////////////////////////////
+void MipChain::filterRows(int level, int yBegin, int yEnd) const
+{
+    const MipLevel& src = levels[level - 1];
+    const MipLevel& dst = levels[level];
+    const unsigned char* srcPixels = &buffer[src.offset];
+    unsigned char* dstPixels = const_cast<unsigned char*>(&buffer[dst.offset]);   // each thread writes own rows
+
+    if(filter == MIP_FILTER_KAISER)
+        kaiserRows(srcPixels, src.width, dstPixels, dst.width, yBegin, yEnd);
+    else if(gammaCorrect)
+        halveRowsGamma(srcPixels, src.width, src.height, dstPixels, dst.width, yBegin, yEnd, channelCount);
+    else
+        halveRows(srcPixels, src.width, src.height, dstPixels, dst.width, yBegin, yEnd, channelCount, true);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// 2x2 box filter with rounding, (a + b + c + d + 2) / 4
+// If the source is 1 texel wide or high, the texel is repeated.
+///////////////////////////////////////////////////////////////////////////////
+void MipChain::halve(const unsigned char* src, int srcWidth, int srcHeight,
+                     unsigned char* dst, int dstWidth, int dstHeight, int channelCount)
+{
+    halveRows(src, srcWidth, srcHeight, dst, dstWidth, 0, dstHeight, channelCount, true);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// scalar version of halve(), for comparison
+///////////////////////////////////////////////////////////////////////////////
+void MipChain::halveScalar(const unsigned char* src, int srcWidth, int srcHeight,
+                           unsigned char* dst, int dstWidth, int dstHeight, int channelCount)
+{
+    halveRows(src, srcWidth, srcHeight, dst, dstWidth, 0, dstHeight, channelCount, false);
+}
+
+
+
+#ifdef MIP_SIMD
+///////////////////////////////////////////////////////////////////////////////
+// (a + b + c + d + 2) / 4 of 16 bytes, where a, b are at p of 2 rows, and c, d
+// are at p + n (next texel) of 2 rows
+///////////////////////////////////////////////////////////////////////////////
+static inline __m128i average16(const unsigned char* p0, const unsigned char* p1, int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    __m128i a = _mm_loadu_si128((const __m128i*)p0);
+    __m128i b = _mm_loadu_si128((const __m128i*)p1);
+    __m128i c = _mm_loadu_si128((const __m128i*)(p0 + n));
+    __m128i d = _mm_loadu_si128((const __m128i*)(p1 + n));
+    __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                               _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+    __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+                               _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+    return _mm_packus_epi16(lo, hi);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// box filter of rows [yBegin, yEnd)
+// SIMD: 8 source texels (24 or 32 bytes) to 4 destination texels per step.
+// The bytes are averaged with the next texel, then every other texel is
+// packed by shuffles, so the result is same as the scalar version.
+///////////////////////////////////////////////////////////////////////////////
+void MipChain::halveRows(const unsigned char* src, int srcWidth, int srcHeight, unsigned char* dst,
+                         int dstWidth, int yBegin, int yEnd, int channelCount, bool simd)
+{
+    size_t srcStride = (size_t)srcWidth * channelCount;
+    int nextColumn = (srcWidth > 1) ? channelCount : 0;
+    dst += (size_t)dstWidth * channelCount * yBegin;
+
+#ifdef MIP_SIMD
+    simd = simd && srcWidth > 1 && (channelCount == 3 || channelCount == 4);
+    __m128i mask0, mask1;
+    if(channelCount == 3)
+    {
+        mask0 = _mm_setr_epi8(0, 1, 2, 6, 7, 8, 12, 13, 14, -1, -1, -1, -1, -1, -1, -1);
+        mask1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 3, 4, -1, -1, -1, -1);
+    }
+    else
+    {
+        mask0 = _mm_setr_epi8(0, 1, 2, 3, 8, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1);
+        mask1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 1, 2, 3, 8, 9, 10, 11);
+    }
+#else
+    simd = false;
+#endif
+
+    for(int y = yBegin; y < yEnd; ++y)
+    {
+        const unsigned char* row0 = src + srcStride * (y * 2);
+        const unsigned char* row1 = (srcHeight > 1) ? row0 + srcStride : row0;
+        int x = 0;
+
+#ifdef MIP_SIMD
+        if(simd)
+        {
+            // it reads 32 + channelCount bytes per step
+            for(; x + 4 <= dstWidth && (size_t)x * 2 * channelCount + 32 + channelCount <= srcStride; x += 4)
+            {
+                const unsigned char* s0 = row0 + (size_t)x * 2 * channelCount;
+                const unsigned char* s1 = row1 + (size_t)x * 2 * channelCount;
+                __m128i v0 = average16(s0, s1, channelCount);
+                __m128i v1 = average16(s0 + 16, s1 + 16, channelCount);
+                __m128i v = _mm_or_si128(_mm_shuffle_epi8(v0, mask0), _mm_shuffle_epi8(v1, mask1));
+                if(channelCount == 4)
+                {
+                    _mm_storeu_si128((__m128i*)dst, v);
+                }
+                else
+                {
+                    // 12 bytes exactly, the next row may be written by another thread
+                    _mm_storel_epi64((__m128i*)dst, v);
+                    int last = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+                    memcpy(dst + 8, &last, 4);
+                }
+                dst += 4 * channelCount;
+            }
+        }
+#endif
+
+        for(; x < dstWidth; ++x)
+        {
+            const unsigned char* s0 = row0 + (size_t)x * 2 * channelCount;
+            const unsigned char* s1 = row1 + (size_t)x * 2 * channelCount;
+            for(int c = 0; c < channelCount; ++c)
+                *dst++ = (unsigned char)((s0[c] + s0[c + nextColumn] + s1[c] + s1[c + nextColumn] + 2) >> 2);
+        }
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// box filter in linear space, alpha (4th channel) is averaged as is
+///////////////////////////////////////////////////////////////////////////////
+void MipChain::halveRowsGamma(const unsigned char* src, int srcWidth, int srcHeight, unsigned char* dst,
+                              int dstWidth, int yBegin, int yEnd, int channelCount)
+{
+    const GammaTable& gamma = getGammaTable();
+    size_t srcStride = (size_t)srcWidth * channelCount;
+    int nextColumn = (srcWidth > 1) ? channelCount : 0;
+    int colorCount = std::min(channelCount, 3);
+    dst += (size_t)dstWidth * channelCount * yBegin;
+
+    for(int y = yBegin; y < yEnd; ++y)
+    {
+        const unsigned char* row0 = src + srcStride * (y * 2);
+        const unsigned char* row1 = (srcHeight > 1) ? row0 + srcStride : row0;
+        for(int x = 0; x < dstWidth; ++x)
+        {
+            const unsigned char* s0 = row0 + (size_t)x * 2 * channelCount;
+            const unsigned char* s1 = row1 + (size_t)x * 2 * channelCount;
+            for(int c = 0; c < colorCount; ++c)
+            {
+                float sum = gamma.toLinear[s0[c]] + gamma.toLinear[s0[c + nextColumn]] +
+                            gamma.toLinear[s1[c]] + gamma.toLinear[s1[c + nextColumn]];
+                dst[c] = gamma.encode(sum * 0.25f);
+            }
+            for(int c = colorCount; c < channelCount; ++c)
+                dst[c] = (unsigned char)((s0[c] + s0[c + nextColumn] + s1[c] + s1[c + nextColumn] + 2) >> 2);
+            dst += channelCount;
+        }
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// separable Kaiser filter of rows [yBegin, yEnd)
+// Each destination row accumulates the source rows of the vertical taps into
+// a float row (vectorized by the compiler), then the horizontal taps are
+// applied to the float row.
+///////////////////////////////////////////////////////////////////////////////
+void MipChain::kaiserRows(const unsigned char* src, int srcWidth, unsigned char* dst, int dstWidth,
+                          int yBegin, int yEnd) const
+{
+    const GammaTable& gamma = getGammaTable();
+    const float* toLinear = gamma.toLinear;
+    size_t srcStride = (size_t)srcWidth * channelCount;
+    int colorCount = gammaCorrect ? std::min(channelCount, 3) : 0;  // channels in linear space
+    std::vector<float> row(srcStride);
+    dst += (size_t)dstWidth * channelCount * yBegin;
+
+    for(int y = yBegin; y < yEnd; ++y)
+    {
+        // vertical
+        std::fill(row.begin(), row.end(), 0.0f);
+        for(int k = 0; k < tapsY.tapCount; ++k)
+        {
+            float weight = tapsY.weights[y * tapsY.tapCount + k];
+            if(weight == 0)
+                continue;
+            const unsigned char* s = src + srcStride * tapsY.indices[y * tapsY.tapCount + k];
+            if(colorCount == 0)
+            {
+                for(size_t i = 0; i < srcStride; ++i)
+                    row[i] += s[i] * weight;
+            }
+            else
+            {
+                for(size_t i = 0; i < srcStride; i += channelCount)
+                {
+                    for(int c = 0; c < colorCount; ++c)
+                        row[i + c] += toLinear[s[i + c]] * weight;
+                    for(int c = colorCount; c < channelCount; ++c)
+                        row[i + c] += s[i + c] * weight;
+                }
+            }
+        }
+
+        // horizontal
+        for(int x = 0; x < dstWidth; ++x)
+        {
+            float sum[4] = { 0, 0, 0, 0 };
+            const int* indices = &tapsX.indices[x * tapsX.tapCount];
+            const float* weights = &tapsX.weights[x * tapsX.tapCount];
+            for(int k = 0; k < tapsX.tapCount; ++k)
+            {
+                const float* s = &row[(size_t)indices[k] * channelCount];
+                for(int c = 0; c < channelCount; ++c)
+                    sum[c] += s[c] * weights[k];
+            }
+            for(int c = 0; c < colorCount; ++c)
+                dst[c] = gamma.encode(sum[c]);
+            for(int c = colorCount; c < channelCount; ++c)
+                dst[c] = (unsigned char)std::min(std::max(sum[c] + 0.5f, 0.0f), 255.0f);
+            dst += channelCount;
+        }
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Kaiser-windowed sinc taps for each destination texel
+// The distance is in destination texels, so the cutoff is at the Nyquist
+// frequency of the destination. The weights are normalized to 1.
+///////////////////////////////////////////////////////////////////////////////
+void MipChain::computeTaps(int srcSize, int dstSize, FilterTaps& taps)
+{
+    float scale = (float)srcSize / dstSize;
+    float support = KAISER_RADIUS * scale;  // in source texels
+    taps.tapCount = (int)ceilf(support * 2) + 1;
+    taps.indices.resize((size_t)dstSize * taps.tapCount);
+    taps.weights.resize((size_t)dstSize * taps.tapCount);
+
+    float i0Alpha = besselI0(KAISER_ALPHA);
+    for(int i = 0; i < dstSize; ++i)
+    {
+        float center = (i + 0.5f) * scale;
+        int first = (int)floorf(center - support + 0.5f);
+        float sum = 0;
+        for(int k = 0; k < taps.tapCount; ++k)
+        {
+            int j = first + k;
+            float t = (j + 0.5f - center) / scale;
+            float weight = 0;
+            if(fabsf(t) < KAISER_RADIUS)
+            {
+                float r = t / KAISER_RADIUS;
+                float sinc = (t == 0) ? 1.0f : sinf(PI * t) / (PI * t);
+                weight = sinc * besselI0(KAISER_ALPHA * sqrtf(1 - r * r)) / i0Alpha;
+            }
+            taps.indices[i * taps.tapCount + k] = std::min(std::max(j, 0), srcSize - 1);
+            taps.weights[i * taps.tapCount + k] = weight;
+            sum += weight;
+        }
+        for(int k = 0; k < taps.tapCount; ++k)
+            taps.weights[i * taps.tapCount + k] /= sum;
+    }
+}
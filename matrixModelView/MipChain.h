@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+// MipChain.h
+// ==========
+// mipmap levels of an 8-bit RGB or RGBA image, built on the CPU
+// All levels are stored in a single buffer, from the base level down to 1x1.
+// The size of the next level is half of the previous one (rounded down, at
+// least 1), same as OpenGL 2.0 non-power-of-two textures, so each level can
+// be uploaded by glTexImage2D() as is without any rescale.
+//
+// Filters:
+// MIP_FILTER_BOX    : average of 2x2 texels with rounding (SSSE3 if available),
+//                     the last column/row of an odd size is not sampled
+// MIP_FILTER_KAISER : separable Kaiser-windowed sinc, 8 taps per axis for 2:1,
+//                     sharper than box, and covers odd sizes without a gap
+// With gamma correction, RGB is averaged in linear space (the image is sRGB),
+// so the small levels do not get darker. Alpha is always linear.
+// The large levels are split by rows among threads.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef MIP_CHAIN_H
+#define MIP_CHAIN_H
+
+#include <stddef.h>
+#include <vector>
+
+// SSSE3 box filter for 3/4-channel images
+#if !defined(MIP_NO_SIMD) && (defined(__SSSE3__) || defined(__AVX2__))
+#define MIP_SIMD
+#endif
+
+enum MipFilter
+{
+    MIP_FILTER_BOX = 0,
+    MIP_FILTER_KAISER
+};
+
+struct MipLevel
+{
+    int width;
+    int height;
+    size_t offset;                          // bytes from the beginning of the buffer
+};
+
+class MipChain
+{
+public:
+    MipChain();
+    ~MipChain() {}
+
+    // options of build()
+    void setFilter(MipFilter filter)        { this->filter = filter; }
+    void setGammaCorrect(bool flag)         { gammaCorrect = flag; }
+    void setThreadCount(int count)          { threadCount = count; }    // 0: # of hardware threads
+
+    // copy the base level from tightly packed pixels, then build the other levels
+    bool build(const unsigned char* pixels, int width, int height, int channelCount);
+    void clear();
+    void swap(MipChain& other);             // exchange levels without copy
+
+    int getLevelCount() const               { return (int)levels.size(); }
+    const MipLevel& getLevel(int level) const   { return levels[level]; }
+    const unsigned char* getPixels(int level) const { return &buffer[levels[level].offset]; }
+    int getChannelCount() const             { return channelCount; }
+    size_t getByteSize() const              { return buffer.size(); }   // all levels
+
+    // average 2x2 texels of src to dst, dst must be (srcWidth/2) x (srcHeight/2) at least 1
+    static void halve(const unsigned char* src, int srcWidth, int srcHeight,
+                      unsigned char* dst, int dstWidth, int dstHeight, int channelCount);
+    static void halveScalar(const unsigned char* src, int srcWidth, int srcHeight,
+                            unsigned char* dst, int dstWidth, int dstHeight, int channelCount);
+
+private:
+    // taps of 1D filter for each destination texel
+    struct FilterTaps
+    {
+        int tapCount;
+        std::vector<int> indices;           // source texels, clamped to edge
+        std::vector<float> weights;         // normalized
+    };
+
+    void buildLevel(int level);
+    void filterRows(int level, int yBegin, int yEnd) const;     // rows of the level from the previous level
+    static void halveRows(const unsigned char* src, int srcWidth, int srcHeight, unsigned char* dst,
+                          int dstWidth, int yBegin, int yEnd, int channelCount, bool simd);
+    static void halveRowsGamma(const unsigned char* src, int srcWidth, int srcHeight, unsigned char* dst,
+                               int dstWidth, int yBegin, int yEnd, int channelCount);
+    void kaiserRows(const unsigned char* src, int srcWidth, unsigned char* dst, int dstWidth,
+                    int yBegin, int yEnd) const;
+    static void computeTaps(int srcSize, int dstSize, FilterTaps& taps);
+
+    std::vector<MipLevel> levels;
+    std::vector<unsigned char> buffer;
+    int channelCount;
+    MipFilter filter;
+    bool gammaCorrect;
+    int threadCount;
+    FilterTaps tapsX;                       // Kaiser taps of the level being built
+    FilterTaps tapsY;
+};
+
+#endif
@@ -9,17 +9,18 @@
 #include <GL/gl.h>
 #endif
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include "ModelGL.h"
-#include "teapot.h"            
-#include "cameraSimple.h"      
+#include "Frustum.h"
+#ifdef _WIN32
 #include "gl/glut.h"
 #include "GL/GL.H"
 #include "GL/GLU.H"
 #include "GL/glui.h"
-#include "Cylinder.h"
 #include "GL/glaux.h"
-#include "BmpLoader.h"
+#endif
 
 // constants
 const float DEG2RAD = 3.141593f / 180;
@@ -31,8 +32,18 @@ const float CAMERA_ANGLE_Y = -45.0f;    // heading in degree
 const float CAMERA_DISTANCE = 25.0f;    // camera distance
 const int   SLIDER_POS_SHIFT = 10;
 
-GLuint g_Cube, g_Sphere, g_Cylinder, g_Cone;                          
-GLuint texture;                       
+// light and materials, same for the fixed pipeline and the core-profile path
+const float LIGHT_POSITION[4] = { 0, 1, 1, 0 };             // directional light in eye space
+const float LIGHT_AMBIENT[4] = { .3f, .3f, .3f, 1.0f };
+const float LIGHT_DIFFUSE[4] = { .8f, .8f, .8f, 1.0f };
+const float LIGHT_SPECULAR[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+const float SURFACE_SHININESS = 100.0f;
+const float CAMERA_AMBIENT[4] = { 0.3f, 0.3f, 0.3f, 1.0f };  // same as drawCamera() in cameraSimple.h
+const float CAMERA_DIFFUSE[4] = { 0.8f, 0.8f, 0.8f, 1.0f };
+const float CAMERA_SPECULAR[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+const float CAMERA_SHININESS = 32.0f;
+const float WHITE_COLOR[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
 //CString bitmap_name;
 
 // flat shading ===========================================
@@ -89,27 +100,81 @@ void main()
 }
 )";
 
+// blinn shading of instances =============================
+// same as above, but the model matrix and color come from per-instance
+// attributes; the instance matrix has uniform scale only
+const char* vsSource3 = R"(
+attribute mat4 instanceMatrix;
+attribute vec4 instanceColor;
+varying vec3 esVertex, esNormal;
+void main()
+{
+    vec4 worldVertex = instanceMatrix * gl_Vertex;
+    mat3 normalMatrix = mat3(instanceMatrix[0].xyz, instanceMatrix[1].xyz, instanceMatrix[2].xyz);
+    esVertex = vec3(gl_ModelViewMatrix * worldVertex);
+    esNormal = gl_NormalMatrix * (normalMatrix * gl_Normal);
+    gl_FrontColor = instanceColor;
+    gl_Position = gl_ModelViewProjectionMatrix * worldVertex;
+}
+)";
+const char* fsSource3 = R"(
+varying vec3 esVertex, esNormal;
+void main()
+{
+    vec3 normal = normalize(esNormal);
+    vec3 view = normalize(-esVertex);
+    vec3 light;
+    if(gl_LightSource[0].position.w == 0.0)
+    {
+        light = normalize(gl_LightSource[0].position.xyz);
+    }
+    else
+    {
+        light = normalize(gl_LightSource[0].position.xyz - esVertex);
+    }
+    vec3 halfVec = normalize(light + view);
+    vec4 color = gl_Color * gl_LightSource[0].ambient;
+    float dotNL = max(dot(normal, light), 0.0);
+    color += gl_Color * gl_LightSource[0].diffuse * dotNL;
+    float dotNH = max(dot(normal, halfVec), 0.0);
+    color += gl_FrontMaterial.specular * gl_FrontLightProduct[0].specular * pow(dotNH, gl_FrontMaterial.shininess);
+    gl_FragColor = vec4(color.rgb, gl_Color.a);
+}
+)";
+
+const int INSTANCE_FLOAT_COUNT = 20;    // matrix(16) + color(4) per instance
+
 
 
 ///////////////////////////////////////////////////////////////////////////////
 // default ctor
 ///////////////////////////////////////////////////////////////////////////////
-ModelGL::ModelGL() : windowWidth(0), windowHeight(0), povWidth(0),
-drawModeChanged(false), drawMode(0),
-cameraAngleX(CAMERA_ANGLE_X), cameraAngleY(CAMERA_ANGLE_Y),
-cameraDistance(CAMERA_DISTANCE), windowSizeChanged(false),
-glslSupported(false), glslReady(false), progId1(0), progId2(0)
+ModelGL::ModelGL() : pendingVersion(1), sceneVersion(0), mouseX(0), mouseY(0),
+x_first(0), y_first(0), x_last(0), y_last(0), pixelsPerUnit(1), frameScheduler(0),
+glslSupported(false), glslReady(false), progId1(0), progId2(0), corePathEnabled(true), coreReady(false),
+instancingReady(false), progId3(0), instanceMatrixLoc(-1), instanceColorLoc(-1), instanceVboId(0),
+instanceBoundsVersion(0), instanceBoundsSize(0), visibleInstanceCount(0)
 {
-    cameraPosition[0] = cameraPosition[1] = cameraPosition[2] = 0;
-    cameraAngle[0] = cameraAngle[1] = cameraAngle[2] = 0;
-    modelPosition[0] = modelPosition[1] = modelPosition[2] = 0;
-    modelAngle[0] = modelAngle[1] = modelAngle[2] = 0;
+    pending.windowWidth = pending.windowHeight = pending.povWidth = 0;
+    pending.windowSizeChanged = pending.drawModeChanged = false;
+    pending.drawMode = 0;
+    pending.cameraPosition[0] = pending.cameraPosition[1] = pending.cameraPosition[2] = 0;
+    pending.cameraAngle[0] = pending.cameraAngle[1] = pending.cameraAngle[2] = 0;
+    pending.modelPosition[0] = pending.modelPosition[1] = pending.modelPosition[2] = 0;
+    pending.modelAngle[0] = pending.modelAngle[1] = pending.modelAngle[2] = 0;
+    pending.object = pending.shape = 0;
+    pending.boxRotationOX = pending.boxRotationOY = pending.boxRotationOZ = false;
+    pending.flagFog = pending.move = pending.isDraw = false;
+    pending.sizeObject = 0;
+    pending.cameraAngleX = CAMERA_ANGLE_X;
+    pending.cameraAngleY = CAMERA_ANGLE_Y;
+    pending.cameraDistance = CAMERA_DISTANCE;
+    pending.instances = std::make_shared<const std::vector<SceneInstance> >();
+    pending.instancesVersion = 0;
+    scene = pending;
     bgColor[0] = bgColor[1] = bgColor[2] = bgColor[3] = 0;
-    boxRotationOX = false; boxRotationOY = false; boxRotationOZ = false; flagFog = false;
-    matrixView.identity();
-    matrixModel.identity();
-    matrixModelView.identity();
     matrixProjection.identity();
+    objectLodLevels[0] = objectLodLevels[1] = 0;
 }
 
 
@@ -121,70 +186,9 @@ ModelGL::~ModelGL()
 {
 }
 
-void LoadTexture(const char* filename) {
-    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-    BmpLoader bl(filename);
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGB, bl.iWidth, bl.iHeight, GL_RGB, GL_UNSIGNED_BYTE, bl.textureData);
-    //glGenTextures(1, &texture);  // Bắt đầu quá trình gen texture.
-    //glBindTexture(GL_TEXTURE_2D, texture);
-    //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    //glTexImage2D(GL_TEXTURE_2D, 0, 3, bl.iWidth, bl.iHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, bl.textureData);
-}
-
 ///////////////////////////////////////////////////////////////////////////////
 // initialize OpenGL states and scene
 ///////////////////////////////////////////////////////////////////////////////
-GLuint MakeCube(const float& size)
-{
-    GLuint boxDisplay;
-    boxDisplay = glGenLists(1);
-    glNewList(boxDisplay, GL_COMPILE);
-
-    glBegin(GL_QUADS);
-    // Front Face
-    glTexCoord2f(0.0f, 0.0f); glVertex3f(-size, -size, size);
-    glTexCoord2f(1.0f, 0.0f); glVertex3f(size, -size, size);
-    glTexCoord2f(1.0f, 1.0f); glVertex3f(size, size, size);
-    glTexCoord2f(0.0f, 1.0f); glVertex3f(-size, size, size);
-    // Back Face
-    glTexCoord2f(1.0f, 0.0f); glVertex3f(-size, -size, -size);
-    glTexCoord2f(1.0f, 1.0f); glVertex3f(-size, size, -size);
-    glTexCoord2f(0.0f, 1.0f); glVertex3f(size, size, -size);
-    glTexCoord2f(0.0f, 0.0f); glVertex3f(size, -size, -size);
-    // Top Face
-    glTexCoord2f(0.0f, 1.0f); glVertex3f(-size, size, -size);
-    glTexCoord2f(0.0f, 0.0f); glVertex3f(-size, size, size);
-    glTexCoord2f(1.0f, 0.0f); glVertex3f(size, size, size);
-    glTexCoord2f(1.0f, 1.0f); glVertex3f(size, size, -size);
-    // Bottom Face
-    glTexCoord2f(1.0f, 1.0f); glVertex3f(-size, -size, -size);
-    glTexCoord2f(0.0f, 1.0f); glVertex3f(size, -size, -size);
-    glTexCoord2f(0.0f, 0.0f); glVertex3f(size, -size, size);
-    glTexCoord2f(1.0f, 0.0f); glVertex3f(-size, -size, size);
-    // Right face
-    glTexCoord2f(1.0f, 0.0f); glVertex3f(size, -size, -size);
-    glTexCoord2f(1.0f, 1.0f); glVertex3f(size, size, -size);
-    glTexCoord2f(0.0f, 1.0f); glVertex3f(size, size, size);
-    glTexCoord2f(0.0f, 0.0f); glVertex3f(size, -size, size);
-    // Left Face
-    glTexCoord2f(0.0f, 0.0f); glVertex3f(-size, -size, -size);
-    glTexCoord2f(1.0f, 0.0f); glVertex3f(-size, -size, size);
-    glTexCoord2f(1.0f, 1.0f); glVertex3f(-size, size, size);
-    glTexCoord2f(0.0f, 1.0f); glVertex3f(-size, size, -size);
-    glEnd();
-
-    glEndList();
-    return boxDisplay;
-}
-
 void ModelGL::init()
 {
     glShadeModel(GL_SMOOTH);                        // shading mathod: GL_SMOOTH or GL_FLAT
@@ -211,6 +215,9 @@ void ModelGL::init()
     glDepthFunc(GL_LEQUAL);
 
     initLights();
+    meshCache.init();
+    helperCache.init();
+    textureManager.init();
 }
 
 
@@ -228,17 +235,65 @@ bool ModelGL::initShaders()
         glslSupported = extension.isSupported("GL_ARB_shader_objects");
         if (glslSupported)
             glslReady = createShaderPrograms();
+
+        // legacy instanced path needs GLSL 1.10 for the per-instance attributes
+        instancingReady = glslReady &&
+                          extension.isSupported("GL_ARB_draw_instanced") &&
+                          extension.isSupported("GL_ARB_instanced_arrays") &&
+                          extension.isSupported("GL_ARB_vertex_buffer_object") &&
+                          createInstanceProgram();
+
+        // core-profile path, the programs above are the fallback
+        if (glslSupported && CoreRenderer::isSupported() && coreRenderer.init())
+        {
+            coreRenderer.setLight(LIGHT_POSITION, LIGHT_AMBIENT, LIGHT_DIFFUSE, LIGHT_SPECULAR);
+            coreRenderer.setMaterial(CoreRenderer::MATERIAL_SURFACE, WHITE_COLOR, WHITE_COLOR, WHITE_COLOR, SURFACE_SHININESS);
+            coreRenderer.setMaterial(CoreRenderer::MATERIAL_CAMERA, CAMERA_AMBIENT, CAMERA_DIFFUSE, CAMERA_SPECULAR, CAMERA_SHININESS);
+        }
+
+        // per-instance matrices and colors, shared by both instanced paths
+        if (instancingReady || coreRenderer.isInstancingReady())
+            glGenBuffersARB(1, &instanceVboId);
+        updateCorePath();
     }
     return glslReady;
 }
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// enable/disable the core-profile path, it is used only if supported
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::setCorePathEnabled(bool enabled)
+{
+    corePathEnabled = enabled;
+    updateCorePath();
+}
+
+void ModelGL::updateCorePath()
+{
+    coreReady = corePathEnabled && coreRenderer.isReady();
+    meshCache.setGenericAttributes(coreReady);
+    helperCache.setGenericAttributes(coreReady);
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // clean up OpenGL objects
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::quit()
 {
+    if (instanceVboId)
+    {
+        glDeleteBuffersARB(1, &instanceVboId);
+        instanceVboId = 0;
+    }
+    coreRenderer.quit();
+    coreReady = false;
+    meshCache.clear();
+    helperCache.clear();
+    textureManager.clear();
 }
 
 
@@ -249,19 +304,15 @@ void ModelGL::quit()
 void ModelGL::initLights()
 {
     // set up light colors (ambient, diffuse, specular)
-    GLfloat lightKa[] = { .3f, .3f, .3f, 1.0f };    // ambient light
-    GLfloat lightKd[] = { .8f, .8f, .8f, 1.0f };    // diffuse light
-    GLfloat lightKs[] = { 1.0f, 1.0f, 1.0f, 1.0f }; // specular light
-    glLightfv(GL_LIGHT0, GL_AMBIENT, lightKa);
-    glLightfv(GL_LIGHT0, GL_DIFFUSE, lightKd);
-    glLightfv(GL_LIGHT0, GL_SPECULAR, lightKs);
-
-    GLfloat shininess = 100.0f;
+    glLightfv(GL_LIGHT0, GL_AMBIENT, LIGHT_AMBIENT);
+    glLightfv(GL_LIGHT0, GL_DIFFUSE, LIGHT_DIFFUSE);
+    glLightfv(GL_LIGHT0, GL_SPECULAR, LIGHT_SPECULAR);
+
+    GLfloat shininess = SURFACE_SHININESS;
     glMateriali(GL_FRONT, GL_SHININESS, shininess);
 
     // position the light in eye space
-    float lightPos[4] = { 0, 1, 1, 0 };        // directional light
-    glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
+    glLightfv(GL_LIGHT0, GL_POSITION, LIGHT_POSITION);
 
     glEnable(GL_LIGHT0);                            // MUST enable each light source after configuration
 }
@@ -315,11 +366,13 @@ void ModelGL::setCamera(float posX, float posY, float posZ, float targetX, float
     position[3] = 1.0f;
 
     // copy axis vectors to matrix
-    matrixView.identity();
-    matrixView.setColumn(0, left);
-    matrixView.setColumn(1, up);
-    matrixView.setColumn(2, forward);
-    matrixView.setColumn(3, position);
+    Lock lock(stateMutex);
+    pending.matrixView.identity();
+    pending.matrixView.setColumn(0, left);
+    pending.matrixView.setColumn(1, up);
+    pending.matrixView.setColumn(2, forward);
+    pending.matrixView.setColumn(3, position);
+    changed();
 }
 
 
@@ -330,18 +383,20 @@ void ModelGL::setCamera(float posX, float posY, float posZ, float targetX, float
 void ModelGL::setWindowSize(int width, int height)
 {
     // assign the width/height of viewport
-    windowWidth = width;
-    windowHeight = height;
+    Lock lock(stateMutex);
+    pending.windowWidth = width;
+    pending.windowHeight = height;
 
     // compute dim for point of view screen
-    povWidth = windowWidth / 2;
-    if (povWidth > windowHeight)
+    pending.povWidth = width / 2;
+    if (pending.povWidth > height)
     {
         // if it is wider than height, reduce to the height (make it square)
-        povWidth = windowHeight;
+        pending.povWidth = height;
     }
 
-    windowSizeChanged = true;
+    pending.windowSizeChanged = true;
+    changed();
 }
 
 
@@ -357,11 +412,20 @@ void ModelGL::setViewport(int x, int y, int w, int h)
     // set perspective viewing frustum
     Matrix4 matrix = setFrustum(FOV_Y, (float)(w) / h, NEAR_PLANE, FAR_PLANE); // FOV, AspectRatio, NearClip, FarClip
 
-    // copy projection matrix to OpenGL
-    glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(matrix.get());
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    // copy projection matrix to OpenGL, keep it for frustum culling and LOD
+    matrixProjection = matrix;
+    pixelsPerUnit = MeshLod::getPixelsPerUnit(matrix[5], h);
+    if (coreReady)
+    {
+        coreRenderer.setProjection(matrix);
+    }
+    else
+    {
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(matrix.get());
+        glMatrixMode(GL_MODELVIEW);
+        glLoadIdentity();
+    }
 }
 
 
@@ -378,11 +442,33 @@ void ModelGL::setViewportSub(int x, int y, int width, int height, float nearPlan
     // set perspective viewing frustum
     Matrix4 matrix = setFrustum(FOV_Y, (float)(width) / height, nearPlane, farPlane); // FOV, AspectRatio, NearClip, FarClip
 
-    // copy projection matrix to OpenGL
-    glMatrixMode(GL_PROJECTION);
-    glLoadMatrixf(matrix.get());
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    // copy projection matrix to OpenGL, keep it for frustum culling and LOD
+    matrixProjection = matrix;
+    pixelsPerUnit = MeshLod::getPixelsPerUnit(matrix[5], height);
+    if (coreReady)
+    {
+        coreRenderer.setProjection(matrix);
+    }
+    else
+    {
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(matrix.get());
+        glMatrixMode(GL_MODELVIEW);
+        glLoadIdentity();
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set the modelview matrix of the following draws
+// the core-profile path passes it as a uniform instead of GL_MODELVIEW
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::loadModelView(const Matrix4& matrix)
+{
+    matrixModelViewCurrent = matrix;
+    if (!coreReady)
+        glLoadMatrixf(matrix.get());
 }
 
 
@@ -397,142 +483,68 @@ void SetMaterialColor(GLfloat ambient[4], GLfloat diff_use[4])
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::draw()
 {
+    // use the same state for the whole frame
+    takeSnapshot();
+    updateInstanceBounds();
+    textureManager.update();                        // upload decoded textures within the budget
+
     drawSub1();
     drawSub2();
  
     // post frame
-    if (windowSizeChanged)
+    if (scene.windowSizeChanged)
     {
-        setViewport(0, 0, windowWidth, windowHeight);
-        windowSizeChanged = false;
+        setViewport(0, 0, scene.windowWidth, scene.windowHeight);
+        scene.windowSizeChanged = false;
     }
 
-    if (drawModeChanged)
+    if (scene.drawModeChanged)
     {
-        if (drawMode == 0)           // fill mode
+        if (scene.drawMode == 0)           // fill mode
         {
             glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
             glEnable(GL_DEPTH_TEST);
             glEnable(GL_CULL_FACE);
         }
-        else if (drawMode == 1)      // wireframe mode
+        else if (scene.drawMode == 1)      // wireframe mode
         {
             glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
             //glDisable(GL_DEPTH_TEST);
             glDisable(GL_CULL_FACE);
         }
-        else if (drawMode == 2)      // point mode
+        else if (scene.drawMode == 2)      // point mode
         {
             glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
             //glDisable(GL_DEPTH_TEST);
             glDisable(GL_CULL_FACE);
         }
-        drawModeChanged = false;
+        scene.drawModeChanged = false;
     }
 }
 
-void MakeSphere(double r, int lats, int longs) {
-    int i, j;
-    for (i = 0; i <= lats; i++) {
-        double lat0 = 3.14 * (-0.5 + (double)(i - 1) / lats);
-        double z0 = sin(lat0);
-        double zr0 = cos(lat0);
-
-        double lat1 = 3.14 * (-0.5 + (double)i / lats);
-        double z1 = sin(lat1);
-        double zr1 = cos(lat1);
-
-        glBegin(GL_QUAD_STRIP);
-        for (j = 0; j <= longs; j++) {
-            double lng = 2 * 3.14 * (double)(j - 1) / longs;
-            double x = cos(lng);
-            double y = sin(lng);
-
-            glNormal3f(x * zr0, y * zr0, z0);
-            glVertex3f(r * x * zr0, r * y * zr0, r * z0);
-            glNormal3f(x * zr1, y * zr1, z1);
-            glVertex3f(r * x * zr1, r * y * zr1, r * z1);
-        }
-        glEnd();
-    }
-}
 
-GLvoid draw_circle(const GLfloat radius, const GLuint num_vertex) // for fun 
-{
-    GLfloat vertex[4];
-    GLfloat texcoord[2];
 
-    const GLfloat delta_angle = 2.0 * 3.1415 / num_vertex;
-
-    //draw the vertex at the center of the circle
-    texcoord[0] = 0.5;
-    texcoord[1] = 0.5;
-    glTexCoord2fv(texcoord);
-
-    vertex[0] = vertex[1] = vertex[2] = 0.0;
-    vertex[3] = 1.0;
-    glVertex4fv(vertex);
-
-    for (int i = 0; i < num_vertex; i++)
-    {
-        texcoord[0] = (std::cos(delta_angle * i) + 1.0) * 0.5;
-        texcoord[1] = (std::sin(delta_angle * i) + 1.0) * 0.5;
-        glTexCoord2fv(texcoord);
-
-        vertex[0] = std::cos(delta_angle * i) * radius;
-        vertex[1] = std::sin(delta_angle * i) * radius;
-        vertex[2] = 0.0;
-        vertex[3] = 1.0;
-        glVertex4fv(vertex);
-    }
-
-    texcoord[0] = (1.0 + 1.0) * 0.5;
-    texcoord[1] = (0.0 + 1.0) * 0.5;
-    glTexCoord2fv(texcoord);
-
-    vertex[0] = 1.0 * radius;
-    vertex[1] = 0.0 * radius;
-    vertex[2] = 0.0;
-    vertex[3] = 1.0;
-    glVertex4fv(vertex);
-    glEnd();
-
-}
-
-void drawTorus(double r, double c, int rSeg, int cSeg)
+///////////////////////////////////////////////////////////////////////////////
+// copy the pending state to the scene state of this frame
+// the one-shot flags are cleared in the pending state once they are taken
+// The instances are not copied, the snapshot shares them with the pending state.
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::takeSnapshot()
 {
-    glFrontFace(GL_CW);
-
-    const double PI = 3.1415926535897932384626433832795;
-    const double TAU = 2 * PI;
-
-    for (int i = 0; i < rSeg; i++) {
-        glBegin(GL_QUAD_STRIP);
-        for (int j = 0; j <= cSeg; j++) {
-            for (int k = 0; k <= 1; k++) {
-                double s = (i + k) % rSeg + 0.5;
-                double t = j % (cSeg + 1);
-
-                double x = (c + r * cos(s * TAU / rSeg)) * cos(t * TAU / cSeg);
-                double y = (c + r * cos(s * TAU / rSeg)) * sin(t * TAU / cSeg);
-                double z = r * sin(s * TAU / rSeg);
-
-                double u = (i + k) / (float)rSeg;
-                double v = t / (float)cSeg;
-
-                glTexCoord2d(u, v);
-                //glNormal3f(2 * x, 2 * y, 2 * z);
-                glVertex3d(2 * x, 2 * y, 2 * z);
-            }
-        }
-        glEnd();
-    }
-
-    glFrontFace(GL_CCW);
+    SceneInstances previous;                // freed after unlock if it is the last reference
+    Lock lock(stateMutex);
+    if (sceneVersion == pendingVersion)
+        return;
+
+    previous = scene.instances;
+    scene = pending;
+    pending.windowSizeChanged = false;
+    pending.drawModeChanged = false;
+    sceneVersion = pendingVersion;
 }
 
 void ModelGL::DrawWithShape() {
-    switch (getModelShape()) {
+    switch (scene.shape) {
     case IDC_RADIO6: // POINT
         glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
         break;
@@ -543,17 +555,29 @@ void ModelGL::DrawWithShape() {
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
         break;
     case IDC_RADIO11: // TEXTURE
+        if (coreReady)
+        {
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            coreRenderer.setTexture(textureManager.getTexture("brics.bmp"));
+            break;
+        }
         glEnable(GL_TEXTURE_2D);
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        LoadTexture("brics.bmp");
+        glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        glBindTexture(GL_TEXTURE_2D, textureManager.getTexture("brics.bmp")); // placeholder until uploaded
         break;
     }
 }
 
 void ModelGL::DrawWithFog() { 
     float col[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-    GLfloat density = cameraDistance; 
+    GLfloat density = scene.cameraDistance; 
     GLfloat fogColor[4] = { 0.5, 0.5, 0.5, 1.0 }; 
+    if (coreReady)
+    {
+        coreRenderer.setFog(density, fogColor);
+        return;
+    }
     glEnable(GL_FOG);
     glFogi(GL_FOG_MODE, GL_EXP2);
     glFogfv(GL_FOG_COLOR, fogColor);
@@ -563,108 +587,402 @@ void ModelGL::DrawWithFog() {
 }
 
 void ModelGL::CloseDrawWithFog() {
-    glDisable(GL_FOG);
+    if (coreReady)
+        coreRenderer.disableFog();
+    else
+        glDisable(GL_FOG);
 }
 
 void ModelGL::CloseDrawWithShape() {
-    glDisable(GL_TEXTURE_2D);
+    if (coreReady)
+        coreRenderer.setTexture(0);
+    else
+        glDisable(GL_TEXTURE_2D);
 }
 
-void ModelGL::drawObject(int id_obj) {
+void ModelGL::drawObject(int id_obj, int lodLevel) {
     // set ambient and diffuse color using glColorMaterial (gold-yellow)
     float diffuseColor[4] = { 0.929524f, 0.796542f, 0.178823f, 1.0f };
-    glColor4fv(diffuseColor);
+    if (!coreReady)
+        glColor4fv(diffuseColor);
 
     // fog
-    if (getFlagFog()) DrawWithFog();
+    if (scene.flagFog) DrawWithFog();
     
     // get size draw a object
-    float size = getSizeObject();
+    float size = scene.sizeObject;
 
-    GLUquadricObj* quadratic_obj = gluNewQuadric();
-    GLuint boxDisplay;
-    
-    // make Cube
-    boxDisplay = glGenLists(4);
-    glNewList(boxDisplay + 0, GL_COMPILE);
-    MakeCube(size);
-    glEndList();
-    g_Cube = boxDisplay + 0;
-
-    // make Sphere
-    glNewList(boxDisplay + 1, GL_COMPILE);
-    gluQuadricDrawStyle(quadratic_obj, GLU_FILL);
-    gluQuadricTexture(quadratic_obj, GL_TRUE);
-    gluQuadricNormals(quadratic_obj, GLU_SMOOTH);
-    gluSphere(quadratic_obj, size, 32, 16);
-    glEndList();
-    g_Sphere = boxDisplay + 1;
-
-    // make Clinder for fun
-    glNewList(boxDisplay + 2, GL_COMPILE);
-    gluQuadricDrawStyle(quadratic_obj, GLU_FILL);
-    gluQuadricTexture(quadratic_obj, GL_TRUE);
-    gluQuadricNormals(quadratic_obj, GLU_SMOOTH);
-    gluCylinder(quadratic_obj, max(1, size/4), max(1, size/4), size, 32, 32);
-    glEndList();
-    g_Cylinder = boxDisplay + 2;
-    
-    // make Cone
-    glNewList(boxDisplay + 3, GL_COMPILE);
-    gluQuadricDrawStyle(quadratic_obj, GLU_FILL);
-    gluQuadricTexture(quadratic_obj, GL_TRUE);
-    gluQuadricNormals(quadratic_obj, GLU_SMOOTH);
-    gluCylinder(quadratic_obj, max(1, size / 4), 0, size, 32, 32);
-    glEndList();
-    g_Cone = boxDisplay + 3;
-
-    Cylinder cylinder(size, size, size*2, 36, 8);
-    Cylinder cylinder_line(size, size, size*2, 36, 8, false);
-    
     // draw object 
+    // meshes are built once per LOD level and reused until the size is changed
     DrawWithShape();
-    glPushMatrix();
+    if (coreReady)
+        coreRenderer.beginMesh(matrixModelViewCurrent, CoreRenderer::MATERIAL_SURFACE, diffuseColor);
+    else
+        glPushMatrix();
+    int shape;
+    MeshLod lod;
+    if (getObjectMesh(id_obj, shape, lod))
+        meshCache.draw(shape, size, lod.getSectorCount(lodLevel), lod.getStackCount(lodLevel));
+
+    if (coreReady)
+        coreRenderer.endMesh();
+    else
+        glPopMatrix();
+    CloseDrawWithShape();
+    CloseDrawWithFog();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// return the cached mesh of the object radio button and its LOD levels
+// level 0 is the full tessellation, the coarsest one keeps the silhouette
+///////////////////////////////////////////////////////////////////////////////
+bool ModelGL::getObjectMesh(int id_obj, int& shape, MeshLod& lod)
+{
     switch (id_obj) {
-    case IDC_RADIO1: // teapot
-        glutSolidTeapot(size);
-        break;
+    case IDC_RADIO1: // teapot, same size as glutSolidTeapot()
+        shape = MESH_TEAPOT;    lod.set(0, 0, 0, 0);
+        return true;
     case IDC_RADIO2: // cube
-        glCallList(g_Cube);
-        break;
+        shape = MESH_CUBE;      lod.set(1, 1, 1, 1);
+        return true;
     case IDC_RADIO3: // torus
-        drawTorus(size / 2, size, 3, 3);
-        break;
+        shape = MESH_TORUS;     lod.set(3, 3, 3, 3);
+        return true;
     case IDC_RADIO4: // sphere
-        glCallList(g_Sphere);
-        break;
+        shape = MESH_SPHERE;    lod.set(32, 16, 8, 4);
+        return true;
     case IDC_RADIO5: // cylinder
-        cylinder.draw();
-        break;
+        shape = MESH_CYLINDER;  lod.set(36, 8, 9, 1);
+        return true;
     case IDC_RADIO9: // wheel
-        drawTorus(size / 2, size, 64, 64);
-        break;
+        shape = MESH_TORUS;     lod.set(64, 64, 8, 8);
+        return true;
     case IDC_RADIO10: // cone
-        glCallList(g_Cone);
-        break;
+        shape = MESH_CONE;      lod.set(32, 32, 8, 1);
+        return true;
+    }
+    return false;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// test the bounding box of the object against the current projection
+// matrixModelView transforms the object to eye space
+///////////////////////////////////////////////////////////////////////////////
+bool ModelGL::isObjectVisible(int id_obj, const Matrix4& matrixModelView)
+{
+    int shape;
+    MeshLod lod;
+    if (!getObjectMesh(id_obj, shape, lod))
+        return false;
+
+    Frustum frustum(matrixProjection * matrixModelView);
+    return frustum.testBox(meshCache.getBounds(shape, scene.sizeObject, lod.getSectorCount(0), lod.getStackCount(0)));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// choose the LOD level of the object from its size in the current viewport
+// the level of the last frame in the view is kept for hysteresis
+///////////////////////////////////////////////////////////////////////////////
+int ModelGL::selectObjectLod(int id_obj, const Matrix4& matrixModelView, int view)
+{
+    int shape;
+    MeshLod lod;
+    if (!getObjectMesh(id_obj, shape, lod))
+        return 0;
+
+    // the model matrix is rigid, so the radius is same in eye space
+    const BoundingBox& bounds = meshCache.getBounds(shape, scene.sizeObject, lod.getSectorCount(0), lod.getStackCount(0));
+    float diameter = MeshLod::getScreenDiameter(matrixModelView * bounds.getCenter(), bounds.getRadius(), pixelsPerUnit);
+    objectLodLevels[view] = lod.selectLevel(diameter, objectLodLevels[view]);
+    return objectLodLevels[view];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// replace the instance list
+// keep them sorted by object, so an object is drawn with a single call
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::setInstances(const std::vector<SceneInstance>& instances)
+{
+    // sort a new vector outside of the lock, then swap the pointer
+    std::shared_ptr<std::vector<SceneInstance> > sorted = std::make_shared<std::vector<SceneInstance> >(instances);
+    std::stable_sort(sorted->begin(), sorted->end(),
+                     [](const SceneInstance& a, const SceneInstance& b) { return a.object < b.object; });
+
+    SceneInstances previous;                // freed after unlock if it is the last reference
+    Lock lock(stateMutex);
+    previous = pending.instances;
+    pending.instances = sorted;
+    ++pending.instancesVersion;
+    changed();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// compute world-space bounding boxes of the instances
+// it is done only when the instances or the object size are changed, not when
+// the camera or the model moves
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::updateInstanceBounds()
+{
+    const std::vector<SceneInstance>& instances = *scene.instances;
+    if (instanceBoundsVersion == scene.instancesVersion && instanceBoundsSize == scene.sizeObject &&
+        instanceBounds.size() == instances.size())
+        return;
+
+    instanceBounds.resize(instances.size());
+    instanceVisible.resize(instances.size());
+    instancesWithoutMesh.clear();
+
+    // same object has the same mesh bounds, look it up once per object
+    BoundingBox bounds;
+    bool hasMesh = false;
+    int object = -1;
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        if (instances[i].object != object)
+        {
+            object = instances[i].object;
+            int shape;
+            MeshLod lod;
+            hasMesh = getObjectMesh(object, shape, lod);
+            if (hasMesh)
+                bounds = meshCache.getBounds(shape, scene.sizeObject, lod.getSectorCount(0), lod.getStackCount(0));
+            else
+                bounds = BoundingBox();     // a point, culled after the frustum test
+        }
+        instanceBounds[i] = bounds.transform(instances[i].matrix);
+        if (!hasMesh)
+            instancesWithoutMesh.push_back((int)i);
+    }
+    instanceBoundsVersion = scene.instancesVersion;
+    instanceBoundsSize = scene.sizeObject;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw the instances inside of the current projection
+// matrixView transforms from world space to eye space
+// The visible instances are grouped into batches by object and LOD level.
+// With GL_ARB_instanced_arrays, the matrices and colors are streamed into a
+// VBO in batch order, and each batch is drawn by a single
+// glDrawElementsInstancedARB() call. Otherwise, they are drawn one by one.
+///////////////////////////////////////////////////////////////////////////////
+int ModelGL::drawInstances(const Matrix4& matrixView, int view)
+{
+    const std::vector<SceneInstance>& instances = *scene.instances;
+    if (instances.empty())
+        return 0;
+
+    Frustum frustum(matrixProjection * matrixView);
+    int visibleCount = frustum.testBoxes(&instanceBounds[0], (int)instanceBounds.size(), &instanceVisible[0]);
+
+    // nothing to draw for the objects without mesh, do not count them
+    for (size_t i = 0; i < instancesWithoutMesh.size(); ++i)
+    {
+        unsigned char& visible = instanceVisible[instancesWithoutMesh[i]];
+        if (visible)
+        {
+            visible = 0;
+            --visibleCount;
+        }
+    }
+    if (visibleCount == 0)
+        return 0;
+
+    // choose LOD levels, the levels of the last frame are kept for hysteresis
+    std::vector<unsigned char>& levels = instanceLodLevels[view];
+    if (levels.size() != instances.size())
+        levels.assign(instances.size(), 0);
+
+    instanceBatches.clear();
+    int begin = 0;
+    while (begin < (int)instances.size())
+    {
+        int object = instances[begin].object;
+        int end = begin;
+        while (end < (int)instances.size() && instances[end].object == object)
+            ++end;
+
+        int shape;
+        MeshLod lod;
+        if (getObjectMesh(object, shape, lod))
+        {
+            int counts[MeshLod::MAX_LEVELS] = { 0 };
+            for (int i = begin; i < end; ++i)
+            {
+                if (!instanceVisible[i])
+                    continue;
+                const BoundingBox& bounds = instanceBounds[i];
+                float diameter = MeshLod::getScreenDiameter(matrixView * bounds.getCenter(), bounds.getRadius(), pixelsPerUnit);
+                levels[i] = (unsigned char)lod.selectLevel(diameter, levels[i]);
+                ++counts[levels[i]];
+            }
+
+            for (int level = 0; level < lod.getLevelCount(); ++level)
+            {
+                if (counts[level] == 0)
+                    continue;
+                InstanceBatch batch = { shape, lod.getSectorCount(level), lod.getStackCount(level),
+                                        level, begin, end, counts[level] };
+                instanceBatches.push_back(batch);
+            }
+        }
+        begin = end;
+    }
+
+    loadModelView(matrixView);
+    if (scene.flagFog) DrawWithFog();
+    DrawWithShape();
+
+    // each path has its own readiness; the core path uses the fixed
+    // attribute locations of CoreRenderer, the legacy path those of progId3
+    bool instanced = coreReady ? coreRenderer.isInstancingReady() : instancingReady;
+    GLint matrixLoc = coreReady ? (GLint)MESH_ATTRIB_INSTANCE_MATRIX : instanceMatrixLoc;
+    GLint colorLoc = coreReady ? (GLint)MESH_ATTRIB_COLOR : instanceColorLoc;
+    if (instanced && instanceVboId)
+    {
+        // pack visible instances in batch order
+        instanceData.resize((size_t)visibleCount * INSTANCE_FLOAT_COUNT);
+        float* data = &instanceData[0];
+        for (size_t b = 0; b < instanceBatches.size(); ++b)
+        {
+            const InstanceBatch& batch = instanceBatches[b];
+            for (int i = batch.begin; i < batch.end; ++i)
+            {
+                if (!instanceVisible[i] || levels[i] != batch.level)
+                    continue;
+                memcpy(data, instances[i].matrix.get(), sizeof(float) * 16);
+                memcpy(data + 16, instances[i].color, sizeof(float) * 4);
+                data += INSTANCE_FLOAT_COUNT;
+            }
+        }
+
+        // orphan the previous storage, the last draw may still use it
+        GLsizeiptrARB dataSize = sizeof(float) * instanceData.size();
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, instanceVboId);
+        glBufferDataARB(GL_ARRAY_BUFFER_ARB, dataSize, 0, GL_STREAM_DRAW_ARB);
+        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, 0, dataSize, &instanceData[0]);
+        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+        if (coreReady)
+        {
+            coreRenderer.beginInstances(matrixView, CoreRenderer::MATERIAL_SURFACE);
+        }
+        else
+        {
+            glUseProgram(progId3);
+            glDisable(GL_COLOR_MATERIAL);
+        }
+
+        // one draw call per batch
+        const GLsizei stride = sizeof(float) * INSTANCE_FLOAT_COUNT;
+        int first = 0;
+        for (size_t b = 0; b < instanceBatches.size(); ++b)
+        {
+            const InstanceBatch& batch = instanceBatches[b];
+            if (!meshCache.bind(batch.shape, scene.sizeObject, batch.sectorCount, batch.stackCount))
+            {
+                first += batch.count;
+                continue;
+            }
+
+            // set the per-instance attributes after bind(), they go into the
+            // VAO of the mesh on the core path, so disable them before unbind()
+            const char* base = (const char*)0 + stride * first;
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, instanceVboId);
+            for (int j = 0; j < 4; ++j)
+            {
+                glEnableVertexAttribArrayARB(matrixLoc + j);
+                glVertexAttribDivisorARB(matrixLoc + j, 1);
+                glVertexAttribPointerARB(matrixLoc + j, 4, GL_FLOAT, GL_FALSE, stride, base + sizeof(float) * 4 * j);
+            }
+            glEnableVertexAttribArrayARB(colorLoc);
+            glVertexAttribDivisorARB(colorLoc, 1);
+            glVertexAttribPointerARB(colorLoc, 4, GL_FLOAT, GL_FALSE, stride, base + sizeof(float) * 16);
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+            meshCache.drawBound(batch.count);
+
+            for (int j = 0; j < 4; ++j)
+            {
+                glVertexAttribDivisorARB(matrixLoc + j, 0);
+                glDisableVertexAttribArrayARB(matrixLoc + j);
+            }
+            glVertexAttribDivisorARB(colorLoc, 0);
+            glDisableVertexAttribArrayARB(colorLoc);
+            meshCache.unbind();
+            first += batch.count;
+        }
+
+        if (coreReady)
+        {
+            coreRenderer.endMesh();
+        }
+        else
+        {
+            glEnable(GL_COLOR_MATERIAL);
+            glUseProgram(0);
+        }
+    }
+    else
+    {
+        // fallback: a draw call per instance
+        if (coreReady)
+            coreRenderer.beginMesh(matrixView, CoreRenderer::MATERIAL_SURFACE, WHITE_COLOR);
+        for (size_t b = 0; b < instanceBatches.size(); ++b)
+        {
+            const InstanceBatch& batch = instanceBatches[b];
+            for (int i = batch.begin; i < batch.end; ++i)
+            {
+                if (!instanceVisible[i] || levels[i] != batch.level)
+                    continue;
+                if (coreReady)
+                {
+                    coreRenderer.setMeshTransform(matrixView * instances[i].matrix, instances[i].color);
+                    meshCache.draw(batch.shape, scene.sizeObject, batch.sectorCount, batch.stackCount);
+                }
+                else
+                {
+                    glPushMatrix();
+                    glMultMatrixf(instances[i].matrix.get());
+                    glColor4fv(instances[i].color);
+                    meshCache.draw(batch.shape, scene.sizeObject, batch.sectorCount, batch.stackCount);
+                    glPopMatrix();
+                }
+            }
+        }
+        if (coreReady)
+            coreRenderer.endMesh();
     }
 
-    glPopMatrix();
-    for (int i = 0; i < 4; i++) glDeleteLists(boxDisplay + i, 1);
     CloseDrawWithShape();
     CloseDrawWithFog();
+    return visibleCount;
 }
 
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // draw left window (view from the camera)
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::drawSub1()
 {
     // clear buffer (whole area)
-    setViewportSub(0, 0, windowWidth, windowHeight, 1, 10);
+    setViewportSub(0, 0, scene.windowWidth, scene.windowHeight, 1, 10);
     glClearColor(bgColor[0], bgColor[1], bgColor[2], bgColor[3]);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
     // make left viewport square viewport
+    int windowHeight = scene.windowHeight;
+    int povWidth = scene.povWidth;
     if (windowHeight > povWidth)
         setViewportSub(0, (windowHeight - povWidth) / 2, povWidth, povWidth, 1, 10);
     else
@@ -675,8 +993,6 @@ void ModelGL::drawSub1()
     glClearColor(0.2f, 0.2f, 0.2f, 1);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-    glPushMatrix();
-
     // set view matrix ========================================================
     // copy the matrix to OpenGL GL_MODELVIEW matrix
     // See updateViewMatrix() how matrixView is constructed. The equivalent
@@ -686,7 +1002,7 @@ void ModelGL::drawSub1()
     //    glRotatef(-cameraAngle[1], 0, 1, 0); // heading (Y)
     //    glRotatef(-cameraAngle[0], 1, 0, 0); // pitch (X)
     //    glTranslatef(-cameraPosition[0], -cameraPosition[1], -cameraPosition[2]);
-    glLoadMatrixf(matrixView.get());
+    loadModelView(scene.matrixView);
     // always draw the grid at the origin (before any modeling transform)
     drawGrid(10, 1);
 
@@ -705,27 +1021,36 @@ void ModelGL::drawSub1()
     // before drawing the object:
     // ModelView_M = View_M * Model_M
     // This modelview matrix transforms the objects from object space to eye space.
-    glLoadMatrixf(matrixModelView.get());
+    loadModelView(scene.matrixModelView);
 
     // draw a teapot and axis after ModelView transform
     // v' = Mmv * v
     drawAxis(4);
 
-    if (glslReady)
+    // skip the object if it is outside of the camera view
+    bool visible = isObjectVisible(scene.object, scene.matrixModelView);
+    int lodLevel = visible ? selectObjectLod(scene.object, scene.matrixModelView, 0) : 0;
+    if (visible && coreReady)
+    {
+        // program and uniforms are set by drawObject()
+        drawObject(scene.object, lodLevel);
+    }
+    else if (visible && glslReady)
     {
         // use GLSL
         glUseProgram(progId2);
         glDisable(GL_COLOR_MATERIAL);
-        drawObject(getModelObject());
+        drawObject(scene.object, lodLevel);
         glEnable(GL_COLOR_MATERIAL);
         glUseProgram(0);
     }
-    else
+    else if (visible)
     {
-        drawObject(getModelObject());
+        drawObject(scene.object, lodLevel);
     }
 
-    glPopMatrix();  
+    // instances are in world space
+    visibleInstanceCount = drawInstances(scene.matrixView, 0);
 }
 
 
@@ -736,21 +1061,18 @@ void ModelGL::drawSub1()
 void ModelGL::drawSub2()
 {
     // set right viewport
-    setViewportSub(povWidth, 0, windowWidth - povWidth, windowHeight, NEAR_PLANE, FAR_PLANE);
+    setViewportSub(scene.povWidth, 0, scene.windowWidth - scene.povWidth, scene.windowHeight, NEAR_PLANE, FAR_PLANE);
 
     // it is done in drawSub1(), no need to clear buffer
     glClearColor(bgColor[0], bgColor[1], bgColor[2], bgColor[3]);   // background color
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-    glPushMatrix();
-
     // First, transform the camera (viewing matrix) from world space to eye space
-    Matrix4 matView, matModel, matModelView;
-    matView.identity();
-    matView.rotateY(cameraAngleY);
-    matView.rotateX(cameraAngleX);
-    matView.translate(0, 0, -cameraDistance);
-    glLoadMatrixf(matView.get());
+    // ORDER: rotY -> rotX -> translation
+    Matrix4 matView = Matrix4::fromEulerTRS(scene.cameraAngleX, scene.cameraAngleY, 0,
+                                            0, 0, -scene.cameraDistance);
+    Matrix4 matModel, matModelView;
+    loadModelView(matView);
     // equivalent OpenGL calls
     //glTranslatef(0, 0, -cameraDistance);
     //glRotatef(cameraAngleX, 1, 0, 0); // pitch
@@ -760,12 +1082,12 @@ void ModelGL::drawSub2()
     drawGrid(7, 1);
 
     // transform teapot
-    matModel.rotateZ(modelAngle[2]);
-    matModel.rotateY(modelAngle[1]);
-    matModel.rotateX(modelAngle[0]);
-    matModel.translate(modelPosition[0], modelPosition[1], modelPosition[2]);
+    const float* modelAngle = scene.modelAngle;
+    const float* modelPosition = scene.modelPosition;
+    matModel = Matrix4::fromEulerTRS(modelAngle[0], modelAngle[1], modelAngle[2],
+                                     modelPosition[0], modelPosition[1], modelPosition[2]);
     matModelView = matView * matModel;
-    glLoadMatrixf(matModelView.get());
+    loadModelView(matModelView);
     // equivalent OpenGL calls
     //glTranslatef(modelPosition[0], modelPosition[1], modelPosition[2]);
     //glRotatef(modelAngle[0], 1, 0, 0);
@@ -775,38 +1097,47 @@ void ModelGL::drawSub2()
     // draw a teapot and axis
     drawAxis(4);
 
-    if (glslReady)
+    bool visible = isObjectVisible(scene.object, matModelView);
+    int lodLevel = visible ? selectObjectLod(scene.object, matModelView, 1) : 0;
+    if (visible && coreReady)
+    {
+        drawObject(scene.object, lodLevel);
+    }
+    else if (visible && glslReady)
     {
         glUseProgram(progId2);
         glDisable(GL_COLOR_MATERIAL);
-        drawObject(getModelObject());
+        drawObject(scene.object, lodLevel);
         glEnable(GL_COLOR_MATERIAL);
         glUseProgram(0);
     }
-    else
+    else if (visible)
     {
-        drawObject(getModelObject());
+        drawObject(scene.object, lodLevel);
     }
 
-    // draw camera axis
-    matModel.identity();
-    matModel.rotateY(180);  // facing to -Z axis
-    matModel.rotateZ(-cameraAngle[2]);
-    matModel.rotateY(cameraAngle[1]);
-    matModel.rotateX(-cameraAngle[0]);
-    matModel.translate(cameraPosition[0], cameraPosition[1], cameraPosition[2]);
-    matModelView = matView * matModel;
-    glLoadMatrixf(matModelView.get());
+    drawInstances(matView, 1);
+
+    // transform of camera object, the axis and the body share the rotation
+    const float* cameraAngle = scene.cameraAngle;
+    const float* cameraPosition = scene.cameraPosition;
+    matModel = Matrix4::fromEulerTRS(-cameraAngle[0], cameraAngle[1], -cameraAngle[2],
+                                     cameraPosition[0], cameraPosition[1], cameraPosition[2]);
+
+    // draw camera axis facing to -Z axis, same as rotateY(180) first:
+    // negate the 1st and 3rd columns instead of another rotation
+    const float* m = matModel.get();
+    Matrix4 matAxis(-m[0], -m[1], -m[2], -m[3],
+                     m[4],  m[5],  m[6],  m[7],
+                    -m[8], -m[9], -m[10], -m[11],
+                     m[12], m[13], m[14], m[15]);
+    matModelView = matView * matAxis;
+    loadModelView(matModelView);
     drawAxis(0.8f);
 
     // transform camera object
-    matModel.identity();
-    matModel.rotateZ(-cameraAngle[2]);
-    matModel.rotateY(cameraAngle[1]);
-    matModel.rotateX(-cameraAngle[0]);
-    matModel.translate(cameraPosition[0], cameraPosition[1], cameraPosition[2]);
     matModelView = matView * matModel;
-    glLoadMatrixf(matModelView.get());
+    loadModelView(matModelView);
     // equivalent OpenGL calls
     //glTranslatef(cameraPosition[0], cameraPosition[1], cameraPosition[2]);
     //glRotatef(-cameraAngle[0], 1, 0, 0);
@@ -816,8 +1147,6 @@ void ModelGL::drawSub2()
     // draw the camera
     drawCamera();
     drawFrustum(FOV_Y, 1, 2, 7);
-
-    glPopMatrix();
 }
 
 
@@ -827,39 +1156,17 @@ void ModelGL::drawSub2()
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::drawGrid(float size, float step)
 {
-    // disable lighting
-    glDisable(GL_LIGHTING);
-
-    glBegin(GL_LINES);
-
-    glColor3f(0.3f, 0.3f, 0.3f);
-    for (float i = step; i <= size; i += step)
-    {
-        glVertex3f(-size, 0, i);   // lines parallel to X-axis
-        glVertex3f(size, 0, i);
-        glVertex3f(-size, 0, -i);   // lines parallel to X-axis
-        glVertex3f(size, 0, -i);
-
-        glVertex3f(i, 0, -size);   // lines parallel to Z-axis
-        glVertex3f(i, 0, size);
-        glVertex3f(-i, 0, -size);   // lines parallel to Z-axis
-        glVertex3f(-i, 0, size);
-    }
-
-    // x-axis
-    glColor3f(0.6f, 0.2f, 0.2f);
-    glVertex3f(-size, 0, 0);
-    glVertex3f(size, 0, 0);
-
-    // z-axis
-    glColor3f(0.2f, 0.2f, 0.6f);
-    glVertex3f(0, 0, -size);
-    glVertex3f(0, 0, size);
+    if (coreReady)
+        coreRenderer.beginLines(matrixModelViewCurrent);
+    else
+        glDisable(GL_LIGHTING);
 
-    glEnd();
+    helperCache.drawGrid(size, step);
 
-    // enable lighting back
-    glEnable(GL_LIGHTING);
+    if (coreReady)
+        coreRenderer.endLines();
+    else
+        glEnable(GL_LIGHTING);
 }
 
 
@@ -870,138 +1177,85 @@ void ModelGL::drawGrid(float size, float step)
 void ModelGL::drawAxis(float size)
 {
     glDepthFunc(GL_ALWAYS);     // to avoid visual artifacts with grid lines
-    glDisable(GL_LIGHTING);
-    glPushMatrix();             //NOTE: There is a bug on Mac misbehaviours of
+    if (coreReady)
+    {
+        coreRenderer.beginLines(matrixModelViewCurrent);
+    }
+    else
+    {
+        glDisable(GL_LIGHTING);
+        glPushMatrix();         //NOTE: There is a bug on Mac misbehaviours of
                                 //      the light position when you draw GL_LINES
                                 //      and GL_POINTS. remember the matrix.
+    }
 
-    // draw axis
-    glLineWidth(3);
-    glBegin(GL_LINES);
-    glColor3f(1, 0, 0);
-    glVertex3f(0, 0, 0);
-    glVertex3f(size, 0, 0);
-    glColor3f(0, 1, 0);
-    glVertex3f(0, 0, 0);
-    glVertex3f(0, size, 0);
-    glColor3f(0, 0, 1);
-    glVertex3f(0, 0, 0);
-    glVertex3f(0, 0, size);
-    glEnd();
-    glLineWidth(1);
-
-    // draw arrows(actually big square dots)
-    glPointSize(8);
-    glBegin(GL_POINTS);
-    glColor3f(1, 0, 0);
-    glVertex3f(size, 0, 0);
-    glColor3f(0, 1, 0);
-    glVertex3f(0, size, 0);
-    glColor3f(0, 0, 1);
-    glVertex3f(0, 0, size);
-    glEnd();
-    glPointSize(1);
+    // lines and arrows(actually big square dots)
+    helperCache.drawAxis(size);
 
     // restore default settings
-    glPopMatrix();
-    glEnable(GL_LIGHTING);
+    if (coreReady)
+    {
+        coreRenderer.endLines();
+    }
+    else
+    {
+        glPopMatrix();
+        glEnable(GL_LIGHTING);
+    }
     glDepthFunc(GL_LEQUAL);
 }
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// draw camera with the same material as drawCamera() in cameraSimple.h
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::drawCamera()
+{
+    if (coreReady)
+    {
+        // the material is in the uniform buffer
+        coreRenderer.beginMesh(matrixModelViewCurrent, CoreRenderer::MATERIAL_CAMERA, WHITE_COLOR);
+        meshCache.draw(MESH_CAMERA, 1, 0, 0);
+        coreRenderer.endMesh();
+        return;
+    }
+
+    // set specular and shiniess using glMaterial
+    glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, CAMERA_SHININESS); // range 0 ~ 128
+    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, CAMERA_SPECULAR);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, CAMERA_DIFFUSE);
+    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, CAMERA_AMBIENT);
+
+    // set ambient and diffuse color using glColorMaterial
+    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+    glColor3fv(CAMERA_DIFFUSE);
+
+    meshCache.draw(MESH_CAMERA, 1, 0, 0);
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // draw frustum
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::drawFrustum(float fovY, float aspectRatio, float nearPlane, float farPlane)
 {
-    float tangent = tanf(fovY / 2 * DEG2RAD);
-    float nearHeight = nearPlane * tangent;
-    float nearWidth = nearHeight * aspectRatio;
-    float farHeight = farPlane * tangent;
-    float farWidth = farHeight * aspectRatio;
-
-    // compute 8 vertices of the frustum
-    float vertices[8][3];
-    // near top right
-    vertices[0][0] = nearWidth;     vertices[0][1] = nearHeight;    vertices[0][2] = -nearPlane;
-    // near top left
-    vertices[1][0] = -nearWidth;    vertices[1][1] = nearHeight;    vertices[1][2] = -nearPlane;
-    // near bottom left
-    vertices[2][0] = -nearWidth;    vertices[2][1] = -nearHeight;   vertices[2][2] = -nearPlane;
-    // near bottom right
-    vertices[3][0] = nearWidth;     vertices[3][1] = -nearHeight;   vertices[3][2] = -nearPlane;
-    // far top right
-    vertices[4][0] = farWidth;      vertices[4][1] = farHeight;     vertices[4][2] = -farPlane;
-    // far top left
-    vertices[5][0] = -farWidth;     vertices[5][1] = farHeight;     vertices[5][2] = -farPlane;
-    // far bottom left
-    vertices[6][0] = -farWidth;     vertices[6][1] = -farHeight;    vertices[6][2] = -farPlane;
-    // far bottom right
-    vertices[7][0] = farWidth;      vertices[7][1] = -farHeight;    vertices[7][2] = -farPlane;
-
-    float colorLine1[4] = { 0.7f, 0.7f, 0.7f, 0.7f };
-    float colorLine2[4] = { 0.2f, 0.2f, 0.2f, 0.7f };
-    float colorPlane[4] = { 0.5f, 0.5f, 0.5f, 0.5f };
-
-    glDisable(GL_LIGHTING);
+    if (coreReady)
+        coreRenderer.beginLines(matrixModelViewCurrent);
+    else
+        glDisable(GL_LIGHTING);
     glDisable(GL_CULL_FACE);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    // draw the edges around frustum
-    glBegin(GL_LINES);
-    glColor4fv(colorLine2);
-    glVertex3f(0, 0, 0);
-    glColor4fv(colorLine1);
-    glVertex3fv(vertices[4]);
-
-    glColor4fv(colorLine2);
-    glVertex3f(0, 0, 0);
-    glColor4fv(colorLine1);
-    glVertex3fv(vertices[5]);
-
-    glColor4fv(colorLine2);
-    glVertex3f(0, 0, 0);
-    glColor4fv(colorLine1);
-    glVertex3fv(vertices[6]);
-
-    glColor4fv(colorLine2);
-    glVertex3f(0, 0, 0);
-    glColor4fv(colorLine1);
-    glVertex3fv(vertices[7]);
-    glEnd();
-
-    glColor4fv(colorLine1);
-    glBegin(GL_LINE_LOOP);
-    glVertex3fv(vertices[4]);
-    glVertex3fv(vertices[5]);
-    glVertex3fv(vertices[6]);
-    glVertex3fv(vertices[7]);
-    glEnd();
-
-    glColor4fv(colorLine1);
-    glBegin(GL_LINE_LOOP);
-    glVertex3fv(vertices[0]);
-    glVertex3fv(vertices[1]);
-    glVertex3fv(vertices[2]);
-    glVertex3fv(vertices[3]);
-    glEnd();
-
-    // draw near and far plane
-    glColor4fv(colorPlane);
-    glBegin(GL_QUADS);
-    glVertex3fv(vertices[0]);
-    glVertex3fv(vertices[1]);
-    glVertex3fv(vertices[2]);
-    glVertex3fv(vertices[3]);
-    glVertex3fv(vertices[4]);
-    glVertex3fv(vertices[5]);
-    glVertex3fv(vertices[6]);
-    glVertex3fv(vertices[7]);
-    glEnd();
+    // edges, far and near loops, then near and far planes
+    helperCache.drawFrustum(fovY, aspectRatio, nearPlane, farPlane);
 
     glEnable(GL_CULL_FACE);
-    glEnable(GL_LIGHTING);
+    if (coreReady)
+        coreRenderer.endLines();
+    else
+        glEnable(GL_LIGHTING);
 }
 
 
@@ -1011,12 +1265,13 @@ void ModelGL::drawFrustum(float fovY, float aspectRatio, float nearPlane, float
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::setViewMatrix(float x, float y, float z, float pitch, float heading, float roll)
 {
-    cameraPosition[0] = x;
-    cameraPosition[1] = y;
-    cameraPosition[2] = z;
-    cameraAngle[0] = pitch;
-    cameraAngle[1] = heading;
-    cameraAngle[2] = roll;
+    Lock lock(stateMutex);
+    pending.cameraPosition[0] = x;
+    pending.cameraPosition[1] = y;
+    pending.cameraPosition[2] = z;
+    pending.cameraAngle[0] = pitch;
+    pending.cameraAngle[1] = heading;
+    pending.cameraAngle[2] = roll;
 
     updateViewMatrix();
 }
@@ -1028,12 +1283,35 @@ void ModelGL::setViewMatrix(float x, float y, float z, float pitch, float headin
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::setModelMatrix(float x, float y, float z, float rx, float ry, float rz)
 {
-    modelPosition[0] = x;
-    modelPosition[1] = y;
-    modelPosition[2] = z;
-    modelAngle[0] = rx;
-    modelAngle[1] = ry;
-    modelAngle[2] = rz;
+    Lock lock(stateMutex);
+    pending.modelPosition[0] = x;
+    pending.modelPosition[1] = y;
+    pending.modelPosition[2] = z;
+    pending.modelAngle[0] = rx;
+    pending.modelAngle[1] = ry;
+    pending.modelAngle[2] = rz;
+
+    updateModelMatrix();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// rotate the object by the delta angles, wrapped to -180 when over 180
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::rotateModel(float dx, float dy, float dz, float position[3], float angle[3])
+{
+    Lock lock(stateMutex);
+    float delta[3] = { dx, dy, dz };
+    for (int i = 0; i < 3; ++i)
+    {
+        float a = pending.modelAngle[i] + delta[i];
+        if (a > 180)
+            a -= 360;
+        pending.modelAngle[i] = a;
+        angle[i] = a;
+        position[i] = pending.modelPosition[i];
+    }
 
     updateModelMatrix();
 }
@@ -1049,26 +1327,40 @@ void ModelGL::updateViewMatrix()
     // Notice translation nd heading values are negated,
     // because we move the whole scene with the inverse of camera transform
     // ORDER: translation -> rotX -> rotY ->rotZ
-    matrixView.identity();
-    matrixView.translate(-cameraPosition[0], -cameraPosition[1], -cameraPosition[2]);
-    matrixView.rotateX(cameraAngle[0]);     // pitch
-    matrixView.rotateY(-cameraAngle[1]);    // heading
-    matrixView.rotateZ(cameraAngle[2]);     // roll
-
-    matrixModelView = matrixView * matrixModel;
+    const float* cameraPosition = pending.cameraPosition;
+    const float* cameraAngle = pending.cameraAngle;
+    pending.matrixView = Matrix4::fromTranslateEuler(-cameraPosition[0], -cameraPosition[1], -cameraPosition[2],
+                                                     cameraAngle[0],    // pitch
+                                                     -cameraAngle[1],   // heading
+                                                     cameraAngle[2]);   // roll
+
+    pending.matrixModelView = pending.matrixView * pending.matrixModel;
+    changed();
 }
 
 void ModelGL::updateModelMatrix()
 {
     // transform objects from object space to world space
     // ORDER: rotZ -> rotY -> rotX -> translation
-    matrixModel.identity();
-    matrixModel.rotateZ(modelAngle[2]);
-    matrixModel.rotateY(modelAngle[1]);
-    matrixModel.rotateX(modelAngle[0]);
-    matrixModel.translate(modelPosition[0], modelPosition[1], modelPosition[2]);
+    const float* modelPosition = pending.modelPosition;
+    const float* modelAngle = pending.modelAngle;
+    pending.matrixModel = Matrix4::fromEulerTRS(modelAngle[0], modelAngle[1], modelAngle[2],
+                                                modelPosition[0], modelPosition[1], modelPosition[2]);
 
-    matrixModelView = matrixView * matrixModel;
+    pending.matrixModelView = pending.matrixView * pending.matrixModel;
+    changed();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// wake up the rendering thread to draw the changed scene
+///////////////////////////////////////////////////////////////////////////////
+void ModelGL::changed()
+{
+    ++pendingVersion;
+    if (frameScheduler)
+        frameScheduler->requestRedraw();
 }
 
 
@@ -1079,21 +1371,27 @@ void ModelGL::updateModelMatrix()
 
 void ModelGL::setSizeObject(int size)
 {
-    sizeObject = size;
+    Lock lock(stateMutex);
+    pending.sizeObject = (float)size;
+    changed();
 }
 
 void ModelGL::setSizeObject(int x, int y)
 {
+    Lock lock(stateMutex);
     x_last = x; y_last = y;
-    sizeObject = (float)sqrtf(pow(x - x_first, 2) + pow(y - y_first, 2))*0.015f;
+    pending.sizeObject = (float)sqrtf(pow(x - x_first, 2) + pow(y - y_first, 2))*0.015f;
+    changed();
 }
 
 void ModelGL::rotateCamera(int x, int y)
 {
-    cameraAngleY += (x - mouseX);
-    cameraAngleX += (y - mouseY);
+    Lock lock(stateMutex);
+    pending.cameraAngleY += (x - mouseX);
+    pending.cameraAngleX += (y - mouseY);
     mouseX = x;
     mouseY = y;
+    changed();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1101,12 +1399,16 @@ void ModelGL::rotateCamera(int x, int y)
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::zoomCamera(int y)
 {
-    cameraDistance -= (y - mouseY) * 0.1f;
+    Lock lock(stateMutex);
+    pending.cameraDistance -= (y - mouseY) * 0.1f;
     mouseY = y;
+    changed();
 }
 void ModelGL::zoomCameraDelta(float delta)
 {
-    cameraDistance -= delta;
+    Lock lock(stateMutex);
+    pending.cameraDistance -= delta;
+    changed();
 }
 
 
@@ -1116,10 +1418,12 @@ void ModelGL::zoomCameraDelta(float delta)
 ///////////////////////////////////////////////////////////////////////////////
 void ModelGL::setDrawMode(int mode)
 {
-    if (drawMode != mode)
+    Lock lock(stateMutex);
+    if (pending.drawMode != mode)
     {
-        drawModeChanged = true;
-        drawMode = mode;
+        pending.drawModeChanged = true;
+        pending.drawMode = mode;
+        changed();
     }
 }
 
@@ -1245,6 +1549,43 @@ bool ModelGL::createShaderPrograms()
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// create shader program for instanced rendering on the legacy path
+///////////////////////////////////////////////////////////////////////////////
+bool ModelGL::createInstanceProgram()
+{
+    GLuint vsId3 = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fsId3 = glCreateShader(GL_FRAGMENT_SHADER);
+    progId3 = glCreateProgram();
+
+    glShaderSource(vsId3, 1, &vsSource3, 0);
+    glShaderSource(fsId3, 1, &fsSource3, 0);
+    glCompileShader(vsId3);
+    glCompileShader(fsId3);
+    glAttachShader(progId3, vsId3);
+    glAttachShader(progId3, fsId3);
+
+    // some drivers alias generic attributes with the built-in ones
+    // (0:vertex, 2:normal, 3:color, 8+:texcoord), so use the unaliased slots
+    glBindAttribLocation(progId3, MESH_ATTRIB_INSTANCE_MATRIX, "instanceMatrix");   // 4 ~ 7
+    glBindAttribLocation(progId3, MESH_ATTRIB_COLOR, "instanceColor");
+    glLinkProgram(progId3);
+
+    GLint linkStatus;
+    glGetProgramiv(progId3, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus != GL_TRUE)
+    {
+        std::cout << "=== GLSL LOG 3 ===\n" << getProgramStatus(progId3) << std::endl;
+        return false;
+    }
+
+    instanceMatrixLoc = glGetAttribLocation(progId3, "instanceMatrix");
+    instanceColorLoc = glGetAttribLocation(progId3, "instanceColor");
+    return instanceMatrixLoc >= 0 && instanceColorLoc >= 0;
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // return error message of shader compile status
 // if no errors, it returns empty string
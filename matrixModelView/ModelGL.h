@@ -12,12 +12,89 @@
 #include <GL/gl.h>
 #endif
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include "Matrices.h"
+#include "BoundingBox.h"
+#include "MeshCache.h"
+#include "HelperCache.h"
+#include "CoreRenderer.h"
+#include "MeshLod.h"
+#include "TextureManager.h"
+#include "FrameScheduler.h"
 #include "glext.h"
 #include "glExtension.h"
 #include "resource.h"
-#include "GL/GLU.H"
+
+#ifdef __APPLE__
+#include <OpenGL/glu.h>
+#else
+#include <GL/glu.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// a copy of a built-in object placed in the scene, drawn in both views
+// It has the size and tessellation of the current model object, so all
+// instances of the same object share one cached mesh.
+///////////////////////////////////////////////////////////////////////////////
+struct SceneInstance
+{
+    int object;             // IDC_RADIO* of the object, same as setModelObject()
+    Matrix4 matrix;         // from object space to world space
+    float color[4];
+};
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// scene state shared by the UI thread and the rendering thread
+// The UI thread modifies the pending state with a short lock, and the
+// rendering thread copies it once per frame, so a frame never sees a half
+// updated scene, e.g. matrixModel and matrixModelView from different inputs.
+// The instances are immutable once set, the snapshot only shares the pointer,
+// and setInstances() replaces it with a new vector and version.
+///////////////////////////////////////////////////////////////////////////////
+typedef std::shared_ptr<const std::vector<SceneInstance> > SceneInstances;
+
+struct SceneState
+{
+    int windowWidth;
+    int windowHeight;
+    int povWidth;           // width for point of view screen (left)
+    bool windowSizeChanged;
+    bool drawModeChanged;
+    int drawMode;
+    float cameraPosition[3];
+    float cameraAngle[3];
+    float modelPosition[3];
+    float modelAngle[3];
+    int object;
+    int shape;
+    bool boxRotationOX;
+    bool boxRotationOY;
+    bool boxRotationOZ;
+    bool flagFog;
+    bool move;
+    bool isDraw;
+    float sizeObject;
+    // these are for 3rd person view
+    float cameraAngleX;
+    float cameraAngleY;
+    float cameraDistance;
+
+    // 4x4 transform matrices
+    Matrix4 matrixView;
+    Matrix4 matrixModel;
+    Matrix4 matrixModelView;
+
+    // instances sorted by object, so each object is a contiguous range
+    SceneInstances instances;                       // never null
+    unsigned int instancesVersion;                  // increased when instances are replaced
+};
+
+
 
 class ModelGL
 {
@@ -39,67 +116,86 @@ public:
 
     void CloseDrawWithShape();
 
-    void drawObject(int id_obj);
+    void drawObject(int id_obj, int lodLevel=0);
 
-    void setMousePosition(int x, int y) { mouseX = x; mouseY = y; };
+    // setters/getters below access the pending scene state, thread-safe
+    void setMousePosition(int x, int y) { Lock lock(stateMutex); mouseX = x; mouseY = y; };
     void setDrawMode(int mode);
     void setWindowSize(int width, int height);
     void setViewMatrix(float x, float y, float z, float pitch, float heading, float roll);
     void setModelMatrix(float x, float y, float z, float rx, float ry, float rz);
+    // add the angles to the model rotation in one step, so concurrent setters
+    // are not lost; returns the position and the angles after the update
+    void rotateModel(float dx, float dy, float dz, float position[3], float angle[3]);
+
+    void setCameraX(float x) { Lock lock(stateMutex); pending.cameraPosition[0] = x; updateViewMatrix(); }
+    void setCameraY(float y) { Lock lock(stateMutex); pending.cameraPosition[1] = y; updateViewMatrix(); }
+    void setCameraZ(float z) { Lock lock(stateMutex); pending.cameraPosition[2] = z; updateViewMatrix(); }
+    void setCameraAngleX(float p) { Lock lock(stateMutex); pending.cameraAngle[0] = p; updateViewMatrix(); }
+    void setCameraAngleY(float h) { Lock lock(stateMutex); pending.cameraAngle[1] = h; updateViewMatrix(); }
+    void setCameraAngleZ(float r) { Lock lock(stateMutex); pending.cameraAngle[2] = r; updateViewMatrix(); }
+    float getCameraX() { Lock lock(stateMutex); return pending.cameraPosition[0]; }
+    float getCameraY() { Lock lock(stateMutex); return pending.cameraPosition[1]; }
+    float getCameraZ() { Lock lock(stateMutex); return pending.cameraPosition[2]; }
+    float getCameraAngleX() { Lock lock(stateMutex); return pending.cameraAngle[0]; }
+    float getCameraAngleY() { Lock lock(stateMutex); return pending.cameraAngle[1]; }
+    float getCameraAngleZ() { Lock lock(stateMutex); return pending.cameraAngle[2]; }
+
+    void setMove(bool b) { Lock lock(stateMutex); pending.move = b; changed(); }
+    void setIsDraw(bool b) { Lock lock(stateMutex); pending.isDraw = b; changed(); }
+    bool getMove() { Lock lock(stateMutex); return pending.move; }
+    bool getisDraw() { Lock lock(stateMutex); return pending.isDraw; }
+    float getSizeObject() { Lock lock(stateMutex); return pending.sizeObject; }
+    int getModelObject() { Lock lock(stateMutex); return pending.object; }
+    void setModelObject(int x) { Lock lock(stateMutex); pending.object = x; changed(); }
 
-    void setCameraX(float x) { cameraPosition[0] = x; updateViewMatrix(); }
-    void setCameraY(float y) { cameraPosition[1] = y; updateViewMatrix(); }
-    void setCameraZ(float z) { cameraPosition[2] = z; updateViewMatrix(); }
-    void setCameraAngleX(float p) { cameraAngle[0] = p; updateViewMatrix(); }
-    void setCameraAngleY(float h) { cameraAngle[1] = h; updateViewMatrix(); }
-    void setCameraAngleZ(float r) { cameraAngle[2] = r; updateViewMatrix(); }
-    float getCameraX() { return cameraPosition[0]; }
-    float getCameraY() { return cameraPosition[1]; }
-    float getCameraZ() { return cameraPosition[2]; }
-    float getCameraAngleX() { return cameraAngle[0]; }
-    float getCameraAngleY() { return cameraAngle[1]; }
-    float getCameraAngleZ() { return cameraAngle[2]; }
-
-    void setMove(bool b) { move = b; }
-    void setIsDraw(bool b) { isDraw = b; }
-    bool getMove() { return move; }
-    bool getisDraw() { return isDraw; }
-    float getSizeObject() { return sizeObject; }
-    int getModelObject() { return object; }
-    void setModelObject(int x) { object = x; }
-
-    void setModelX(float x) { modelPosition[0] = x; updateModelMatrix(); }
-    void setModelY(float y) { modelPosition[1] = y; updateModelMatrix(); }
-    void setModelZ(float z) { modelPosition[2] = z; updateModelMatrix(); }
-    void setModelAngleX(float a) { modelAngle[0] = a; updateModelMatrix(); }
-    void setModelAngleY(float a) { modelAngle[1] = a; updateModelMatrix(); }
-    void setModelAngleZ(float a) { modelAngle[2] = a; updateModelMatrix(); }
-    float getModelX() { return modelPosition[0]; }
-    float getModelY() { return modelPosition[1]; }
-    float getModelZ() { return modelPosition[2]; }
-    float getModelAngleX() { return modelAngle[0]; }
-    float getModelAngleY() { return modelAngle[1]; }
-    float getModelAngleZ() { return modelAngle[2]; }
-
-    void setBoxRotationOX(bool b) { boxRotationOX = b; }
-    void setBoxRotationOY(bool b) { boxRotationOY = b; }
-    void setBoxRotationOZ(bool b) { boxRotationOZ = b; }
-
-    bool boxRotationOXIsCheck() { return boxRotationOX; }
-    bool boxRotationOYIsCheck() { return boxRotationOY; }
-    bool boxRotationOZIsCheck() { return boxRotationOZ; }
-
-    void setFlagFog(bool ff) { flagFog = ff; }
-    bool getFlagFog() { return flagFog; }
-
-    void setModelShape(int id) { shape = id; }
-    int getModelShape() { return shape; }
-
-    // return 16 elements of  target matrix
-    const float* getViewMatrixElements() { return matrixView.get(); }
-    const float* getModelMatrixElements() { return matrixModel.get(); }
-    const float* getModelViewMatrixElements() { return matrixModelView.get(); }
-    const float* getProjectionMatrixElements() { return matrixProjection.get(); }
+    void setModelX(float x) { Lock lock(stateMutex); pending.modelPosition[0] = x; updateModelMatrix(); }
+    void setModelY(float y) { Lock lock(stateMutex); pending.modelPosition[1] = y; updateModelMatrix(); }
+    void setModelZ(float z) { Lock lock(stateMutex); pending.modelPosition[2] = z; updateModelMatrix(); }
+    void setModelAngleX(float a) { Lock lock(stateMutex); pending.modelAngle[0] = a; updateModelMatrix(); }
+    void setModelAngleY(float a) { Lock lock(stateMutex); pending.modelAngle[1] = a; updateModelMatrix(); }
+    void setModelAngleZ(float a) { Lock lock(stateMutex); pending.modelAngle[2] = a; updateModelMatrix(); }
+    float getModelX() { Lock lock(stateMutex); return pending.modelPosition[0]; }
+    float getModelY() { Lock lock(stateMutex); return pending.modelPosition[1]; }
+    float getModelZ() { Lock lock(stateMutex); return pending.modelPosition[2]; }
+    float getModelAngleX() { Lock lock(stateMutex); return pending.modelAngle[0]; }
+    float getModelAngleY() { Lock lock(stateMutex); return pending.modelAngle[1]; }
+    float getModelAngleZ() { Lock lock(stateMutex); return pending.modelAngle[2]; }
+
+    void setBoxRotationOX(bool b) { Lock lock(stateMutex); pending.boxRotationOX = b; changed(); }
+    void setBoxRotationOY(bool b) { Lock lock(stateMutex); pending.boxRotationOY = b; changed(); }
+    void setBoxRotationOZ(bool b) { Lock lock(stateMutex); pending.boxRotationOZ = b; changed(); }
+
+    bool boxRotationOXIsCheck() { Lock lock(stateMutex); return pending.boxRotationOX; }
+    bool boxRotationOYIsCheck() { Lock lock(stateMutex); return pending.boxRotationOY; }
+    bool boxRotationOZIsCheck() { Lock lock(stateMutex); return pending.boxRotationOZ; }
+    bool isAnimating() { Lock lock(stateMutex); return pending.boxRotationOX || pending.boxRotationOY || pending.boxRotationOZ; }
+
+    void setFlagFog(bool ff) { Lock lock(stateMutex); pending.flagFog = ff; changed(); }
+    bool getFlagFog() { Lock lock(stateMutex); return pending.flagFog; }
+
+    void setModelShape(int id) { Lock lock(stateMutex); pending.shape = id; changed(); }
+    int getModelShape() { Lock lock(stateMutex); return pending.shape; }
+
+    // return copy of target matrix
+    Matrix4 getViewMatrix() { Lock lock(stateMutex); return pending.matrixView; }
+    Matrix4 getModelMatrix() { Lock lock(stateMutex); return pending.matrixModel; }
+    Matrix4 getModelViewMatrix() { Lock lock(stateMutex); return pending.matrixModelView; }
+
+    // instance list, replaced at once
+    void setInstances(const std::vector<SceneInstance>& instances);
+    void clearInstances() { setInstances(std::vector<SceneInstance>()); }
+    int getInstanceCount() { Lock lock(stateMutex); return (int)pending.instances->size(); }
+    int getVisibleInstanceCount() const { return visibleInstanceCount; }   // in the camera view of the last frame
+    bool isInstancingSupported() const { return coreReady ? coreRenderer.isInstancingReady() : instancingReady; }   // false if the per-instance draw fallback is used
+
+    // scheduler to wake up the rendering thread when the scene is changed
+    void setFrameScheduler(FrameScheduler* scheduler) { frameScheduler = scheduler; textureManager.setFrameScheduler(scheduler); }
+
+    // texture load stats (hits, misses, bytes)
+    const TextureManager& getTextureManager() const { return textureManager; }
+    void finishTextures() { textureManager.finish(); }  // wait for the textures loading in background
+    void setTextureCache(const std::string& directory, bool compress) { textureManager.setCache(directory, compress); }  // call before init()
 
 	void setSizeObject(int x);
 
@@ -108,8 +204,13 @@ public:
     void rotateCamera(int x, int y);
     void zoomCamera(int dist);
     void zoomCameraDelta(float delta);  // for mousewheel
-    void setX1Y1SizeObject(int x, int y) { x_first = x; y_first = y; }
+    void setX1Y1SizeObject(int x, int y) { Lock lock(stateMutex); x_first = x; y_first = y; }
     bool isShaderSupported() { return glslSupported; }
+
+    // core-profile path (GLSL 1.40, VAO, UBO), used if supported and enabled
+    // call it on the rendering thread, the cached meshes are rebuilt on change
+    void setCorePathEnabled(bool enabled);
+    bool isCorePathActive() const { return coreReady; }
     void runTexture();
 protected:
 
@@ -123,56 +224,96 @@ private:
     void drawSub1();                                // draw upper window
     void drawSub2();                                // draw bottom window
     void drawFrustum(float fovy, float aspect, float near, float far);
+    void drawCamera();                              // draw camera mesh baked from cameraSimple.h
+    void loadModelView(const Matrix4& matrix);      // for following draws, GL_MODELVIEW if fixed pipeline
+    void updateCorePath();                          // switch MeshCache and states to the chosen path
+    bool getObjectMesh(int id_obj, int& shape, MeshLod& lod);
+    bool isObjectVisible(int id_obj, const Matrix4& matrixModelView);  // frustum culling with matrixProjection
+    int selectObjectLod(int id_obj, const Matrix4& matrixModelView, int view);  // view: 0 = drawSub1, 1 = drawSub2
+    void updateInstanceBounds();                    // world-space AABBs of scene.instances, once per instances and size
+    int drawInstances(const Matrix4& matrixView, int view); // draw visible instances, return the count
+    bool createInstanceProgram();
     Matrix4 setFrustum(float l, float r, float b, float t, float n, float f);
     Matrix4 setFrustum(float fovy, float ratio, float n, float f);
     Matrix4 setOrthoFrustum(float l, float r, float b, float t, float n = -1, float f = 1);
-    void updateModelMatrix();
-    void updateViewMatrix();
+    void updateModelMatrix();                       // stateMutex must be locked
+    void updateViewMatrix();                        // stateMutex must be locked
+    void changed();                                 // request to redraw the scene, stateMutex must be locked
+    void takeSnapshot();                            // copy pending state for this frame
     bool createShaderPrograms();
     std::string getShaderStatus(GLuint shader);     // return GLSL compile error log
     std::string getProgramStatus(GLuint program);   // return GLSL link error log
     
     // members
-    int windowWidth;
-    int windowHeight;
-    int povWidth;           // width for point of view screen (left)
-    bool windowSizeChanged;
-    bool drawModeChanged;
-    int drawMode;
+    typedef std::lock_guard<std::mutex> Lock;
+    SceneState pending;                 // modified by setters
+    SceneState scene;                   // snapshot for the current frame, used by rendering thread only
+    unsigned int pendingVersion;        // increased by changed()
+    unsigned int sceneVersion;          // version of the snapshot
+    std::mutex stateMutex;              // guard pending state
     int mouseX;
     int mouseY;
-    float cameraPosition[3];
-    float cameraAngle[3];
-    float modelPosition[3];
-    float modelAngle[3];
-    int object;
-    bool boxRotationOX = false;
-    bool boxRotationOY = false;
-    bool boxRotationOZ = false;
-    bool flagFog;
-    // these are for 3rd person view
-    float cameraAngleX;
-    float cameraAngleY;
-    float cameraDistance;
     float bgColor[4];
-    int shape;
-    bool move;
-    bool isDraw;
-    float sizeObject = 0;
     int x_first, y_first;
     int x_last, y_last;
-
-    // 4x4 transform matrices
-    Matrix4 matrixView;
-    Matrix4 matrixModel;
-    Matrix4 matrixModelView;
     Matrix4 matrixProjection;
+    Matrix4 matrixModelViewCurrent;     // set by loadModelView()
+    float pixelsPerUnit;                // of matrixProjection, for LOD selection
+
+    // cached VBOs of built-in shapes
+    MeshCache meshCache;
+
+    // cached VBOs of grid, axis and frustum
+    HelperCache helperCache;
+
+    // textures loaded once per file
+    TextureManager textureManager;
+
+    // notified by changed(), not owned
+    FrameScheduler* frameScheduler;
 
     // glsl extension
     bool glslSupported;
     bool glslReady;
     GLuint progId1;             // shader program with color
     GLuint progId2;             // shader program with color + lighting
+
+    // core-profile path, replaces the fixed pipeline and progId1~3
+    CoreRenderer coreRenderer;
+    bool corePathEnabled;
+    bool coreReady;
+
+    // instanced rendering (GL_ARB_draw_instanced, GL_ARB_instanced_arrays) on
+    // the legacy path, the core path has CoreRenderer::isInstancingReady()
+    bool instancingReady;
+    GLuint progId3;             // progId2 with per-instance matrix and color
+    GLint instanceMatrixLoc;    // mat4 takes 4 locations from it
+    GLint instanceColorLoc;
+    GLuint instanceVboId;       // visible instances of a view, streamed per draw
+    std::vector<float> instanceData;            // matrix + color of visible instances
+    std::vector<BoundingBox> instanceBounds;    // of scene.instances
+    std::vector<unsigned char> instanceVisible;
+    std::vector<int> instancesWithoutMesh;      // indices of instances not to draw
+    unsigned int instanceBoundsVersion;         // instancesVersion of instanceBounds
+    float instanceBoundsSize;                   // sizeObject of instanceBounds
+    int visibleInstanceCount;
+
+    // LOD levels of the last frame per view, for hysteresis
+    int objectLodLevels[2];
+    std::vector<unsigned char> instanceLodLevels[2];
+
+    // visible instances of an object with the same LOD level, drawn at once
+    struct InstanceBatch
+    {
+        int shape;
+        int sectorCount;
+        int stackCount;
+        int level;
+        int begin;                      // range in scene.instances
+        int end;
+        int count;                      // visible instances in the range with the level
+    };
+    std::vector<InstanceBatch> instanceBatches;
 };
 #endif
 
@@ -0,0 +1,220 @@
+///////////////////////////////////////////////////////////////////////////////
+// OffscreenGL.cpp
+// ===============
+// OpenGL rendering context without any window for headless mode
+// It creates a surfaceless EGL context (e.g. Mesa llvmpipe software renderer)
+// and draws into a framebuffer object, so it runs on a machine that has no
+// display and no GPU.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <algorithm>
+#include <cstdio>
+#include "OffscreenGL.h"
+#include "glExtension.h"
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+OffscreenGL::OffscreenGL() : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT),
+                             fboId(0), colorId(0), depthId(0), width(0), height(0)
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// dtor
+///////////////////////////////////////////////////////////////////////////////
+OffscreenGL::~OffscreenGL()
+{
+    close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// create EGL context and FBO with the given size, then make it current
+///////////////////////////////////////////////////////////////////////////////
+bool OffscreenGL::create(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    if(!createContext())
+        return false;
+
+    if(!createFramebuffer())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// delete FBO and EGL context
+///////////////////////////////////////////////////////////////////////////////
+void OffscreenGL::close()
+{
+    if(context != EGL_NO_CONTEXT)
+    {
+        if(fboId)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glDeleteFramebuffers(1, &fboId);
+            glDeleteRenderbuffers(1, &colorId);
+            glDeleteRenderbuffers(1, &depthId);
+            fboId = colorId = depthId = 0;
+        }
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        context = EGL_NO_CONTEXT;
+    }
+
+    if(display != EGL_NO_DISPLAY)
+    {
+        eglTerminate(display);
+        display = EGL_NO_DISPLAY;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// read RGB pixels of the framebuffer, the top row comes first
+///////////////////////////////////////////////////////////////////////////////
+bool OffscreenGL::readPixels(std::vector<unsigned char>& rgb)
+{
+    if(!fboId)
+        return false;
+
+    int rowSize = width * 3;
+    std::vector<unsigned char> pixels((size_t)rowSize * height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    // OpenGL starts from the bottom row
+    rgb.resize(pixels.size());
+    for(int i = 0; i < height; ++i)
+    {
+        const unsigned char* src = &pixels[(size_t)(height - 1 - i) * rowSize];
+        std::copy(src, src + rowSize, &rgb[(size_t)i * rowSize]);
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// write the framebuffer to binary PPM (P6) file
+///////////////////////////////////////////////////////////////////////////////
+bool OffscreenGL::savePpm(const std::string& fileName)
+{
+    std::vector<unsigned char> rgb;
+    if(!readPixels(rgb))
+        return false;
+
+    FILE* file = fopen(fileName.c_str(), "wb");
+    if(!file)
+    {
+        errorMessage = "cannot open " + fileName;
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    size_t count = fwrite(&rgb[0], 1, rgb.size(), file);
+    fclose(file);
+    return count == rgb.size();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// create surfaceless EGL context for desktop OpenGL (compatibility profile)
+///////////////////////////////////////////////////////////////////////////////
+bool OffscreenGL::createContext()
+{
+    // prefer surfaceless platform, it does not need any window system
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if(getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, 0);
+    if(display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if(display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        errorMessage = "failed to initialize EGL display";
+        display = EGL_NO_DISPLAY;
+        return false;
+    }
+
+    const EGLint attributes[] = {
+        EGL_SURFACE_TYPE,       EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE,    EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = 0;
+    EGLint configCount = 0;
+    eglChooseConfig(display, attributes, &config, 1, &configCount);
+
+    if(!eglBindAPI(EGL_OPENGL_API))
+    {
+        errorMessage = "desktop OpenGL is not supported by EGL";
+        return false;
+    }
+
+    // no attributes for the legacy (compatibility) context
+    context = eglCreateContext(display, configCount > 0 ? config : (EGLConfig)0, EGL_NO_CONTEXT, 0);
+    if(context == EGL_NO_CONTEXT)
+    {
+        errorMessage = "failed to create EGL context";
+        return false;
+    }
+
+    if(!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        errorMessage = "failed to make EGL context current";
+        return false;
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// create FBO with RGBA8 color and 24-bit depth + 8-bit stencil buffers
+// The FBO stays bound, so all draw calls go into it.
+///////////////////////////////////////////////////////////////////////////////
+bool OffscreenGL::createFramebuffer()
+{
+    glGenRenderbuffers(1, &colorId);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depthId);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthId);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fboId);
+    glBindFramebuffer(GL_FRAMEBUFFER, fboId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthId);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthId);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        errorMessage = "framebuffer object is not complete";
+        return false;
+    }
+    return true;
+}
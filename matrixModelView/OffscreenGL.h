@@ -0,0 +1,47 @@
+///////////////////////////////////////////////////////////////////////////////
+// OffscreenGL.h
+// =============
+// OpenGL rendering context without any window for headless mode
+// It creates a surfaceless EGL context (e.g. Mesa llvmpipe software renderer)
+// and draws into a framebuffer object, so it runs on a machine that has no
+// display and no GPU.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef OFFSCREEN_GL_H
+#define OFFSCREEN_GL_H
+
+#include <GL/gl.h>
+#include <string>
+#include <vector>
+
+class OffscreenGL
+{
+public:
+    OffscreenGL();
+    ~OffscreenGL();
+
+    bool create(int width, int height);             // create context and FBO, then make it current
+    void close();
+
+    bool readPixels(std::vector<unsigned char>& rgb);   // RGB, top row first
+    bool savePpm(const std::string& fileName);      // write the framebuffer to binary PPM
+
+    int getWidth() const                            { return width; }
+    int getHeight() const                           { return height; }
+    const std::string& getErrorMessage() const      { return errorMessage; }
+
+private:
+    bool createContext();
+    bool createFramebuffer();
+
+    void* display;                                  // EGLDisplay
+    void* context;                                  // EGLContext
+    GLuint fboId;
+    GLuint colorId;                                 // color renderbuffer
+    GLuint depthId;                                 // depth/stencil renderbuffer
+    int width;
+    int height;
+    std::string errorMessage;
+};
+
+#endif
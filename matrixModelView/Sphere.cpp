@@ -0,0 +1,351 @@
+///////////////////////////////////////////////////////////////////////////////
+// Sphere.cpp
+// ==========
+// Sphere for OpenGL with (radius, sectors, stacks)
+// The min number of sectors is 3 and the min number of stacks are 2.
+// The poles are on z-axis, same as gluSphere().
+// - radius : the radius of the sphere
+// - sectors: the number of slices around z-axis (longitude)
+// - stacks : the number of subdivisions from the north pole to the south pole
+//            (latitude)
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>    // include windows.h to avoid thousands of compile errors even though this class is not depending on Windows
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <iostream>
+#include <cmath>
+#include "Sphere.h"
+
+
+
+// constants //////////////////////////////////////////////////////////////////
+const int MIN_SECTOR_COUNT = 3;
+const int MIN_STACK_COUNT  = 2;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+Sphere::Sphere(float radius, int sectors, int stacks) : radius(0), sectorCount(0), stackCount(0),
+                                                        interleavedStride(32)
+{
+    set(radius, sectors, stacks);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// setters
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::set(float radius, int sectors, int stacks)
+{
+    if(sectors < MIN_SECTOR_COUNT)
+        sectors = MIN_SECTOR_COUNT;
+    if(stacks < MIN_STACK_COUNT)
+        stacks = MIN_STACK_COUNT;
+
+    this->radius = radius;
+    if(this->sectorCount != sectors)
+    {
+        this->sectorCount = sectors;
+        buildSectorTable();
+    }
+    this->stackCount = stacks;
+
+    buildVertices();
+}
+
+void Sphere::setRadius(float radius)
+{
+    if(this->radius != radius)
+        set(radius, sectorCount, stackCount);
+}
+
+void Sphere::setSectorCount(int sectors)
+{
+    if(sectors != this->sectorCount)
+        set(radius, sectors, stackCount);
+}
+
+void Sphere::setStackCount(int stacks)
+{
+    if(stacks != this->stackCount)
+        set(radius, sectorCount, stacks);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the bounding box without scanning vertices
+///////////////////////////////////////////////////////////////////////////////
+BoundingBox Sphere::getBounds() const
+{
+    return BoundingBox(Vector3(-radius, -radius, -radius), Vector3(radius, radius, radius));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// print itself
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::printSelf() const
+{
+    std::cout << "===== Sphere =====\n"
+              << "        Radius: " << radius << "\n"
+              << "  Sector Count: " << sectorCount << "\n"
+              << "   Stack Count: " << stackCount << "\n"
+              << "Triangle Count: " << getTriangleCount() << "\n"
+              << "   Index Count: " << getIndexCount() << "\n"
+              << "  Vertex Count: " << getVertexCount() << "\n"
+              << "  Normal Count: " << getNormalCount() << "\n"
+              << "TexCoord Count: " << getTexCoordCount() << std::endl;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw a sphere in VertexArray mode
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::draw() const
+{
+    // interleaved array
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, interleavedStride, &interleavedVertices[0]);
+    glNormalPointer(GL_FLOAT, interleavedStride, &interleavedVertices[3]);
+    glTexCoordPointer(2, GL_FLOAT, interleavedStride, &interleavedVertices[6]);
+
+    glDrawElements(GL_TRIANGLES, (unsigned int)indices.size(), GL_UNSIGNED_INT, indices.data());
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw lines only
+// the caller must set the line width before call this
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::drawLines(const float lineColor[4]) const
+{
+    // set line colour
+    glColor4fv(lineColor);
+    glMaterialfv(GL_FRONT, GL_DIFFUSE,   lineColor);
+
+    // draw lines with VA
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, vertices.data());
+
+    glDrawElements(GL_LINES, (unsigned int)lineIndices.size(), GL_UNSIGNED_INT, lineIndices.data());
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw a sphere surfaces and lines on top of it
+// the caller must set the line width before call this
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::drawWithLines(const float lineColor[4]) const
+{
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1.0, 1.0f); // move polygon backward
+    this->draw();
+    glDisable(GL_POLYGON_OFFSET_FILL);
+
+    // draw lines with VA
+    drawLines(lineColor);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// dealloc vectors
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::clearArrays()
+{
+    std::vector<float>().swap(vertices);
+    std::vector<float>().swap(normals);
+    std::vector<float>().swap(texCoords);
+    std::vector<unsigned int>().swap(indices);
+    std::vector<unsigned int>().swap(lineIndices);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build vertices of sphere with smooth shading
+// x = r * cos(u) * cos(v)
+// y = r * cos(u) * sin(v)
+// z = r * sin(u)
+// where u: stack(latitude) angle (-90 <= u <= 90)
+//       v: sector(longitude) angle (0 <= v <= 360)
+// The first and last vertices of each stack have the same position but
+// different tex coords.
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::buildVertices()
+{
+    const float PI = acosf(-1);
+    float stackStep = PI / stackCount;
+
+    clearArrays();
+    vertices.reserve((size_t)(stackCount + 1) * (sectorCount + 1) * 3);
+    normals.reserve(vertices.capacity());
+    texCoords.reserve((size_t)(stackCount + 1) * (sectorCount + 1) * 2);
+
+    for(int i = 0; i <= stackCount; ++i)
+    {
+        float stackAngle = PI / 2 - i * stackStep;      // from pi/2 to -pi/2
+        float xy = cosf(stackAngle);                    // r * cos(u)
+        float z = sinf(stackAngle);                     // r * sin(u)
+
+        // cos(v) and sin(v) come from the table
+        for(int j = 0, k = 0; j <= sectorCount; ++j, k += 2)
+        {
+            float nx = xy * sectorTable[k];
+            float ny = xy * sectorTable[k + 1];
+            addVertex(nx * radius, ny * radius, z * radius);
+            addNormal(nx, ny, z);
+            addTexCoord((float)j / sectorCount, 1.0f - (float)i / stackCount);
+        }
+    }
+
+    // indices
+    //  k1--k1+1
+    //  |  / |
+    //  | /  |
+    //  k2--k2+1
+    for(int i = 0; i < stackCount; ++i)
+    {
+        unsigned int k1 = i * (sectorCount + 1);    // beginning of current stack
+        unsigned int k2 = k1 + sectorCount + 1;     // beginning of next stack
+
+        for(int j = 0; j < sectorCount; ++j, ++k1, ++k2)
+        {
+            // 2 triangles per sector excluding 1st and last stacks
+            if(i != 0)
+                addIndices(k1, k2, k1 + 1);     // k1---k2---k1+1
+            if(i != (stackCount - 1))
+                addIndices(k1 + 1, k2, k2 + 1); // k1+1---k2---k2+1
+
+            // vertical lines for all stacks
+            lineIndices.push_back(k1);
+            lineIndices.push_back(k2);
+            // horizontal lines except 1st stack
+            if(i != 0)
+            {
+                lineIndices.push_back(k1);
+                lineIndices.push_back(k1 + 1);
+            }
+        }
+    }
+
+    // generate interleaved vertex array as well
+    buildInterleavedVertices();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// generate interleaved vertices: V/N/T
+// stride must be 32 bytes
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::buildInterleavedVertices()
+{
+    std::vector<float>().swap(interleavedVertices);
+    interleavedVertices.reserve(vertices.size() / 3 * 8);
+
+    std::size_t i, j;
+    std::size_t count = vertices.size();
+    for(i = 0, j = 0; i < count; i += 3, j += 2)
+    {
+        interleavedVertices.insert(interleavedVertices.end(), &vertices[i], &vertices[i] + 3);
+        interleavedVertices.insert(interleavedVertices.end(), &normals[i], &normals[i] + 3);
+        interleavedVertices.insert(interleavedVertices.end(), &texCoords[j], &texCoords[j] + 2);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// compute cos and sin of the sector angles once, all stacks reuse them
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::buildSectorTable()
+{
+    const float PI = acosf(-1);
+    float sectorStep = 2 * PI / sectorCount;
+
+    std::vector<float>().swap(sectorTable);
+    sectorTable.reserve((size_t)(sectorCount + 1) * 2);
+    for(int i = 0; i <= sectorCount; ++i)
+    {
+        float sectorAngle = i * sectorStep;
+        sectorTable.push_back(cosf(sectorAngle));
+        sectorTable.push_back(sinf(sectorAngle));
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single vertex to array
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::addVertex(float x, float y, float z)
+{
+    vertices.push_back(x);
+    vertices.push_back(y);
+    vertices.push_back(z);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single normal to array
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::addNormal(float nx, float ny, float nz)
+{
+    normals.push_back(nx);
+    normals.push_back(ny);
+    normals.push_back(nz);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single texture coord to array
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::addTexCoord(float s, float t)
+{
+    texCoords.push_back(s);
+    texCoords.push_back(t);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add 3 indices to array
+///////////////////////////////////////////////////////////////////////////////
+void Sphere::addIndices(unsigned int i1, unsigned int i2, unsigned int i3)
+{
+    indices.push_back(i1);
+    indices.push_back(i2);
+    indices.push_back(i3);
+}
@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+// Sphere.h
+// ========
+// Sphere for OpenGL with (radius, sectors, stacks)
+// The min number of sectors is 3 and the min number of stacks are 2.
+// The poles are on z-axis, same as gluSphere().
+// - radius : the radius of the sphere
+// - sectors: the number of slices around z-axis (longitude)
+// - stacks : the number of subdivisions from the north pole to the south pole
+//            (latitude)
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GEOMETRY_SPHERE_H
+#define GEOMETRY_SPHERE_H
+
+#include <vector>
+#include "BoundingBox.h"
+
+class Sphere
+{
+public:
+    // ctor/dtor
+    Sphere(float radius=1.0f, int sectorCount=36, int stackCount=18);
+    ~Sphere() {}
+
+    // getters/setters
+    float getRadius() const                 { return radius; }
+    int getSectorCount() const              { return sectorCount; }
+    int getStackCount() const               { return stackCount; }
+    void set(float radius, int sectorCount, int stackCount);
+    void setRadius(float radius);
+    void setSectorCount(int sectorCount);
+    void setStackCount(int stackCount);
+    BoundingBox getBounds() const;
+
+    // for vertex data
+    unsigned int getVertexCount() const     { return (unsigned int)vertices.size() / 3; }
+    unsigned int getNormalCount() const     { return (unsigned int)normals.size() / 3; }
+    unsigned int getTexCoordCount() const   { return (unsigned int)texCoords.size() / 2; }
+    unsigned int getIndexCount() const      { return (unsigned int)indices.size(); }
+    unsigned int getLineIndexCount() const  { return (unsigned int)lineIndices.size(); }
+    unsigned int getTriangleCount() const   { return getIndexCount() / 3; }
+    unsigned int getVertexSize() const      { return (unsigned int)vertices.size() * sizeof(float); }
+    unsigned int getNormalSize() const      { return (unsigned int)normals.size() * sizeof(float); }
+    unsigned int getTexCoordSize() const    { return (unsigned int)texCoords.size() * sizeof(float); }
+    unsigned int getIndexSize() const       { return (unsigned int)indices.size() * sizeof(unsigned int); }
+    unsigned int getLineIndexSize() const   { return (unsigned int)lineIndices.size() * sizeof(unsigned int); }
+    const float* getVertices() const        { return vertices.data(); }
+    const float* getNormals() const         { return normals.data(); }
+    const float* getTexCoords() const       { return texCoords.data(); }
+    const unsigned int* getIndices() const  { return indices.data(); }
+    const unsigned int* getLineIndices() const  { return lineIndices.data(); }
+
+    // for interleaved vertices: V/N/T
+    unsigned int getInterleavedVertexCount() const  { return getVertexCount(); }    // # of vertices
+    unsigned int getInterleavedVertexSize() const   { return (unsigned int)interleavedVertices.size() * sizeof(float); }    // # of bytes
+    int getInterleavedStride() const                { return interleavedStride; }   // should be 32 bytes
+    const float* getInterleavedVertices() const     { return &interleavedVertices[0]; }
+
+    // draw in VertexArray mode
+    void draw() const;                                  // draw surface
+    void drawLines(const float lineColor[4]) const;     // draw lines only
+    void drawWithLines(const float lineColor[4]) const; // draw surface and lines
+
+    // debug
+    void printSelf() const;
+
+private:
+    // member functions
+    void buildVertices();
+    void buildInterleavedVertices();
+    void buildSectorTable();
+    void clearArrays();
+    void addVertex(float x, float y, float z);
+    void addNormal(float x, float y, float z);
+    void addTexCoord(float s, float t);
+    void addIndices(unsigned int i1, unsigned int i2, unsigned int i3);
+
+    // member vars
+    float radius;
+    int sectorCount;                        // longitude, # of slices
+    int stackCount;                         // latitude, # of stacks
+    std::vector<float> sectorTable;         // cos, sin of each sector angle, shared by all stacks
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<float> texCoords;
+    std::vector<unsigned int> indices;
+    std::vector<unsigned int> lineIndices;
+
+    // interleaved
+    std::vector<float> interleavedVertices;
+    int interleavedStride;                  // # of bytes to hop to the next vertex (should be 32 bytes)
+};
+
+#endif
@@ -0,0 +1,310 @@
+///////////////////////////////////////////////////////////////////////////////
+// TextureFile.cpp
+// ===============
+// preprocessed texture file with all mipmap levels, mapped into memory
+// without any decoding
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "TextureFile.h"
+#include "BlockCompressor.h"
+#include "MipChain.h"
+
+// constants
+const char TEXTURE_MAGIC[4] = { 'C', 'T', 'E', 'X' };
+const uint32_t TEXTURE_VERSION = 1;
+const uint32_t TEXTURE_MAX_LEVELS = 17;     // 65536 to 1
+const uint64_t TEXTURE_ALIGNMENT = 16;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor/dtor
+///////////////////////////////////////////////////////////////////////////////
+TextureFile::TextureFile() : data(0), size(0), header(0), levels(0), fileHandle(0), mappingHandle(0)
+{
+}
+
+TextureFile::~TextureFile()
+{
+    close();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// map the texture file into memory, then check the header and the level table
+///////////////////////////////////////////////////////////////////////////////
+bool TextureFile::open(const char* fileName)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, 0);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        errorMessage = std::string("cannot open ") + fileName;
+        return false;
+    }
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    size = (size_t)fileSize.QuadPart;
+
+    HANDLE mapping = size ? CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0) : 0;
+    if(mapping)
+    {
+        mappingHandle = mapping;
+        data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    int fd = ::open(fileName, O_RDONLY);
+    if(fd < 0)
+    {
+        errorMessage = std::string("cannot open ") + fileName;
+        return false;
+    }
+
+    struct stat status;
+    if(fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        size = (size_t)status.st_size;
+        data = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED)
+            data = 0;
+    }
+    ::close(fd);    // the mapping stays valid after closing the file
+#endif
+
+    if(!data)
+    {
+        errorMessage = std::string("cannot map ") + fileName;
+        close();
+        return false;
+    }
+
+    // validate the header and levels, so the getters do not need any check
+    const TextureHeader* h = (const TextureHeader*)data;
+    if(size < sizeof(TextureHeader) || memcmp(h->magic, TEXTURE_MAGIC, 4) != 0 || h->version != TEXTURE_VERSION)
+    {
+        errorMessage = std::string("invalid texture file ") + fileName;
+        close();
+        return false;
+    }
+
+    bool valid = h->format <= TEXTURE_FORMAT_BC3 && h->width > 0 && h->height > 0 &&
+                 h->levelCount > 0 && h->levelCount <= TEXTURE_MAX_LEVELS &&
+                 sizeof(TextureHeader) + h->levelCount * sizeof(TextureLevel) <= size;
+    const TextureLevel* l = (const TextureLevel*)(h + 1);
+    for(uint32_t i = 0; valid && i < h->levelCount; ++i)
+    {
+        uint64_t expected;
+        if(h->format == TEXTURE_FORMAT_BC1)
+            expected = BlockCompressor::getSize(l[i].width, l[i].height, BlockCompressor::BC1_BLOCK_SIZE);
+        else if(h->format == TEXTURE_FORMAT_BC3)
+            expected = BlockCompressor::getSize(l[i].width, l[i].height, BlockCompressor::BC3_BLOCK_SIZE);
+        else
+            expected = (uint64_t)l[i].width * l[i].height * (h->format == TEXTURE_FORMAT_RGBA ? 4 : 3);
+        valid = l[i].width > 0 && l[i].height > 0 && l[i].size == expected &&
+                l[i].offset <= size && l[i].size <= size - l[i].offset;
+    }
+    if(!valid || l[0].width != h->width || l[0].height != h->height)
+    {
+        errorMessage = std::string("corrupted texture file ") + fileName;
+        close();
+        return false;
+    }
+
+    header = h;
+    levels = l;
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// unmap the file
+///////////////////////////////////////////////////////////////////////////////
+void TextureFile::close()
+{
+#ifdef _WIN32
+    if(data)
+        UnmapViewOfFile(data);
+    if(mappingHandle)
+        CloseHandle((HANDLE)mappingHandle);
+    if(fileHandle)
+        CloseHandle((HANDLE)fileHandle);
+    mappingHandle = fileHandle = 0;
+#else
+    if(data)
+        munmap((void*)data, size);
+#endif
+    data = 0;
+    size = 0;
+    header = 0;
+    levels = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// exchange the mappings without remapping
+///////////////////////////////////////////////////////////////////////////////
+void TextureFile::swap(TextureFile& other)
+{
+    std::swap(data, other.data);
+    std::swap(size, other.size);
+    std::swap(header, other.header);
+    std::swap(levels, other.levels);
+    std::swap(fileHandle, other.fileHandle);
+    std::swap(mappingHandle, other.mappingHandle);
+    errorMessage.swap(other.errorMessage);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return bytes of all levels
+///////////////////////////////////////////////////////////////////////////////
+size_t TextureFile::getByteSize() const
+{
+    size_t bytes = 0;
+    for(int i = 0; i < getLevelCount(); ++i)
+        bytes += (size_t)levels[i].size;
+    return bytes;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// write the levels of mip chain to a texture file
+///////////////////////////////////////////////////////////////////////////////
+bool TextureFile::save(const char* fileName, const MipChain& mipChain, bool compress,
+                       uint64_t sourceSize, int64_t sourceTime)
+{
+    int levelCount = mipChain.getLevelCount();
+    int channelCount = mipChain.getChannelCount();
+    if(levelCount == 0 || levelCount > (int)TEXTURE_MAX_LEVELS || (channelCount != 3 && channelCount != 4))
+        return false;
+
+    TextureHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TEXTURE_MAGIC, 4);
+    header.version = TEXTURE_VERSION;
+    if(compress)
+        header.format = (channelCount == 4) ? TEXTURE_FORMAT_BC3 : TEXTURE_FORMAT_BC1;
+    else
+        header.format = (channelCount == 4) ? TEXTURE_FORMAT_RGBA : TEXTURE_FORMAT_RGB;
+    header.width = mipChain.getLevel(0).width;
+    header.height = mipChain.getLevel(0).height;
+    header.levelCount = levelCount;
+    header.sourceSize = sourceSize;
+    header.sourceTime = sourceTime;
+
+    // level table
+    std::vector<TextureLevel> levels(levelCount);
+    uint64_t offset = sizeof(TextureHeader) + levelCount * sizeof(TextureLevel);
+    for(int i = 0; i < levelCount; ++i)
+    {
+        const MipLevel& level = mipChain.getLevel(i);
+        offset = (offset + TEXTURE_ALIGNMENT - 1) & ~(TEXTURE_ALIGNMENT - 1);
+        levels[i].width = level.width;
+        levels[i].height = level.height;
+        levels[i].offset = offset;
+        if(header.format == TEXTURE_FORMAT_BC1)
+            levels[i].size = BlockCompressor::getSize(level.width, level.height, BlockCompressor::BC1_BLOCK_SIZE);
+        else if(header.format == TEXTURE_FORMAT_BC3)
+            levels[i].size = BlockCompressor::getSize(level.width, level.height, BlockCompressor::BC3_BLOCK_SIZE);
+        else
+            levels[i].size = (uint64_t)level.width * level.height * channelCount;
+        offset += levels[i].size;
+    }
+
+    std::string tempName = std::string(fileName) + ".tmp";
+    FILE* file = fopen(tempName.c_str(), "wb");
+    if(!file)
+        return false;
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(&levels[0], sizeof(TextureLevel), levelCount, file);
+    std::vector<unsigned char> blocks;
+    const char padding[TEXTURE_ALIGNMENT] = { 0 };
+    uint64_t position = sizeof(TextureHeader) + levelCount * sizeof(TextureLevel);
+    for(int i = 0; i < levelCount; ++i)
+    {
+        fwrite(padding, 1, (size_t)(levels[i].offset - position), file);
+
+        const MipLevel& level = mipChain.getLevel(i);
+        const unsigned char* pixels = mipChain.getPixels(i);
+        if(compress)
+        {
+            blocks.resize((size_t)levels[i].size);
+            if(channelCount == 4)
+                BlockCompressor::encodeBc3(pixels, level.width, level.height, channelCount, &blocks[0]);
+            else
+                BlockCompressor::encodeBc1(pixels, level.width, level.height, channelCount, &blocks[0]);
+            pixels = &blocks[0];
+        }
+        fwrite(pixels, 1, (size_t)levels[i].size, file);
+        position = levels[i].offset + levels[i].size;
+    }
+
+    bool written = ferror(file) == 0;
+    written = (fclose(file) == 0) && written;
+    if(!written)
+    {
+        remove(tempName.c_str());
+        return false;
+    }
+
+    // replace the old file at once
+#ifdef _WIN32
+    written = MoveFileExA(tempName.c_str(), fileName, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    written = rename(tempName.c_str(), fileName) == 0;
+#endif
+    if(!written)
+        remove(tempName.c_str());
+    return written;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return size and modified time of a file, in nanoseconds if the file
+// system keeps it, otherwise in seconds * 10^9
+///////////////////////////////////////////////////////////////////////////////
+bool TextureFile::getFileStatus(const char* fileName, uint64_t& size, int64_t& time)
+{
+#ifdef _WIN32
+    struct _stat64 status;
+    if(_stat64(fileName, &status) != 0)
+        return false;
+#else
+    struct stat status;
+    if(stat(fileName, &status) != 0)
+        return false;
+#endif
+    size = (uint64_t)status.st_size;
+    time = (int64_t)status.st_mtime * 1000000000;
+#if defined(__linux__)
+    time += status.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+    time += status.st_mtimespec.tv_nsec;
+#endif
+    return true;
+}
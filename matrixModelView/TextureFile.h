@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+// TextureFile.h
+// =============
+// preprocessed texture file with all mipmap levels, mapped into memory
+// without any decoding, so each level is passed to glTexImage2D() or
+// glCompressedTexImage2DARB() straight from the mapping.
+// The levels are uncompressed RGB/RGBA, or block compressed BC1/BC3 (S3TC)
+// by BlockCompressor. The file also keeps the size and modified time of the
+// source image, to find out if the cached file is outdated.
+//
+// file layout (little-endian):
+// TextureHeader (64 bytes)
+// TextureLevel * levelCount (24 bytes each)
+// pixels of each level at TextureLevel::offset, aligned to 16 bytes
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEXTURE_FILE_H
+#define TEXTURE_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+class MipChain;
+
+enum TextureFormat
+{
+    TEXTURE_FORMAT_RGB = 0,
+    TEXTURE_FORMAT_RGBA,
+    TEXTURE_FORMAT_BC1,                     // RGB, 8 bytes per 4x4 block
+    TEXTURE_FORMAT_BC3                      // RGBA, 16 bytes per 4x4 block
+};
+
+struct TextureHeader
+{
+    char magic[4];                          // "CTEX"
+    uint32_t version;
+    uint32_t format;                        // TextureFormat
+    uint32_t width;                         // base level
+    uint32_t height;
+    uint32_t levelCount;
+    uint64_t sourceSize;                    // bytes of the source image file
+    int64_t sourceTime;                     // modified time of the source, nanoseconds since epoch
+    uint32_t reserved[6];
+};
+
+struct TextureLevel
+{
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;                        // bytes from the beginning of file
+    uint64_t size;
+};
+
+class TextureFile
+{
+public:
+    TextureFile();
+    ~TextureFile();
+
+    bool open(const char* fileName);        // map the file into memory and validate the header
+    void close();
+    bool isOpen() const                     { return header != 0; }
+    void swap(TextureFile& other);          // exchange mappings
+
+    TextureFormat getFormat() const         { return (TextureFormat)header->format; }
+    bool isCompressed() const               { return header->format >= TEXTURE_FORMAT_BC1; }
+    int getWidth() const                    { return header->width; }
+    int getHeight() const                   { return header->height; }
+    int getLevelCount() const               { return header ? header->levelCount : 0; }
+    const TextureLevel& getLevel(int level) const   { return levels[level]; }
+    const unsigned char* getPixels(int level) const { return (const unsigned char*)data + levels[level].offset; }
+    size_t getByteSize() const;             // all levels
+    uint64_t getSourceSize() const          { return header->sourceSize; }
+    int64_t getSourceTime() const           { return header->sourceTime; }
+
+    const std::string& getErrorMessage() const  { return errorMessage; }
+
+    // write all levels of the mip chain, compressed to BC1 (RGB) or BC3 (RGBA)
+    // if compress is true. It is written to a temporary file first, then
+    // renamed, so another process never maps a partial file.
+    static bool save(const char* fileName, const MipChain& mipChain, bool compress,
+                     uint64_t sourceSize, int64_t sourceTime);
+
+    // size and modified time of a file, false if it does not exist
+    static bool getFileStatus(const char* fileName, uint64_t& size, int64_t& time);
+
+private:
+    const void* data;                       // mapped file
+    size_t size;
+    const TextureHeader* header;            // 0 if not opened
+    const TextureLevel* levels;
+    void* fileHandle;                       // for Windows
+    void* mappingHandle;
+    std::string errorMessage;
+};
+
+#endif
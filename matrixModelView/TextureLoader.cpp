@@ -0,0 +1,298 @@
+///////////////////////////////////////////////////////////////////////////////
+// TextureLoader.cpp
+// =================
+// pool of worker threads decoding image files into mipmap chains
+// See TextureLoader.h for the threading model.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <climits>
+#include <cstdlib>
+#include <sys/stat.h>
+#endif
+
+#include <cstdio>
+#include <iostream>
+#include "TextureLoader.h"
+#include "BmpLoader.h"
+
+// constants
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;     // 64-bit FNV-1a
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the absolute path, or the path as is if it cannot be resolved
+///////////////////////////////////////////////////////////////////////////////
+static std::string getFullPath(const std::string& path)
+{
+#ifdef _WIN32
+    char fullPath[MAX_PATH];
+    DWORD length = GetFullPathNameA(path.c_str(), MAX_PATH, fullPath, 0);
+    if(length == 0 || length >= MAX_PATH)
+        return path;
+    return std::string(fullPath, length);
+#else
+    char fullPath[PATH_MAX];
+    if(!realpath(path.c_str(), fullPath))
+        return path;
+    return fullPath;
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor/dtor
+///////////////////////////////////////////////////////////////////////////////
+TextureLoader::TextureLoader() : busyCount(0), stopping(false), cacheCompressed(false),
+                                 cacheHitCount(0), cacheMissCount(0)
+{
+}
+
+TextureLoader::~TextureLoader()
+{
+    stop();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// create worker threads
+///////////////////////////////////////////////////////////////////////////////
+void TextureLoader::start(int threadCount)
+{
+    stop();
+
+    if(threadCount <= 0)
+    {
+        threadCount = (int)std::thread::hardware_concurrency() - 1;
+        if(threadCount < 1)
+            threadCount = 1;
+    }
+
+    stopping = false;
+    for(int i = 0; i < threadCount; ++i)
+        threads.push_back(std::thread(&TextureLoader::run, this));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// cancel the queued requests, wait for the decoding ones, then join workers
+///////////////////////////////////////////////////////////////////////////////
+void TextureLoader::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        requests.clear();
+        requestCond.notify_all();
+    }
+
+    for(size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    threads.clear();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    results.clear();
+    idleCond.notify_all();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set the function called after each decode
+///////////////////////////////////////////////////////////////////////////////
+void TextureLoader::setCallback(const std::function<void()>& callback)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    this->callback = callback;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set the cache directory, and create it if it does not exist
+///////////////////////////////////////////////////////////////////////////////
+void TextureLoader::setCache(const std::string& directory, bool compress)
+{
+    cacheDirectory = directory;
+    cacheCompressed = compress;
+    if(directory.empty())
+        return;
+
+#ifdef _WIN32
+    CreateDirectoryA(directory.c_str(), 0);
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// queue a file to decode
+///////////////////////////////////////////////////////////////////////////////
+void TextureLoader::request(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.push_back(path);
+    requestCond.notify_one();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// take the oldest decoded image without blocking
+///////////////////////////////////////////////////////////////////////////////
+bool TextureLoader::pop(TextureImage& image)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if(results.empty())
+        return false;
+
+    TextureImage& result = results.front();
+    image.path.swap(result.path);
+    image.mipChain.swap(result.mipChain);
+    image.file.swap(result.file);
+    image.errorMessage.swap(result.errorMessage);
+    results.pop_front();
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// block until no request is queued or decoding
+///////////////////////////////////////////////////////////////////////////////
+void TextureLoader::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCond.wait(lock, [this]() { return (requests.empty() && busyCount == 0) || threads.empty(); });
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return # of requests not popped yet
+///////////////////////////////////////////////////////////////////////////////
+int TextureLoader::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return (int)(requests.size() + results.size()) + busyCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// map the cached file if it is up to date, otherwise decode the file, build
+// all mipmap levels and write them to the cache
+// The compressed levels are mapped from the new cached file, so the texture
+// is same as the next run.
+///////////////////////////////////////////////////////////////////////////////
+void TextureLoader::decode(TextureImage& image)
+{
+    image.mipChain.clear();
+    image.file.close();
+    image.errorMessage.clear();
+
+    std::string cachePath;
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if(!cacheDirectory.empty() && TextureFile::getFileStatus(image.path.c_str(), sourceSize, sourceTime))
+    {
+        cachePath = getCachePath(image.path);
+        if(image.file.open(cachePath.c_str()) && image.file.isCompressed() == cacheCompressed &&
+           image.file.getSourceSize() == sourceSize && image.file.getSourceTime() == sourceTime)
+        {
+            ++cacheHitCount;
+            return;
+        }
+        image.file.close();
+        ++cacheMissCount;
+    }
+
+    BmpLoader bmp;
+    if(!bmp.load(image.path.c_str()))
+    {
+        image.errorMessage = bmp.getErrorMessage();
+        return;
+    }
+    image.mipChain.build(bmp.getPixels(), bmp.getWidth(), bmp.getHeight(), bmp.getChannelCount());
+
+    if(cachePath.empty())
+        return;
+    if(!TextureFile::save(cachePath.c_str(), image.mipChain, cacheCompressed, sourceSize, sourceTime))
+    {
+        std::cout << "[WARNING] Failed to write texture cache " << cachePath << std::endl;
+        return;
+    }
+    if(cacheCompressed && image.file.open(cachePath.c_str()))
+        image.mipChain.clear();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the cached file of the image, named by the hash of the full path
+///////////////////////////////////////////////////////////////////////////////
+std::string TextureLoader::getCachePath(const std::string& path) const
+{
+    std::string fullPath = getFullPath(path);
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for(size_t i = 0; i < fullPath.size(); ++i)
+    {
+        hash ^= (unsigned char)fullPath[i];
+        hash *= FNV_PRIME;
+    }
+
+    char fileName[32];
+    snprintf(fileName, sizeof(fileName), "/%016llx%s", (unsigned long long)hash, cacheCompressed ? ".bc.tex" : ".tex");
+    return cacheDirectory + fileName;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// worker loop, decode outside of the lock
+///////////////////////////////////////////////////////////////////////////////
+void TextureLoader::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true)
+    {
+        requestCond.wait(lock, [this]() { return stopping || !requests.empty(); });
+        if(stopping)
+            break;
+
+        TextureImage image;
+        image.path = requests.front();
+        requests.pop_front();
+        ++busyCount;
+
+        lock.unlock();
+        decode(image);
+        lock.lock();
+
+        --busyCount;
+        results.push_back(TextureImage());
+        results.back().path.swap(image.path);
+        results.back().mipChain.swap(image.mipChain);
+        results.back().file.swap(image.file);
+        results.back().errorMessage.swap(image.errorMessage);
+        if(requests.empty() && busyCount == 0)
+            idleCond.notify_all();
+
+        if(callback)
+        {
+            std::function<void()> notify = callback;
+            lock.unlock();
+            notify();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// TextureLoader.h
+// ===============
+// pool of worker threads decoding image files into mipmap chains
+// The requests are decoded in order by any idle worker, then the results are
+// popped by the rendering thread, which uploads them to OpenGL. No OpenGL
+// call is made in the workers.
+// The callback is called from a worker thread after each decode, e.g. to wake
+// up the rendering thread.
+//
+// With a cache directory, each decoded image is also written to a TextureFile
+// with all levels (block compressed if requested). The cached file is named
+// by the hash of the full path of the source, and used only if the size and
+// modified time of the source are same as when it was cached. Then the image
+// is not decoded at all; the file is mapped and uploaded as is.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MipChain.h"
+#include "TextureFile.h"
+
+// decoded image, or the cached file if it is open
+// both are empty if failed
+struct TextureImage
+{
+    std::string path;
+    MipChain mipChain;
+    TextureFile file;
+    std::string errorMessage;
+};
+
+class TextureLoader
+{
+public:
+    TextureLoader();
+    ~TextureLoader();
+
+    void start(int threadCount=0);          // 0: # of hardware threads - 1, at least 1
+    void stop();                            // cancel queued requests and join workers
+    int getThreadCount() const              { return (int)threads.size(); }
+
+    void setCallback(const std::function<void()>& callback);    // call before start()
+
+    // cache directory of texture files, empty to disable, call before start()
+    // compress: BC1 for RGB and BC3 for RGBA, otherwise the levels as decoded
+    void setCache(const std::string& directory, bool compress=false);
+    const std::string& getCacheDirectory() const    { return cacheDirectory; }
+    int getCacheHitCount() const            { return cacheHitCount; }
+    int getCacheMissCount() const           { return cacheMissCount; }
+
+    // called from the rendering thread
+    void request(const std::string& path);  // decode in background
+    bool pop(TextureImage& image);          // take a decoded image, false if none is ready
+    void wait();                            // block until all requests are decoded
+    int getPendingCount() const;            // queued or decoding
+
+    // map the cached file, or decode an image file (and cache it) on the calling thread
+    void decode(TextureImage& image);
+
+private:
+    void run();                             // worker loop
+    std::string getCachePath(const std::string& path) const;
+
+    std::vector<std::thread> threads;
+    std::deque<std::string> requests;
+    std::deque<TextureImage> results;
+    int busyCount;                          // # of workers decoding now
+    bool stopping;
+    std::function<void()> callback;
+    std::string cacheDirectory;
+    bool cacheCompressed;
+    std::atomic<int> cacheHitCount;
+    std::atomic<int> cacheMissCount;
+
+    mutable std::mutex mutex;
+    std::condition_variable requestCond;    // wake up workers
+    std::condition_variable idleCond;       // wake up wait()
+};
+
+#endif
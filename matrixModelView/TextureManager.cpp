@@ -0,0 +1,484 @@
+///////////////////////////////////////////////////////////////////////////////
+// TextureManager.cpp
+// ==================
+// registry of OpenGL textures keyed by file path
+// Each image file is decoded and uploaded only once, then the same texture id
+// is returned for every request. All textures are deleted by clear().
+// The files are decoded by worker threads (or mapped from the cache), then
+// uploaded within a budget per frame, see TextureManager.h.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureManager.h"
+#ifdef __APPLE__
+#include <OpenGL/glu.h>
+#else
+#include <GL/glu.h>
+#endif
+#include <cstring>
+#include <iostream>
+#include "BlockCompressor.h"
+#include "FrameScheduler.h"
+#include "glExtension.h"
+
+// constants //////////////////////////////////////////////////////////////////
+const unsigned int DEFAULT_UPLOAD_BUDGET = 4 * 1024 * 1024;     // bytes per frame
+const unsigned char PLACEHOLDER_PIXELS[] = { 160, 160, 160,  96,  96,  96,      // 2x2 grey checker
+                                              96,  96,  96, 160, 160, 160 };
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+TextureManager::TextureManager() : placeholderId(0), pboId(0), pboSupported(false), npotSupported(false),
+                                   s3tcSupported(false), cacheCompressed(false), uploadBudget(DEFAULT_UPLOAD_BUDGET), frameScheduler(0),
+                                   hitCount(0), missCount(0), bytesResident(0), pendingCount(0), uploadedBytes(0)
+{
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// check extensions, create the placeholder and start decoding workers
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void TextureManager::init(int threadCount)
+{
+    glExtension& extension = glExtension::getInstance();
+    pboSupported = extension.isSupported("GL_ARB_vertex_buffer_object") &&
+                   extension.isSupported("GL_ARB_pixel_buffer_object");
+    npotSupported = extension.isSupported("GL_ARB_texture_non_power_of_two");
+    s3tcSupported = extension.isSupported("GL_ARB_texture_compression") &&
+                    extension.isSupported("GL_EXT_texture_compression_s3tc");
+    if(pboSupported && !pboId)
+        glGenBuffersARB(1, &pboId);
+
+    // GLU cannot rescale compressed levels for OpenGL 1.x, so cache them as is
+    loader.setCache(cacheDirectory, cacheCompressed && s3tcSupported && npotSupported);
+
+    createPlaceholder();
+
+    // wake up the rendering thread to upload the decoded texture
+    loader.setCallback([this]()
+    {
+        if(frameScheduler)
+            frameScheduler->requestRedraw();
+    });
+    loader.start(threadCount);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return texture id of the image file
+// The file is requested at the first call only. The placeholder is returned
+// until the texture is uploaded, and 0 if the file is invalid.
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+GLuint TextureManager::getTexture(const std::string& path)
+{
+    std::map<std::string, Texture>::iterator iter = textures.find(path);
+    if(iter == textures.end())
+    {
+        ++missCount;
+        Texture texture;
+        texture.id = 0;
+        texture.width = texture.height = 0;
+        texture.bytes = 0;
+        texture.state = TEXTURE_LOADING;
+        iter = textures.insert(std::make_pair(path, texture)).first;
+        ++pendingCount;
+
+        if(loader.getThreadCount() > 0)
+        {
+            loader.request(path);
+        }
+        else
+        {
+            // no worker (init() is not called), decode and upload now
+            TextureImage image;
+            image.path = path;
+            loader.decode(image);
+            beginUpload(image);
+            uploadLevels((size_t)-1);
+        }
+    }
+    else
+    {
+        ++hitCount;
+    }
+
+    const Texture& texture = iter->second;
+    if(texture.state == TEXTURE_READY || texture.state == TEXTURE_FAILED)
+        return texture.id;
+    else
+        return placeholderId;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// take the decoded textures, then upload them within the budget
+// If there is more to upload, the next frame is requested.
+///////////////////////////////////////////////////////////////////////////////
+void TextureManager::update()
+{
+    TextureImage image;
+    while(loader.pop(image))
+        beginUpload(image);
+
+    if(uploads.empty())
+        return;
+
+    uploadLevels(uploadBudget);
+    if(!uploads.empty() && frameScheduler)
+        frameScheduler->requestRedraw();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// block until all requested textures are decoded, then upload all of them
+///////////////////////////////////////////////////////////////////////////////
+void TextureManager::finish()
+{
+    loader.wait();
+
+    TextureImage image;
+    while(loader.pop(image))
+        beginUpload(image);
+    uploadLevels((size_t)-1);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// delete all textures
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void TextureManager::clear()
+{
+    loader.stop();
+    uploads.clear();
+
+    std::map<std::string, Texture>::iterator iter;
+    for(iter = textures.begin(); iter != textures.end(); ++iter)
+    {
+        if(iter->second.id)
+            glDeleteTextures(1, &iter->second.id);
+    }
+    textures.clear();
+    bytesResident = 0;
+    pendingCount = 0;
+
+    if(placeholderId)
+    {
+        glDeleteTextures(1, &placeholderId);
+        placeholderId = 0;
+    }
+    if(pboId)
+    {
+        glDeleteBuffersARB(1, &pboId);
+        pboId = 0;
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set the cache directory of texture files, applied by init()
+///////////////////////////////////////////////////////////////////////////////
+void TextureManager::setCache(const std::string& directory, bool compress)
+{
+    cacheDirectory = directory;
+    cacheCompressed = compress;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// 2x2 checker without mipmaps
+///////////////////////////////////////////////////////////////////////////////
+void TextureManager::createPlaceholder()
+{
+    if(placeholderId)
+        return;
+
+    glGenTextures(1, &placeholderId);
+    glBindTexture(GL_TEXTURE_2D, placeholderId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 2, 2, 0, GL_RGB, GL_UNSIGNED_BYTE, PLACEHOLDER_PIXELS);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);          // restore default of ModelGL::init()
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// create the texture object, the levels are allocated and uploaded later by
+// uploadLevels()
+///////////////////////////////////////////////////////////////////////////////
+void TextureManager::beginUpload(TextureImage& image)
+{
+    std::map<std::string, Texture>::iterator iter = textures.find(image.path);
+    if(iter == textures.end())
+        return;                             // cleared while decoding
+
+    Texture& texture = iter->second;
+    const MipChain& mipChain = image.mipChain;
+    const TextureFile& file = image.file;
+    if(!file.isOpen() && mipChain.getLevelCount() == 0)
+    {
+        // keep id 0 for invalid file, so it is not decoded again at every frame
+        std::cout << "[ERROR] " << image.errorMessage << std::endl;
+        texture.state = TEXTURE_FAILED;
+        --pendingCount;
+        return;
+    }
+
+    GLenum format;
+    GLenum internalFormat;
+    const unsigned char* pixels;
+    if(file.isOpen())
+    {
+        TextureFormat fileFormat = file.getFormat();
+        format = (fileFormat == TEXTURE_FORMAT_RGBA || fileFormat == TEXTURE_FORMAT_BC3) ? GL_RGBA : GL_RGB;
+        if(fileFormat == TEXTURE_FORMAT_BC1)
+            internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        else if(fileFormat == TEXTURE_FORMAT_BC3)
+            internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        else
+            internalFormat = format;
+        texture.width = file.getWidth();
+        texture.height = file.getHeight();
+        texture.bytes = (unsigned int)file.getByteSize();
+        pixels = file.getPixels(0);
+    }
+    else
+    {
+        format = internalFormat = (mipChain.getChannelCount() == 4) ? GL_RGBA : GL_RGB;
+        texture.width = mipChain.getLevel(0).width;
+        texture.height = mipChain.getLevel(0).height;
+        texture.bytes = (unsigned int)mipChain.getByteSize();
+        pixels = mipChain.getPixels(0);
+    }
+
+    // sample level 0 only until all levels are uploaded, see uploadLevels()
+    glGenTextures(1, &texture.id);
+    glBindTexture(GL_TEXTURE_2D, texture.id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    bool powerOfTwo = (texture.width & (texture.width - 1)) == 0 && (texture.height & (texture.height - 1)) == 0;
+    if(!powerOfTwo && !npotSupported)
+    {
+        // OpenGL 1.x, let GLU rescale it to power of two at once
+        // (never compressed, see init())
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        gluBuild2DMipmaps(GL_TEXTURE_2D, format, texture.width, texture.height, format, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        texture.state = TEXTURE_READY;
+        bytesResident += texture.bytes;
+        uploadedBytes += texture.bytes;
+        --pendingCount;
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    texture.state = TEXTURE_UPLOADING;
+
+    uploads.push_back(Upload());
+    Upload& upload = uploads.back();
+    upload.path = image.path;
+    upload.mipChain.swap(image.mipChain);
+    upload.file.swap(image.file);
+    upload.format = format;
+    upload.internalFormat = internalFormat;
+    upload.allocated = false;
+    upload.level = 0;
+    upload.row = 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// upload the queued textures in order until the budget is spent
+// The first step of a frame is always done even if it is over the budget.
+// When the chain is complete, the texture is switched to trilinear filtering.
+///////////////////////////////////////////////////////////////////////////////
+void TextureManager::uploadLevels(size_t budget)
+{
+    if(uploads.empty())
+        return;
+
+    size_t spent = 0;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);          // rows are tightly packed
+    while(!uploads.empty())
+    {
+        Upload& upload = uploads.front();
+        if(!uploadRows(upload, budget, spent))
+            break;
+
+        // the texture is still bound by uploadRows()
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+        Texture& texture = textures[upload.path];
+        texture.state = TEXTURE_READY;
+        bytesResident += texture.bytes;
+        --pendingCount;
+        uploads.pop_front();
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);          // restore default of ModelGL::init()
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// allocate all levels, then upload the rows of the remaining levels
+// The allocation costs the size of all levels, because some drivers clear the
+// whole storage at once (e.g. Mesa llvmpipe).
+// The compressed levels are uploaded by block rows (4 texel rows each).
+// It returns true if all levels are uploaded.
+///////////////////////////////////////////////////////////////////////////////
+bool TextureManager::uploadRows(Upload& upload, size_t budget, size_t& spent)
+{
+    int levelCount = getLevelCount(upload);
+    glBindTexture(GL_TEXTURE_2D, textures[upload.path].id);
+
+    int width, height;
+    const unsigned char* pixels;
+    if(!upload.allocated)
+    {
+        size_t bytes = upload.file.isOpen() ? upload.file.getByteSize() : upload.mipChain.getByteSize();
+        if(spent > 0 && spent + bytes > budget)
+            return false;
+
+        // from the smallest level, so the storage is not relayouted at each level
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        for(int i = levelCount - 1; i >= 0; --i)
+        {
+            getLevel(upload, i, width, height, pixels);
+            glTexImage2D(GL_TEXTURE_2D, i, upload.internalFormat, width, height, 0, upload.format, GL_UNSIGNED_BYTE, 0);
+        }
+        upload.allocated = true;
+        spent += bytes;
+    }
+
+    int texelRows = 1;                      // per row of the upload
+    int blockSize = 0;
+    if(upload.internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+        blockSize = BlockCompressor::BC1_BLOCK_SIZE;
+    else if(upload.internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+        blockSize = BlockCompressor::BC3_BLOCK_SIZE;
+    if(blockSize)
+        texelRows = 4;
+
+    while(upload.level < levelCount)
+    {
+        getLevel(upload, upload.level, width, height, pixels);
+        int rowCount = (height + texelRows - 1) / texelRows;
+        size_t rowSize = blockSize ? BlockCompressor::getSize(width, 4, blockSize)
+                                   : (size_t)width * ((upload.format == GL_RGBA) ? 4 : 3);
+        size_t rows = (spent < budget) ? (budget - spent) / rowSize : 0;
+        if(rows < 1)
+        {
+            if(spent > 0)
+                return false;
+            rows = 1;
+        }
+        if(rows > (size_t)(rowCount - upload.row))
+            rows = rowCount - upload.row;
+
+        // the last block row may be shorter than 4 texels
+        int y = upload.row * texelRows;
+        int subHeight = (int)rows * texelRows;
+        if(subHeight > height - y)
+            subHeight = height - y;
+
+        size_t bytes = rowSize * rows;
+        uploadSubImage(upload, y, width, subHeight, bytes, pixels + rowSize * upload.row);
+        spent += bytes;
+        uploadedBytes += (unsigned int)bytes;
+
+        upload.row += (int)rows;
+        if(upload.row == rowCount)
+        {
+            ++upload.level;
+            upload.row = 0;
+        }
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// copy rows to the orphaned PBO, then the driver copies it to the texture
+// without blocking; or upload directly from the system memory without PBO
+///////////////////////////////////////////////////////////////////////////////
+void TextureManager::uploadSubImage(const Upload& upload, int y, int width, int height, size_t size,
+                                    const unsigned char* pixels)
+{
+    bool compressed = upload.internalFormat != upload.format;
+    if(pboSupported)
+    {
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, pboId);
+        glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, size, 0, GL_STREAM_DRAW_ARB);
+        void* buffer = glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+        if(buffer)
+        {
+            memcpy(buffer, pixels, size);
+            glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB);
+            if(compressed)
+                glCompressedTexSubImage2DARB(GL_TEXTURE_2D, upload.level, 0, y, width, height, upload.internalFormat, (GLsizei)size, 0);
+            else
+                glTexSubImage2D(GL_TEXTURE_2D, upload.level, 0, y, width, height, upload.format, GL_UNSIGNED_BYTE, 0);
+            glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+            return;
+        }
+        glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+    }
+
+    if(compressed)
+        glCompressedTexSubImage2DARB(GL_TEXTURE_2D, upload.level, 0, y, width, height, upload.internalFormat, (GLsizei)size, pixels);
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, upload.level, 0, y, width, height, upload.format, GL_UNSIGNED_BYTE, pixels);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return # of levels and a level of the upload, from the cached file or the
+// decoded mip chain
+///////////////////////////////////////////////////////////////////////////////
+int TextureManager::getLevelCount(const Upload& upload)
+{
+    return upload.file.isOpen() ? upload.file.getLevelCount() : upload.mipChain.getLevelCount();
+}
+
+void TextureManager::getLevel(const Upload& upload, int level, int& width, int& height, const unsigned char*& pixels)
+{
+    if(upload.file.isOpen())
+    {
+        const TextureLevel& fileLevel = upload.file.getLevel(level);
+        width = fileLevel.width;
+        height = fileLevel.height;
+        pixels = upload.file.getPixels(level);
+    }
+    else
+    {
+        const MipLevel& mipLevel = upload.mipChain.getLevel(level);
+        width = mipLevel.width;
+        height = mipLevel.height;
+        pixels = upload.mipChain.getPixels(level);
+    }
+}
@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// TextureManager.h
+// ================
+// registry of OpenGL textures keyed by file path
+// Each image file is decoded and uploaded only once, then the same texture id
+// is returned for every request. All textures are deleted by clear().
+// The counters show if steady-state frames do any disk or upload work.
+//
+// The files are decoded with the mipmaps by the worker threads of
+// TextureLoader. Until a texture is uploaded, getTexture() returns a small
+// placeholder texture. update() allocates the levels and uploads them row by
+// row, no more than the upload budget per frame (at least 1 step), through a
+// streaming pixel buffer object if GL_ARB_pixel_buffer_object is supported,
+// so a large texture set is spread over many frames instead of stalling one.
+//
+// With a cache directory, the decoded levels are kept in texture files (see
+// TextureLoader.h), optionally block compressed to BC1/BC3 if the driver
+// supports GL_EXT_texture_compression_s3tc. A compressed texture takes 1/6
+// (RGB) or 1/4 (RGBA) of the GPU memory, and is uploaded by block rows with
+// glCompressedTexSubImage2DARB() straight from the mapped file.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEXTURE_MANAGER_H
+#define TEXTURE_MANAGER_H
+
+#ifdef _WIN32
+#include <windows.h>    // include windows.h to avoid thousands of compile errors even though this class is not depending on Windows
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <deque>
+#include <map>
+#include <string>
+#include "TextureLoader.h"
+
+class FrameScheduler;
+
+class TextureManager
+{
+public:
+    TextureManager();
+    ~TextureManager() {}
+
+    void init(int threadCount=0);                   // check extensions and start workers, OpenGL RC must be set
+    GLuint getTexture(const std::string& path);     // request once, then return cached id (or placeholder while loading)
+    void update();                                  // upload decoded textures within the budget, call once per frame
+    void finish();                                  // block until all requested textures are uploaded
+    void clear();                                   // stop workers and delete all textures, OpenGL RC must be set
+
+    // cache of decoded textures on disk, call before init(), empty to disable
+    // compress is ignored if S3TC is not supported
+    void setCache(const std::string& directory, bool compress=false);
+
+    void setUploadBudget(unsigned int bytes)        { uploadBudget = bytes; }   // per update()
+    unsigned int getUploadBudget() const            { return uploadBudget; }
+
+    // scheduler to draw a new frame when a texture is decoded or partially uploaded
+    void setFrameScheduler(FrameScheduler* scheduler) { frameScheduler = scheduler; }
+
+    // stats
+    unsigned int getTextureCount() const    { return (unsigned int)textures.size(); }
+    unsigned int getHitCount() const        { return hitCount; }
+    unsigned int getMissCount() const       { return missCount; }
+    unsigned int getBytesResident() const   { return bytesResident; }  // incl. mipmaps
+    unsigned int getPendingCount() const    { return pendingCount; }   // decoding or uploading
+    unsigned int getUploadedBytes() const   { return uploadedBytes; }  // since resetCounters()
+    bool isPboSupported() const             { return pboSupported; }
+    bool isCompressionSupported() const     { return s3tcSupported; }
+    unsigned int getCacheHitCount() const   { return loader.getCacheHitCount(); }
+    void resetCounters()                    { hitCount = missCount = uploadedBytes = 0; }
+
+private:
+    enum TextureState
+    {
+        TEXTURE_LOADING = 0,                // decoding in a worker
+        TEXTURE_UPLOADING,                  // levels are being allocated and uploaded
+        TEXTURE_READY,
+        TEXTURE_FAILED                      // invalid file, id is 0
+    };
+
+    struct Texture
+    {
+        GLuint id;
+        int width;
+        int height;
+        unsigned int bytes;
+        int state;
+    };
+
+    // decoded texture waiting for upload
+    struct Upload
+    {
+        std::string path;
+        MipChain mipChain;                  // decoded levels, or
+        TextureFile file;                   // mapped levels from the cache
+        GLenum format;                      // GL_RGB or GL_RGBA
+        GLenum internalFormat;              // same as format, or S3TC
+        bool allocated;                     // storage of all levels
+        int level;                          // next level and row to upload
+        int row;                            // 4 texel rows per block row if compressed
+    };
+
+    void createPlaceholder();
+    void beginUpload(TextureImage& image);
+    void uploadLevels(size_t budget);       // upload the queued levels up to budget bytes
+    bool uploadRows(Upload& upload, size_t budget, size_t& spent);  // true if all levels are uploaded
+    void uploadSubImage(const Upload& upload, int y, int width, int height, size_t size, const unsigned char* pixels);
+    static int getLevelCount(const Upload& upload);
+    static void getLevel(const Upload& upload, int level, int& width, int& height, const unsigned char*& pixels);
+
+    std::map<std::string, Texture> textures;
+    TextureLoader loader;
+    std::deque<Upload> uploads;
+    GLuint placeholderId;
+    GLuint pboId;                           // streaming pixel unpack buffer
+    bool pboSupported;
+    bool npotSupported;                     // otherwise non-power-of-two images are rescaled by GLU
+    bool s3tcSupported;
+    std::string cacheDirectory;
+    bool cacheCompressed;
+    unsigned int uploadBudget;
+    FrameScheduler* frameScheduler;
+    unsigned int hitCount;
+    unsigned int missCount;
+    unsigned int bytesResident;
+    unsigned int pendingCount;
+    unsigned int uploadedBytes;
+};
+
+#endif
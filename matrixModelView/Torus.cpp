@@ -0,0 +1,364 @@
+///////////////////////////////////////////////////////////////////////////////
+// Torus.cpp
+// =========
+// Torus for OpenGL with (major radius, minor radius, sectors, sides)
+// The min number of sectors and sides is 3.
+// The torus lies on XY plane around z-axis.
+// - major radius: the distance from the center of the torus to the center of
+//                 the tube
+// - minor radius: the radius of the tube
+// - sectors     : the number of slices around z-axis
+// - sides       : the number of slices around the tube
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>    // include windows.h to avoid thousands of compile errors even though this class is not depending on Windows
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <iostream>
+#include <cmath>
+#include "Torus.h"
+
+
+
+// constants //////////////////////////////////////////////////////////////////
+const int MIN_SECTOR_COUNT = 3;
+const int MIN_SIDE_COUNT   = 3;
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ctor
+///////////////////////////////////////////////////////////////////////////////
+Torus::Torus(float majorRadius, float minorRadius, int sectors, int sides)
+    : majorRadius(0), minorRadius(0), sectorCount(0), sideCount(0), interleavedStride(32)
+{
+    set(majorRadius, minorRadius, sectors, sides);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// setters
+///////////////////////////////////////////////////////////////////////////////
+void Torus::set(float majorRadius, float minorRadius, int sectors, int sides)
+{
+    if(sectors < MIN_SECTOR_COUNT)
+        sectors = MIN_SECTOR_COUNT;
+    if(sides < MIN_SIDE_COUNT)
+        sides = MIN_SIDE_COUNT;
+
+    this->majorRadius = majorRadius;
+    this->minorRadius = minorRadius;
+    if(this->sectorCount != sectors || this->sideCount != sides)
+    {
+        this->sectorCount = sectors;
+        this->sideCount = sides;
+        buildTrigTables();
+    }
+
+    buildVertices();
+}
+
+void Torus::setMajorRadius(float radius)
+{
+    if(this->majorRadius != radius)
+        set(radius, minorRadius, sectorCount, sideCount);
+}
+
+void Torus::setMinorRadius(float radius)
+{
+    if(this->minorRadius != radius)
+        set(majorRadius, radius, sectorCount, sideCount);
+}
+
+void Torus::setSectorCount(int sectors)
+{
+    if(sectors != this->sectorCount)
+        set(majorRadius, minorRadius, sectors, sideCount);
+}
+
+void Torus::setSideCount(int sides)
+{
+    if(sides != this->sideCount)
+        set(majorRadius, minorRadius, sectorCount, sides);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the bounding box without scanning vertices
+///////////////////////////////////////////////////////////////////////////////
+BoundingBox Torus::getBounds() const
+{
+    float radius = majorRadius + minorRadius;
+    return BoundingBox(Vector3(-radius, -radius, -minorRadius), Vector3(radius, radius, minorRadius));
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// print itself
+///////////////////////////////////////////////////////////////////////////////
+void Torus::printSelf() const
+{
+    std::cout << "===== Torus =====\n"
+              << "  Major Radius: " << majorRadius << "\n"
+              << "  Minor Radius: " << minorRadius << "\n"
+              << "  Sector Count: " << sectorCount << "\n"
+              << "    Side Count: " << sideCount << "\n"
+              << "Triangle Count: " << getTriangleCount() << "\n"
+              << "   Index Count: " << getIndexCount() << "\n"
+              << "  Vertex Count: " << getVertexCount() << "\n"
+              << "  Normal Count: " << getNormalCount() << "\n"
+              << "TexCoord Count: " << getTexCoordCount() << std::endl;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw a torus in VertexArray mode
+// OpenGL RC must be set before calling it
+///////////////////////////////////////////////////////////////////////////////
+void Torus::draw() const
+{
+    // interleaved array
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, interleavedStride, &interleavedVertices[0]);
+    glNormalPointer(GL_FLOAT, interleavedStride, &interleavedVertices[3]);
+    glTexCoordPointer(2, GL_FLOAT, interleavedStride, &interleavedVertices[6]);
+
+    glDrawElements(GL_TRIANGLES, (unsigned int)indices.size(), GL_UNSIGNED_INT, indices.data());
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw lines only
+// the caller must set the line width before call this
+///////////////////////////////////////////////////////////////////////////////
+void Torus::drawLines(const float lineColor[4]) const
+{
+    // set line colour
+    glColor4fv(lineColor);
+    glMaterialfv(GL_FRONT, GL_DIFFUSE,   lineColor);
+
+    // draw lines with VA
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, vertices.data());
+
+    glDrawElements(GL_LINES, (unsigned int)lineIndices.size(), GL_UNSIGNED_INT, lineIndices.data());
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// draw a torus surfaces and lines on top of it
+// the caller must set the line width before call this
+///////////////////////////////////////////////////////////////////////////////
+void Torus::drawWithLines(const float lineColor[4]) const
+{
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(1.0, 1.0f); // move polygon backward
+    this->draw();
+    glDisable(GL_POLYGON_OFFSET_FILL);
+
+    // draw lines with VA
+    drawLines(lineColor);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// dealloc vectors
+///////////////////////////////////////////////////////////////////////////////
+void Torus::clearArrays()
+{
+    std::vector<float>().swap(vertices);
+    std::vector<float>().swap(normals);
+    std::vector<float>().swap(texCoords);
+    std::vector<unsigned int>().swap(indices);
+    std::vector<unsigned int>().swap(lineIndices);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// build vertices of torus with smooth shading
+// x = (R + r * cos(u)) * cos(v)
+// y = (R + r * cos(u)) * sin(v)
+// z = r * sin(u)
+// where u: side angle around the tube (0 <= u <= 360)
+//       v: sector angle around z-axis (0 <= v <= 360)
+// The vertices are stored side by side, and the first and last vertices of
+// each side, and the first and last sides have the same position but
+// different tex coords.
+///////////////////////////////////////////////////////////////////////////////
+void Torus::buildVertices()
+{
+    clearArrays();
+    vertices.reserve((size_t)(sideCount + 1) * (sectorCount + 1) * 3);
+    normals.reserve(vertices.capacity());
+    texCoords.reserve((size_t)(sideCount + 1) * (sectorCount + 1) * 2);
+
+    for(int i = 0, m = 0; i <= sideCount; ++i, m += 2)
+    {
+        float cosU = sideTable[m];
+        float sinU = sideTable[m + 1];
+        float xy = majorRadius + minorRadius * cosU;    // distance from z-axis
+        float z = minorRadius * sinU;
+
+        for(int j = 0, k = 0; j <= sectorCount; ++j, k += 2)
+        {
+            float cosV = sectorTable[k];
+            float sinV = sectorTable[k + 1];
+            addVertex(xy * cosV, xy * sinV, z);
+            addNormal(cosU * cosV, cosU * sinV, sinU);
+            addTexCoord((float)i / sideCount, (float)j / sectorCount);
+        }
+    }
+
+    // indices, counter-clockwise from outside
+    //  k1--k1+1
+    //  |  \ |
+    //  |   \|
+    //  k2--k2+1
+    for(int i = 0; i < sideCount; ++i)
+    {
+        unsigned int k1 = i * (sectorCount + 1);    // beginning of current side
+        unsigned int k2 = k1 + sectorCount + 1;     // beginning of next side
+
+        for(int j = 0; j < sectorCount; ++j, ++k1, ++k2)
+        {
+            // 2 triangles per sector
+            addIndices(k1, k2 + 1, k2);
+            addIndices(k1, k1 + 1, k2 + 1);
+
+            // lines along the tube and around z-axis
+            lineIndices.push_back(k1);
+            lineIndices.push_back(k2);
+            lineIndices.push_back(k1);
+            lineIndices.push_back(k1 + 1);
+        }
+    }
+
+    // generate interleaved vertex array as well
+    buildInterleavedVertices();
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// generate interleaved vertices: V/N/T
+// stride must be 32 bytes
+///////////////////////////////////////////////////////////////////////////////
+void Torus::buildInterleavedVertices()
+{
+    std::vector<float>().swap(interleavedVertices);
+    interleavedVertices.reserve(vertices.size() / 3 * 8);
+
+    std::size_t i, j;
+    std::size_t count = vertices.size();
+    for(i = 0, j = 0; i < count; i += 3, j += 2)
+    {
+        interleavedVertices.insert(interleavedVertices.end(), &vertices[i], &vertices[i] + 3);
+        interleavedVertices.insert(interleavedVertices.end(), &normals[i], &normals[i] + 3);
+        interleavedVertices.insert(interleavedVertices.end(), &texCoords[j], &texCoords[j] + 2);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// compute cos and sin of the sector and side angles once, they are reused
+// for every vertex instead of 2 calls per vertex
+// the last entry of each table wraps around to the first angle
+///////////////////////////////////////////////////////////////////////////////
+void Torus::buildTrigTables()
+{
+    const float TAU = 2 * acosf(-1);
+
+    std::vector<float>().swap(sectorTable);
+    sectorTable.reserve((size_t)(sectorCount + 1) * 2);
+    for(int i = 0; i <= sectorCount; ++i)
+    {
+        float sectorAngle = i * TAU / sectorCount;
+        sectorTable.push_back(cosf(sectorAngle));
+        sectorTable.push_back(sinf(sectorAngle));
+    }
+
+    // sides start at the half step
+    std::vector<float>().swap(sideTable);
+    sideTable.reserve((size_t)(sideCount + 1) * 2);
+    for(int i = 0; i <= sideCount; ++i)
+    {
+        float sideAngle = ((i % sideCount) + 0.5f) * TAU / sideCount;
+        sideTable.push_back(cosf(sideAngle));
+        sideTable.push_back(sinf(sideAngle));
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single vertex to array
+///////////////////////////////////////////////////////////////////////////////
+void Torus::addVertex(float x, float y, float z)
+{
+    vertices.push_back(x);
+    vertices.push_back(y);
+    vertices.push_back(z);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single normal to array
+///////////////////////////////////////////////////////////////////////////////
+void Torus::addNormal(float nx, float ny, float nz)
+{
+    normals.push_back(nx);
+    normals.push_back(ny);
+    normals.push_back(nz);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add single texture coord to array
+///////////////////////////////////////////////////////////////////////////////
+void Torus::addTexCoord(float s, float t)
+{
+    texCoords.push_back(s);
+    texCoords.push_back(t);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// add 3 indices to array
+///////////////////////////////////////////////////////////////////////////////
+void Torus::addIndices(unsigned int i1, unsigned int i2, unsigned int i3)
+{
+    indices.push_back(i1);
+    indices.push_back(i2);
+    indices.push_back(i3);
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// Torus.h
+// =======
+// Torus for OpenGL with (major radius, minor radius, sectors, sides)
+// The min number of sectors and sides is 3.
+// The torus lies on XY plane around z-axis.
+// - major radius: the distance from the center of the torus to the center of
+//                 the tube
+// - minor radius: the radius of the tube
+// - sectors     : the number of slices around z-axis
+// - sides       : the number of slices around the tube
+// The sides start at the half step, so the top and bottom of a torus with few
+// sides are flat, e.g. a 3x3 torus.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef GEOMETRY_TORUS_H
+#define GEOMETRY_TORUS_H
+
+#include <vector>
+#include "BoundingBox.h"
+
+class Torus
+{
+public:
+    // ctor/dtor
+    Torus(float majorRadius=1.0f, float minorRadius=0.5f, int sectorCount=36, int sideCount=18);
+    ~Torus() {}
+
+    // getters/setters
+    float getMajorRadius() const            { return majorRadius; }
+    float getMinorRadius() const            { return minorRadius; }
+    int getSectorCount() const              { return sectorCount; }
+    int getSideCount() const                { return sideCount; }
+    void set(float majorRadius, float minorRadius, int sectorCount, int sideCount);
+    void setMajorRadius(float radius);
+    void setMinorRadius(float radius);
+    void setSectorCount(int sectorCount);
+    void setSideCount(int sideCount);
+    BoundingBox getBounds() const;
+
+    // for vertex data
+    unsigned int getVertexCount() const     { return (unsigned int)vertices.size() / 3; }
+    unsigned int getNormalCount() const     { return (unsigned int)normals.size() / 3; }
+    unsigned int getTexCoordCount() const   { return (unsigned int)texCoords.size() / 2; }
+    unsigned int getIndexCount() const      { return (unsigned int)indices.size(); }
+    unsigned int getLineIndexCount() const  { return (unsigned int)lineIndices.size(); }
+    unsigned int getTriangleCount() const   { return getIndexCount() / 3; }
+    unsigned int getVertexSize() const      { return (unsigned int)vertices.size() * sizeof(float); }
+    unsigned int getNormalSize() const      { return (unsigned int)normals.size() * sizeof(float); }
+    unsigned int getTexCoordSize() const    { return (unsigned int)texCoords.size() * sizeof(float); }
+    unsigned int getIndexSize() const       { return (unsigned int)indices.size() * sizeof(unsigned int); }
+    unsigned int getLineIndexSize() const   { return (unsigned int)lineIndices.size() * sizeof(unsigned int); }
+    const float* getVertices() const        { return vertices.data(); }
+    const float* getNormals() const         { return normals.data(); }
+    const float* getTexCoords() const       { return texCoords.data(); }
+    const unsigned int* getIndices() const  { return indices.data(); }
+    const unsigned int* getLineIndices() const  { return lineIndices.data(); }
+
+    // for interleaved vertices: V/N/T
+    unsigned int getInterleavedVertexCount() const  { return getVertexCount(); }    // # of vertices
+    unsigned int getInterleavedVertexSize() const   { return (unsigned int)interleavedVertices.size() * sizeof(float); }    // # of bytes
+    int getInterleavedStride() const                { return interleavedStride; }   // should be 32 bytes
+    const float* getInterleavedVertices() const     { return &interleavedVertices[0]; }
+
+    // draw in VertexArray mode
+    void draw() const;                                  // draw surface
+    void drawLines(const float lineColor[4]) const;     // draw lines only
+    void drawWithLines(const float lineColor[4]) const; // draw surface and lines
+
+    // debug
+    void printSelf() const;
+
+private:
+    // member functions
+    void buildVertices();
+    void buildInterleavedVertices();
+    void buildTrigTables();
+    void clearArrays();
+    void addVertex(float x, float y, float z);
+    void addNormal(float x, float y, float z);
+    void addTexCoord(float s, float t);
+    void addIndices(unsigned int i1, unsigned int i2, unsigned int i3);
+
+    // member vars
+    float majorRadius;
+    float minorRadius;
+    int sectorCount;                        // # of slices around z-axis
+    int sideCount;                          // # of slices around the tube
+    std::vector<float> sectorTable;         // cos, sin of each sector angle, shared by all sides
+    std::vector<float> sideTable;           // cos, sin of each side angle
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<float> texCoords;
+    std::vector<unsigned int> indices;
+    std::vector<unsigned int> lineIndices;
+
+    // interleaved
+    std::vector<float> interleavedVertices;
+    int interleavedStride;                  // # of bytes to hop to the next vertex (should be 32 bytes)
+};
+
+#endif
@@ -475,10 +475,15 @@ void ViewFormGL::updateMatrices()
     std::wstringstream wss;
     int i;
 
+    // copies of the matrices, they can be changed by the rendering thread
+    Matrix4 matView = model->getViewMatrix();
+    Matrix4 matModel = model->getModelMatrix();
+    Matrix4 matModelView = model->getModelViewMatrix();
+
     // convert number to string with limited decimal points
     wss << std::fixed << std::setprecision(2);
 
-    matrix = model->getViewMatrixElements();
+    matrix = matView.get();
     for (i = 0; i < 16; ++i)
     {
         wss.str(L"");
@@ -486,7 +491,7 @@ void ViewFormGL::updateMatrices()
         mv[i].setText(wss.str().c_str());
     }
 
-    matrix = model->getModelMatrixElements();
+    matrix = matModel.get();
     for (i = 0; i < 16; ++i)
     {
         wss.str(L"");
@@ -494,7 +499,7 @@ void ViewFormGL::updateMatrices()
         mm[i].setText(wss.str().c_str());
     }
 
-    matrix = model->getModelViewMatrixElements();
+    matrix = matModelView.get();
     for (i = 0; i < 16; ++i)
     {
         wss.str(L"");
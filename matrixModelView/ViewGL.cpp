@@ -331,3 +331,16 @@ void ViewGL::swapBuffers()
 {
     ::SwapBuffers(hdc);
 }
+
+///////////////////////////////////////////////////////////////////////////////
+// set the number of vblanks to wait for swap, 0 disables vsync
+// it requires WGL_EXT_swap_control and the RC must be current in this thread
+///////////////////////////////////////////////////////////////////////////////
+bool ViewGL::setSwapInterval(int interval)
+{
+    glExtension& extension = glExtension::getInstance();
+    if (!extension.isSupported("WGL_EXT_swap_control"))
+        return false;
+
+    return wglSwapIntervalEXT(interval) == TRUE;
+}
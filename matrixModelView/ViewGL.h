@@ -17,6 +17,7 @@ namespace Win
         void closeContext(HWND handle);
         void activateContext();
         void swapBuffers();
+        bool setSwapInterval(int interval);         // 0: vsync off, 1: vsync on
 
         HDC getDC() const { return hdc; };
         HGLRC getRC() const { return hglrc; };
@@ -233,7 +233,7 @@ static GLint cameraIndices[] = {
 
 
 
-void drawCamera()
+inline void drawCamera()
 {
 	float shininess = 32.0f;
 	float ambientColor[4] = { 0.3f, 0.3f, 0.3f, 1.0f };
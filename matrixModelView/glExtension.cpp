@@ -42,6 +42,10 @@ PFNGLGETBUFFERPARAMETERIVARBPROC    pglGetBufferParameterivARB = 0; // return va
 PFNGLMAPBUFFERARBPROC               pglMapBufferARB = 0;            // map VBO procedure
 PFNGLUNMAPBUFFERARBPROC             pglUnmapBufferARB = 0;          // unmap VBO procedure
 
+// GL_ARB_texture_compression
+PFNGLCOMPRESSEDTEXIMAGE2DARBPROC    pglCompressedTexImage2DARB = 0;     // upload compressed image
+PFNGLCOMPRESSEDTEXSUBIMAGE2DARBPROC pglCompressedTexSubImage2DARB = 0;  // upload compressed sub image
+
 // GL_ARB_shader_objects
 PFNGLDELETEOBJECTARBPROC            pglDeleteObjectARB = 0;         // delete shader object
 PFNGLGETHANDLEARBPROC               pglGetHandleARB = 0;            // return handle of program
@@ -265,6 +269,16 @@ PFNGLDEBUGMESSAGEINSERTARBPROC   pglDebugMessageInsertARB = 0;
 PFNGLDEBUGMESSAGECALLBACKARBPROC pglDebugMessageCallbackARB = 0;
 PFNGLGETDEBUGMESSAGELOGARBPROC   pglGetDebugMessageLogARB = 0;
 
+// GL_ARB_draw_instanced and GL_ARB_instanced_arrays
+PFNGLDRAWELEMENTSINSTANCEDARBPROC   pglDrawElementsInstancedARB = 0;    // draw N instances of the elements
+PFNGLVERTEXATTRIBDIVISORARBPROC     pglVertexAttribDivisorARB = 0;      // advance the attribute per instance
+
+// GL_ARB_uniform_buffer_object
+PFNGLGETUNIFORMBLOCKINDEXPROC       pglGetUniformBlockIndex = 0;        // return index of uniform block
+PFNGLUNIFORMBLOCKBINDINGPROC        pglUniformBlockBinding = 0;         // assign binding point to uniform block
+PFNGLBINDBUFFERBASEPROC             pglBindBufferBase = 0;              // bind whole buffer to binding point
+PFNGLBINDBUFFERRANGEPROC            pglBindBufferRange = 0;             // bind part of buffer to binding point
+
 // GL_ARB_direct_state_access
 PFNGLCREATETRANSFORMFEEDBACKSPROC                 pglCreateTransformFeedbacks = 0; // for transform feedback object
 PFNGLTRANSFORMFEEDBACKBUFFERBASEPROC              pglTransformFeedbackBufferBase = 0;
@@ -557,6 +571,11 @@ void glExtension::getFunctionPointers()
         {
             glActiveTextureARB = (PFNGLACTIVETEXTUREARBPROC)wglGetProcAddress("glActiveTextureARB");
         }
+        else if (extensions[i] == "GL_ARB_texture_compression")
+        {
+            glCompressedTexImage2DARB = (PFNGLCOMPRESSEDTEXIMAGE2DARBPROC)wglGetProcAddress("glCompressedTexImage2DARB");
+            glCompressedTexSubImage2DARB = (PFNGLCOMPRESSEDTEXSUBIMAGE2DARBPROC)wglGetProcAddress("glCompressedTexSubImage2DARB");
+        }
         else if (extensions[i] == "GL_ARB_vertex_buffer_object") // same as PBO
         {
             glGenBuffersARB = (PFNGLGENBUFFERSARBPROC)wglGetProcAddress("glGenBuffersARB");
@@ -796,6 +815,21 @@ void glExtension::getFunctionPointers()
             glDebugMessageCallbackARB = (PFNGLDEBUGMESSAGECALLBACKARBPROC)wglGetProcAddress("glDebugMessageCallbackARB");
             glGetDebugMessageLogARB = (PFNGLGETDEBUGMESSAGELOGARBPROC)wglGetProcAddress("glGetDebugMessageLogARB");
         }
+        else if (extensions[i] == "GL_ARB_draw_instanced")
+        {
+            glDrawElementsInstancedARB = (PFNGLDRAWELEMENTSINSTANCEDARBPROC)wglGetProcAddress("glDrawElementsInstancedARB");
+        }
+        else if (extensions[i] == "GL_ARB_instanced_arrays")
+        {
+            glVertexAttribDivisorARB = (PFNGLVERTEXATTRIBDIVISORARBPROC)wglGetProcAddress("glVertexAttribDivisorARB");
+        }
+        else if (extensions[i] == "GL_ARB_uniform_buffer_object")
+        {
+            glGetUniformBlockIndex = (PFNGLGETUNIFORMBLOCKINDEXPROC)wglGetProcAddress("glGetUniformBlockIndex");
+            glUniformBlockBinding = (PFNGLUNIFORMBLOCKBINDINGPROC)wglGetProcAddress("glUniformBlockBinding");
+            glBindBufferBase = (PFNGLBINDBUFFERBASEPROC)wglGetProcAddress("glBindBufferBase");
+            glBindBufferRange = (PFNGLBINDBUFFERRANGEPROC)wglGetProcAddress("glBindBufferRange");
+        }
         else if (extensions[i] == "GL_ARB_direct_state_access")
         {
             // for transform feedback object
@@ -924,6 +958,13 @@ void glExtension::getFunctionPointers()
             wglGetSwapIntervalEXT = (PFNWGLGETSWAPINTERVALEXTPROC)wglGetProcAddress("wglGetSwapIntervalEXT");
         }
     }
+
+    // instanced draw and divisor are core in OpenGL 3.3, a core-profile
+    // context may not list the ARB extensions
+    if (!glDrawElementsInstancedARB)
+        glDrawElementsInstancedARB = (PFNGLDRAWELEMENTSINSTANCEDARBPROC)wglGetProcAddress("glDrawElementsInstanced");
+    if (!glVertexAttribDivisorARB)
+        glVertexAttribDivisorARB = (PFNGLVERTEXATTRIBDIVISORARBPROC)wglGetProcAddress("glVertexAttribDivisor");
 #endif
 }
 
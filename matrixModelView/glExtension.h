@@ -3,7 +3,9 @@
 #define GL_EXTENSION_H
 
 // in order to get function prototypes from glext.h, define GL_GLEXT_PROTOTYPES before including glext.h
+#ifndef GL_GLEXT_PROTOTYPES
 #define GL_GLEXT_PROTOTYPES
+#endif
 
 #ifdef _WIN32
 #ifndef WIN32_LEAN_AND_MEAN
@@ -112,6 +114,12 @@ extern PFNGLUNMAPBUFFERARBPROC          pglUnmapBufferARB;          // unmap VBO
 #define glMapBufferARB                  pglMapBufferARB
 #define glUnmapBufferARB                pglUnmapBufferARB
 
+// GL_ARB_texture_compression
+extern PFNGLCOMPRESSEDTEXIMAGE2DARBPROC     pglCompressedTexImage2DARB;     // upload compressed image
+extern PFNGLCOMPRESSEDTEXSUBIMAGE2DARBPROC  pglCompressedTexSubImage2DARB;  // upload compressed sub image
+#define glCompressedTexImage2DARB           pglCompressedTexImage2DARB
+#define glCompressedTexSubImage2DARB        pglCompressedTexSubImage2DARB
+
 // GL_ARB_shader_objects
 extern PFNGLDELETEOBJECTARBPROC         pglDeleteObjectARB;         // delete shader object
 extern PFNGLGETHANDLEARBPROC            pglGetHandleARB;            // return handle of program
@@ -545,6 +553,22 @@ extern PFNGLGETDEBUGMESSAGELOGARBPROC   pglGetDebugMessageLogARB;
 #define glDebugMessageCallbackARB       pglDebugMessageCallbackARB
 #define glGetDebugMessageLogARB         pglGetDebugMessageLogARB
 
+// GL_ARB_draw_instanced and GL_ARB_instanced_arrays
+extern PFNGLDRAWELEMENTSINSTANCEDARBPROC    pglDrawElementsInstancedARB;    // draw N instances of the elements
+extern PFNGLVERTEXATTRIBDIVISORARBPROC      pglVertexAttribDivisorARB;      // advance the attribute per instance
+#define glDrawElementsInstancedARB          pglDrawElementsInstancedARB
+#define glVertexAttribDivisorARB            pglVertexAttribDivisorARB
+
+// GL_ARB_uniform_buffer_object
+extern PFNGLGETUNIFORMBLOCKINDEXPROC    pglGetUniformBlockIndex;    // return index of uniform block
+extern PFNGLUNIFORMBLOCKBINDINGPROC     pglUniformBlockBinding;     // assign binding point to uniform block
+extern PFNGLBINDBUFFERBASEPROC          pglBindBufferBase;          // bind whole buffer to binding point
+extern PFNGLBINDBUFFERRANGEPROC         pglBindBufferRange;         // bind part of buffer to binding point
+#define glGetUniformBlockIndex          pglGetUniformBlockIndex
+#define glUniformBlockBinding           pglUniformBlockBinding
+#define glBindBufferBase                pglBindBufferBase
+#define glBindBufferRange               pglBindBufferRange
+
 // GL_ARB_direct_state_access
 extern PFNGLCREATETRANSFORMFEEDBACKSPROC                 pglCreateTransformFeedbacks; // for transform feedback object
 extern PFNGLTRANSFORMFEEDBACKBUFFERBASEPROC              pglTransformFeedbackBufferBase;
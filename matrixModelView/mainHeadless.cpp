@@ -0,0 +1,493 @@
+///////////////////////////////////////////////////////////////////////////////
+// mainHeadless.cpp
+// ================
+// main function of headless mode for performance regression tests
+// It drives ModelGL without any window: draws N frames of a scripted model or
+// camera path into an offscreen context, writes the frames to PPM files, and
+// reports CPU and GPU time of each frame as CSV.
+//
+// USAGE: matrixModelViewHeadless [-frames N] [-size WxH] [-object NAME]
+//                                [-shape point|line|fill|texture] [-path model|camera]
+//                                [-out DIR] [-instances N] [-stress] [-fixed]
+//                                [-cache DIR] [-compress]
+//  NAME: teapot, cube, torus, sphere, cylinder, wheel, cone
+//  -out: write frame_0000.ppm, frame_0001.ppm, ... into DIR
+//  -instances: add N copies of the object on a 3D grid around the origin
+//  -stress: find the max instance count that keeps 60 FPS, no frame dump
+//  -fixed: use the fixed pipeline and GLSL 1.10 even if the core-profile
+//          path is supported, to compare CPU time of both paths
+//  -cache: keep the decoded textures with mipmaps in DIR, and map them at the
+//          next run instead of decoding; -compress stores them as BC1/BC3
+//  The startup time (until all textures are uploaded) and the texture memory
+//  are reported after the warm-up frames.
+//  The GPU time is "n/a" without OpenGL 3.3 or GL_ARB_timer_query, and with a
+//  software rasterizer (e.g. llvmpipe), which draws at glFinish() on the CPU.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "OffscreenGL.h"
+#include "ModelGL.h"
+
+// constants
+const float PI = 3.141593f;
+const float CAMERA_DISTANCE = 7.0f;     // same as the initial view in ControllerFormGL
+const int   OBJECT_SIZE = 2;
+const int   WARMUP_FRAMES = 2;
+const float INSTANCE_EXTENT = 5.0f;     // instances fill a cube of this size at the origin
+const double TARGET_FRAME_TIME = 1000.0 / 60;   // 60 FPS in milliseconds
+const int   STRESS_FRAMES = 15;         // frames measured per instance count
+const int   STRESS_MAX_INSTANCES = 1 << 20;
+
+// command line options
+struct Options
+{
+    int frameCount;
+    int width;
+    int height;
+    int object;                         // IDC_RADIO* of the object
+    int shape;                          // IDC_RADIO* of the polygon mode
+    bool cameraPath;                    // move camera instead of model
+    std::string outDir;                 // empty if no frame dump
+    int instanceCount;
+    bool stress;
+    bool fixedPipeline;                 // disable the core-profile path
+    std::string cacheDir;               // empty if no texture cache
+    bool compress;                      // block compressed texture cache
+};
+
+// time of a frame in milliseconds
+struct FrameTime
+{
+    double cpu;                         // draw calls submitted by ModelGL::draw()
+    double gpu;                         // GL_TIME_ELAPSED of the draw calls, 0 if no timer
+    double total;                       // until glFinish() returns
+};
+
+// function declarations
+static bool parseOptions(int argc, char* argv[], Options& options);
+static void setScene(ModelGL& model, const Options& options, int frame);
+static void printSummary(const char* name, const std::vector<FrameTime>& times, double FrameTime::*member);
+static bool isGpuTimerSupported();
+static void setInstances(ModelGL& model, const Options& options, int count);
+static double measureFrameTime(ModelGL& model, const Options& options, int instanceCount);
+static int runStress(ModelGL& model, const Options& options);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// main function of headless mode
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    Options options;
+    if(!parseOptions(argc, argv, options))
+        return 1;
+
+    OffscreenGL offscreen;
+    if(!offscreen.create(options.width, options.height))
+    {
+        fprintf(stderr, "[ERROR] %s\n", offscreen.getErrorMessage().c_str());
+        return 1;
+    }
+    fprintf(stderr, "OpenGL renderer: %s (%s)\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    ModelGL model;
+    model.setTextureCache(options.cacheDir, options.compress);
+    model.init();
+    model.setCorePathEnabled(!options.fixedPipeline);
+    if(!model.initShaders())
+        fprintf(stderr, "[WARNING] GLSL is not available, use fixed pipeline.\n");
+    fprintf(stderr, "Render path: %s\n", model.isCorePathActive() ? "core (GLSL 1.40, VAO, UBO)" : "fixed pipeline");
+    model.setWindowSize(options.width, options.height);
+    model.setModelObject(options.object);
+    model.setModelShape(options.shape);
+    model.setSizeObject(OBJECT_SIZE);
+    model.setViewMatrix(0, 0, CAMERA_DISTANCE, 0, 0, 0);
+    setInstances(model, options, options.instanceCount);
+    if(options.instanceCount > 0 || options.stress)
+        fprintf(stderr, "Instancing: %s\n", model.isInstancingSupported() ? "glDrawElementsInstancedARB" : "draw per instance");
+
+    if(options.stress)
+    {
+        int count = runStress(model, options);
+        model.quit();
+        offscreen.close();
+        return count > 0 ? 0 : 1;
+    }
+
+    // GPU timer, available since OpenGL 3.3 (GL_ARB_timer_query)
+    GLuint queryId = 0;
+    bool gpuTimer = isGpuTimerSupported();
+    if(gpuTimer)
+        glGenQueries(1, &queryId);
+    else
+        fprintf(stderr, "GPU timer: n/a\n");
+
+    // warm up (shader compile, mesh upload, texture load), ModelGL applies
+    // the viewport and polygon mode at the end of the first frame
+    for(int i = 0; i < WARMUP_FRAMES; ++i)
+    {
+        setScene(model, options, 0);
+        model.draw();
+        glFinish();
+    }
+    model.finishTextures();                 // decoded in background, measure the frames with them
+    double startup = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    const TextureManager& textures = model.getTextureManager();
+    fprintf(stderr, "Startup: %.1f ms, %u textures (%u from cache%s), %.1f KB texture memory\n",
+            startup, textures.getTextureCount(), textures.getCacheHitCount(),
+            (options.compress && textures.isCompressionSupported()) ? ", BC1/BC3" : "",
+            textures.getBytesResident() / 1024.0);
+
+    std::vector<FrameTime> times(options.frameCount);
+    printf("frame,cpu_ms,gpu_ms,total_ms\n");
+    for(int i = 0; i < options.frameCount; ++i)
+    {
+        setScene(model, options, i);
+
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        if(gpuTimer)
+            glBeginQuery(GL_TIME_ELAPSED, queryId);
+        model.draw();
+        if(gpuTimer)
+            glEndQuery(GL_TIME_ELAPSED);
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        glFinish();
+        std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+        GLuint64 elapsed = 0;
+        if(gpuTimer)
+            glGetQueryObjectui64v(queryId, GL_QUERY_RESULT, &elapsed);
+
+        times[i].cpu = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        times[i].gpu = elapsed / 1000000.0;
+        times[i].total = std::chrono::duration<double, std::milli>(t2 - t0).count();
+        if(gpuTimer)
+            printf("%d,%.3f,%.3f,%.3f\n", i, times[i].cpu, times[i].gpu, times[i].total);
+        else
+            printf("%d,%.3f,n/a,%.3f\n", i, times[i].cpu, times[i].total);
+
+        if(!options.outDir.empty())
+        {
+            char fileName[32];
+            snprintf(fileName, sizeof(fileName), "/frame_%04d.ppm", i);
+            if(!offscreen.savePpm(options.outDir + fileName))
+            {
+                fprintf(stderr, "[ERROR] Failed to write %s%s\n", options.outDir.c_str(), fileName);
+                return 1;
+            }
+        }
+    }
+
+    printSummary("cpu", times, &FrameTime::cpu);
+    if(gpuTimer)
+        printSummary("gpu", times, &FrameTime::gpu);
+    else
+        fprintf(stderr, "%-5s n/a\n", "gpu");
+    printSummary("total", times, &FrameTime::total);
+
+    if(gpuTimer)
+        glDeleteQueries(1, &queryId);
+    model.quit();
+    offscreen.close();
+    return 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// parse command line options, return false if there is an invalid option
+///////////////////////////////////////////////////////////////////////////////
+static bool parseOptions(int argc, char* argv[], Options& options)
+{
+    options.frameCount = 120;
+    options.width = 800;
+    options.height = 400;
+    options.object = IDC_RADIO1;
+    options.shape = IDC_RADIO8;
+    options.cameraPath = false;
+    options.instanceCount = 0;
+    options.stress = false;
+    options.fixedPipeline = false;
+    options.compress = false;
+
+    const char* objectNames[] = { "teapot", "cube", "torus", "sphere", "cylinder", "wheel", "cone" };
+    const int objectIds[] = { IDC_RADIO1, IDC_RADIO2, IDC_RADIO3, IDC_RADIO4, IDC_RADIO5, IDC_RADIO9, IDC_RADIO10 };
+    const char* shapeNames[] = { "point", "line", "fill", "texture" };
+    const int shapeIds[] = { IDC_RADIO6, IDC_RADIO7, IDC_RADIO8, IDC_RADIO11 };
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : 0;
+        bool valid = (value != 0);
+
+        if(arg == "-frames" && value)
+        {
+            options.frameCount = atoi(value);
+            valid = options.frameCount > 0;
+        }
+        else if(arg == "-size" && value)
+        {
+            valid = sscanf(value, "%dx%d", &options.width, &options.height) == 2 &&
+                    options.width > 0 && options.height > 0;
+        }
+        else if(arg == "-object" && value)
+        {
+            valid = false;
+            for(int j = 0; j < 7; ++j)
+            {
+                if(strcmp(value, objectNames[j]) == 0)
+                {
+                    options.object = objectIds[j];
+                    valid = true;
+                }
+            }
+        }
+        else if(arg == "-shape" && value)
+        {
+            valid = false;
+            for(int j = 0; j < 4; ++j)
+            {
+                if(strcmp(value, shapeNames[j]) == 0)
+                {
+                    options.shape = shapeIds[j];
+                    valid = true;
+                }
+            }
+        }
+        else if(arg == "-path" && value)
+        {
+            options.cameraPath = (strcmp(value, "camera") == 0);
+            valid = options.cameraPath || strcmp(value, "model") == 0;
+        }
+        else if(arg == "-out" && value)
+        {
+            options.outDir = value;
+        }
+        else if(arg == "-instances" && value)
+        {
+            options.instanceCount = atoi(value);
+            valid = options.instanceCount >= 0;
+        }
+        else if(arg == "-stress")
+        {
+            options.stress = true;
+            continue;       // no value
+        }
+        else if(arg == "-fixed")
+        {
+            options.fixedPipeline = true;
+            continue;       // no value
+        }
+        else if(arg == "-cache" && value)
+        {
+            options.cacheDir = value;
+        }
+        else if(arg == "-compress")
+        {
+            options.compress = true;
+            continue;       // no value
+        }
+        else
+        {
+            valid = false;
+        }
+
+        if(!valid)
+        {
+            fprintf(stderr, "USAGE: %s [-frames N] [-size WxH] [-object NAME] "
+                            "[-shape point|line|fill|texture] [-path model|camera] [-out DIR] "
+                            "[-instances N] [-stress] [-fixed] [-cache DIR] [-compress]\n", argv[0]);
+            return false;
+        }
+        ++i;    // skip value
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// set the model or camera for the frame, one full turn over all frames
+///////////////////////////////////////////////////////////////////////////////
+static void setScene(ModelGL& model, const Options& options, int frame)
+{
+    float t = (float)frame / options.frameCount;
+    float angle = 360.0f * t - 180.0f;
+
+    if(options.cameraPath)
+    {
+        // orbit around Y-axis, facing to the origin
+        float heading = 360.0f * t;
+        float x = CAMERA_DISTANCE * sinf(heading * PI / 180.0f);
+        float z = CAMERA_DISTANCE * cosf(heading * PI / 180.0f);
+        model.setViewMatrix(x, 1, z, 0, heading, 0);
+    }
+    else
+    {
+        model.setModelMatrix(0, 0, 0, angle * 0.5f, angle, 0);
+    }
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// print average, min and max of frame times
+///////////////////////////////////////////////////////////////////////////////
+static void printSummary(const char* name, const std::vector<FrameTime>& times, double FrameTime::*member)
+{
+    double sum = 0, minTime = 0, maxTime = 0;
+    for(size_t i = 0; i < times.size(); ++i)
+    {
+        double t = times[i].*member;
+        sum += t;
+        if(i == 0 || t < minTime) minTime = t;
+        if(i == 0 || t > maxTime) maxTime = t;
+    }
+    fprintf(stderr, "%-5s avg %.3f ms, min %.3f ms, max %.3f ms\n",
+            name, sum / times.size(), minTime, maxTime);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// check if GL_TIME_ELAPSED measures the draw calls: OpenGL 3.3 or
+// GL_ARB_timer_query, on a hardware renderer
+// A software rasterizer defers the drawing to glFinish(), so the query of the
+// draw calls only measures the queued commands (~0.005 ms on llvmpipe).
+///////////////////////////////////////////////////////////////////////////////
+static bool isGpuTimerSupported()
+{
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    if(version)
+        sscanf(version, "%d.%d", &major, &minor);
+    bool supported = (major > 3 || (major == 3 && minor >= 3)) ||
+                     glExtension::getInstance().isSupported("GL_ARB_timer_query");
+    if(!supported)
+        return false;
+
+    const char* names[] = { "llvmpipe", "softpipe", "Software Rasterizer", "SWR" };
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    for(int i = 0; renderer && i < 4; ++i)
+    {
+        if(strstr(renderer, names[i]))
+            return false;
+    }
+    return true;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// place instances on a 3D grid in a fixed cube around the origin, so most of
+// them are in both views at any count; more instances make the grid denser
+// and each copy smaller. the color changes along the grid
+///////////////////////////////////////////////////////////////////////////////
+static void setInstances(ModelGL& model, const Options& options, int count)
+{
+    std::vector<SceneInstance> instances(count);
+    int side = (int)ceilf(cbrtf((float)count));
+    float spacing = INSTANCE_EXTENT / side;
+    float scale = 0.5f * spacing / OBJECT_SIZE;
+    for(int i = 0; i < count; ++i)
+    {
+        int x = i % side;
+        int y = (i / side) % side;
+        int z = i / (side * side);
+
+        SceneInstance& instance = instances[i];
+        instance.object = options.object;
+        instance.matrix.identity();
+        instance.matrix.scale(scale);
+        instance.matrix.rotateY(30.0f * i);
+        instance.matrix.translate((x - (side - 1) * 0.5f) * spacing,
+                                  (y - (side - 1) * 0.5f) * spacing,
+                                  (z - (side - 1) * 0.5f) * spacing);
+        instance.color[0] = (x + 0.5f) / side;
+        instance.color[1] = (y + 0.5f) / side;
+        instance.color[2] = (z + 0.5f) / side;
+        instance.color[3] = 1.0f;
+    }
+    model.setInstances(instances);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// return the median total frame time with the given instance count
+// the median is stable against a few slow frames of the software renderer
+///////////////////////////////////////////////////////////////////////////////
+static double measureFrameTime(ModelGL& model, const Options& options, int instanceCount)
+{
+    setInstances(model, options, instanceCount);
+    for(int i = 0; i < WARMUP_FRAMES; ++i)
+    {
+        setScene(model, options, 0);
+        model.draw();
+        glFinish();
+    }
+
+    std::vector<double> times(STRESS_FRAMES);
+    for(int i = 0; i < STRESS_FRAMES; ++i)
+    {
+        setScene(model, options, i);
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        model.draw();
+        glFinish();
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+        times[i] = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    }
+    std::nth_element(times.begin(), times.begin() + STRESS_FRAMES / 2, times.end());
+    return times[STRESS_FRAMES / 2];
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// double the instance count until a frame takes longer than 60 FPS, then
+// binary search between the last 2 counts
+// print the max count that keeps 60 FPS, and return it
+///////////////////////////////////////////////////////////////////////////////
+static int runStress(ModelGL& model, const Options& options)
+{
+    printf("instances,visible,total_ms\n");
+
+    int good = 0;
+    int bad = 0;
+    for(int count = 1; count <= STRESS_MAX_INSTANCES; count *= 2)
+    {
+        double t = measureFrameTime(model, options, count);
+        printf("%d,%d,%.3f\n", count, model.getVisibleInstanceCount(), t);
+        if(t > TARGET_FRAME_TIME)
+        {
+            bad = count;
+            break;
+        }
+        good = count;
+    }
+
+    // resolve to about 1% of the count
+    while(bad > 0 && bad - good > std::max(1, good / 100))
+    {
+        int count = good + (bad - good) / 2;
+        double t = measureFrameTime(model, options, count);
+        printf("%d,%d,%.3f\n", count, model.getVisibleInstanceCount(), t);
+        if(t > TARGET_FRAME_TIME)
+            bad = count;
+        else
+            good = count;
+    }
+
+    fprintf(stderr, "max instances at 60 FPS: %d%s\n", good, bad == 0 ? " (limit reached)" : "");
+    return good;
+}
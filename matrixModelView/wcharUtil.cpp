@@ -1,6 +1,7 @@
 #pragma warning(disable : 4996)
 #include <cstdlib>
 #include <cwchar>
+#include <cstring>
 #include <sstream>
 #include <string>
 #include <iomanip>
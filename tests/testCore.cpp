@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// testCore.cpp
+// ============
+// unit tests of cs105core
+//
+// USAGE: testCore [matrices|cylinder|frustum|quaternion]
+// It runs the given test, or all tests without argument, and returns 0 if all
+// checks pass, otherwise 1.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include "testCore.h"
+
+struct Test
+{
+    const char* name;
+    int (*run)();
+};
+
+static const Test TESTS[] =
+{
+    { "matrices", testMatrices },
+    { "cylinder", testCylinder },
+    { "frustum",  testFrustum },
+    { "quaternion", testQuaternion }
+};
+static const int TEST_COUNT = sizeof(TESTS) / sizeof(TESTS[0]);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// print a failed check
+///////////////////////////////////////////////////////////////////////////////
+int fail(const char* test, const char* format, ...)
+{
+    printf("[FAIL] %s: ", test);
+    va_list valist;
+    va_start(valist, format);
+    vprintf(format, valist);
+    va_end(valist);
+    printf("\n");
+    return 1;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    int failCount = 0;
+    bool found = false;
+    for(int i = 0; i < TEST_COUNT; ++i)
+    {
+        if(argc > 1 && strcmp(argv[1], TESTS[i].name) != 0)
+            continue;
+
+        found = true;
+        int count = TESTS[i].run();
+        printf("%s: %s\n", TESTS[i].name, count == 0 ? "passed" : "FAILED");
+        failCount += count;
+    }
+
+    if(!found)
+    {
+        printf("[ERROR] unknown test: %s\n", argv[1]);
+        return 1;
+    }
+    return failCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+///////////////////////////////////////////////////////////////////////////////
+// testCore.h
+// ==========
+// unit tests of cs105core, run by ctest
+// Each test returns the number of failed checks, and prints every failure.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef TEST_CORE_H
+#define TEST_CORE_H
+
+// print a failed check and return 1, e.g. failCount += fail("...", ...)
+int fail(const char* test, const char* format, ...);
+
+// tests
+int testMatrices();
+int testCylinder();
+int testFrustum();
+int testQuaternion();
+
+#endif
@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+// testCylinder.cpp
+// ================
+// Cylinder updated in place by set() and the setters must have the same
+// arrays as a new Cylinder built with the same params.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <vector>
+#include "Cylinder.h"
+#include "testCore.h"
+
+const float CYLINDER_EPSILON = 1e-5f;       // same formulas, only the order of updates differs
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// compare all arrays of 2 cylinders, return # of failures
+///////////////////////////////////////////////////////////////////////////////
+static int compareFloats(const char* name, const float* a, const float* b, unsigned int count)
+{
+    for(unsigned int i = 0; i < count; ++i)
+    {
+        if(fabsf(a[i] - b[i]) > CYLINDER_EPSILON)
+            return fail("cylinder", "%s[%u] is %f, rebuilt is %f", name, i, a[i], b[i]);
+    }
+    return 0;
+}
+
+static int compareUints(const char* name, const unsigned int* a, const unsigned int* b, unsigned int count)
+{
+    for(unsigned int i = 0; i < count; ++i)
+    {
+        if(a[i] != b[i])
+            return fail("cylinder", "%s[%u] is %u, rebuilt is %u", name, i, a[i], b[i]);
+    }
+    return 0;
+}
+
+static int compareCylinders(const Cylinder& updated, const Cylinder& rebuilt)
+{
+    if(updated.getVertexCount() != rebuilt.getVertexCount() ||
+       updated.getNormalCount() != rebuilt.getNormalCount() ||
+       updated.getTexCoordCount() != rebuilt.getTexCoordCount() ||
+       updated.getIndexCount() != rebuilt.getIndexCount() ||
+       updated.getLineIndexCount() != rebuilt.getLineIndexCount() ||
+       updated.getBaseStartIndex() != rebuilt.getBaseStartIndex() ||
+       updated.getTopStartIndex() != rebuilt.getTopStartIndex())
+    {
+        return fail("cylinder", "array sizes differ (%u vertices, rebuilt %u)",
+                    updated.getVertexCount(), rebuilt.getVertexCount());
+    }
+
+    int failCount = 0;
+    failCount += compareFloats("vertices", updated.getVertices(), rebuilt.getVertices(), updated.getVertexCount() * 3);
+    failCount += compareFloats("normals", updated.getNormals(), rebuilt.getNormals(), updated.getNormalCount() * 3);
+    failCount += compareFloats("texCoords", updated.getTexCoords(), rebuilt.getTexCoords(), updated.getTexCoordCount() * 2);
+    failCount += compareFloats("interleaved", updated.getInterleavedVertices(), rebuilt.getInterleavedVertices(),
+                               updated.getInterleavedVertexCount() * 8);
+    failCount += compareUints("indices", updated.getIndices(), rebuilt.getIndices(), updated.getIndexCount());
+    failCount += compareUints("lineIndices", updated.getLineIndices(), rebuilt.getLineIndices(), updated.getLineIndexCount());
+    return failCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// smooth and flat, several tessellations, shape and topology changes
+///////////////////////////////////////////////////////////////////////////////
+int testCylinder()
+{
+    const int SECTORS[] = { 3, 8, 36, 128 };
+    const int STACKS[] = { 1, 2, 7 };
+
+    int failCount = 0;
+    for(int s = 0; s < 2; ++s)
+    {
+        bool smooth = (s == 0);
+        for(int i = 0; i < 4; ++i)
+        {
+            for(int j = 0; j < 3; ++j)
+            {
+                int sectors = SECTORS[i];
+                int stacks = STACKS[j];
+
+                // shape only: positions and normals are updated in place
+                Cylinder cylinder(1.0f, 1.0f, 1.0f, sectors, stacks, smooth);
+                cylinder.set(2.0f, 0.5f, 3.0f, sectors, stacks, smooth);
+                failCount += compareCylinders(cylinder, Cylinder(2.0f, 0.5f, 3.0f, sectors, stacks, smooth));
+
+                // each setter, including a cone (top radius 0)
+                cylinder.setBaseRadius(0.75f);
+                cylinder.setTopRadius(0.0f);
+                cylinder.setHeight(1.5f);
+                failCount += compareCylinders(cylinder, Cylinder(0.75f, 0.0f, 1.5f, sectors, stacks, smooth));
+
+                // topology and shape at once
+                cylinder.set(1.25f, 2.5f, 0.5f, sectors + 1, stacks + 1, !smooth);
+                failCount += compareCylinders(cylinder, Cylinder(1.25f, 2.5f, 0.5f, sectors + 1, stacks + 1, !smooth));
+
+                // back to the original topology
+                cylinder.setSectorCount(sectors);
+                cylinder.setStackCount(stacks);
+                cylinder.setSmooth(smooth);
+                failCount += compareCylinders(cylinder, Cylinder(1.25f, 2.5f, 0.5f, sectors, stacks, smooth));
+            }
+        }
+    }
+    return failCount;
+}
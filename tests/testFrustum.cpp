@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////
+// testFrustum.cpp
+// ===============
+// planes extracted from a known perspective projection, the box tests against
+// brute-force clip-space tests of the box corners, and the sphere tests against
+// the distance to each plane
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "Frustum.h"
+#include "testCore.h"
+
+const float FRUSTUM_EPSILON = 1e-5f;
+const int FRUSTUM_VIEW_COUNT = 200;
+const int FRUSTUM_BOX_COUNT = 1000;         // per view
+const int FRUSTUM_SPHERE_COUNT = 1001;      // per view, not a multiple of 4
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// same as glFrustum()
+///////////////////////////////////////////////////////////////////////////////
+static Matrix4 makeFrustum(float l, float r, float b, float t, float n, float f)
+{
+    Matrix4 mat;
+    mat[0]  = 2 * n / (r - l);
+    mat[5]  = 2 * n / (t - b);
+    mat[8]  = (r + l) / (r - l);
+    mat[9]  = (t + b) / (t - b);
+    mat[10] = -(f + n) / (f - n);
+    mat[11] = -1;
+    mat[14] = -(2 * f * n) / (f - n);
+    mat[15] = 0;
+    return mat;
+}
+
+static float randomFloat(float min, float max)
+{
+    return min + (max - min) * (float)rand() / RAND_MAX;
+}
+
+// clip-space test of a point: -w <= x,y,z <= w
+static bool isInside(const Matrix4& matrix, const Vector3& point)
+{
+    Vector4 clip = matrix * Vector4(point.x, point.y, point.z, 1);
+    return clip.x >= -clip.w && clip.x <= clip.w &&
+           clip.y >= -clip.w && clip.y <= clip.w &&
+           clip.z >= -clip.w && clip.z <= clip.w;
+}
+
+// index of the plane that all corners are outside, or -1
+static int findSeparatingPlane(const Frustum& frustum, const BoundingBox& box)
+{
+    for(int i = 0; i < Frustum::PLANE_COUNT; ++i)
+    {
+        Vector4 plane = frustum.getPlane(i);
+        bool outside = true;
+        for(int j = 0; j < 8 && outside; ++j)
+        {
+            float x = (j & 1) ? box.max.x : box.min.x;
+            float y = (j & 2) ? box.max.y : box.min.y;
+            float z = (j & 4) ? box.max.z : box.min.z;
+            outside = plane.x * x + plane.y * y + plane.z * z + plane.w < -FRUSTUM_EPSILON;
+        }
+        if(outside)
+            return i;
+    }
+    return -1;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// planes of glFrustum(-1, 1, -1, 1, 1, 10) with identity view
+///////////////////////////////////////////////////////////////////////////////
+static int testPlanes()
+{
+    const float s = 1.0f / sqrtf(2.0f);
+    const Vector4 EXPECTED[Frustum::PLANE_COUNT] =
+    {
+        Vector4( s, 0, -s, 0),              // left:   x >= z
+        Vector4(-s, 0, -s, 0),              // right:  x <= -z
+        Vector4( 0, s, -s, 0),              // bottom
+        Vector4( 0,-s, -s, 0),              // top
+        Vector4( 0, 0, -1, -1),             // near:   z <= -1
+        Vector4( 0, 0,  1, 10)              // far:    z >= -10
+    };
+
+    int failCount = 0;
+    Frustum frustum(makeFrustum(-1, 1, -1, 1, 1, 10));
+    for(int i = 0; i < Frustum::PLANE_COUNT; ++i)
+    {
+        Vector4 plane = frustum.getPlane(i);
+        if(!plane.equal(EXPECTED[i], FRUSTUM_EPSILON))
+            failCount += fail("frustum", "plane %d is (%f, %f, %f, %f)", i, plane.x, plane.y, plane.z, plane.w);
+    }
+
+    // single boxes and points
+    if(!frustum.testBox(BoundingBox(Vector3(-0.5f, -0.5f, -5.5f), Vector3(0.5f, 0.5f, -4.5f))))
+        failCount += fail("frustum", "box inside is culled");
+    if(frustum.testBox(BoundingBox(Vector3(-0.5f, -0.5f, 4.5f), Vector3(0.5f, 0.5f, 5.5f))))
+        failCount += fail("frustum", "box behind the camera is not culled");
+    if(frustum.testBox(BoundingBox(Vector3(-0.5f, -0.5f, -20.5f), Vector3(0.5f, 0.5f, -19.5f))))
+        failCount += fail("frustum", "box beyond the far plane is not culled");
+    if(!frustum.testBox(BoundingBox(Vector3(-6, -0.5f, -5.5f), Vector3(-4.5f, 0.5f, -4.5f))))
+        failCount += fail("frustum", "box intersecting the left plane is culled");
+    if(frustum.testBox(BoundingBox(Vector3(-9, -0.5f, -5.5f), Vector3(-7, 0.5f, -4.5f))))
+        failCount += fail("frustum", "box outside the left plane is not culled");
+    if(!frustum.testPoint(Vector3(0, 0, -2)) || frustum.testPoint(Vector3(0, 0, -0.5f)))
+        failCount += fail("frustum", "point test");
+    if(!frustum.testSphere(Vector3(0, 0, -0.5f), 0.6f) || frustum.testSphere(Vector3(0, 0, -0.5f), 0.4f))
+        failCount += fail("frustum", "sphere test at the near plane");
+    return failCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// random views and boxes:
+// - a box with a corner inside the frustum is never culled
+// - a box with all corners outside the same plane is always culled
+// - testBoxes() gives the same result as testBox()
+///////////////////////////////////////////////////////////////////////////////
+static int testRandomBoxes()
+{
+    srand(15);
+    int failCount = 0;
+    std::vector<BoundingBox> boxes(FRUSTUM_BOX_COUNT);
+    std::vector<unsigned char> visible(FRUSTUM_BOX_COUNT);
+    for(int i = 0; i < FRUSTUM_VIEW_COUNT && failCount == 0; ++i)
+    {
+        float n = randomFloat(0.1f, 2.0f);
+        Matrix4 projection = makeFrustum(randomFloat(-2, -0.2f), randomFloat(0.2f, 2), randomFloat(-2, -0.2f), randomFloat(0.2f, 2),
+                                         n, n + randomFloat(1, 50));
+        Matrix4 view;
+        view.rotate(randomFloat(0, 360), randomFloat(-1, 1), randomFloat(-1, 1), randomFloat(0.1f, 1));
+        view.translate(randomFloat(-5, 5), randomFloat(-5, 5), randomFloat(-5, 5));
+        Matrix4 matrix = projection * view;
+        Frustum frustum(matrix);
+
+        for(int j = 0; j < FRUSTUM_BOX_COUNT; ++j)
+        {
+            Vector3 center(randomFloat(-30, 30), randomFloat(-30, 30), randomFloat(-30, 30));
+            Vector3 extent(randomFloat(0, 3), randomFloat(0, 3), randomFloat(0, 3));
+            boxes[j] = BoundingBox(center - extent, center + extent);
+        }
+        int visibleCount = frustum.testBoxes(&boxes[0], FRUSTUM_BOX_COUNT, &visible[0]);
+
+        int count = 0;
+        for(int j = 0; j < FRUSTUM_BOX_COUNT; ++j)
+        {
+            const BoundingBox& box = boxes[j];
+            bool result = frustum.testBox(box);
+            count += result ? 1 : 0;
+            if(result != (visible[j] != 0))
+                failCount += fail("frustum", "view %d box %d: testBoxes() is %d, testBox() is %d", i, j, visible[j], result);
+
+            // corners and center, inside by the projection itself
+            bool inside = isInside(matrix, box.getCenter());
+            for(int k = 0; k < 8 && !inside; ++k)
+            {
+                inside = isInside(matrix, Vector3((k & 1) ? box.max.x : box.min.x,
+                                                  (k & 2) ? box.max.y : box.min.y,
+                                                  (k & 4) ? box.max.z : box.min.z));
+            }
+            if(inside && !result)
+                failCount += fail("frustum", "view %d box %d is visible but culled", i, j);
+
+            int plane = findSeparatingPlane(frustum, box);
+            if(plane >= 0 && result)
+                failCount += fail("frustum", "view %d box %d is outside plane %d but not culled", i, j, plane);
+        }
+        if(count != visibleCount)
+            failCount += fail("frustum", "view %d: testBoxes() returns %d, %d are visible", i, visibleCount, count);
+    }
+    return failCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// random views and spheres:
+// - a sphere with the center inside the frustum is never culled
+// - a sphere farther than the radius outside a plane is always culled, and a
+//   sphere within the radius of all planes is never culled
+// - testSpheres() gives the same result as testSphere()
+///////////////////////////////////////////////////////////////////////////////
+static int testRandomSpheres()
+{
+    srand(16);
+    int failCount = 0;
+    std::vector<Vector4> spheres(FRUSTUM_SPHERE_COUNT);
+    std::vector<unsigned char> visible(FRUSTUM_SPHERE_COUNT);
+    for(int i = 0; i < FRUSTUM_VIEW_COUNT && failCount == 0; ++i)
+    {
+        float n = randomFloat(0.1f, 2.0f);
+        Matrix4 projection = makeFrustum(randomFloat(-2, -0.2f), randomFloat(0.2f, 2), randomFloat(-2, -0.2f), randomFloat(0.2f, 2),
+                                         n, n + randomFloat(1, 50));
+        Matrix4 view;
+        view.rotate(randomFloat(0, 360), randomFloat(-1, 1), randomFloat(-1, 1), randomFloat(0.1f, 1));
+        view.translate(randomFloat(-5, 5), randomFloat(-5, 5), randomFloat(-5, 5));
+        Matrix4 matrix = projection * view;
+        Frustum frustum(matrix);
+
+        for(int j = 0; j < FRUSTUM_SPHERE_COUNT; ++j)
+            spheres[j] = Vector4(randomFloat(-30, 30), randomFloat(-30, 30), randomFloat(-30, 30), randomFloat(0, 3));
+        int visibleCount = frustum.testSpheres(&spheres[0], FRUSTUM_SPHERE_COUNT, &visible[0]);
+
+        int count = 0;
+        for(int j = 0; j < FRUSTUM_SPHERE_COUNT; ++j)
+        {
+            const Vector4& sphere = spheres[j];
+            Vector3 center(sphere.x, sphere.y, sphere.z);
+            bool result = frustum.testSphere(center, sphere.w);
+            count += result ? 1 : 0;
+            if(result != (visible[j] != 0))
+                failCount += fail("frustum", "view %d sphere %d: testSpheres() is %d, testSphere() is %d", i, j, visible[j], result);
+
+            if(isInside(matrix, center) && !result)
+                failCount += fail("frustum", "view %d sphere %d is visible but culled", i, j);
+
+            // signed distances to the planes
+            bool outside = false;
+            bool near = true;
+            for(int k = 0; k < Frustum::PLANE_COUNT; ++k)
+            {
+                Vector4 plane = frustum.getPlane(k);
+                float dist = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+                outside = outside || dist < -sphere.w - FRUSTUM_EPSILON;
+                near = near && dist > -sphere.w + FRUSTUM_EPSILON;
+            }
+            if(outside && result)
+                failCount += fail("frustum", "view %d sphere %d is outside a plane but not culled", i, j);
+            if(near && !result)
+                failCount += fail("frustum", "view %d sphere %d is within all planes but culled", i, j);
+        }
+        if(count != visibleCount)
+            failCount += fail("frustum", "view %d: testSpheres() returns %d, %d are visible", i, visibleCount, count);
+    }
+    return failCount;
+}
+
+
+
+int testFrustum()
+{
+    return testPlanes() + testRandomBoxes() + testRandomSpheres();
+}
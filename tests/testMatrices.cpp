@@ -0,0 +1,296 @@
+///////////////////////////////////////////////////////////////////////////////
+// testMatrices.cpp
+// ================
+// SIMD paths of Matrix4 against the scalar paths (multiplyScalar(),
+// invertAffineScalar(), invertGeneralScalar()) on random and degenerate
+// matrices. If MATRICES_SIMD is not defined, both paths are the same code.
+//
+// Error is relative to the magnitude: |simd - scalar| <= e * max(1, scale)
+// - multiply, transform: 1e-5, scale is the sum of |products| of the element
+//   (|M1| * |M2|), because the terms may cancel out (FMA rounds once less
+//   per term than SSE mul + add)
+// - inverse: 1e-4, scale is |scalar| (different order of cofactor products, well-conditioned
+//   inputs only; degenerate inputs must give the same fallback)
+//
+// The fused Euler builders (fromEulerTRS(), fromTranslateEuler()) are compared
+// with the composed rotateX/Y/Z() and translate() within 1e-5.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "Matrices.h"
+#include "testCore.h"
+
+const float MULTIPLY_EPSILON = 1e-5f;
+const float INVERSE_EPSILON = 1e-4f;
+const int RANDOM_MATRIX_COUNT = 10000;
+const int TRANSFORM_POINT_COUNT = 1001;     // odd count for the remainder of the SIMD loop
+const float EULER_EPSILON = 1e-5f;
+const int EULER_ANGLE_COUNT = 100000;
+
+
+
+static float randomFloat(float min, float max)
+{
+    return min + (max - min) * (float)rand() / RAND_MAX;
+}
+
+// return index of the first different element, or -1
+// scales are the magnitudes of each element, or |b| if it is 0
+static int compare(const float* a, const float* b, int count, float epsilon, const float* scales = 0)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        float scale = scales ? scales[i] : fabsf(b[i]);
+        if(scale < 1)
+            scale = 1;
+        if(fabsf(a[i] - b[i]) > epsilon * scale)
+            return i;
+    }
+    return -1;
+}
+
+static Matrix4 absolute(const Matrix4& m)
+{
+    Matrix4 a;
+    for(int i = 0; i < 16; ++i)
+        a[i] = fabsf(m[i]);
+    return a;
+}
+
+static Matrix4 makeRandom(float range)
+{
+    float m[16];
+    for(int i = 0; i < 16; ++i)
+        m[i] = randomFloat(-range, range);
+    return Matrix4(m);
+}
+
+// rotation, non-uniform scale and translation; last row is (0,0,0,1)
+static Matrix4 makeRandomAffine()
+{
+    Matrix4 m;
+    m.scale(randomFloat(0.2f, 4), randomFloat(0.2f, 4), randomFloat(0.2f, 4));
+    m.rotate(randomFloat(0, 360), randomFloat(-1, 1), randomFloat(-1, 1), randomFloat(0.1f, 1));
+    m.translate(randomFloat(-100, 100), randomFloat(-100, 100), randomFloat(-100, 100));
+    return m;
+}
+
+// diagonally dominant, so it is far from singular
+static Matrix4 makeRandomGeneral()
+{
+    Matrix4 m = makeRandom(1);
+    m[0] += 4;  m[5] += 4;  m[10] += 4;  m[15] += 4;
+    return m;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// degenerate inputs: singular, zero, zero scale, huge and tiny values
+///////////////////////////////////////////////////////////////////////////////
+static std::vector<Matrix4> makeDegenerates()
+{
+    std::vector<Matrix4> matrices;
+
+    matrices.push_back(Matrix4());                          // identity
+    Matrix4 zero;
+    zero.scale(0);
+    zero[15] = 0;
+    matrices.push_back(zero);                               // all zero
+
+    Matrix4 flat;
+    flat.scale(1, 1, 0);                                    // zero scale on z, det(R) = 0
+    flat.translate(1, 2, 3);
+    matrices.push_back(flat);
+
+    Matrix4 duplicate = makeRandom(1);                      // 2 same columns
+    for(int i = 0; i < 4; ++i)
+        duplicate[4 + i] = duplicate[i];
+    matrices.push_back(duplicate);
+
+    Matrix4 tiny;
+    tiny.scale(1e-3f);                                      // det = 1e-9, below EPSILON
+    matrices.push_back(tiny);
+
+    Matrix4 huge;
+    huge.scale(1e3f);
+    huge.translate(1e6f, -1e6f, 1e6f);
+    matrices.push_back(huge);
+
+    Matrix4 projection;                                     // glFrustum(-1,1,-1,1,1,100)
+    projection[10] = -101.0f / 99;
+    projection[11] = -1;
+    projection[14] = -200.0f / 99;
+    projection[15] = 0;
+    matrices.push_back(projection);
+
+    return matrices;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// M1 * M2 and M * v
+///////////////////////////////////////////////////////////////////////////////
+static int testMultiply(const Matrix4& m1, const Matrix4& m2, const char* kind, int index)
+{
+    int failCount = 0;
+
+    Matrix4 simd = m1 * m2;
+    Matrix4 scalar = m1.multiplyScalar(m2);
+    Matrix4 scales = absolute(m1).multiplyScalar(absolute(m2));
+    int i = compare(simd.get(), scalar.get(), 16, MULTIPLY_EPSILON, scales.get());
+    if(i >= 0)
+        failCount += fail("matrices", "%s %d: M1*M2 [%d] is %g, scalar is %g", kind, index, i, simd[i], scalar[i]);
+
+    Vector4 v(randomFloat(-10, 10), randomFloat(-10, 10), randomFloat(-10, 10), randomFloat(-2, 2));
+    Vector4 simdV = m1 * v;
+    Vector4 scalarV = m1.multiplyScalar(v);
+    Vector4 scalesV = absolute(m1).multiplyScalar(Vector4(fabsf(v.x), fabsf(v.y), fabsf(v.z), fabsf(v.w)));
+    i = compare(&simdV.x, &scalarV.x, 4, MULTIPLY_EPSILON, &scalesV.x);
+    if(i >= 0)
+        failCount += fail("matrices", "%s %d: M*v [%d] is %g, scalar is %g", kind, index, i, (&simdV.x)[i], (&scalarV.x)[i]);
+
+    return failCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// batch transform of points, SoA and interleaved, against M * (x,y,z,1)
+///////////////////////////////////////////////////////////////////////////////
+static int testTransform(const Matrix4& m, const char* kind, int index)
+{
+    const int STRIDE = 8;                                   // floats, V/N/T interleaved
+    std::vector<float> x(TRANSFORM_POINT_COUNT), y(TRANSFORM_POINT_COUNT), z(TRANSFORM_POINT_COUNT);
+    std::vector<float> outX(TRANSFORM_POINT_COUNT), outY(TRANSFORM_POINT_COUNT), outZ(TRANSFORM_POINT_COUNT);
+    std::vector<float> interleaved(TRANSFORM_POINT_COUNT * STRIDE);
+    for(int i = 0; i < TRANSFORM_POINT_COUNT; ++i)
+    {
+        x[i] = interleaved[i * STRIDE] = randomFloat(-10, 10);
+        y[i] = interleaved[i * STRIDE + 1] = randomFloat(-10, 10);
+        z[i] = interleaved[i * STRIDE + 2] = randomFloat(-10, 10);
+    }
+
+    m.transform(&x[0], &y[0], &z[0], &outX[0], &outY[0], &outZ[0], TRANSFORM_POINT_COUNT);
+    m.transform(&interleaved[0], &interleaved[0], TRANSFORM_POINT_COUNT, STRIDE * sizeof(float));
+
+    for(int i = 0; i < TRANSFORM_POINT_COUNT; ++i)
+    {
+        Vector4 scalar = m.multiplyScalar(Vector4(x[i], y[i], z[i], 1));
+        Vector4 scales = absolute(m).multiplyScalar(Vector4(fabsf(x[i]), fabsf(y[i]), fabsf(z[i]), 1));
+        float soa[3] = { outX[i], outY[i], outZ[i] };
+        if(compare(soa, &scalar.x, 3, MULTIPLY_EPSILON, &scales.x) >= 0 ||
+           compare(&interleaved[i * STRIDE], &scalar.x, 3, MULTIPLY_EPSILON, &scales.x) >= 0)
+        {
+            return fail("matrices", "%s %d: transform point %d is (%g, %g, %g), scalar is (%g, %g, %g)",
+                        kind, index, i, soa[0], soa[1], soa[2], scalar.x, scalar.y, scalar.z);
+        }
+    }
+    return 0;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// invertAffine() and invertGeneral()
+///////////////////////////////////////////////////////////////////////////////
+static int testInverse(const Matrix4& m, bool affine, const char* kind, int index)
+{
+    int failCount = 0;
+
+    if(affine)
+    {
+        Matrix4 simd = m;
+        Matrix4 scalar = m;
+        simd.invertAffine();
+        scalar.invertAffineScalar();
+        int i = compare(simd.get(), scalar.get(), 16, INVERSE_EPSILON);
+        if(i >= 0)
+            failCount += fail("matrices", "%s %d: invertAffine [%d] is %g, scalar is %g", kind, index, i, simd[i], scalar[i]);
+    }
+
+    Matrix4 simd = m;
+    Matrix4 scalar = m;
+    simd.invertGeneral();
+    scalar.invertGeneralScalar();
+    int i = compare(simd.get(), scalar.get(), 16, INVERSE_EPSILON);
+    if(i >= 0)
+        failCount += fail("matrices", "%s %d: invertGeneral [%d] is %g, scalar is %g", kind, index, i, simd[i], scalar[i]);
+
+    return failCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// fused Euler builders against the composed rotations and translation, random
+// angles in [-360, 360] and translations in [-10, 10]
+///////////////////////////////////////////////////////////////////////////////
+static int testEulerBuilders()
+{
+    int failCount = 0;
+    for(int i = 0; i < EULER_ANGLE_COUNT && failCount < 10; ++i)
+    {
+        float ax = randomFloat(-360, 360), ay = randomFloat(-360, 360), az = randomFloat(-360, 360);
+        float tx = randomFloat(-10, 10), ty = randomFloat(-10, 10), tz = randomFloat(-10, 10);
+
+        Matrix4 composed;
+        composed.rotateZ(az);
+        composed.rotateY(ay);
+        composed.rotateX(ax);
+        composed.translate(tx, ty, tz);
+        Matrix4 fused = Matrix4::fromEulerTRS(ax, ay, az, tx, ty, tz);
+        int j = compare(fused.get(), composed.get(), 16, EULER_EPSILON);
+        if(j >= 0)
+            failCount += fail("matrices", "fromEulerTRS(%g, %g, %g, %g, %g, %g) [%d] is %g, composed is %g",
+                              ax, ay, az, tx, ty, tz, j, fused[j], composed[j]);
+
+        composed.identity();
+        composed.translate(tx, ty, tz);
+        composed.rotateX(ax);
+        composed.rotateY(ay);
+        composed.rotateZ(az);
+        fused = Matrix4::fromTranslateEuler(tx, ty, tz, ax, ay, az);
+        j = compare(fused.get(), composed.get(), 16, EULER_EPSILON);
+        if(j >= 0)
+            failCount += fail("matrices", "fromTranslateEuler(%g, %g, %g, %g, %g, %g) [%d] is %g, composed is %g",
+                              tx, ty, tz, ax, ay, az, j, fused[j], composed[j]);
+    }
+    return failCount;
+}
+
+
+
+int testMatrices()
+{
+    srand(3);
+    int failCount = 0;
+
+    for(int i = 0; i < RANDOM_MATRIX_COUNT && failCount < 10; ++i)
+    {
+        Matrix4 affine = makeRandomAffine();
+        Matrix4 general = makeRandomGeneral();
+        failCount += testMultiply(affine, general, "random", i);
+        failCount += testMultiply(makeRandom(100), makeRandom(100), "random", i);
+        failCount += testInverse(affine, true, "affine", i);
+        failCount += testInverse(general, false, "general", i);
+        if(i % 100 == 0)
+            failCount += testTransform(i % 200 == 0 ? affine : general, "random", i);
+    }
+
+    std::vector<Matrix4> degenerates = makeDegenerates();
+    for(int i = 0; i < (int)degenerates.size(); ++i)
+    {
+        const Matrix4& m = degenerates[i];
+        failCount += testMultiply(m, m, "degenerate", i);
+        failCount += testMultiply(m, makeRandomAffine(), "degenerate", i);
+        failCount += testTransform(m, "degenerate", i);
+        failCount += testInverse(m, m[3] == 0 && m[7] == 0 && m[11] == 0 && m[15] == 1, "degenerate", i);
+    }
+
+    failCount += testEulerBuilders();
+    return failCount;
+}
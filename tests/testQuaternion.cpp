@@ -0,0 +1,248 @@
+///////////////////////////////////////////////////////////////////////////////
+// testQuaternion.cpp
+// ==================
+// Quaternion conversions against the matrix builders of Matrix4, slerp/nlerp
+// endpoints and the shortest path, and KeyframeTrack sampling at keys, between
+// keys, out of range and looping.
+// q and -q are the same rotation, so quaternions are compared by |dot| = 1,
+// or by their matrices.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstdlib>
+#include "Matrices.h"
+#include "KeyframeTrack.h"
+#include "testCore.h"
+
+const float QUATERNION_EPSILON = 1e-5f;
+const float TRACK_EPSILON = 1e-4f;          // looping time loses a few bits
+const int RANDOM_ROTATION_COUNT = 100000;
+
+
+
+static float randomFloat(float min, float max)
+{
+    return min + (max - min) * (float)rand() / RAND_MAX;
+}
+
+// return index of the first different element, or -1
+static int compare(const float* a, const float* b, int count, float epsilon)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        if(fabsf(a[i] - b[i]) > epsilon)
+            return i;
+    }
+    return -1;
+}
+
+// same rotation, q or -q
+static bool isSameRotation(const Quaternion& q1, const Quaternion& q2, float epsilon)
+{
+    return fabsf(fabsf(q1.dot(q2)) - 1) <= epsilon;
+}
+
+// rotation angle from q1 to q2 in degree
+static float getAngle(const Quaternion& q1, const Quaternion& q2)
+{
+    float cosine = fabsf(q1.dot(q2));
+    if(cosine > 1)
+        cosine = 1;
+    return 2 * acosf(cosine) * 180.0f / 3.141593f;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// fromEuler(), getMatrix() and fromMatrix() against Matrix4::fromEulerTRS()
+///////////////////////////////////////////////////////////////////////////////
+static int testConversions()
+{
+    int failCount = 0;
+    for(int i = 0; i < RANDOM_ROTATION_COUNT && failCount < 10; ++i)
+    {
+        float ax = randomFloat(-360, 360), ay = randomFloat(-360, 360), az = randomFloat(-360, 360);
+        Vector3 t(randomFloat(-10, 10), randomFloat(-10, 10), randomFloat(-10, 10));
+        Matrix4 expected = Matrix4::fromEulerTRS(ax, ay, az, t.x, t.y, t.z);
+
+        Quaternion q = Quaternion::fromEuler(ax, ay, az);
+        if(fabsf(q.length() - 1) > QUATERNION_EPSILON)
+            failCount += fail("quaternion", "fromEuler(%g, %g, %g) length is %g", ax, ay, az, q.length());
+
+        // T * R
+        Matrix4 m = q.getMatrix(t);
+        int j = compare(m.get(), expected.get(), 16, QUATERNION_EPSILON * 10);     // translation up to 10
+        if(j >= 0)
+            failCount += fail("quaternion", "fromEuler(%g, %g, %g).getMatrix(t) [%d] is %g, fromEulerTRS is %g",
+                              ax, ay, az, j, m[j], expected[j]);
+
+        // rotation only
+        expected.setColumn(3, Vector4(0, 0, 0, 1));
+        m = q.getMatrix();
+        j = compare(m.get(), expected.get(), 16, QUATERNION_EPSILON);
+        if(j >= 0)
+            failCount += fail("quaternion", "fromEuler(%g, %g, %g).getMatrix() [%d] is %g, fromEulerTRS is %g",
+                              ax, ay, az, j, m[j], expected[j]);
+
+        // back from the matrix, all 4 branches of fromMatrix() are taken
+        Quaternion q2 = Quaternion::fromMatrix(expected);
+        if(!isSameRotation(q, q2, QUATERNION_EPSILON))
+            failCount += fail("quaternion", "fromMatrix(fromEulerTRS(%g, %g, %g)) is (%g, %g, %g, %g), fromEuler is (%g, %g, %g, %g)",
+                              ax, ay, az, q2.s, q2.x, q2.y, q2.z, q.s, q.x, q.y, q.z);
+        q2 = Quaternion::fromMatrix(q.getMatrix3());
+        if(!isSameRotation(q, q2, QUATERNION_EPSILON))
+            failCount += fail("quaternion", "fromMatrix(getMatrix3()) of (%g, %g, %g) is not the same rotation", ax, ay, az);
+
+        // rotate a vector directly
+        Vector3 v(randomFloat(-1, 1), randomFloat(-1, 1), randomFloat(-1, 1));
+        Vector3 v1 = q.rotate(v);
+        Vector3 v2 = expected * v;
+        if(!v1.equal(v2, QUATERNION_EPSILON))
+            failCount += fail("quaternion", "rotate() of (%g, %g, %g) is (%g, %g, %g), matrix is (%g, %g, %g)",
+                              ax, ay, az, v1.x, v1.y, v1.z, v2.x, v2.y, v2.z);
+    }
+    return failCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// slerp() and nlerp(): endpoints, constant angular speed of slerp, and the
+// shortest path when the quaternions are on opposite hemispheres
+///////////////////////////////////////////////////////////////////////////////
+static int testInterpolation()
+{
+    int failCount = 0;
+    const Vector3 axisZ(0, 0, 1);
+
+    // random endpoints
+    for(int i = 0; i < 1000 && failCount < 10; ++i)
+    {
+        Quaternion from = Quaternion::fromEuler(randomFloat(-180, 180), randomFloat(-180, 180), randomFloat(-180, 180));
+        Quaternion to = Quaternion::fromEuler(randomFloat(-180, 180), randomFloat(-180, 180), randomFloat(-180, 180));
+        if(!isSameRotation(Quaternion::slerp(from, to, 0), from, QUATERNION_EPSILON) ||
+           !isSameRotation(Quaternion::slerp(from, to, 1), to, QUATERNION_EPSILON))
+            failCount += fail("quaternion", "slerp() %d: endpoints are not the inputs", i);
+        if(!isSameRotation(Quaternion::nlerp(from, to, 0), from, QUATERNION_EPSILON) ||
+           !isSameRotation(Quaternion::nlerp(from, to, 1), to, QUATERNION_EPSILON))
+            failCount += fail("quaternion", "nlerp() %d: endpoints are not the inputs", i);
+
+        // the angle from the start is proportional to t
+        float angle = getAngle(from, to);
+        for(int k = 1; k < 4; ++k)
+        {
+            float t = k * 0.25f;
+            Quaternion q = Quaternion::slerp(from, to, t);
+            if(fabsf(q.length() - 1) > QUATERNION_EPSILON)
+                failCount += fail("quaternion", "slerp() %d at %g: length is %g", i, t, q.length());
+            if(fabsf(getAngle(from, q) - angle * t) > 0.05f)   // acos() near 1 loses precision
+                failCount += fail("quaternion", "slerp() %d at %g: angle is %g, expected %g", i, t, getAngle(from, q), angle * t);
+        }
+    }
+
+    // 0 to 90 degree about z, stored as -q, still goes through 45 not 225
+    Quaternion from;
+    Quaternion to = -Quaternion::fromAxisAngle(axisZ, 90);
+    Quaternion half = Quaternion::fromAxisAngle(axisZ, 45);
+    Quaternion q = Quaternion::slerp(from, to, 0.5f);
+    if(!isSameRotation(q, half, QUATERNION_EPSILON))
+        failCount += fail("quaternion", "slerp() does not take the shortest path, (%g, %g, %g, %g)", q.s, q.x, q.y, q.z);
+    q = Quaternion::nlerp(from, to, 0.5f);
+    if(!isSameRotation(q, half, QUATERNION_EPSILON))
+        failCount += fail("quaternion", "nlerp() does not take the shortest path, (%g, %g, %g, %g)", q.s, q.x, q.y, q.z);
+
+    // nearly same rotations fall back to nlerp, still normalized
+    to = Quaternion::fromAxisAngle(axisZ, 0.01f);
+    q = Quaternion::slerp(from, to, 0.5f);
+    if(fabsf(q.length() - 1) > QUATERNION_EPSILON || !isSameRotation(q, Quaternion::fromAxisAngle(axisZ, 0.005f), QUATERNION_EPSILON))
+        failCount += fail("quaternion", "slerp() of nearly same rotations is (%g, %g, %g, %g)", q.s, q.x, q.y, q.z);
+
+    return failCount;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// KeyframeTrack: 0 to 90 to 180 degree about z at time 1, 2 and 4, moving
+// along x; keys are added out of order
+///////////////////////////////////////////////////////////////////////////////
+static int testTrack()
+{
+    int failCount = 0;
+    const Vector3 axisZ(0, 0, 1);
+
+    KeyframeTrack track;
+    if(!isSameRotation(track.getRotation(1), Quaternion(), 0) || compare(track.getMatrix(1).get(), Matrix4().get(), 16, 0) >= 0)
+        failCount += fail("quaternion", "empty track is not identity");
+
+    track.addKey(4, Quaternion::fromAxisAngle(axisZ, 180), Vector3(4, 0, 0));
+    track.addKey(1, Quaternion::fromAxisAngle(axisZ, 0), Vector3(0, 0, 0));
+    track.addKey(2, Quaternion::fromAxisAngle(axisZ, 90), Vector3(2, 0, 0));
+    if(track.getKeyCount() != 3 || track.getKey(0).time != 1 || track.getKey(1).time != 2 || track.getKey(2).time != 4)
+        failCount += fail("quaternion", "track keys are not sorted by time");
+    if(track.getDuration() != 3)
+        failCount += fail("quaternion", "track duration is %g, expected 3", track.getDuration());
+
+    // time, expected angle and x, clamped out of range without loop
+    const float SAMPLES[][3] =
+    {
+        { 1,    0,   0 },               // at keys
+        { 2,    90,  2 },
+        { 4,    180, 4 },
+        { 1.5f, 45,  1 },               // between keys
+        { 3,    135, 3 },
+        { 3.5f, 157.5f, 3.5f },
+        { 0,    0,   0 },               // before the first key
+        { 9,    180, 4 }                // after the last key
+    };
+    for(int pass = 0; pass < 2; ++pass)
+    {
+        // the same samples with loop, shifted by whole durations
+        bool loop = (pass == 1);
+        track.setLoop(loop);
+        for(int i = 0; i < (int)(sizeof(SAMPLES) / sizeof(SAMPLES[0])); ++i)
+        {
+            float time = SAMPLES[i][0];
+            if(loop && (time < 1 || time > 4))
+                continue;                               // clamping only
+            for(int k = 0; k < (loop ? 4 : 1); ++k)
+            {
+                float shift = loop ? (k - 1) * 3.0f * (k == 3 ? 1000 : 1) : 0;    // -3, 0, 3, 6000 seconds
+                float t = time + shift;
+                Quaternion expected = Quaternion::fromAxisAngle(axisZ, SAMPLES[i][1]);
+                Vector3 position(SAMPLES[i][2], 0, 0);
+                if(loop && time == 4)
+                {
+                    // the end of a loop is the start of the next loop
+                    expected = Quaternion();
+                    position.set(0, 0, 0);
+                }
+
+                Quaternion q = track.getRotation(t);
+                if(!isSameRotation(q, expected, TRACK_EPSILON))
+                    failCount += fail("quaternion", "track (loop %d) rotation at %g is %g degree, expected %g",
+                                      loop, t, getAngle(Quaternion(), q), getAngle(Quaternion(), expected));
+                Vector3 p = track.getPosition(t);
+                if(!p.equal(position, TRACK_EPSILON))
+                    failCount += fail("quaternion", "track (loop %d) position at %g is (%g, %g, %g), expected (%g, %g, %g)",
+                                      loop, t, p.x, p.y, p.z, position.x, position.y, position.z);
+
+                // matrix and dual quaternion from the same segment
+                Matrix4 m1 = track.getMatrix(t);
+                Matrix4 m2 = q.getMatrix(p);
+                Matrix4 m3 = track.getDualQuaternion(t).getMatrix();
+                if(compare(m1.get(), m2.get(), 16, TRACK_EPSILON) >= 0 || compare(m3.get(), m2.get(), 16, TRACK_EPSILON) >= 0)
+                    failCount += fail("quaternion", "track (loop %d) matrix at %g is not T * R of the samples", loop, t);
+            }
+        }
+    }
+    return failCount;
+}
+
+
+
+int testQuaternion()
+{
+    srand(14);
+    return testConversions() + testInterpolation() + testTrack();
+}
@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshBake.cpp
+// ============
+// bake the meshes in teapot.h and cameraSimple.h into binary mesh files
+// The triangle strips are converted to a single triangle list, and the
+// vertices are quantized by BinaryMesh::save().
+//
+// USAGE: meshBake [OUTPUT_DIR]
+// It writes teapot.mesh and camera.mesh into OUTPUT_DIR (default: current).
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "BinaryMesh.h"
+#include "teapot.h"
+#include "cameraSimple.h"
+
+// strips of cameraSimple.h, packed one after another
+static const int cameraStripCounts[] = { 5, 5, 5, 5, 5, 5, 39, 44, 44, 44, 44 };
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// convert packed triangle strips to triangle list
+// odd triangles of a strip are reversed to keep the winding, and degenerate
+// triangles joining the strips are dropped
+///////////////////////////////////////////////////////////////////////////////
+template<class T>
+static std::vector<unsigned int> stripsToTriangles(const T* indices, const int* stripCounts,
+                                                   int stripCount)
+{
+    std::vector<unsigned int> triangles;
+    for(int i = 0; i < stripCount; ++i)
+    {
+        for(int j = 2; j < stripCounts[i]; ++j)
+        {
+            unsigned int i1 = indices[j - 2];
+            unsigned int i2 = indices[j - 1];
+            unsigned int i3 = indices[j];
+            if(i1 == i2 || i2 == i3 || i1 == i3)
+                continue;
+
+            if(j % 2 == 0)
+            {
+                triangles.push_back(i1);
+                triangles.push_back(i2);
+            }
+            else
+            {
+                triangles.push_back(i2);
+                triangles.push_back(i1);
+            }
+            triangles.push_back(i3);
+        }
+        indices += stripCounts[i];
+    }
+    return triangles;
+}
+
+
+
+static bool bake(const std::string& fileName, const float* positions, const float* normals,
+                 unsigned int vertexCount, const std::vector<unsigned int>& indices)
+{
+    if(!BinaryMesh::save(fileName.c_str(), positions, normals, vertexCount, &indices[0],
+                         (unsigned int)indices.size()))
+    {
+        printf("[ERROR] Failed to write %s\n", fileName.c_str());
+        return false;
+    }
+
+    BinaryMesh mesh;
+    if(!mesh.open(fileName.c_str()))
+    {
+        printf("[ERROR] %s\n", mesh.getErrorMessage().c_str());
+        return false;
+    }
+    printf("%s: %u vertices, %u triangles, %u-bit indices\n", fileName.c_str(),
+           mesh.getVertexCount(), mesh.getIndexCount() / 3, mesh.getIndexSize() * 8);
+    return true;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    std::string dir = (argc > 1) ? std::string(argv[1]) + "/" : "";
+
+    // teapot: 16-bit indices
+    std::vector<int> teapotCounts(teapotStripCounts, teapotStripCounts + TEAPOT_STRIP_COUNT);
+    std::vector<unsigned int> teapotTriangles = stripsToTriangles(teapotIndices, &teapotCounts[0],
+                                                                  TEAPOT_STRIP_COUNT);
+    bool result = bake(dir + "teapot.mesh", teapotVertices, teapotNormals,
+                       sizeof(teapotVertices) / sizeof(teapotVertices[0]) / 3, teapotTriangles);
+
+    // camera: 32-bit indices
+    int cameraStripCount = sizeof(cameraStripCounts) / sizeof(cameraStripCounts[0]);
+    std::vector<unsigned int> cameraTriangles = stripsToTriangles(cameraIndices, cameraStripCounts,
+                                                                  cameraStripCount);
+    result = bake(dir + "camera.mesh", cameraVertices, cameraNormals,
+                  sizeof(cameraVertices) / sizeof(cameraVertices[0]) / 3, cameraTriangles) && result;
+
+    return result ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////
+// teapotMeshCheck.cpp
+// ===================
+// check the baked teapot mesh loaded by MeshCache is geometrically identical to
+// the triangle strips in teapot.h, and report the draw call reduction
+// It does not need OpenGL context, both meshes are compared on CPU. The
+// positions and normals may differ within the 16-bit quantization error.
+//
+// USAGE: teapotMeshCheck [teapot.mesh]
+// It returns 0 if all triangles match, otherwise 1.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "MeshCache.h"
+#include "teapot.h"
+
+// triangle with the smallest index first, winding order is preserved
+struct Triangle
+{
+    unsigned int i1, i2, i3;
+
+    Triangle(unsigned int a, unsigned int b, unsigned int c)
+    {
+        if(a <= b && a <= c)        { i1 = a; i2 = b; i3 = c; }
+        else if(b <= a && b <= c)   { i1 = b; i2 = c; i3 = a; }
+        else                        { i1 = c; i2 = a; i3 = b; }
+    }
+
+    bool operator<(const Triangle& rhs) const
+    {
+        if(i1 != rhs.i1) return i1 < rhs.i1;
+        if(i2 != rhs.i2) return i2 < rhs.i2;
+        return i3 < rhs.i3;
+    }
+
+    bool operator==(const Triangle& rhs) const
+    {
+        return i1 == rhs.i1 && i2 == rhs.i2 && i3 == rhs.i3;
+    }
+};
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+// expand the strips as OpenGL does for GL_TRIANGLE_STRIP:
+// triangle n is (v[n], v[n+1], v[n+2]) if n is even, (v[n+1], v[n], v[n+2]) if odd
+///////////////////////////////////////////////////////////////////////////////
+static std::vector<Triangle> expandStrips(int& stripTriangleCount)
+{
+    std::vector<Triangle> triangles;
+    stripTriangleCount = 0;
+
+    int offset = 0;
+    for(int i = 0; i < TEAPOT_STRIP_COUNT; ++i)
+    {
+        const GLushort* v = &teapotIndices[offset];
+        for(int n = 0; n + 2 < teapotStripCounts[i]; ++n)
+        {
+            ++stripTriangleCount;
+            unsigned int a = v[n], b = v[n + 1], c = v[n + 2];
+            if(a == b || b == c || a == c)
+                continue;   // degenerate, nothing is rasterized
+
+            if(n % 2 == 0)
+                triangles.push_back(Triangle(a, b, c));
+            else
+                triangles.push_back(Triangle(b, a, c));
+        }
+        offset += teapotStripCounts[i];
+    }
+    return triangles;
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    const char* fileName = (argc > 1) ? argv[1] : CS105_DATA_DIR "/teapot.mesh";
+    const float SIZE = 2.0f;
+    const float POSITION_EPSILON = 7.0f / 65535;    // teapot is about 6.4 wide
+    const float NORMAL_EPSILON = 1.0f / 32767;
+    bool passed = true;
+
+    // reference: triangles drawn by the strips
+    int stripTriangleCount;
+    std::vector<Triangle> expected = expandStrips(stripTriangleCount);
+    std::sort(expected.begin(), expected.end());
+
+    // merged mesh
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    if(!MeshCache::buildTeapot(SIZE, vertices, indices, fileName))
+        return 1;
+
+    // vertices must be teapot.h vertices with the glutSolidTeapot transform
+    const int vertexCount = sizeof(teapotVertices) / sizeof(teapotVertices[0]) / 3;
+    if((int)vertices.size() != vertexCount * 8)
+    {
+        printf("[FAIL] vertex count: %d, expected %d\n", (int)vertices.size() / 8, vertexCount);
+        return 1;
+    }
+
+    const float scale = 0.5f * SIZE;
+    float positionError = 0, normalError = 0;
+    for(int i = 0; i < vertexCount; ++i)
+    {
+        const float* v = &vertices[i * 8];
+        const float* p = &teapotVertices[i * 3];
+        const float* n = &teapotNormals[i * 3];
+        positionError = std::max(positionError, fabsf(v[0] / scale - p[0]));
+        positionError = std::max(positionError, fabsf(v[1] / scale + 1.5f - p[1]));
+        positionError = std::max(positionError, fabsf(v[2] / scale - p[2]));
+        for(int j = 0; j < 3; ++j)
+            normalError = std::max(normalError, fabsf(v[3 + j] - n[j]));
+    }
+    printf("max error: position %g, normal %g\n", positionError, normalError);
+    if(positionError > POSITION_EPSILON || normalError > NORMAL_EPSILON)
+    {
+        printf("[FAIL] vertices are different\n");
+        passed = false;
+    }
+
+    // triangles must be the same set with the same winding
+    std::vector<Triangle> merged;
+    for(size_t i = 0; i + 2 < indices.size(); i += 3)
+        merged.push_back(Triangle(indices[i], indices[i + 1], indices[i + 2]));
+    std::sort(merged.begin(), merged.end());
+    if(merged != expected)
+    {
+        printf("[FAIL] triangles: %d, expected %d\n", (int)merged.size(), (int)expected.size());
+        passed = false;
+    }
+
+    printf("strips:    %d draw calls, %d triangles (%d degenerate), %d indices (16-bit)\n",
+           TEAPOT_STRIP_COUNT, stripTriangleCount, stripTriangleCount - (int)expected.size(),
+           (int)(sizeof(teapotIndices) / sizeof(teapotIndices[0])));
+    printf("merged:    1 draw call, %d triangles, %d indices (32-bit)\n",
+           (int)merged.size(), (int)indices.size());
+    printf("%s\n", passed ? "[PASS] merged mesh is identical to the strips" : "[FAIL]");
+    return passed ? 0 : 1;
+}